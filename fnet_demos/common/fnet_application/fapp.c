@@ -237,6 +237,24 @@ const struct fnet_shell_command fapp_cmd_table [] =
 #if FAPP_CFG_BENCH_CMD   
     { "benchrx",    0u, 2u, fapp_benchrx_cmd, "Receiver Benchmark", "[tcp|udp [multicast ip]"},
     { "benchtx",    1u, 5u, fapp_benchtx_cmd, "Transmitter Benchmark", "<remote ip>[tcp|udp[<message size>\r\n\t[<number of messages>[<number of iterations>]]]"},
+#if FNET_CFG_HEAP_SLAB
+    { "benchmem",   0u, 1u, fapp_benchmem_cmd, "Memory Allocator Benchmark", "[<number of operations>]"},
+#endif
+    { "benchcsum",  0u, 1u, fapp_benchcsum_cmd, "Checksum Benchmark", "[<number of iterations>]"},
+#if FNET_CFG_TCP && FNET_CFG_IP4
+    { "benchtcpdemux", 0u, 1u, fapp_benchtcpdemux_cmd, "TCP Demultiplexing Benchmark", "[<number of segments>]"},
+#endif
+#if FNET_CFG_TCP && !FNET_CFG_TCP_DISCARD_OUT_OF_ORDER
+    { "benchtcpreass", 0u, 1u, fapp_benchtcpreass_cmd, "TCP Reassembly Benchmark", "[<number of segments>]"},
+#endif
+#if FNET_CFG_TCP && FNET_CFG_IP4 && FNET_CFG_LOOPBACK
+    { "benchtcpchurn", 0u, 1u, fapp_benchtcpchurn_cmd, "TCP Connection Churn Benchmark", "[<number of connections>]"},
+    { "benchtcploss", 0u, 1u, fapp_benchtcploss_cmd, "TCP Loss Recovery Benchmark", "[<number of KB>]"},
+    { "benchtcpwrite", 0u, 1u, fapp_benchtcpwrite_cmd, "TCP Small Write Benchmark", "[<number of KB>]"},
+#if FNET_CFG_LOOPBACK_DELAY_QUEUE
+    { "benchtcprtt", 0u, 2u, fapp_benchtcprtt_cmd, "TCP Large Window Benchmark", "[<buffer KB> [<number of KB>]]"},
+#endif
+#endif
 #endif
 #if FAPP_CFG_REINIT_CMD   /* Used to test FNET release/init only. */
     { "reinit",     0u, 0u, fapp_reinit_cmd,  "Reinit application", ""},
@@ -786,6 +804,7 @@ static void fapp_stat_cmd( fnet_shell_desc_t desc, fnet_index_t argc, fnet_char_
         fnet_shell_println(desc, "\nPackets:");
         fnet_shell_println(desc, FAPP_SHELL_INFO_FORMAT_D, "TX Packets", statistics.tx_packet);
         fnet_shell_println(desc, FAPP_SHELL_INFO_FORMAT_D, "RX Packets", statistics.rx_packet);
+        fnet_shell_println(desc, FAPP_SHELL_INFO_FORMAT_D, "TX Dropped", statistics.tx_drop);
     }
 
 #if FNET_CFG_IP6
@@ -31,6 +31,9 @@
 #include "fapp.h"
 #include "fapp_prv.h"
 #include "fapp_bench.h"
+#include "stack/fnet_checksum.h"
+#include "stack/fnet_prot.h"
+#include "stack/fnet_loop.h"
 
 #if FAPP_CFG_BENCH_CMD
 
@@ -98,6 +101,26 @@ static void fapp_bench_tcp_rx (fnet_shell_desc_t desc, fnet_address_family_t fam
 static void fapp_bench_udp_rx (fnet_shell_desc_t desc, fnet_address_family_t family, struct sockaddr *multicast_address /* optional, set to 0*/);
 static void fapp_bench_tcp_tx (struct fapp_bench_tx_params *params);
 static void fapp_bench_udp_tx (struct fapp_bench_tx_params *params);
+#if FNET_CFG_HEAP_SLAB
+static void fapp_bench_mem_run( fnet_shell_desc_t desc, fnet_char_t *name, fnet_bool_t slab, fnet_size_t iterations );
+#endif
+static fnet_uint16_t fapp_bench_csum_ref( const fnet_uint8_t *buf, fnet_size_t len );
+static fnet_size_t fapp_bench_csum_test( fnet_size_t tests );
+static void fapp_bench_csum_run( fnet_shell_desc_t desc, fnet_char_t *name, const fnet_uint8_t *buf, fnet_size_t iterations );
+#if FNET_CFG_TCP && FNET_CFG_IP4
+static void fapp_bench_demux_run( fnet_shell_desc_t desc, fnet_size_t sockets, fnet_size_t iterations );
+#endif
+#if FNET_CFG_TCP && !FNET_CFG_TCP_DISCARD_OUT_OF_ORDER
+static void fapp_bench_reass_run( fnet_shell_desc_t desc, fnet_char_t *name, fnet_size_t segments, fnet_bool_t loss );
+#endif
+#if FNET_CFG_TCP && FNET_CFG_IP4 && FNET_CFG_LOOPBACK
+static fnet_return_t fapp_bench_churn_connection( fnet_socket_t listen_sock, struct sockaddr *addr );
+static fnet_return_t fapp_bench_loop_connect( fnet_shell_desc_t desc, fnet_size_t bufsize, fnet_socket_t *listen_sock, fnet_socket_t *tx_sock, fnet_socket_t *rx_sock );
+static void fapp_bench_loop_close( fnet_socket_t listen_sock, fnet_socket_t tx_sock, fnet_socket_t rx_sock );
+static void fapp_bench_loop_run( fnet_shell_desc_t desc, const fnet_char_t *name, fnet_index_t loss, fnet_time_t delay, fnet_size_t bufsize, fnet_size_t size );
+static fnet_size_t fapp_bench_sndbuf_netbufs( fnet_socket_t s );
+static void fapp_bench_write_run( fnet_shell_desc_t desc, fnet_size_t write_size, fnet_size_t size );
+#endif
 
 /************************************************************************
 * NAME: fapp_bench_print_results
@@ -895,6 +918,1130 @@ void fapp_benchtx_cmd( fnet_shell_desc_t desc, fnet_index_t argc, fnet_char_t **
 }
 
 
+#if FNET_CFG_HEAP_SLAB
+/************************************************************************
+* NAME: fapp_bench_mem_run
+*
+* DESCRIPTION: Runs random alloc/free sequence in a memory pool. 
+************************************************************************/
+static void fapp_bench_mem_run( fnet_shell_desc_t desc, fnet_char_t *name, fnet_bool_t slab, fnet_size_t iterations )
+{
+    static const fnet_mempool_slab_class_t  classes[] =
+    {
+        {sizeof(fnet_netbuf_t), FAPP_BENCH_MEM_SLOTS/2u},
+        {FAPP_BENCH_MEM_CB_SIZE, 4u},
+        {FAPP_BENCH_MEM_DATA_SIZE, 4u}
+    };
+    void                *slots[FAPP_BENCH_MEM_SLOTS];
+    fnet_mempool_desc_t mpool;
+    fnet_uint32_t       rnd = 1u;
+    fnet_size_t         i;
+    fnet_index_t        slot;
+    fnet_size_t         size;
+    fnet_size_t         failed = 0u;
+    fnet_size_t         free_size;
+    fnet_size_t         max_size;
+    fnet_time_t         interval;
+    
+    fnet_memset_zero(slots, sizeof(slots));
+    
+    /* The benchmark buffer is used as the pool memory.*/
+    mpool = fnet_mempool_init(fapp_bench.buffer, sizeof(fapp_bench.buffer), FNET_MEMPOOL_ALIGN_8);
+    if(mpool == 0)
+    {
+        return;
+    }
+    
+    if(slab && (fnet_mempool_slab_init(mpool, classes, sizeof(classes)/sizeof(classes[0])) == FNET_ERR))
+    {
+        fnet_shell_println(desc, FAPP_INIT_ERR, "slab");
+        return;
+    }
+    
+    fapp_bench.first_time = fnet_timer_ticks();
+    
+    for(i = 0u; i < iterations; i++)
+    {
+        rnd = rnd * 1103515245u + 12345u; /* LCG */
+        slot = (rnd >> 8) % FAPP_BENCH_MEM_SLOTS;
+        
+        if(slots[slot])
+        {
+            fnet_mempool_free(mpool, slots[slot]);
+            slots[slot] = 0;
+        }
+        else
+        {
+            /* Netbuf headers dominate, then data buffers and control blocks.*/
+            switch((rnd >> 16) & 0x7u)
+            {
+                case 0: case 1: case 2: case 3:
+                    size = sizeof(fnet_netbuf_t);
+                    break;
+                case 4: case 5:
+                    size = FAPP_BENCH_MEM_DATA_SIZE;
+                    break;
+                case 6:
+                    size = FAPP_BENCH_MEM_CB_SIZE;
+                    break;
+                default:
+                    size = 16u + ((rnd >> 20) & 0xFFu);
+                    break;
+            }
+            
+            slots[slot] = fnet_mempool_malloc(mpool, size);
+            if(slots[slot] == 0)
+            {
+                failed++;
+            }
+        }
+    }
+    
+    fapp_bench.last_time = fnet_timer_ticks();
+    interval = fnet_timer_get_interval(fapp_bench.first_time, fapp_bench.last_time);
+    
+    free_size = fnet_mempool_free_mem_status(mpool);
+    max_size = fnet_mempool_malloc_max(mpool);
+    
+    fnet_shell_println(desc, "%-6s: %u operations in %u ms, %u failed", name, iterations, interval*FNET_TIMER_PERIOD_MS, failed);
+    fnet_shell_println(desc, "\tfree %u bytes, max chunk %u bytes, fragmentation %u%%", free_size, max_size,
+                        (free_size == 0u) ? 0u : (100u - ((max_size*100u)/free_size)));
+    
+    for(i = 0u; i < FAPP_BENCH_MEM_SLOTS; i++)
+    {
+        fnet_mempool_free(mpool, slots[i]);
+    }
+    
+    fnet_mempool_release(mpool);
+}
+
+/************************************************************************
+* NAME: fapp_benchmem_cmd
+*
+* DESCRIPTION: Start memory allocator benchmark. 
+*              Compares the first/best-fit arena with the slab allocator.
+************************************************************************/
+void fapp_benchmem_cmd( fnet_shell_desc_t desc, fnet_index_t argc, fnet_char_t ** argv )
+{
+    fnet_size_t     iterations = FAPP_BENCH_MEM_ITERATIONS_DEFAULT;
+    fnet_char_t     *p = 0;
+
+    if(argc > 1)
+    {
+        iterations = fnet_strtoul(argv[1], &p, 0);
+        if(iterations == 0u)
+        {
+            fnet_shell_println(desc, FAPP_PARAM_ERR, argv[1]); /* Print error mesage. */
+            return;
+        }
+    }
+
+    fnet_shell_println(desc, "Memory allocator benchmark (pool %u bytes):", sizeof(fapp_bench.buffer));
+
+    fapp_bench_mem_run(desc, "arena", FNET_FALSE, iterations);
+    fapp_bench_mem_run(desc, "slab", FNET_TRUE, iterations);
+    
+    fnet_shell_println(desc, FAPP_BENCH_COMPLETED_STR);
+}
+#endif /* FNET_CFG_HEAP_SLAB */
+
+/************************************************************************
+* NAME: fapp_bench_csum_ref
+*
+* DESCRIPTION: Reference byte-wise Internet checksum, 
+*              in host byte order. 
+************************************************************************/
+static fnet_uint16_t fapp_bench_csum_ref( const fnet_uint8_t *buf, fnet_size_t len )
+{
+    fnet_uint32_t   sum = 0u;
+    fnet_size_t     i;
+    
+    for(i = 0u; (i + 1u) < len; i += 2u)
+    {
+        sum += ((fnet_uint32_t)buf[i] << 8) | buf[i + 1u];
+    }
+    
+    if((len & 1u) != 0u)
+    {
+        sum += (fnet_uint32_t)buf[len - 1u] << 8;
+    }
+    
+    while((sum >> 16) != 0u)
+    {
+        sum = (sum & 0xffffu) + (sum >> 16);
+    }
+    
+    return (fnet_uint16_t)(~sum & 0xffffu);
+}
+
+/************************************************************************
+* NAME: fapp_bench_csum_test
+*
+* DESCRIPTION: Checks the stack checksum against the reference one, 
+*              for random data, start alignments and net_buf chain splits.
+*              Returns number of mismatches.
+************************************************************************/
+static fnet_size_t fapp_bench_csum_test( fnet_size_t tests )
+{
+    fnet_uint32_t   rnd = 1u;
+    fnet_size_t     errors = 0u;
+    fnet_size_t     t;
+    fnet_size_t     offset;
+    fnet_size_t     len;
+    fnet_size_t     pos;
+    fnet_size_t     seg_len;
+    fnet_uint8_t    *buf;
+    fnet_uint16_t   sum_ref;
+    fnet_netbuf_t   *nb;
+    fnet_netbuf_t   *nb_seg;
+    
+    for(t = 0u; t < tests; t++)
+    {
+        /* New random data.*/
+        for(pos = 0u; pos < (FAPP_BENCH_CSUM_SIZE + 4u); pos++)
+        {
+            rnd = rnd * 1103515245u + 12345u; /* LCG */
+            fapp_bench.buffer[pos] = (fnet_uint8_t)(rnd >> 16);
+        }
+        
+        rnd = rnd * 1103515245u + 12345u;
+        offset = (rnd >> 8) & 0x3u;
+        len = 1u + ((rnd >> 12) % FAPP_BENCH_CSUM_SIZE);
+        buf = &fapp_bench.buffer[offset];
+        
+        sum_ref = fapp_bench_csum_ref(buf, len);
+        
+        if(fnet_ntohs(fnet_checksum_buf(buf, len)) != sum_ref)
+        {
+            errors++;
+        }
+
+        /* Split to a chain of random, also odd, segment lengths.*/
+        nb = 0;
+        for(pos = 0u; pos < len; pos += seg_len)
+        {
+            rnd = rnd * 1103515245u + 12345u;
+            seg_len = ((rnd >> 16) & 1u) ? (1u + ((rnd >> 8) & 0x3u)) : (1u + ((rnd >> 8) % 300u));
+            if(seg_len > (len - pos))
+            {
+                seg_len = len - pos;
+            }
+            
+            nb_seg = fnet_netbuf_from_buf(&buf[pos], seg_len, FNET_FALSE);
+            if(nb_seg == 0)
+            {
+                break;
+            }
+            nb = (nb == 0) ? nb_seg : fnet_netbuf_concat(nb, nb_seg);
+        }
+        
+        if(pos < len) /* No memory.*/
+        {
+            errors++;
+        }
+        else if(fnet_ntohs(fnet_checksum(nb, len)) != sum_ref)
+        {
+            errors++;
+        }
+        else
+        {}
+        
+        if(nb)
+        {
+            fnet_netbuf_free_chain(nb);
+        }
+    }
+    
+    return errors;
+}
+
+/************************************************************************
+* NAME: fapp_bench_csum_run
+*
+* DESCRIPTION: Measures checksum calculation time. 
+************************************************************************/
+static void fapp_bench_csum_run( fnet_shell_desc_t desc, fnet_char_t *name, const fnet_uint8_t *buf, fnet_size_t iterations )
+{
+    fnet_size_t     i;
+    fnet_uint16_t   sum = 0u;
+    fnet_time_t     interval;
+    
+    fapp_bench.first_time = fnet_timer_ticks();
+    
+    for(i = 0u; i < iterations; i++)
+    {
+        sum += fnet_checksum_buf((fnet_uint8_t *)buf, FAPP_BENCH_CSUM_SIZE);
+    }
+    
+    fapp_bench.last_time = fnet_timer_ticks();
+    interval = fnet_timer_get_interval(fapp_bench.first_time, fapp_bench.last_time)*FNET_TIMER_PERIOD_MS;
+    
+    fnet_shell_println(desc, "%-8s: %u x %u bytes in %u ms (%u KB/s) [%04X]", name, iterations, FAPP_BENCH_CSUM_SIZE, interval,
+                        (interval == 0u) ? 0u : ((iterations * FAPP_BENCH_CSUM_SIZE) / interval), sum);
+}
+
+/************************************************************************
+* NAME: fapp_benchcsum_cmd
+*
+* DESCRIPTION: Start Internet checksum benchmark. 
+*              Verifies the checksum kernel and measures its speed.
+************************************************************************/
+void fapp_benchcsum_cmd( fnet_shell_desc_t desc, fnet_index_t argc, fnet_char_t ** argv )
+{
+    fnet_size_t     iterations = FAPP_BENCH_CSUM_ITERATIONS_DEFAULT;
+    fnet_char_t     *p = 0;
+    fnet_size_t     errors;
+
+    if(argc > 1)
+    {
+        iterations = fnet_strtoul(argv[1], &p, 0);
+        if(iterations == 0u)
+        {
+            fnet_shell_println(desc, FAPP_PARAM_ERR, argv[1]); /* Print error mesage. */
+            return;
+        }
+    }
+
+    fnet_shell_println(desc, "Checksum benchmark:");
+    
+    errors = fapp_bench_csum_test(FAPP_BENCH_CSUM_TESTS);
+    fnet_shell_println(desc, "%-8s: %u tests, %u errors", "verify", FAPP_BENCH_CSUM_TESTS, errors);
+
+    fapp_bench_csum_run(desc, "aligned", &fapp_bench.buffer[0], iterations);
+    fapp_bench_csum_run(desc, "odd", &fapp_bench.buffer[1], iterations);
+    
+    fnet_shell_println(desc, FAPP_BENCH_COMPLETED_STR);
+}
+
+#if FNET_CFG_TCP && FNET_CFG_IP4
+/************************************************************************
+* NAME: fapp_bench_demux_run
+*
+* DESCRIPTION: Measures TCP input demultiplexing time. 
+*              RST segments to a closed port are passed directly to 
+*              the TCP input, so the socket lookup is the worst case
+*              and no reply is sent.
+************************************************************************/
+static void fapp_bench_demux_run( fnet_shell_desc_t desc, fnet_size_t sockets, fnet_size_t iterations )
+{
+    fnet_netif_t        *netif = (fnet_netif_t *)fnet_netif_get_default();
+    struct sockaddr     src_addr;
+    struct sockaddr     dest_addr;
+    fnet_tcp_header_t   header;
+    fnet_netbuf_t       *nb;
+    fnet_size_t         i;
+    fnet_time_t         interval;
+
+    /* Documentation addresses (RFC5737), they are never used for sending.*/
+    fnet_memset_zero(&src_addr, sizeof(src_addr));
+    src_addr.sa_family = AF_INET;
+    ((struct sockaddr_in *)(&src_addr))->sin_addr.s_addr = FNET_IP4_ADDR_INIT(192u, 0u, 2u, 1u);
+    fnet_memset_zero(&dest_addr, sizeof(dest_addr));
+    dest_addr.sa_family = AF_INET;
+    ((struct sockaddr_in *)(&dest_addr))->sin_addr.s_addr = FNET_IP4_ADDR_INIT(192u, 0u, 2u, 2u);
+
+    /* RST segment to the port just below the listening ones.*/
+    fnet_memset_zero(&header, sizeof(header));
+    header.source_port = FNET_HTONS(FAPP_BENCH_DEMUX_SRC_PORT);
+    header.destination_port = FNET_HTONS(FAPP_BENCH_DEMUX_PORT - 1u);
+    header.hdrlength__flags = FNET_HTONS(((sizeof(header) / 4u) << 12) | FNET_TCP_SGT_RST);
+
+    if((nb = fnet_netbuf_from_buf(&header, sizeof(header), FNET_TRUE)) == 0)
+    {
+        return;
+    }
+    header.checksum = fnet_checksum_pseudo_start(nb, FNET_HTONS((fnet_uint16_t)FNET_IP_PROTOCOL_TCP), (fnet_uint16_t)sizeof(header));
+    header.checksum = fnet_checksum_pseudo_end(header.checksum, &src_addr.sa_data[0], &dest_addr.sa_data[0], sizeof(fnet_ip4_addr_t));
+    fnet_netbuf_free_chain(nb);
+
+    fapp_bench.first_time = fnet_timer_ticks();
+
+    for(i = 0u; i < iterations; i++)
+    {
+        if((nb = fnet_netbuf_from_buf(&header, sizeof(header), FNET_TRUE)) == 0)
+        {
+            break;
+        }
+
+        fnet_isr_lock();
+        fnet_tcp_prot_if.prot_input(netif, &src_addr, &dest_addr, nb, 0);
+        fnet_isr_unlock();
+    }
+
+    fapp_bench.last_time = fnet_timer_ticks();
+    interval = fnet_timer_get_interval(fapp_bench.first_time, fapp_bench.last_time)*FNET_TIMER_PERIOD_MS;
+
+    fnet_shell_println(desc, "%4u sockets: %u segments in %u ms (%u segments/s)", sockets, i, interval,
+                        (interval == 0u) ? 0u : ((i * 1000u) / interval));
+}
+
+/************************************************************************
+* NAME: fapp_benchtcpdemux_cmd
+*
+* DESCRIPTION: Start TCP demultiplexing benchmark. 
+*              Measures the TCP input cost while the number of 
+*              listening sockets grows up to the socket limit.
+************************************************************************/
+void fapp_benchtcpdemux_cmd( fnet_shell_desc_t desc, fnet_index_t argc, fnet_char_t ** argv )
+{
+    fnet_size_t         iterations = FAPP_BENCH_DEMUX_ITERATIONS_DEFAULT;
+    fnet_char_t         *p = 0;
+    fnet_socket_t       sockets[FNET_CFG_SOCKET_MAX];
+    fnet_size_t         sockets_num = 0u;
+    struct sockaddr     local_addr;
+
+    if(argc > 1)
+    {
+        iterations = fnet_strtoul(argv[1], &p, 0);
+        if(iterations == 0u)
+        {
+            fnet_shell_println(desc, FAPP_PARAM_ERR, argv[1]); /* Print error mesage. */
+            return;
+        }
+    }
+
+    fnet_shell_println(desc, "TCP demultiplexing benchmark:");
+
+    fapp_bench_demux_run(desc, 0u, iterations);
+
+    while(sockets_num < FNET_CFG_SOCKET_MAX)
+    {
+        if((sockets[sockets_num] = fnet_socket(AF_INET, SOCK_STREAM, 0u)) == FNET_ERR)
+        {
+            break;
+        }
+
+        fnet_memset_zero(&local_addr, sizeof(local_addr));
+        local_addr.sa_family = AF_INET;
+        local_addr.sa_port = FNET_HTONS((fnet_uint16_t)(FAPP_BENCH_DEMUX_PORT + sockets_num));
+
+        if((fnet_socket_bind(sockets[sockets_num], &local_addr, sizeof(local_addr)) == FNET_ERR)
+            || (fnet_socket_listen(sockets[sockets_num], 1u) == FNET_ERR))
+        {
+            fnet_socket_close(sockets[sockets_num]);
+            break;
+        }
+
+        sockets_num++;
+
+        /* Measure at every power of two.*/
+        if((sockets_num & (sockets_num - 1u)) == 0u)
+        {
+            fapp_bench_demux_run(desc, sockets_num, iterations);
+        }
+    }
+
+    if((sockets_num & (sockets_num - 1u)) != 0u)
+    {
+        fapp_bench_demux_run(desc, sockets_num, iterations);
+    }
+
+    while(sockets_num)
+    {
+        sockets_num--;
+        fnet_socket_close(sockets[sockets_num]);
+    }
+
+    fnet_shell_println(desc, FAPP_BENCH_COMPLETED_STR);
+}
+#endif /* FNET_CFG_TCP && FNET_CFG_IP4 */
+
+#if FNET_CFG_TCP && !FNET_CFG_TCP_DISCARD_OUT_OF_ORDER
+/************************************************************************
+* NAME: fapp_bench_reass_run
+*
+* DESCRIPTION: Simulates the receive side of a bulk TCP transfer. 
+*              If loss is set, the first segment of every window is 
+*              lost and retransmitted after the rest of the window,
+*              so the whole window passes the reassembly queue.
+************************************************************************/
+static void fapp_bench_reass_run( fnet_shell_desc_t desc, fnet_char_t *name, fnet_size_t segments, fnet_bool_t loss )
+{
+    fnet_tcp_reass_t    reass;
+    fnet_netbuf_t       *nb;
+    fnet_uint32_t       rcv_seq = 0u;
+    fnet_uint32_t       seq;
+    fnet_size_t         i;
+    fnet_size_t         delivered = 0u;
+    fnet_size_t         queued_max = 0u;
+    fnet_index_t        blocks_max = 0u;
+    fnet_size_t         heap_start = fnet_free_mem_status_netbuf();
+    fnet_size_t         heap_min = heap_start;
+    fnet_size_t         heap;
+    fnet_time_t         interval;
+
+    fnet_memset_zero(&reass, sizeof(reass));
+
+    fapp_bench.first_time = fnet_timer_ticks();
+
+    for(i = 0u; i < segments; i++)
+    {
+        /* Segment order within a window: 1, 2, ..., N-1, 0 (retransmission).*/
+        if((loss == FNET_TRUE) && ((i % FAPP_BENCH_REASS_WINDOW) != (FAPP_BENCH_REASS_WINDOW - 1u)))
+        {
+            seq = (fnet_uint32_t)((i + 1u) * FAPP_BENCH_REASS_SEGMENT_SIZE);
+        }
+        else if(loss == FNET_TRUE)
+        {
+            seq = (fnet_uint32_t)((i + 1u - FAPP_BENCH_REASS_WINDOW) * FAPP_BENCH_REASS_SEGMENT_SIZE);
+        }
+        else
+        {
+            seq = (fnet_uint32_t)(i * FAPP_BENCH_REASS_SEGMENT_SIZE);
+        }
+
+        if((nb = fnet_netbuf_from_buf(&fapp_bench.buffer[0], FAPP_BENCH_REASS_SEGMENT_SIZE, FNET_TRUE)) == 0)
+        {
+            break;
+        }
+
+        if(seq == rcv_seq)
+        {
+            /* In-order data is passed to the application.*/
+            rcv_seq += FAPP_BENCH_REASS_SEGMENT_SIZE;
+            delivered += FAPP_BENCH_REASS_SEGMENT_SIZE;
+            fnet_netbuf_free_chain(nb);
+        }
+        else
+        {
+            fnet_tcp_reass_add(&reass, seq, nb, FAPP_BENCH_REASS_WINDOW * FAPP_BENCH_REASS_SEGMENT_SIZE);
+
+            if(reass.count > queued_max)
+            {
+                queued_max = reass.count;
+            }
+            if(reass.block_num > blocks_max)
+            {
+                blocks_max = reass.block_num;
+            }
+            heap = fnet_free_mem_status_netbuf();
+            if(heap < heap_min)
+            {
+                heap_min = heap;
+            }
+        }
+
+        while((nb = fnet_tcp_reass_get(&reass, &rcv_seq)) != 0)
+        {
+            delivered += nb->total_length;
+            fnet_netbuf_free_chain(nb);
+        }
+    }
+
+    fnet_tcp_reass_free(&reass);
+
+    fapp_bench.last_time = fnet_timer_ticks();
+    interval = fnet_timer_get_interval(fapp_bench.first_time, fapp_bench.last_time)*FNET_TIMER_PERIOD_MS;
+
+    fnet_shell_println(desc, "%-8s: %u bytes in %u ms (%u KB/s), queue max %u bytes in %u blocks, heap %u bytes", name, delivered, interval,
+                        (interval == 0u) ? 0u : (delivered / interval), queued_max, blocks_max, heap_start - heap_min);
+}
+
+/************************************************************************
+* NAME: fapp_benchtcpreass_cmd
+*
+* DESCRIPTION: Start TCP reassembly benchmark. 
+*              Compares goodput and receive-side memory of a lossless 
+*              transfer and of a transfer that loses one segment per window.
+************************************************************************/
+void fapp_benchtcpreass_cmd( fnet_shell_desc_t desc, fnet_index_t argc, fnet_char_t ** argv )
+{
+    fnet_size_t     segments = FAPP_BENCH_REASS_SEGMENTS_DEFAULT;
+    fnet_char_t     *p = 0;
+
+    if(argc > 1)
+    {
+        segments = fnet_strtoul(argv[1], &p, 0);
+        if(segments == 0u)
+        {
+            fnet_shell_println(desc, FAPP_PARAM_ERR, argv[1]); /* Print error mesage. */
+            return;
+        }
+    }
+
+    /* Whole windows only.*/
+    segments = ((segments + FAPP_BENCH_REASS_WINDOW - 1u) / FAPP_BENCH_REASS_WINDOW) * FAPP_BENCH_REASS_WINDOW;
+
+    fnet_shell_println(desc, "TCP reassembly benchmark (%u x %u bytes, window %u segments):", segments, FAPP_BENCH_REASS_SEGMENT_SIZE, FAPP_BENCH_REASS_WINDOW);
+
+    fapp_bench_reass_run(desc, "no loss", segments, FNET_FALSE);
+    fapp_bench_reass_run(desc, "loss", segments, FNET_TRUE);
+
+    fnet_shell_println(desc, FAPP_BENCH_COMPLETED_STR);
+}
+#endif /* FNET_CFG_TCP && !FNET_CFG_TCP_DISCARD_OUT_OF_ORDER */
+
+#if FNET_CFG_TCP && FNET_CFG_IP4 && FNET_CFG_LOOPBACK
+/************************************************************************
+* NAME: fapp_bench_churn_connection
+*
+* DESCRIPTION: Opens one TCP connection over the loopback interface,
+*              sends a request and closes it. The client closes first,
+*              so its side of the connection enters the TIME_WAIT state.
+************************************************************************/
+static fnet_return_t fapp_bench_churn_connection( fnet_socket_t listen_sock, struct sockaddr *addr )
+{
+    fnet_socket_t           tx_sock;
+    fnet_socket_t           rx_sock = FNET_ERR;
+    fnet_socket_state_t     connection_state;
+    fnet_size_t             option_len;
+    fnet_time_t             start_time = fnet_timer_ticks();
+    fnet_return_t           result = FNET_ERR;
+
+    if((tx_sock = fnet_socket(AF_INET, SOCK_STREAM, 0u)) == FNET_ERR)
+    {
+        return FNET_ERR;
+    }
+
+    if(fnet_socket_connect(tx_sock, addr, sizeof(*addr)) == FNET_ERR)
+    {
+        goto EXIT;
+    }
+
+    /* Wait for the connection.*/
+    do
+    {
+        if(rx_sock == FNET_ERR)
+        {
+            rx_sock = fnet_socket_accept(listen_sock, 0, 0);
+        }
+
+        option_len = sizeof(connection_state); 
+        fnet_socket_getopt(tx_sock, SOL_SOCKET, SO_STATE, &connection_state, &option_len);
+
+        if((connection_state == SS_UNCONNECTED) 
+            || ((fnet_timer_get_interval(start_time, fnet_timer_ticks())*FNET_TIMER_PERIOD_MS) > FAPP_BENCH_CHURN_TIMEOUT_MS))
+        {
+            goto EXIT;
+        }
+    }
+    while((connection_state != SS_CONNECTED) || (rx_sock == FNET_ERR));
+
+    if(fnet_socket_send(tx_sock, &fapp_bench.buffer[0], FAPP_BENCH_CHURN_REQUEST_SIZE, 0u) != (fnet_int32_t)FAPP_BENCH_CHURN_REQUEST_SIZE)
+    {
+        goto EXIT;
+    }
+
+    /* The client closes first.*/
+    fnet_socket_close(tx_sock);
+    tx_sock = FNET_ERR;
+
+    /* The server reads the request, until the connection is closed by the client.*/
+    while(fnet_socket_recv(rx_sock, &fapp_bench.buffer[0], FAPP_BENCH_BUFFER_SIZE, 0u) != FNET_ERR)
+    {
+        if((fnet_timer_get_interval(start_time, fnet_timer_ticks())*FNET_TIMER_PERIOD_MS) > FAPP_BENCH_CHURN_TIMEOUT_MS)
+        {
+            goto EXIT;
+        }
+    }
+
+    result = FNET_OK;
+
+EXIT:
+    if(rx_sock != FNET_ERR)
+    {
+        fnet_socket_close(rx_sock);
+    }
+    if(tx_sock != FNET_ERR)
+    {
+        fnet_socket_close(tx_sock);
+    }
+
+    return result;
+}
+
+/************************************************************************
+* NAME: fapp_benchtcpchurn_cmd
+*
+* DESCRIPTION: Start TCP connection churn benchmark. 
+*              Opens and closes TCP connections over the loopback 
+*              interface, and reports the connection rate and the heap
+*              memory that is still held by the connections 
+*              in the TIME_WAIT state.
+************************************************************************/
+void fapp_benchtcpchurn_cmd( fnet_shell_desc_t desc, fnet_index_t argc, fnet_char_t ** argv )
+{
+    fnet_size_t     connections = FAPP_BENCH_CHURN_CONNECTIONS_DEFAULT;
+    fnet_char_t     *p = 0;
+    struct sockaddr addr;
+    fnet_socket_t   listen_sock;
+    fnet_size_t     i;
+    fnet_size_t     heap_start = fnet_free_mem_status();
+    fnet_size_t     heap_min = heap_start;
+    fnet_size_t     heap;
+    fnet_time_t     interval;
+
+    if(argc > 1)
+    {
+        connections = fnet_strtoul(argv[1], &p, 0);
+        if(connections == 0u)
+        {
+            fnet_shell_println(desc, FAPP_PARAM_ERR, argv[1]); /* Print error mesage. */
+            return;
+        }
+    }
+
+    fnet_shell_println(desc, "TCP connection churn benchmark (%u connections over loopback, %u TIME_WAIT records):", 
+                        connections, FNET_CFG_TCP_TIMEWAIT_SIZE);
+
+    fnet_memset_zero(&addr, sizeof(addr));
+    addr.sa_family = AF_INET;
+    addr.sa_port = FNET_HTONS(FAPP_BENCH_CHURN_PORT);
+    ((struct sockaddr_in *)(&addr))->sin_addr.s_addr = FNET_CFG_LOOPBACK_IP4_ADDR;
+
+    if((listen_sock = fnet_socket(AF_INET, SOCK_STREAM, 0u)) == FNET_ERR)
+    {
+        return;
+    }
+
+    if((fnet_socket_bind(listen_sock, &addr, sizeof(addr)) == FNET_ERR)
+        || (fnet_socket_listen(listen_sock, 1u) == FNET_ERR))
+    {
+        fnet_shell_println(desc, "Socket error.");
+        fnet_socket_close(listen_sock);
+        return;
+    }
+
+    fapp_bench.first_time = fnet_timer_ticks();
+
+    for(i = 0u; (i < connections) && (fnet_shell_ctrlc(desc) == FNET_FALSE); i++)
+    {
+        if(fapp_bench_churn_connection(listen_sock, &addr) == FNET_ERR)
+        {
+            break;
+        }
+
+        heap = fnet_free_mem_status();
+        if(heap < heap_min)
+        {
+            heap_min = heap;
+        }
+    }
+
+    fapp_bench.last_time = fnet_timer_ticks();
+    interval = fnet_timer_get_interval(fapp_bench.first_time, fapp_bench.last_time)*FNET_TIMER_PERIOD_MS;
+
+    fnet_socket_close(listen_sock);
+
+    heap = fnet_free_mem_status();
+
+    fnet_shell_println(desc, "%u connections in %u ms (%u per s), heap held after the run %u bytes (peak %u bytes)%s", 
+                        i, interval, (interval == 0u) ? 0u : ((i * 1000u) / interval), 
+                        (heap < heap_start) ? (heap_start - heap) : 0u, heap_start - heap_min, (i < connections) ? ", not completed" : "");
+
+    fnet_shell_println(desc, FAPP_BENCH_COMPLETED_STR);
+}
+
+/************************************************************************
+* NAME: fapp_bench_loop_connect
+*
+* DESCRIPTION: Opens a TCP connection over the loopback interface.
+*              "bufsize" is the socket send and receive buffer size.
+*
+* RETURNS: FNET_OK and the listening, sending and receiving sockets,
+*          FNET_ERR if the connection failed.
+************************************************************************/
+static fnet_return_t fapp_bench_loop_connect( fnet_shell_desc_t desc, fnet_size_t bufsize, fnet_socket_t *listen_sock, fnet_socket_t *tx_sock, fnet_socket_t *rx_sock )
+{
+    const fnet_size_t       bufsize_option = bufsize;
+    struct sockaddr         addr;
+    fnet_socket_state_t     connection_state;
+    fnet_size_t             option_len;
+    fnet_time_t             interval;
+
+    fnet_memset_zero(&addr, sizeof(addr));
+    addr.sa_family = AF_INET;
+    addr.sa_port = FNET_HTONS(FAPP_BENCH_LOSS_PORT);
+    ((struct sockaddr_in *)(&addr))->sin_addr.s_addr = FNET_CFG_LOOPBACK_IP4_ADDR;
+
+    *rx_sock = FNET_ERR;
+
+    if((*listen_sock = fnet_socket(AF_INET, SOCK_STREAM, 0u)) == FNET_ERR)
+    {
+        return FNET_ERR;
+    }
+
+    if((*tx_sock = fnet_socket(AF_INET, SOCK_STREAM, 0u)) == FNET_ERR)
+    {
+        fnet_socket_close(*listen_sock);
+        return FNET_ERR;
+    }
+
+    if((fnet_socket_setopt(*listen_sock, SOL_SOCKET, SO_RCVBUF, &bufsize_option, sizeof(bufsize_option)) == FNET_ERR)
+        || (fnet_socket_setopt(*tx_sock, SOL_SOCKET, SO_SNDBUF, &bufsize_option, sizeof(bufsize_option)) == FNET_ERR)
+        || (fnet_socket_bind(*listen_sock, &addr, sizeof(addr)) == FNET_ERR)
+        || (fnet_socket_listen(*listen_sock, 1u) == FNET_ERR)
+        || (fnet_socket_connect(*tx_sock, &addr, sizeof(addr)) == FNET_ERR))
+    {
+        fnet_shell_println(desc, "Socket error.");
+        goto ERROR;
+    }
+
+    /* Wait for the connection.*/
+    fapp_bench.first_time = fnet_timer_ticks();
+    do
+    {
+        option_len = sizeof(connection_state); 
+        fnet_socket_getopt(*tx_sock, SOL_SOCKET, SO_STATE, &connection_state, &option_len);
+
+        if(*rx_sock == FNET_ERR)
+        {
+            *rx_sock = fnet_socket_accept(*listen_sock, 0, 0);
+        }
+
+        fapp_bench.last_time = fnet_timer_ticks();
+        interval = fnet_timer_get_interval(fapp_bench.first_time, fapp_bench.last_time)*FNET_TIMER_PERIOD_MS;
+    }
+    while(((connection_state == SS_CONNECTING) || (*rx_sock == FNET_ERR)) 
+          && (connection_state != SS_UNCONNECTED) && (interval < FAPP_BENCH_LOSS_TIMEOUT_MS));
+
+    if((connection_state != SS_CONNECTED) || (*rx_sock == FNET_ERR))
+    {
+        fnet_shell_println(desc, "Connection failed.");
+        goto ERROR;
+    }
+
+    return FNET_OK;
+
+ERROR:
+    fapp_bench_loop_close(*listen_sock, *tx_sock, *rx_sock);
+    return FNET_ERR;
+}
+
+/************************************************************************
+* NAME: fapp_bench_loop_close
+*
+* DESCRIPTION: Closes the sockets opened by fapp_bench_loop_connect().
+************************************************************************/
+static void fapp_bench_loop_close( fnet_socket_t listen_sock, fnet_socket_t tx_sock, fnet_socket_t rx_sock )
+{
+    if(rx_sock != FNET_ERR)
+    {
+        fnet_socket_close(rx_sock);
+    }
+    fnet_socket_close(tx_sock);
+    fnet_socket_close(listen_sock);
+}
+
+/************************************************************************
+* NAME: fapp_bench_loop_run
+*
+* DESCRIPTION: Measures TCP goodput over the loopback interface, 
+*              that randomly drops the given percentage of packets
+*              and delays them by the given time (in ms, one way).
+*              "bufsize" is the socket send and receive buffer size.
+************************************************************************/
+static void fapp_bench_loop_run( fnet_shell_desc_t desc, const fnet_char_t *name, fnet_index_t loss, fnet_time_t delay, fnet_size_t bufsize, fnet_size_t size )
+{
+    fnet_socket_t           listen_sock;
+    fnet_socket_t           tx_sock;
+    fnet_socket_t           rx_sock;
+    fnet_size_t             sent = 0u;
+    fnet_size_t             received = 0u;
+    fnet_int32_t            result;
+    fnet_time_t             interval;
+
+    if(fapp_bench_loop_connect(desc, bufsize, &listen_sock, &tx_sock, &rx_sock) == FNET_ERR)
+    {
+        return;
+    }
+
+    /* The connection establishment is lossless.*/
+    fnet_loop_set_loss(loss);
+#if FNET_CFG_LOOPBACK_DELAY_QUEUE
+    fnet_loop_set_delay(delay);
+#else
+    FNET_COMP_UNUSED_ARG(delay);
+#endif
+
+    fapp_bench.first_time = fnet_timer_ticks();
+
+    while(received < size)
+    {
+        if(sent < size)
+        {
+            result = fnet_socket_send(tx_sock, &fapp_bench.buffer[0], 
+                                      ((size - sent) > FAPP_BENCH_BUFFER_SIZE) ? FAPP_BENCH_BUFFER_SIZE : (size - sent), 0u);
+            if(result == FNET_ERR)
+            {
+                break;
+            }
+            sent += (fnet_size_t)result;
+        }
+
+        result = fnet_socket_recv(rx_sock, &fapp_bench.buffer[0], FAPP_BENCH_BUFFER_SIZE, 0u);
+        if(result == FNET_ERR)
+        {
+            break;
+        }
+        received += (fnet_size_t)result;
+
+        fapp_bench.last_time = fnet_timer_ticks();
+        interval = fnet_timer_get_interval(fapp_bench.first_time, fapp_bench.last_time)*FNET_TIMER_PERIOD_MS;
+
+        if((interval > FAPP_BENCH_LOSS_TIMEOUT_MS) || fnet_shell_ctrlc(desc))
+        {
+            break;
+        }
+    }
+
+    fapp_bench.last_time = fnet_timer_ticks();
+    interval = fnet_timer_get_interval(fapp_bench.first_time, fapp_bench.last_time)*FNET_TIMER_PERIOD_MS;
+
+    fnet_shell_println(desc, "%s: %u bytes in %u ms (%u KB/s)%s", name, received, interval,
+                        (interval == 0u) ? 0u : (received / interval), (received < size) ? ", not completed" : "");
+
+    fnet_loop_set_loss(0u);
+#if FNET_CFG_LOOPBACK_DELAY_QUEUE
+    fnet_loop_set_delay(0u);
+#endif
+
+    fapp_bench_loop_close(listen_sock, tx_sock, rx_sock);
+}
+
+/************************************************************************
+* NAME: fapp_bench_sndbuf_netbufs
+*
+* DESCRIPTION: Returns the number of net_bufs in the send buffer 
+*              of the TCP socket.
+************************************************************************/
+static fnet_size_t fapp_bench_sndbuf_netbufs( fnet_socket_t s )
+{
+    fnet_socket_if_t    *sk;
+    fnet_netbuf_t       *nb;
+    fnet_size_t         netbufs = 0u;
+
+    fnet_isr_lock();
+
+    for(sk = fnet_tcp_prot_if.head; sk != 0; sk = sk->next)
+    {
+        if(sk->descriptor == s)
+        {
+            for(nb = sk->send_buffer.net_buf_chain; nb != 0; nb = nb->next)
+            {
+                netbufs++;
+            }
+            break;
+        }
+    }
+
+    fnet_isr_unlock();
+
+    return netbufs;
+}
+
+/************************************************************************
+* NAME: fapp_bench_write_run
+*
+* DESCRIPTION: Measures small writes to a TCP socket over the loopback 
+*              interface. The receiver does not read until the send 
+*              buffer is full, so the net_bufs of the full send buffer 
+*              are counted. Then "size" bytes are transferred 
+*              by "write_size" writes.
+************************************************************************/
+static void fapp_bench_write_run( fnet_shell_desc_t desc, fnet_size_t write_size, fnet_size_t size )
+{
+    fnet_socket_t           listen_sock;
+    fnet_socket_t           tx_sock;
+    fnet_socket_t           rx_sock;
+    fnet_size_t             sent = 0u;
+    fnet_size_t             received = 0u;
+    fnet_size_t             queued;
+    fnet_size_t             netbufs;
+    fnet_int32_t            result;
+    fnet_time_t             interval;
+
+    if(fapp_bench_loop_connect(desc, FAPP_BENCH_SOCKET_BUF_SIZE, &listen_sock, &tx_sock, &rx_sock) == FNET_ERR)
+    {
+        return;
+    }
+
+    /* Fill the receive and send buffers.*/
+    do
+    {
+        result = fnet_socket_send(tx_sock, &fapp_bench.buffer[0], write_size, 0u);
+        if(result == FNET_ERR)
+        {
+            goto EXIT;
+        }
+        sent += (fnet_size_t)result;
+    }
+    while((result > 0) && (sent < size));
+
+    queued = sent;
+    netbufs = fapp_bench_sndbuf_netbufs(tx_sock);
+
+    fapp_bench.first_time = fnet_timer_ticks();
+
+    while(received < size)
+    {
+        /* Write until the send buffer is full.*/
+        result = 1;
+        while((sent < size) && (result > 0))
+        {
+            result = fnet_socket_send(tx_sock, &fapp_bench.buffer[0], 
+                                      ((size - sent) > write_size) ? write_size : (size - sent), 0u);
+            if(result == FNET_ERR)
+            {
+                break;
+            }
+            sent += (fnet_size_t)result;
+        }
+
+        if(result == FNET_ERR)
+        {
+            break;
+        }
+
+        result = fnet_socket_recv(rx_sock, &fapp_bench.buffer[0], FAPP_BENCH_BUFFER_SIZE, 0u);
+        if(result == FNET_ERR)
+        {
+            break;
+        }
+        received += (fnet_size_t)result;
+
+        fapp_bench.last_time = fnet_timer_ticks();
+        interval = fnet_timer_get_interval(fapp_bench.first_time, fapp_bench.last_time)*FNET_TIMER_PERIOD_MS;
+
+        if((interval > FAPP_BENCH_LOSS_TIMEOUT_MS) || fnet_shell_ctrlc(desc))
+        {
+            break;
+        }
+    }
+
+    fapp_bench.last_time = fnet_timer_ticks();
+    interval = fnet_timer_get_interval(fapp_bench.first_time, fapp_bench.last_time)*FNET_TIMER_PERIOD_MS;
+
+    fnet_shell_println(desc, "%3u B writes: %u net_bufs for %u queued bytes, %u bytes in %u ms (%u KB/s)%s", 
+                        write_size, netbufs, queued, received, interval,
+                        (interval == 0u) ? 0u : (received / interval), (received < size) ? ", not completed" : "");
+
+EXIT:
+    fapp_bench_loop_close(listen_sock, tx_sock, rx_sock);
+}
+
+/************************************************************************
+* NAME: fapp_benchtcploss_cmd
+*
+* DESCRIPTION: Start TCP loss recovery benchmark. 
+*              Measures TCP goodput over the loopback interface
+*              for random packet loss from 0 to 5 percent.
+************************************************************************/
+void fapp_benchtcploss_cmd( fnet_shell_desc_t desc, fnet_index_t argc, fnet_char_t ** argv )
+{
+    fnet_size_t     size = FAPP_BENCH_LOSS_SIZE_DEFAULT;
+    fnet_char_t     *p = 0;
+    fnet_index_t    loss;
+    fnet_char_t     name[16];
+
+    if(argc > 1)
+    {
+        size = fnet_strtoul(argv[1], &p, 0) * 1024u;
+        if(size == 0u)
+        {
+            fnet_shell_println(desc, FAPP_PARAM_ERR, argv[1]); /* Print error mesage. */
+            return;
+        }
+    }
+
+    fnet_shell_println(desc, "TCP loss recovery benchmark (%u bytes over loopback, SACK %s):", size, FNET_CFG_TCP_SACK ? "on" : "off");
+
+    for(loss = 0u; loss <= FAPP_BENCH_LOSS_MAX; loss++)
+    {
+        fnet_snprintf(name, sizeof(name), "%2u%% loss", loss);
+        fapp_bench_loop_run(desc, name, loss, 0u, FAPP_BENCH_SOCKET_BUF_SIZE, size);
+    }
+
+    fnet_shell_println(desc, FAPP_BENCH_COMPLETED_STR);
+}
+
+#if FNET_CFG_LOOPBACK_DELAY_QUEUE
+/************************************************************************
+* NAME: fapp_benchtcprtt_cmd
+*
+* DESCRIPTION: Start TCP large window benchmark. 
+*              Measures TCP goodput over the loopback interface
+*              for the simulated round trip time from 0 to 400 ms.
+************************************************************************/
+void fapp_benchtcprtt_cmd( fnet_shell_desc_t desc, fnet_index_t argc, fnet_char_t ** argv )
+{
+    static const fnet_time_t rtt_table[] = {0u, 50u, 100u, 200u, 400u};
+    fnet_size_t     size = FAPP_BENCH_RTT_SIZE_DEFAULT;
+    fnet_size_t     bufsize = FAPP_BENCH_RTT_BUF_SIZE_DEFAULT;
+    fnet_char_t     *p = 0;
+    fnet_index_t    i;
+    fnet_char_t     name[16];
+
+    if(argc > 1)
+    {
+        bufsize = fnet_strtoul(argv[1], &p, 0) * 1024u;
+        if(bufsize == 0u)
+        {
+            fnet_shell_println(desc, FAPP_PARAM_ERR, argv[1]); /* Print error mesage. */
+            return;
+        }
+    }
+
+    if(argc > 2)
+    {
+        size = fnet_strtoul(argv[2], &p, 0) * 1024u;
+        if(size == 0u)
+        {
+            fnet_shell_println(desc, FAPP_PARAM_ERR, argv[2]); /* Print error mesage. */
+            return;
+        }
+    }
+
+    fnet_shell_println(desc, "TCP large window benchmark (%u bytes over loopback, %u bytes buffers, auto-tuning %s):", 
+                        size, bufsize, FNET_CFG_TCP_RCVBUF_AUTO ? "on" : "off");
+
+    for(i = 0u; i < (sizeof(rtt_table)/sizeof(rtt_table[0])); i++)
+    {
+        fnet_snprintf(name, sizeof(name), "%3u ms RTT", rtt_table[i]);
+        /* The loopback delays packets in both directions.*/
+        fapp_bench_loop_run(desc, name, 0u, rtt_table[i]/2u, bufsize, size);
+    }
+
+    fnet_shell_println(desc, FAPP_BENCH_COMPLETED_STR);
+}
+#endif /* FNET_CFG_LOOPBACK_DELAY_QUEUE */
+
+/************************************************************************
+* NAME: fapp_benchtcpwrite_cmd
+*
+* DESCRIPTION: Start TCP small write benchmark. 
+*              Measures the send buffer net_bufs and TCP goodput 
+*              over the loopback interface for 16, 64 and 256 byte writes.
+************************************************************************/
+void fapp_benchtcpwrite_cmd( fnet_shell_desc_t desc, fnet_index_t argc, fnet_char_t ** argv )
+{
+    static const fnet_size_t write_table[] = {16u, 64u, 256u};
+    fnet_size_t     size = FAPP_BENCH_WRITE_SIZE_DEFAULT;
+    fnet_char_t     *p = 0;
+    fnet_index_t    i;
+
+    if(argc > 1)
+    {
+        size = fnet_strtoul(argv[1], &p, 0) * 1024u;
+        if(size == 0u)
+        {
+            fnet_shell_println(desc, FAPP_PARAM_ERR, argv[1]); /* Print error mesage. */
+            return;
+        }
+    }
+
+    fnet_shell_println(desc, "TCP small write benchmark (%u bytes over loopback, %u bytes buffers, coalescing %s):", 
+                        size, FAPP_BENCH_SOCKET_BUF_SIZE, FNET_CFG_TCP_SEND_COALESCE ? "on" : "off");
+
+    for(i = 0u; i < (sizeof(write_table)/sizeof(write_table[0])); i++)
+    {
+        fapp_bench_write_run(desc, write_table[i], size);
+    }
+
+    fnet_shell_println(desc, FAPP_BENCH_COMPLETED_STR);
+}
+#endif /* FNET_CFG_TCP && FNET_CFG_IP4 && FNET_CFG_LOOPBACK */
+
 #endif /* FAPP_CFG_BENCH_CMD */
 
 
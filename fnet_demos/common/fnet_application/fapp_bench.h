@@ -46,12 +46,62 @@
 #define FAPP_BENCH_TX_ITERATION_NUMBER_DEFAULT  (1)
 #define FAPP_BENCH_TX_ITERATION_NUMBER_MAX      (10000)
 
+#define FAPP_BENCH_MEM_ITERATIONS_DEFAULT       (100000u)   /* Number of memory allocator benchmark operations.*/
+#define FAPP_BENCH_MEM_SLOTS                    (48u)       /* Number of simultaneously allocated blocks.*/
+#define FAPP_BENCH_MEM_CB_SIZE                  (128u)      /* Control block size.*/
+#define FAPP_BENCH_MEM_DATA_SIZE                (600u)      /* Data block size.*/
+
+#define FAPP_BENCH_CSUM_ITERATIONS_DEFAULT      (10000u)    /* Number of checksum benchmark iterations.*/
+#define FAPP_BENCH_CSUM_TESTS                   (1000u)     /* Number of checksum correctness tests.*/
+#define FAPP_BENCH_CSUM_SIZE                    (1460u)     /* Checksummed data size.*/
+
+#define FAPP_BENCH_DEMUX_ITERATIONS_DEFAULT     (10000u)    /* Number of injected TCP segments per measurement.*/
+#define FAPP_BENCH_DEMUX_PORT                   (20000u)    /* First local port of the listening sockets (in host byte order).*/
+#define FAPP_BENCH_DEMUX_SRC_PORT               (40000u)    /* Source port of the injected segments (in host byte order).*/
+
+#define FAPP_BENCH_REASS_SEGMENTS_DEFAULT       (10000u)    /* Number of simulated TCP segments.*/
+#define FAPP_BENCH_REASS_SEGMENT_SIZE           (1460u)     /* Simulated TCP segment size.*/
+#define FAPP_BENCH_REASS_WINDOW                 (16u)       /* Simulated receive window, in segments.*/
+
+#define FAPP_BENCH_LOSS_SIZE_DEFAULT            (256u*1024u) /* Number of bytes transferred per measurement.*/
+#define FAPP_BENCH_LOSS_MAX                     (5u)        /* Maximal packet loss (in percent).*/
+#define FAPP_BENCH_LOSS_PORT                    (7008u)     /* Port of the loopback connection (in host byte order).*/
+#define FAPP_BENCH_LOSS_TIMEOUT_MS              (60000u)    /* Maximal duration of a measurement.*/
+
+#define FAPP_BENCH_RTT_SIZE_DEFAULT             (256u*1024u) /* Number of bytes transferred per measurement.*/
+#define FAPP_BENCH_RTT_BUF_SIZE_DEFAULT         (32u*1024u) /* Socket send and receive buffer size.*/
+
+#define FAPP_BENCH_WRITE_SIZE_DEFAULT           (256u*1024u) /* Number of bytes transferred per measurement.*/
+
+#define FAPP_BENCH_CHURN_CONNECTIONS_DEFAULT    (200u)      /* Number of opened and closed connections.*/
+#define FAPP_BENCH_CHURN_REQUEST_SIZE           (64u)       /* Data sent over every connection.*/
+#define FAPP_BENCH_CHURN_PORT                   (7009u)     /* Port of the listening socket (in host byte order).*/
+#define FAPP_BENCH_CHURN_TIMEOUT_MS             (5000u)     /* Maximal duration of one connection.*/
+
 #if defined(__cplusplus)
 extern "C" {
 #endif
 
 void fapp_benchrx_cmd( fnet_shell_desc_t desc, fnet_index_t argc, fnet_char_t ** argv );
 void fapp_benchtx_cmd( fnet_shell_desc_t desc, fnet_index_t argc, fnet_char_t ** argv );
+#if FNET_CFG_HEAP_SLAB
+void fapp_benchmem_cmd( fnet_shell_desc_t desc, fnet_index_t argc, fnet_char_t ** argv );
+#endif
+void fapp_benchcsum_cmd( fnet_shell_desc_t desc, fnet_index_t argc, fnet_char_t ** argv );
+#if FNET_CFG_TCP && FNET_CFG_IP4
+void fapp_benchtcpdemux_cmd( fnet_shell_desc_t desc, fnet_index_t argc, fnet_char_t ** argv );
+#endif
+#if FNET_CFG_TCP && !FNET_CFG_TCP_DISCARD_OUT_OF_ORDER
+void fapp_benchtcpreass_cmd( fnet_shell_desc_t desc, fnet_index_t argc, fnet_char_t ** argv );
+#endif
+#if FNET_CFG_TCP && FNET_CFG_IP4 && FNET_CFG_LOOPBACK
+void fapp_benchtcpchurn_cmd( fnet_shell_desc_t desc, fnet_index_t argc, fnet_char_t ** argv );
+void fapp_benchtcploss_cmd( fnet_shell_desc_t desc, fnet_index_t argc, fnet_char_t ** argv );
+void fapp_benchtcpwrite_cmd( fnet_shell_desc_t desc, fnet_index_t argc, fnet_char_t ** argv );
+#if FNET_CFG_LOOPBACK_DELAY_QUEUE
+void fapp_benchtcprtt_cmd( fnet_shell_desc_t desc, fnet_index_t argc, fnet_char_t ** argv );
+#endif
+#endif
 
 #if defined(__cplusplus)
 }
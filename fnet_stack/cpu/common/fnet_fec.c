@@ -55,6 +55,16 @@ static fnet_return_t fnet_fec_init(fnet_netif_t *netif);
 static void fnet_fec_release(fnet_netif_t *netif);
 static void fnet_fec_input(fnet_netif_t *netif);
 static void fnet_fec_rx_buf_next( fnet_fec_if_t *ethif);
+#if FNET_CFG_CPU_ETH_RX_ZERO_COPY
+static fnet_netbuf_t *fnet_fec_rx_buf_loan( fnet_fec_if_t *ethif, fnet_uint8_t *data_ptr, fnet_size_t length );
+static void *fnet_fec_rx_loan_get( fnet_fec_if_t *ethif );
+static void fnet_fec_rx_loan_release( fnet_fec_if_t *ethif );
+#endif
+#if FNET_CFG_CPU_ETH_TX_SG
+static fnet_fec_buf_desc_t *fnet_fec_tx_buf_desc_next( fnet_fec_if_t *ethif, fnet_fec_buf_desc_t *buf_desc );
+static void fnet_fec_tx_reclaim( fnet_fec_if_t *ethif );
+static fnet_netbuf_t *fnet_fec_tx_bounce( fnet_netbuf_t *nb, fnet_size_t offset );
+#endif
 static fnet_return_t fnet_fec_get_hw_addr(fnet_netif_t *netif, fnet_uint8_t * hw_addr);
 static fnet_return_t fnet_fec_set_hw_addr(fnet_netif_t *netif, fnet_uint8_t * hw_addr);
 static fnet_bool_t fnet_fec_is_connected(fnet_netif_t *netif);
@@ -64,6 +74,11 @@ static fnet_return_t fnet_fec_get_statistics(fnet_netif_t *netif, struct fnet_ne
 /* FEC rx frame interrup handler. */
 static void fnet_fec_isr_rx_handler_top(fnet_uint32_t cookie);
 static void fnet_fec_isr_rx_handler_bottom(fnet_uint32_t cookie);
+#if FNET_CFG_CPU_ETH_TX_SG
+/* FEC tx frame interrup handler. */
+static void fnet_fec_isr_tx_handler_top(fnet_uint32_t cookie);
+static void fnet_fec_isr_tx_handler_bottom(fnet_uint32_t cookie);
+#endif
 
 static void fnet_fec_get_mac_addr(fnet_fec_if_t *ethif, fnet_mac_addr_t *mac_addr);
 
@@ -148,6 +163,9 @@ static fnet_return_t fnet_fec_init(fnet_netif_t *netif)
     		ethif->reg = (volatile fnet_fec_reg_t *)FNET_FEC0_BASE_ADDR;  /* Set FEC module base refister pointer.*/
     		ethif->reg_phy = (volatile fnet_fec_reg_t *)FNET_FEC0_BASE_ADDR;
     		ethif->vector_number = FNET_CFG_CPU_ETH0_VECTOR_NUMBER;       /* Set RX Frame interrupt number.*/
+        #if FNET_CFG_CPU_ETH_TX_SG
+    		ethif->tx_vector_number = FNET_CFG_CPU_ETH0_TX_VECTOR_NUMBER; /* Set TX Frame interrupt number.*/
+        #endif
          	ethif->phy_addr = FNET_CFG_CPU_ETH0_PHY_ADDR;                 /* Set default PHY address */
     		break;
         #endif    		
@@ -156,6 +174,9 @@ static fnet_return_t fnet_fec_init(fnet_netif_t *netif)
     		ethif->reg = (volatile fnet_fec_reg_t *)FNET_FEC1_BASE_ADDR;  /* Set FEC module base refister pointer.*/
     		ethif->reg_phy = (volatile fnet_fec_reg_t *)FNET_FEC0_BASE_ADDR;
     		ethif->vector_number = FNET_CFG_CPU_ETH1_VECTOR_NUMBER;       /* Set RX Frame interrupt number.*/
+        #if FNET_CFG_CPU_ETH_TX_SG
+    		ethif->tx_vector_number = FNET_CFG_CPU_ETH1_TX_VECTOR_NUMBER; /* Set TX Frame interrupt number.*/
+        #endif
          	ethif->phy_addr = FNET_CFG_CPU_ETH1_PHY_ADDR;                 /* Set default PHY address */    		
     		break;
        #endif    		
@@ -196,13 +217,41 @@ static fnet_return_t fnet_fec_init(fnet_netif_t *netif)
 
     ethif->tx_buf_desc_num=FNET_FEC_TX_BUF_NUM;
 
+#if FNET_CFG_CPU_ETH_TX_SG
+    ethif->tx_buf_desc_dirty = ethif->tx_buf_desc;
+    ethif->tx_buf_desc_free = FNET_FEC_TX_BUF_NUM;
+    fnet_memset_zero(ethif->tx_nb, sizeof(ethif->tx_nb));
+#endif
+
+#if FNET_CFG_CPU_ETH_RX_ZERO_COPY
+    /* Allocate the Rx buffer pool once, the driver keeps one reference to each buffer.*/
+    fnet_memset_zero(ethif->rx_loan, sizeof(ethif->rx_loan));
+    fnet_memset_zero(ethif->rx_loan_pool, sizeof(ethif->rx_loan_pool));
+    ethif->rx_loan_next = 0u;
+    
+    for (i = 0U; i < FNET_FEC_RX_LOAN_NUM; i++)
+    {
+        if((ethif->rx_loan_pool[i] = fnet_malloc_netbuf(FNET_FEC_RX_LOAN_SIZE)) == 0)
+        {
+            result = FNET_ERR;
+            goto ERROR;
+        }
+        ((fnet_uint32_t *)ethif->rx_loan_pool[i])[0] = 1u; /* Free buffer: the pool reference only.*/
+    }
+#endif
+
     /* Initialize Rx descriptor rings.*/
     for (i = 0U; i < FNET_FEC_RX_BUF_NUM; i++)
     {
         ethif->rx_buf_desc[i].status = FNET_HTONS(FNET_FEC_RX_BD_E);
         ethif->rx_buf_desc[i].length = FNET_HTONS(0U);
             
+    #if FNET_CFG_CPU_ETH_RX_ZERO_COPY
+        ethif->rx_loan[i] = fnet_fec_rx_loan_get(ethif);
+        ethif->rx_buf_desc[i].buf_ptr = (fnet_uint8_t *)fnet_htonl(FNET_FEC_ALIGN_DIV(FNET_FEC_RX_BUF_DIV, &((fnet_uint32_t *)ethif->rx_loan[i])[1]));
+    #else
         ethif->rx_buf_desc[i].buf_ptr = (fnet_uint8_t *)fnet_htonl(FNET_FEC_ALIGN_DIV(FNET_FEC_RX_BUF_DIV, ethif->rx_buf[i]));
+    #endif
     }
 
     ethif->rx_buf_desc_num = FNET_FEC_RX_BUF_NUM;
@@ -215,6 +264,18 @@ static fnet_return_t fnet_fec_init(fnet_netif_t *netif)
     
     /* Install RX Frame interrupt handler.*/
     result = fnet_isr_vector_init(ethif->vector_number, fnet_fec_isr_rx_handler_top, fnet_fec_isr_rx_handler_bottom, FNET_CFG_CPU_ETH_VECTOR_PRIORITY, (fnet_uint32_t)netif);
+
+#if FNET_CFG_CPU_ETH_TX_SG
+    /* Install TX Frame interrupt handler, releasing transmitted net_bufs.*/
+    if((result == FNET_OK) && (ethif->tx_vector_number != 0u))
+    {
+        result = fnet_isr_vector_init(ethif->tx_vector_number, fnet_fec_isr_tx_handler_top, fnet_fec_isr_tx_handler_bottom, FNET_CFG_CPU_ETH_VECTOR_PRIORITY, (fnet_uint32_t)netif);
+        if(result != FNET_OK)
+        {
+            fnet_isr_vector_release(ethif->vector_number);
+        }
+    }
+#endif
         
     if( result == FNET_OK)
     {
@@ -332,6 +393,12 @@ static fnet_return_t fnet_fec_init(fnet_netif_t *netif)
         /* Enable interrupts (Receive frame interrupt).*/
     #if FNET_FEC_INTERRUPT_ENABLE 
         ethif->reg->EIMR = FNET_FEC_EIMR_RXF;
+        #if FNET_CFG_CPU_ETH_TX_SG
+        if(ethif->tx_vector_number != 0u)
+        {
+            ethif->reg->EIMR |= FNET_FEC_EIMR_TXF;  /* Transmit frame interrupt.*/
+        }
+        #endif
     #endif
             
         /* Enable FEC */
@@ -392,6 +459,12 @@ static fnet_return_t fnet_fec_init(fnet_netif_t *netif)
         ethif->reg->RDAR=FNET_FEC_RDAR_R_DES_ACTIVE;    
     }
 ERROR:   
+#if FNET_CFG_CPU_ETH_RX_ZERO_COPY
+    if(result != FNET_OK)
+    {
+        fnet_fec_rx_loan_release(ethif);
+    }
+#endif
     return result;
 }
 
@@ -417,6 +490,32 @@ static void fnet_fec_release(fnet_netif_t *netif)
     ethif->reg->EIR = 0xFFFFFFFFU;   /* Clear any pending FEC interrupt flags. */
     
     fnet_isr_vector_release(ethif->vector_number);
+#if FNET_CFG_CPU_ETH_TX_SG
+    if(ethif->tx_vector_number != 0u)
+    {
+        fnet_isr_vector_release(ethif->tx_vector_number);
+    }
+#endif
+
+#if FNET_CFG_CPU_ETH_RX_ZERO_COPY
+    fnet_fec_rx_loan_release(ethif);
+#endif
+
+#if FNET_CFG_CPU_ETH_TX_SG
+    {
+        fnet_index_t i;
+        
+        /* Release net_bufs of not completed frames.*/
+        for(i = 0u; i < FNET_FEC_TX_BUF_NUM; i++)
+        {
+            if(ethif->tx_nb[i])
+            {
+                fnet_netbuf_free_chain(ethif->tx_nb[i]);
+                ethif->tx_nb[i] = 0;
+            }
+        }
+    }
+#endif
 
     fnet_eth_release(netif); /* Common Ethernet-interface release.*/
 }
@@ -507,8 +606,13 @@ static void fnet_fec_input(fnet_netif_t *netif)
             
             fnet_eth_trace("\nRX", ethheader); /* Print ETH header.*/
                 
+        #if FNET_CFG_CPU_ETH_RX_ZERO_COPY
+            nb = fnet_fec_rx_buf_loan( ethif, ((fnet_uint8_t *)ethheader + sizeof(fnet_eth_header_t)), 
+                                        (fnet_size_t)(fnet_ntohs(ethif->rx_buf_desc_cur->length)) - sizeof(fnet_eth_header_t) );
+        #else
             nb = fnet_netbuf_from_buf( ((fnet_uint8_t *)ethheader + sizeof(fnet_eth_header_t)), 
                                         (fnet_size_t)(fnet_ntohs(ethif->rx_buf_desc_cur->length)) - sizeof(fnet_eth_header_t), FNET_TRUE );
+        #endif
             if(nb)
             {
                 if((ethif->rx_buf_desc_cur->status & FNET_HTONS(FNET_FEC_RX_BD_BC)) != 0u)    /* Broadcast */
@@ -603,6 +707,133 @@ NEXT_FRAME:
    return result;
 }
 
+#if FNET_CFG_CPU_ETH_RX_ZERO_COPY
+/************************************************************************
+* NAME: fnet_fec_rx_buf_loan
+*
+* DESCRIPTION: Passes the current Rx buffer, containing the frame data 
+*              "data_ptr", to the stack as a net_buf, and gives the 
+*              descriptor a free buffer from the Rx buffer pool.
+*              A frame shorter than FNET_CFG_CPU_ETH_RX_COPYBREAK, 
+*              or received when the pool is exhausted, is copied 
+*              and the current buffer stays in the ring.
+*************************************************************************/
+static fnet_netbuf_t *fnet_fec_rx_buf_loan( fnet_fec_if_t *ethif, fnet_uint8_t *data_ptr, fnet_size_t length )
+{
+    fnet_netbuf_t   *nb = 0;
+    void            *new_buf;
+    fnet_index_t    i = (fnet_index_t)(ethif->rx_buf_desc_cur - ethif->rx_buf_desc);
+
+    if(length >= FNET_CFG_CPU_ETH_RX_COPYBREAK)
+    {
+        new_buf = fnet_fec_rx_loan_get(ethif);
+    
+        if(new_buf)
+        {
+            nb = fnet_netbuf_from_data(ethif->rx_loan[i], data_ptr, length, FNET_FALSE);
+        
+            if(nb)
+            {
+                /* The net_buf reference and the pool reference.
+                 * The buffer is free again, when the stack releases the net_buf.*/
+                ((fnet_uint32_t *)ethif->rx_loan[i])[0] = 2u;
+            
+                /* Replenish the descriptor.*/
+                ethif->rx_loan[i] = new_buf;
+                ethif->rx_buf_desc_cur->buf_ptr = (fnet_uint8_t *)fnet_htonl(FNET_FEC_ALIGN_DIV(FNET_FEC_RX_BUF_DIV, &((fnet_uint32_t *)new_buf)[1]));
+            }
+            else
+            {
+                ((fnet_uint32_t *)new_buf)[0] = 1u; /* Return it to the pool.*/
+            }
+        }
+    }
+    
+    if(nb == 0)
+    {
+        /* Right-sized copy, the Rx buffer is reused by the descriptor.*/
+        nb = fnet_netbuf_from_buf(data_ptr, length, FNET_TRUE);
+    }
+    
+    return nb;
+}
+
+/************************************************************************
+* NAME: fnet_fec_rx_loan_get
+*
+* DESCRIPTION: Takes a free buffer from the Rx buffer pool.
+*              A free buffer has only the pool reference.
+*              The taken buffer gets the descriptor reference.
+*              Returns 0 if all buffers are in the ring or loaned.
+*************************************************************************/
+static void *fnet_fec_rx_loan_get( fnet_fec_if_t *ethif )
+{
+    void            *buf = 0;
+    fnet_index_t    n;
+    
+    for(n = 0u; n < FNET_FEC_RX_LOAN_NUM; n++)
+    {
+        if(((fnet_uint32_t *)ethif->rx_loan_pool[ethif->rx_loan_next])[0] == 1u)
+        {
+            buf = ethif->rx_loan_pool[ethif->rx_loan_next];
+            ((fnet_uint32_t *)buf)[0] = 2u;
+        }
+        
+        ethif->rx_loan_next++;
+        if(ethif->rx_loan_next >= FNET_FEC_RX_LOAN_NUM)
+        {
+            ethif->rx_loan_next = 0u;
+        }
+        
+        if(buf)
+        {
+            break;
+        }
+    }
+    
+    return buf;
+}
+
+/************************************************************************
+* NAME: fnet_fec_rx_loan_release
+*
+* DESCRIPTION: Releases the Rx buffer pool. 
+*              A buffer still loaned to the stack is freed 
+*              when the stack releases its net_buf.
+*************************************************************************/
+static void fnet_fec_rx_loan_release( fnet_fec_if_t *ethif )
+{
+    fnet_index_t i;
+    
+    /* Drop the descriptor references.*/
+    for(i = 0u; i < FNET_FEC_RX_BUF_NUM; i++)
+    {
+        if(ethif->rx_loan[i])
+        {
+            ((fnet_uint32_t *)ethif->rx_loan[i])[0] = ((fnet_uint32_t *)ethif->rx_loan[i])[0] - 1u;
+            ethif->rx_loan[i] = 0;
+        }
+    }
+    
+    /* Drop the pool references.*/
+    for(i = 0u; i < FNET_FEC_RX_LOAN_NUM; i++)
+    {
+        if(ethif->rx_loan_pool[i])
+        {
+            if(((fnet_uint32_t *)ethif->rx_loan_pool[i])[0] == 1u)
+            {
+                fnet_free_netbuf(ethif->rx_loan_pool[i]);
+            }
+            else
+            {
+                ((fnet_uint32_t *)ethif->rx_loan_pool[i])[0] = ((fnet_uint32_t *)ethif->rx_loan_pool[i])[0] - 1u;
+            }
+            ethif->rx_loan_pool[i] = 0;
+        }
+    }
+}
+#endif /* FNET_CFG_CPU_ETH_RX_ZERO_COPY */
+
 /************************************************************************
 * NAME: fnet_fec_rx_buf_next
 *
@@ -688,6 +919,278 @@ static void fnet_fec_checksum_clear(fnet_uint16_t type, fnet_uint8_t *datagram,
 }
 #endif /* FNET_CFG_CPU_ETH_HW_TX_PROTOCOL_CHECKSUM */
 
+#if FNET_CFG_CPU_ETH_TX_SG
+/************************************************************************
+* NAME: fnet_fec_tx_buf_desc_next
+*
+* DESCRIPTION: Returns the Tx buffer descriptor following "buf_desc" 
+*              in the ring.
+*************************************************************************/
+static fnet_fec_buf_desc_t *fnet_fec_tx_buf_desc_next( fnet_fec_if_t *ethif, fnet_fec_buf_desc_t *buf_desc )
+{
+    fnet_fec_buf_desc_t *result;
+    
+    if(buf_desc == &ethif->tx_buf_desc[FNET_FEC_TX_BUF_NUM - 1u])
+    {
+        result = ethif->tx_buf_desc;
+    }
+    else
+    {
+        result = buf_desc + 1;
+    }
+    
+    return result;
+}
+
+/************************************************************************
+* NAME: fnet_fec_tx_reclaim
+*
+* DESCRIPTION: Releases the Tx buffer descriptors and the net_bufs 
+*              of the frames that have been transmitted.
+*              Called with interrupts locked.
+*************************************************************************/
+static void fnet_fec_tx_reclaim( fnet_fec_if_t *ethif )
+{
+    fnet_index_t i;
+
+    while((ethif->tx_buf_desc_free < FNET_FEC_TX_BUF_NUM)
+          && ((ethif->tx_buf_desc_dirty->status & FNET_HTONS(FNET_FEC_TX_BD_R)) == 0u))
+    {
+        i = (fnet_index_t)(ethif->tx_buf_desc_dirty - ethif->tx_buf_desc);
+        
+        /* The net_buf chain is attached to the last descriptor of the frame.*/
+        if(ethif->tx_nb[i])
+        {
+            fnet_netbuf_free_chain(ethif->tx_nb[i]);
+            ethif->tx_nb[i] = 0;
+        }
+        
+        ethif->tx_buf_desc_free++;
+        ethif->tx_buf_desc_dirty = fnet_fec_tx_buf_desc_next(ethif, ethif->tx_buf_desc_dirty);
+    }
+}
+
+/************************************************************************
+* NAME: fnet_fec_tx_bounce
+*
+* DESCRIPTION: Copies the net_buf chain data, starting from "offset", 
+*              to a new net_buf, which data is aligned as the module 
+*              requires (FNET_FEC_TX_BUF_DIV).
+*              Called with interrupts locked.
+*************************************************************************/
+static fnet_netbuf_t *fnet_fec_tx_bounce( fnet_netbuf_t *nb, fnet_size_t offset )
+{
+    fnet_netbuf_t   *bounce_nb = 0;
+    void            *data;
+    void            *data_ptr;
+    fnet_size_t     length = nb->total_length - offset;
+
+    /* [reference_counter][alignment][buffer].*/
+    data = fnet_malloc_netbuf(sizeof(fnet_uint32_t) + (FNET_FEC_TX_BUF_DIV - 1U) + length);
+    
+    if(data)
+    {
+        data_ptr = (void *)FNET_FEC_ALIGN_DIV(FNET_FEC_TX_BUF_DIV, &((fnet_uint32_t *)data)[1]);
+        
+        fnet_netbuf_to_buf(nb, offset, length, data_ptr);
+        
+        bounce_nb = fnet_netbuf_from_data(data, data_ptr, length, FNET_FALSE);
+        if(bounce_nb == 0)
+        {
+            fnet_free_netbuf(data);
+        }
+    }
+    
+    return bounce_nb;
+}
+
+/************************************************************************
+* NAME: fnet_fec_output
+*
+* DESCRIPTION: Ethernet low-level output function.
+*              Scatter-gather version. The Ethernet header and the frame 
+*              head are copied to the first descriptor buffer, 
+*              the rest of the net_buf chain is mapped to the following 
+*              descriptors without copying.
+*              If a segment is not aligned as the module requires, 
+*              or the chain is too fragmented, the rest of the chain 
+*              is copied to one aligned net_buf.
+*************************************************************************/
+void fnet_fec_output(fnet_netif_t *netif, fnet_uint16_t type, const fnet_mac_addr_t dest_addr, fnet_netbuf_t* nb)
+{
+    fnet_fec_if_t       *ethif = (fnet_fec_if_t *)((fnet_eth_if_t *)(netif->if_ptr))->if_cpu_ptr; 
+    fnet_eth_header_t   *ethheader;
+    fnet_fec_buf_desc_t *buf_desc_first;
+    fnet_fec_buf_desc_t *buf_desc;
+    fnet_netbuf_t       *nb_seg;
+    fnet_size_t         copy_length;
+    fnet_size_t         offset;
+    fnet_index_t        seg_number;
+    fnet_index_t        seg_count;
+    fnet_bool_t         bounce;
+    fnet_netbuf_t       *bounce_nb;
+ 
+    if((nb!=0) && (nb->total_length<=netif->mtu)) 
+    {
+        fnet_isr_lock();
+        
+        fnet_fec_tx_reclaim(ethif);
+
+        copy_length = nb->total_length;
+        if(copy_length > FNET_CFG_CPU_ETH_TX_SG_COPY_SIZE)
+        {
+            copy_length = FNET_CFG_CPU_ETH_TX_SG_COPY_SIZE;
+        }
+        
+        /* Count net_buf segments left after the copied head, 
+         * and check alignment of their data.*/
+        seg_number = 0u;
+        bounce = FNET_FALSE;
+        offset = copy_length;
+        for(nb_seg = nb; nb_seg; nb_seg = nb_seg->next)
+        {
+            if(offset >= nb_seg->length)
+            {
+                offset -= nb_seg->length;
+            }
+            else
+            {
+                if((((fnet_uint32_t)nb_seg->data_ptr + offset) & (FNET_FEC_TX_BUF_DIV - 1U)) != 0u)
+                {
+                    bounce = FNET_TRUE;
+                }
+                offset = 0u;
+                seg_number++;
+            }
+        }
+        
+        /* The chain is too fragmented for the ring, make it contiguous.*/
+        if(seg_number >= FNET_FEC_TX_BUF_NUM)
+        {
+            bounce = FNET_TRUE;
+        }
+        
+        if(bounce == FNET_TRUE)
+        {
+            seg_number = 1u;
+        }
+        
+        /* Drop the frame instead of waiting, if the ring is full.*/
+        if((seg_number + 1u) <= ethif->tx_buf_desc_free)
+        {
+            bounce_nb = 0;
+            if(bounce == FNET_TRUE)
+            {
+                bounce_nb = fnet_fec_tx_bounce(nb, copy_length);
+                if(bounce_nb == 0)
+                {
+                    ((fnet_eth_if_t *)(netif->if_ptr))->statistics.tx_drop++;
+                    fnet_isr_unlock();
+                    goto DROP;
+                }
+            }
+            
+            buf_desc_first = ethif->tx_buf_desc_cur;
+            
+            ethheader = (fnet_eth_header_t *)FNET_FEC_ALIGN_DIV(FNET_FEC_TX_BUF_DIV, ethif->tx_buf[buf_desc_first - ethif->tx_buf_desc]);
+
+            fnet_netbuf_to_buf(nb, 0u, copy_length, (void *)((fnet_uint32_t)ethheader + FNET_ETH_HDR_SIZE));
+
+        #if FNET_CFG_CPU_ETH_HW_TX_PROTOCOL_CHECKSUM && FNET_FEC_HW_TX_PROTOCOL_CHECKSUM_FIX
+            /* The IP and transport headers are in the copied head.*/
+            if((nb->flags & FNET_NETBUF_FLAG_HW_PROTOCOL_CHECKSUM) == 0)
+            {
+                fnet_fec_checksum_clear(type, (fnet_uint8_t *)ethheader + FNET_ETH_HDR_SIZE, copy_length);
+            }
+        #endif
+
+            fnet_memcpy (ethheader->destination_addr, dest_addr, sizeof(fnet_mac_addr_t));
+            fnet_fec_get_mac_addr(ethif, &ethheader->source_addr);
+            ethheader->type=fnet_htons(type);
+
+            buf_desc_first->buf_ptr = (fnet_uint8_t *)fnet_htonl((fnet_uint32_t)ethheader);
+            buf_desc_first->length = fnet_htons((fnet_uint16_t)(FNET_ETH_HDR_SIZE + copy_length));
+            
+            /* The copied head is not a part of the aligned net_buf.*/
+            offset = copy_length;
+            if(bounce_nb)
+            {
+                fnet_netbuf_free_chain(nb);
+                nb = bounce_nb;
+                offset = 0u;
+            }
+            
+            /* Map the rest of the chain. The first descriptor is made ready last.*/
+            buf_desc = buf_desc_first;
+            seg_count = 0u;
+            for(nb_seg = nb; nb_seg; nb_seg = nb_seg->next)
+            {
+                if(offset >= nb_seg->length)
+                {
+                    offset -= nb_seg->length;
+                }
+                else
+                {
+                    seg_count++;
+                    buf_desc = fnet_fec_tx_buf_desc_next(ethif, buf_desc);
+                    
+                    buf_desc->buf_ptr = (fnet_uint8_t *)fnet_htonl((fnet_uint32_t)nb_seg->data_ptr + offset);
+                    buf_desc->length = fnet_htons((fnet_uint16_t)(nb_seg->length - offset));
+                    
+                    if(seg_count == seg_number)
+                    {
+                        buf_desc->status = (fnet_uint16_t)((buf_desc->status & FNET_HTONS(FNET_FEC_TX_BD_W)) | FNET_HTONS(FNET_FEC_TX_BD_R | FNET_FEC_TX_BD_L | FNET_FEC_TX_BD_TC));
+                    }
+                    else
+                    {
+                        buf_desc->status = (fnet_uint16_t)((buf_desc->status & FNET_HTONS(FNET_FEC_TX_BD_W)) | FNET_HTONS(FNET_FEC_TX_BD_R));
+                    }
+                    offset = 0u;
+                }
+            }
+            
+            ethif->tx_buf_desc_free -= (seg_number + 1u);
+            ethif->tx_buf_desc_cur = fnet_fec_tx_buf_desc_next(ethif, buf_desc);
+            
+            if(seg_number)
+            {
+                /* Hold the chain until the last descriptor is transmitted.*/
+                ethif->tx_nb[buf_desc - ethif->tx_buf_desc] = nb;
+                nb = 0;
+                
+                buf_desc_first->status = (fnet_uint16_t)((buf_desc_first->status & FNET_HTONS(FNET_FEC_TX_BD_W)) | FNET_HTONS(FNET_FEC_TX_BD_R));
+            }
+            else
+            {
+                buf_desc_first->status = (fnet_uint16_t)((buf_desc_first->status & FNET_HTONS(FNET_FEC_TX_BD_W)) | FNET_HTONS(FNET_FEC_TX_BD_R | FNET_FEC_TX_BD_L | FNET_FEC_TX_BD_TC));
+            }
+            
+            while(ethif->reg->TDAR) /* Workaround.*/
+            {}
+
+            ethif->reg->TDAR=FNET_FEC_TDAR_X_DES_ACTIVE; /* Indicate that there has been a transmit buffer produced.*/
+
+#if !FNET_CFG_CPU_ETH_MIB       
+            ((fnet_eth_if_t *)(netif->if_ptr))->statistics.tx_packet++;
+#endif
+        }
+        else
+        {
+            ((fnet_eth_if_t *)(netif->if_ptr))->statistics.tx_drop++;
+        }
+        
+        fnet_isr_unlock();
+    }
+
+DROP:
+    if(nb)
+    {
+        fnet_netbuf_free_chain(nb);
+    }
+}
+
+#else /* !FNET_CFG_CPU_ETH_TX_SG */
+
 #ifdef FNET_FEC_TEST_RACE_CONDITION
 fnet_index_t fnet_fec_output_reentry_count;
 #endif
@@ -778,6 +1281,8 @@ void fnet_fec_output(fnet_netif_t *netif, fnet_uint16_t type, const fnet_mac_add
     fnet_netbuf_free_chain(nb);   
 }
 
+#endif /* FNET_CFG_CPU_ETH_TX_SG */
+
 /************************************************************************
 * NAME: fnet_eth_output_frame
 *
@@ -788,9 +1293,46 @@ void fnet_fec_output_frame(fnet_netif_t *netif, fnet_uint8_t* frame, fnet_size_t
 {
     fnet_fec_if_t       *ethif =  (fnet_fec_if_t *)((fnet_eth_if_t *)(netif->if_ptr))->if_cpu_ptr;
     fnet_eth_header_t   *ethheader;
+#if FNET_CFG_CPU_ETH_TX_SG
+    fnet_fec_buf_desc_t *buf_desc;
+#endif
  
     if((frame!=0U) && (frame_size<=netif->mtu)) 
     {
+#if FNET_CFG_CPU_ETH_TX_SG
+        fnet_isr_lock();
+        do
+        {
+            fnet_fec_tx_reclaim(ethif);
+        }
+        while(ethif->tx_buf_desc_free == 0u);
+        
+        /* Send the frame from the caller buffer.*/
+        ethheader = (fnet_eth_header_t *)frame;
+        buf_desc = ethif->tx_buf_desc_cur;
+        buf_desc->buf_ptr = (fnet_uint8_t *)fnet_htonl((fnet_uint32_t)ethheader);
+        buf_desc->length = fnet_htons((fnet_uint16_t)(frame_size));
+        buf_desc->status = (fnet_uint16_t)((buf_desc->status & FNET_HTONS(FNET_FEC_TX_BD_W)) | FNET_HTONS(FNET_FEC_TX_BD_R | FNET_FEC_TX_BD_L | FNET_FEC_TX_BD_TC));
+        
+        ethif->tx_buf_desc_free--;
+        ethif->tx_buf_desc_cur = fnet_fec_tx_buf_desc_next(ethif, buf_desc);
+        
+        while(ethif->reg->TDAR) /* Workaround for ENET module.*/
+        {}
+
+        ethif->reg->TDAR=FNET_FEC_TDAR_X_DES_ACTIVE; /* Indicate that there has been a transmit buffer produced.*/
+        fnet_isr_unlock();
+        
+        fnet_eth_trace("\nTX", ethheader); /* Print ETH header.*/
+
+        /* The frame buffer belongs to the caller, wait until it is sent.*/
+        while((buf_desc->status & FNET_HTONS(FNET_FEC_TX_BD_R)) != 0u)
+        {}
+        
+        fnet_isr_lock();
+        fnet_fec_tx_reclaim(ethif);
+        fnet_isr_unlock();
+#else
         while((ethif->tx_buf_desc_cur->status & FNET_HTONS(FNET_FEC_TX_BD_R)) != 0u)
         {}
       
@@ -818,6 +1360,7 @@ void fnet_fec_output_frame(fnet_netif_t *netif, fnet_uint8_t* frame, fnet_size_t
         {}
 
         ethif->reg->TDAR=FNET_FEC_TDAR_X_DES_ACTIVE; /* Indicate that there has been a transmit buffer produced.*/
+#endif
 
 #if !FNET_CFG_CPU_ETH_MIB       
         ((fnet_eth_if_t *)(netif->if_ptr))->statistics.tx_packet++;
@@ -921,6 +1464,7 @@ static fnet_return_t fnet_fec_get_statistics(fnet_netif_t *netif, struct fnet_ne
     #if FNET_CFG_CPU_ETH_MIB 
         statistics->tx_packet = ethif->reg->RMON_T_PACKETS; 
         statistics->rx_packet = ethif->reg->RMON_R_PACKETS;
+        statistics->tx_drop = ((fnet_eth_if_t *)(netif->if_ptr))->statistics.tx_drop;
     #else 
         *statistics = ((fnet_eth_if_t *)(netif->if_ptr))->statistics;
     #endif        
@@ -961,9 +1505,48 @@ static void fnet_fec_isr_rx_handler_bottom (fnet_uint32_t cookie)
 	fnet_isr_lock();
 
     fnet_fec_input(netif);
+
+#if FNET_CFG_CPU_ETH_TX_SG
+    /* Completion poll of transmitted frames.*/
+    fnet_fec_tx_reclaim((fnet_fec_if_t *)((fnet_eth_if_t *)(netif->if_ptr))->if_cpu_ptr);
+#endif
+    
+    fnet_isr_unlock();
+}
+
+#if FNET_CFG_CPU_ETH_TX_SG
+/************************************************************************
+* NAME: fnet_fec_isr_tx_handler_top
+*
+* DESCRIPTION: Top Ethernet transmit frame interrupt handler. 
+*              Clear event flag
+*************************************************************************/
+static void fnet_fec_isr_tx_handler_top (fnet_uint32_t cookie) 
+{
+    fnet_fec_if_t *ethif = (fnet_fec_if_t *)((fnet_eth_if_t *)(((fnet_netif_t *)cookie)->if_ptr))->if_cpu_ptr;
+    
+    /* Clear FEC TX Event from the Event Register (by writing 1).*/
+    ethif->reg->EIR = FNET_FEC_EIR_TXF;
+}
+
+/************************************************************************
+* NAME: fnet_fec_isr_tx_handler_bottom
+*
+* DESCRIPTION: This function implements the Ethernet transmit 
+*              frame interrupt handler. 
+*              It releases the transmitted net_bufs.
+*************************************************************************/
+static void fnet_fec_isr_tx_handler_bottom (fnet_uint32_t cookie) 
+{
+    fnet_netif_t *netif = (fnet_netif_t *)cookie;
+	
+    fnet_isr_lock();
+
+    fnet_fec_tx_reclaim((fnet_fec_if_t *)((fnet_eth_if_t *)(netif->if_ptr))->if_cpu_ptr);
     
     fnet_isr_unlock();
 }
+#endif /* FNET_CFG_CPU_ETH_TX_SG */
 
 
 /************************************************************************
@@ -131,8 +131,20 @@
 
 
 #define FNET_FEC_BUF_SIZE           (((FNET_CFG_CPU_ETH0_MTU>FNET_CFG_CPU_ETH1_MTU)?FNET_CFG_CPU_ETH0_MTU:FNET_CFG_CPU_ETH1_MTU)+FNET_ETH_HDR_SIZE+FNET_ETH_CRC_SIZE+16U) /* Ring Buffer sizes in bytes.*/
-#define FNET_FEC_TX_BUF_NUM         (FNET_CFG_CPU_ETH_TX_BUFS_MAX)
+#if FNET_CFG_CPU_ETH_TX_SG
+    #define FNET_FEC_TX_BUF_NUM         (FNET_CFG_CPU_ETH_TX_SG_BD_MAX)
+    #define FNET_FEC_TX_BUF_SIZE        (FNET_ETH_HDR_SIZE+FNET_CFG_CPU_ETH_TX_SG_COPY_SIZE) /* Header buffer size in bytes.*/
+#else
+    #define FNET_FEC_TX_BUF_NUM         (FNET_CFG_CPU_ETH_TX_BUFS_MAX)
+    #define FNET_FEC_TX_BUF_SIZE        (FNET_FEC_BUF_SIZE)
+#endif
 #define FNET_FEC_RX_BUF_NUM         (FNET_CFG_CPU_ETH_RX_BUFS_MAX)
+#if FNET_CFG_CPU_ETH_RX_ZERO_COPY
+    /* Receive buffer allocated from the netbuf heap: [reference_counter][alignment][buffer].*/
+    #define FNET_FEC_RX_LOAN_SIZE       (sizeof(fnet_uint32_t)+(FNET_FEC_RX_BUF_DIV-1U)+FNET_FEC_BUF_SIZE)
+    /* Receive buffer pool: the ring, and as many buffers again loaned to the stack.*/
+    #define FNET_FEC_RX_LOAN_NUM        (FNET_FEC_RX_BUF_NUM*2U)
+#endif
 
 
 /************************************************************************
@@ -572,8 +584,20 @@ typedef struct
 #endif
     fnet_uint8_t tx_buf_desc_buf[(FNET_FEC_TX_BUF_NUM * sizeof(fnet_fec_buf_desc_t)) + (FNET_FEC_BUF_DESC_DIV-1U)];
     fnet_uint8_t rx_buf_desc_buf[(FNET_FEC_RX_BUF_NUM * sizeof(fnet_fec_buf_desc_t)) + (FNET_FEC_BUF_DESC_DIV-1U)];
-    fnet_uint8_t tx_buf[FNET_FEC_TX_BUF_NUM][FNET_FEC_BUF_SIZE + (FNET_FEC_TX_BUF_DIV-1U)];
+#if FNET_CFG_CPU_ETH_TX_SG
+    fnet_fec_buf_desc_t      *tx_buf_desc_dirty; /* Points to the oldest descriptor not released yet.*/
+    fnet_index_t             tx_buf_desc_free;   /* Number of free Tx Buffer Descriptors.*/
+    fnet_netbuf_t            *tx_nb[FNET_FEC_TX_BUF_NUM]; /* Net_bufs held until Tx complete, indexed by the last descriptor of a frame.*/
+    fnet_uint32_t            tx_vector_number;   /* Vector number of the Ethernet Transmit Frame interrupt.*/
+#endif
+    fnet_uint8_t tx_buf[FNET_FEC_TX_BUF_NUM][FNET_FEC_TX_BUF_SIZE + (FNET_FEC_TX_BUF_DIV-1U)];
+#if FNET_CFG_CPU_ETH_RX_ZERO_COPY
+    void                     *rx_loan[FNET_FEC_RX_BUF_NUM]; /* Rx buffers of the descriptors, taken from rx_loan_pool.*/
+    void                     *rx_loan_pool[FNET_FEC_RX_LOAN_NUM]; /* Rx buffers allocated once from the netbuf heap.*/
+    fnet_index_t             rx_loan_next;      /* Next pool entry to check for a free buffer.*/
+#else
     fnet_uint8_t rx_buf[FNET_FEC_RX_BUF_NUM][FNET_FEC_BUF_SIZE + (FNET_FEC_RX_BUF_DIV-1U)];    
+#endif
 }
 fnet_fec_if_t;
 
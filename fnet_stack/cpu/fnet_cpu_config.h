@@ -401,6 +401,25 @@
     #define FNET_CFG_CPU_TIMER_VECTOR_PRIORITY        (3u)
 #endif
 
+/**************************************************************************/ /*!
+ * @def      FNET_CFG_CPU_TIMER_FINE
+ * @brief    Fine-grained time of the hardware timer:
+ *               - @c 1 = is enabled. @n
+ *                 The CPU port provides fnet_cpu_timer_ms(), which adds 
+ *                 the time elapsed in the current timer period, read from 
+ *                 the hardware timer counter, so the time has millisecond
+ *                 granularity. It is used for the TCP timestamps and 
+ *                 round trip time measurement. @n
+ *                 It is ignored if @ref FNET_CFG_OS_TIMER is set.
+ *               - @c 0 = is disabled. The time advances by 
+ *                 @ref FNET_TIMER_PERIOD_MS steps.
+ *           @n @n NOTE: It is enabled by default for Kinetis.
+ * @showinitializer
+ ******************************************************************************/
+#ifndef FNET_CFG_CPU_TIMER_FINE
+    #define FNET_CFG_CPU_TIMER_FINE                 (0)
+#endif
+
 /**************************************************************************/ /*!
  * @def      FNET_CFG_CPU_CACHE
  * @brief    Cache invalidation:
@@ -636,6 +655,32 @@
 #endif
 #endif    
 
+/**************************************************************************/ /*!
+ * @def      FNET_CFG_CPU_ETH0_TX_VECTOR_NUMBER
+ * @brief    Vector number of the Ethernet Transmit Frame interrupt.
+ *           It is used only if @ref FNET_CFG_CPU_ETH_TX_SG is set to @c 1,
+ *           to release the transmitted net_bufs. 
+ *           If it is @c 0, they are released only by a completion poll.
+ *           @n @n NOTE: User application should not change this parameter. 
+ * @showinitializer 
+ ******************************************************************************/
+#ifndef FNET_CFG_CPU_ETH0_TX_VECTOR_NUMBER
+    #define FNET_CFG_CPU_ETH0_TX_VECTOR_NUMBER  (0)
+#endif
+
+/**************************************************************************/ /*!
+ * @def      FNET_CFG_CPU_ETH1_TX_VECTOR_NUMBER
+ * @brief    Vector number of the Ethernet Transmit Frame interrupt.
+ *           It is used only if @ref FNET_CFG_CPU_ETH_TX_SG is set to @c 1,
+ *           to release the transmitted net_bufs. 
+ *           If it is @c 0, they are released only by a completion poll.
+ *           @n @n NOTE: User application should not change this parameter. 
+ * @showinitializer 
+ ******************************************************************************/
+#ifndef FNET_CFG_CPU_ETH1_TX_VECTOR_NUMBER
+    #define FNET_CFG_CPU_ETH1_TX_VECTOR_NUMBER  (0)
+#endif
+
 /**************************************************************************/ /*!
  * @def      FNET_CFG_CPU_ETH_VECTOR_PRIORITY
  * @brief    Default Interrupt priority level for the Ethernet module. 
@@ -674,6 +719,90 @@
     #define FNET_CFG_CPU_ETH_RX_BUFS_MAX        (2u)
 #endif
 
+/**************************************************************************/ /*!
+ * @def      FNET_CFG_CPU_ETH_TX_SG
+ * @brief    Scatter-gather (zero-copy) transmit mode of the Ethernet module:
+ *               - @c 1 = is enabled. @n
+ *                 The Ethernet header and the first 
+ *                 @ref FNET_CFG_CPU_ETH_TX_SG_COPY_SIZE bytes of a frame are 
+ *                 copied to a small buffer, the rest of the net_buf chain 
+ *                 is mapped directly onto the following buffer descriptors.
+ *                 The net_bufs are held until their transmission is complete
+ *                 and released by the Transmit Frame interrupt 
+ *                 (@ref FNET_CFG_CPU_ETH0_TX_VECTOR_NUMBER) or by a completion poll. 
+ *                 A net_buf, which data is not aligned as the module requires, 
+ *                 is copied to an aligned net_buf first. 
+ *                 If the descriptor ring is full, the frame is dropped 
+ *                 instead of waiting, and counted in the @c tx_drop statistics.@n
+ *                 @ref FNET_CFG_CPU_ETH_TX_SG_BD_MAX replaces 
+ *                 @ref FNET_CFG_CPU_ETH_TX_BUFS_MAX.
+ *               - @b @c 0 = is disabled (Default value).@n
+ *                 A frame is copied to the MTU-sized transmit buffer.
+ * @showinitializer
+ ******************************************************************************/
+#ifndef FNET_CFG_CPU_ETH_TX_SG
+    #define FNET_CFG_CPU_ETH_TX_SG              (0)
+#endif
+
+/**************************************************************************/ /*!
+ * @def      FNET_CFG_CPU_ETH_RX_ZERO_COPY
+ * @brief    Zero-copy (buffer loaning) receive mode of the Ethernet module:
+ *               - @c 1 = is enabled. @n
+ *                 A pool of receive buffers, twice the number of receive 
+ *                 descriptors, is allocated once from the netbuf heap.
+ *                 A received frame is passed to the stack in its 
+ *                 receive buffer, and the descriptor gets a free buffer 
+ *                 from the pool. The buffer returns to the pool 
+ *                 when the net_buf is freed.@n
+ *                 A frame shorter than @ref FNET_CFG_CPU_ETH_RX_COPYBREAK, 
+ *                 or received when no pool buffer is free, is copied.
+ *               - @b @c 0 = is disabled (Default value).@n
+ *                 A frame is copied from the static receive buffer 
+ *                 to a new net_buf.
+ * @showinitializer
+ ******************************************************************************/
+#ifndef FNET_CFG_CPU_ETH_RX_ZERO_COPY
+    #define FNET_CFG_CPU_ETH_RX_ZERO_COPY       (0)
+#endif
+
+/**************************************************************************/ /*!
+ * @def      FNET_CFG_CPU_ETH_RX_COPYBREAK
+ * @brief    Minimum length of the received frame data, in bytes, passed 
+ *           to the stack in its receive buffer. 
+ *           A shorter frame is copied to a right-sized net_buf, 
+ *           and its receive buffer is reused at once.@n
+ *           It is used only if @ref FNET_CFG_CPU_ETH_RX_ZERO_COPY is set to @c 1.
+ * @showinitializer
+ ******************************************************************************/
+#ifndef FNET_CFG_CPU_ETH_RX_COPYBREAK
+    #define FNET_CFG_CPU_ETH_RX_COPYBREAK       (256U)
+#endif
+
+/**************************************************************************/ /*!
+ * @def      FNET_CFG_CPU_ETH_TX_SG_BD_MAX
+ * @brief    Number of transmit buffer descriptors in the scatter-gather 
+ *           transmit mode. A frame uses one descriptor plus one descriptor 
+ *           per mapped net_buf.@n
+ *           It is used only if @ref FNET_CFG_CPU_ETH_TX_SG is set to @c 1.
+ * @showinitializer
+ ******************************************************************************/
+#ifndef FNET_CFG_CPU_ETH_TX_SG_BD_MAX
+    #define FNET_CFG_CPU_ETH_TX_SG_BD_MAX       (16u)
+#endif
+
+/**************************************************************************/ /*!
+ * @def      FNET_CFG_CPU_ETH_TX_SG_COPY_SIZE
+ * @brief    Number of leading frame bytes (after the Ethernet header) 
+ *           copied in the scatter-gather transmit mode. 
+ *           It must cover the IP and transport headers. Shorter frames 
+ *           are copied entirely and released immediately.@n
+ *           It is used only if @ref FNET_CFG_CPU_ETH_TX_SG is set to @c 1.
+ * @showinitializer
+ ******************************************************************************/
+#ifndef FNET_CFG_CPU_ETH_TX_SG_COPY_SIZE
+    #define FNET_CFG_CPU_ETH_TX_SG_COPY_SIZE    (128u)
+#endif
+
 /**************************************************************************/ /*!
  * @def      FNET_CFG_CPU_ETH_ATONEGOTIATION_TIMEOUT
  * @brief    Defines Ethernet Autonegotiation Timeout (in ms), 
@@ -63,6 +63,10 @@
 #undef FNET_CFG_CPU_ETH0_VECTOR_NUMBER 
 #define FNET_CFG_CPU_ETH0_VECTOR_NUMBER     87
 
+/* Ethernet TX IRQ number */ 
+#undef FNET_CFG_CPU_ETH0_TX_VECTOR_NUMBER 
+#define FNET_CFG_CPU_ETH0_TX_VECTOR_NUMBER  83
+
 /* No cache. */
 #define FNET_CFG_CPU_CACHE                  (0) 
 
@@ -112,12 +112,14 @@
  **************************************************************************/
 #define FNET_FEC0_BASE_ADDR                 ((fnet_vuint32_t*)(0xFC0D4004)) 
 #define FNET_CFG_CPU_ETH0_VECTOR_NUMBER     (40+0x40)
+#define FNET_CFG_CPU_ETH0_TX_VECTOR_NUMBER  (36+0x40)
 
 /**************************************************************************
  *  ENET1
  **************************************************************************/
 #define FNET_FEC1_BASE_ADDR                 ((fnet_vuint32_t*)(0xFC0D8004)) 
 #define FNET_CFG_CPU_ETH1_VECTOR_NUMBER     (53+0x40)
+#define FNET_CFG_CPU_ETH1_TX_VECTOR_NUMBER  (49+0x40)
 
 /**************************************************************************
  *  There is cache.
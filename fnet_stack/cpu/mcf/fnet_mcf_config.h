@@ -69,6 +69,14 @@
     #define FNET_CFG_CPU_ETH0_VECTOR_NUMBER     (27+0x40)
 #endif
 
+/******************************************************************************
+ *  Vector number of the Ethernet Transmit Frame interrupt.
+ *  NOTE: User application should not change this parameter. 
+ ******************************************************************************/
+#ifndef FNET_CFG_CPU_ETH0_TX_VECTOR_NUMBER
+    #define FNET_CFG_CPU_ETH0_TX_VECTOR_NUMBER  (23+0x40)
+#endif
+
 /**************************************************************************/ /*!
  * @def      FNET_CFG_MCF_TIMER_DTIM
  * @brief    The DMA Timer (DTIM) module:
@@ -88,6 +88,25 @@
     #endif
 #endif
 
+/******************************************************************************
+ *  Vector number of the Ethernet Transmit Frame vector number.
+ *  NOTE: User application should not change this parameter. 
+ ******************************************************************************/
+#ifndef FNET_CFG_CPU_ETH0_TX_VECTOR_NUMBER
+    #if FNET_CFG_CPU_MK64FN1
+        #define FNET_CFG_CPU_ETH0_TX_VECTOR_NUMBER     (99U)
+    #else
+        #define FNET_CFG_CPU_ETH0_TX_VECTOR_NUMBER     (92U)
+    #endif
+#endif
+
+/*****************************************************************************
+ *  The PIT counter gives the fine-grained time.
+ ******************************************************************************/
+#ifndef FNET_CFG_CPU_TIMER_FINE
+    #define FNET_CFG_CPU_TIMER_FINE                     (1)
+#endif
+
 /*****************************************************************************
  *  Byte order is little endian. 
  ******************************************************************************/ 
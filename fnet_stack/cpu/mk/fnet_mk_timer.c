@@ -102,6 +102,40 @@ fnet_return_t fnet_cpu_timer_init( fnet_time_t period_ms )
     return result;
 }
 
+#if FNET_CFG_CPU_TIMER_FINE
+/************************************************************************
+* NAME: fnet_cpu_timer_ms
+*
+* DESCRIPTION: Returns the time in milliseconds, including the time 
+*              elapsed in the current period of the PIT timer.
+*************************************************************************/
+fnet_time_t fnet_cpu_timer_ms( void )
+{
+    fnet_time_t     ticks;
+    fnet_uint32_t   elapsed;
+    fnet_uint32_t   load = FNET_MK_PIT_LDVAL(FNET_CFG_CPU_TIMER_NUMBER);
+    
+    do
+    {
+        ticks = fnet_timer_ticks();
+        
+        if((FNET_MK_PIT_TFLG(FNET_CFG_CPU_TIMER_NUMBER) & FNET_MK_PIT_TFLG_TIF_MASK) != 0u)
+        {
+            /* The period is over, but the tick is not counted yet.*/
+            elapsed = load;
+        }
+        else
+        {
+            /* The counter counts down from the load value.*/
+            elapsed = load - FNET_MK_PIT_CVAL(FNET_CFG_CPU_TIMER_NUMBER);
+        }
+    }
+    while(ticks != fnet_timer_ticks());
+    
+    return (ticks * FNET_TIMER_PERIOD_MS) + (elapsed / FNET_MK_PERIPH_CLOCK_KHZ);
+}
+#endif /* FNET_CFG_CPU_TIMER_FINE */
+
 /************************************************************************
 * NAME: fnet_cpu_timer_release
 *
@@ -543,8 +543,11 @@ static void fnet_http_state_machine( void *http_if_p )
                         send_size = http->send_max;
                     }
                     
+                    /* The status line, headers and body are combined into full-size segments,
+                     * the rest is sent by the last data or by closing the socket.*/
                     if((res = fnet_socket_send(session->socket_foreign, session->buffer
-                                  + session->response.buffer_sent, send_size, 0u)) != FNET_ERR)
+                                  + session->response.buffer_sent, send_size, 
+                                  (session->response.send_eof == FNET_TRUE) ? 0u : (fnet_flag_t)MSG_MORE)) != FNET_ERR)
                     {
                         if(res)
                         {
@@ -35,6 +35,9 @@ static fnet_uint32_t fnet_checksum_nb(fnet_netbuf_t * nb, fnet_size_t length);
 
 #if !FNET_CFG_OVERLOAD_CHECKSUM_LOW
 static fnet_uint32_t fnet_checksum_low(fnet_uint32_t sum, fnet_size_t length, const fnet_uint16_t *d_ptr);
+#if FNET_CFG_CHECKSUM_LOW_WIDE
+static fnet_uint32_t fnet_checksum_low_wide(fnet_uint32_t sum, fnet_size_t length, const fnet_uint16_t *d_ptr);
+#endif
 #endif
 
 /*RFC:
@@ -60,6 +63,14 @@ static fnet_uint32_t fnet_checksum_low(fnet_uint32_t sum, fnet_size_t length, co
         fnet_uint16_t   p_byte1;
         fnet_int32_t   current_length = (fnet_int32_t)length;
         
+#if FNET_CFG_CHECKSUM_LOW_WIDE
+        /* Odd addresses (after an odd net_buf boundary) stay on 16-bit words.*/
+        if(((fnet_uint32_t)d_ptr & 1u) == 0u)
+        {
+            return fnet_checksum_low_wide(sum, length, d_ptr);
+        }
+#endif
+
         while((current_length -= 32) >= 0)
         {
             sum += *d_ptr++;
@@ -103,80 +114,272 @@ static fnet_uint32_t fnet_checksum_low(fnet_uint32_t sum, fnet_size_t length, co
         }
         return sum;
 } 
+
+#if FNET_CFG_CHECKSUM_LOW_WIDE
+/************************************************************************
+* NAME: fnet_checksum_low_wide
+*
+* DESCRIPTION: Calculates Internet checksum using 32-bit word loads.
+*              The carries out of the 32-bit accumulator are counted 
+*              separately and folded in with it at the end.
+*              "d_ptr" must be 16-bit aligned.
+*************************************************************************/
+static fnet_uint32_t fnet_checksum_low_wide(fnet_uint32_t sum, fnet_size_t length, const fnet_uint16_t *d_ptr)
+{
+        const fnet_uint32_t *w_ptr;
+        fnet_uint32_t       w_sum = 0u;
+        fnet_uint32_t       carry = 0u;
+        fnet_uint32_t       w;
+        fnet_int32_t        current_length = (fnet_int32_t)length;
+
+        /* Align to the 32-bit boundary.*/
+        if((((fnet_uint32_t)d_ptr & 2u) != 0u) && (current_length >= 2))
+        {
+            sum += *d_ptr++;
+            current_length -= 2;
+        }
+        
+        w_ptr = (const fnet_uint32_t *)d_ptr;
+
+        while((current_length -= 32) >= 0)
+        {
+            w = *w_ptr++; w_sum += w; carry += (w_sum < w) ? 1u : 0u;
+            w = *w_ptr++; w_sum += w; carry += (w_sum < w) ? 1u : 0u;
+            w = *w_ptr++; w_sum += w; carry += (w_sum < w) ? 1u : 0u;
+            w = *w_ptr++; w_sum += w; carry += (w_sum < w) ? 1u : 0u;
+            w = *w_ptr++; w_sum += w; carry += (w_sum < w) ? 1u : 0u;
+            w = *w_ptr++; w_sum += w; carry += (w_sum < w) ? 1u : 0u;
+            w = *w_ptr++; w_sum += w; carry += (w_sum < w) ? 1u : 0u;
+            w = *w_ptr++; w_sum += w; carry += (w_sum < w) ? 1u : 0u;
+        }
+        current_length += 32;
+
+        while((current_length -= 4) >= 0)
+        {
+            w = *w_ptr++; w_sum += w; carry += (w_sum < w) ? 1u : 0u;
+        }
+        current_length += 4;
+        
+        /* Fold the 32-bit sum. Both halves are 16-bit words in memory order.*/
+        sum += (w_sum & 0xffffu) + (w_sum >> 16) + carry;
+
+        d_ptr = (const fnet_uint16_t *)w_ptr;
+
+        if(current_length >= 2)
+        {
+            sum += *d_ptr++;
+            current_length -= 2;
+        }
+        
+        if(current_length)
+        {
+            sum += (fnet_uint16_t)((*((const fnet_uint16_t *)d_ptr)) & FNET_NTOHS(0xFF00u));
+        }
+        
+        return sum;
+}
+#endif /* FNET_CFG_CHECKSUM_LOW_WIDE */
+
 #else
 
 extern fnet_uint32_t fnet_checksum_low(fnet_uint32_t sum, fnet_size_t length, const fnet_uint16_t *d_ptr);
 
 #endif
 
-static fnet_uint32_t fnet_checksum_nb(fnet_netbuf_t * nb, fnet_size_t length)
+/************************************************************************
+* NAME: fnet_checksum_fold
+*
+* DESCRIPTION: Folds the 32-bit accumulator to the 16-bit partial sum.
+*
+*************************************************************************/
+static fnet_uint32_t fnet_checksum_fold(fnet_uint32_t sum)
 {
-    fnet_netbuf_t   *tmp_nb;
-    fnet_uint16_t   *d_ptr;
-    fnet_uint16_t   p_byte2;
-    fnet_uint32_t   sum = 0U;
-    fnet_int32_t    current_length;
-    fnet_int32_t    len = (fnet_int32_t)length;
+    while ((sum>>16) != 0u) 
+    {
+        sum = (sum & 0xffffu) + (sum >> 16);
+    }
+    
+    return sum;
+}
 
-    tmp_nb = nb;
+/************************************************************************
+* NAME: fnet_checksum_swap
+*
+* DESCRIPTION: Swaps bytes of the 16-bit partial sum. It is used 
+*              for the data starting at an odd offset of the checksummed 
+*              region.
+*************************************************************************/
+static fnet_uint32_t fnet_checksum_swap(fnet_uint32_t sum)
+{
+    sum = fnet_checksum_fold(sum);
 
-    d_ptr = (fnet_uint16_t *)tmp_nb->data_ptr;               /* Store the data pointer of the 1st net_buf.*/
+    return (((sum << 8) | (sum >> 8)) & 0xffffu);
+}
 
-    if(nb->length > (fnet_size_t)len)
-    {
-        current_length = len;          /* If no more net_bufs to proceed.*/
-    }
-    else
-    {
-        current_length = (fnet_int32_t)nb->length;   /* Or full first net_buf.*/
-    }
+/************************************************************************
+* NAME: fnet_checksum_nb
+*
+* DESCRIPTION: Calculates the partial sum of "length" bytes of nb chain.
+*              Each net_buf is summed separately. Its partial sum 
+*              is byte-swapped, if it starts at an odd offset. 
+*              The sum cached by the fused copy is used when available.
+*************************************************************************/
+static fnet_uint32_t fnet_checksum_nb(fnet_netbuf_t * nb, fnet_size_t length)
+{
+    fnet_uint32_t   sum = 0U;
+    fnet_uint32_t   part;
+    fnet_size_t     current_length;
+    fnet_size_t     offset = 0u;
+#if FNET_CFG_CHECKSUM_COPY
+    fnet_size_t     head_length;
+#endif
 
-    while(len)
+    while((length > 0u) && (nb != 0))
     {
-        len -= current_length;       /* current_length bytes should be proceeded.*/
+        if(nb->length > length)
+        {
+            current_length = length;          /* If no more net_bufs to proceed.*/
+        }
+        else
+        {
+            current_length = nb->length;      /* Or full net_buf.*/
+        }
 
-        sum = fnet_checksum_low(sum, (fnet_size_t)current_length, d_ptr); 
-        
-        if(len)
+#if FNET_CFG_CHECKSUM_COPY
+        if((current_length == nb->length) && (nb->checksum_length != 0u) && (nb->checksum_length <= current_length))
         {
-            tmp_nb = tmp_nb->next;
-            d_ptr = (fnet_uint16_t *)tmp_nb->data_ptr;
-            
-            if(((fnet_size_t)current_length & 1u) != 0u)
+            /* Only the data in front of the cached sum (e.g. prepended header) is summed.*/
+            head_length = current_length - nb->checksum_length;
+            part = fnet_checksum_low(0U, head_length, (fnet_uint16_t *)nb->data_ptr);
+
+            if((head_length & 1u) != 0u)
             {
-                if(len)
-                {
-                    /* If previous fragment was odd, add in first byte in lower 8 bits. */
-                    p_byte2 = fnet_ntohs(((fnet_uint16_t)(*((fnet_uint8_t *)d_ptr)) & 0x00FFU));
-                    d_ptr = (fnet_uint16_t *)((fnet_uint8_t *)d_ptr + 1);
-                    
-                    sum += (fnet_uint16_t)p_byte2;
-                    len--;
-                    current_length = -1;
-                }
-                else
-                {
-                    current_length = 0;
-                }
+                part += fnet_checksum_swap(nb->checksum);
             }
             else
             {
-                current_length = 0;
+                part += nb->checksum;
             }
-              
+        }
+        else
+#endif
+        {
+            part = fnet_checksum_low(0U, current_length, (fnet_uint16_t *)nb->data_ptr);
+        }
+
+        if((offset & 1u) != 0u)
+        {
+            part = fnet_checksum_swap(part);
+        }
+
+        sum += part;
+        offset += current_length;
+        length -= current_length;
+        nb = nb->next;
+    }
+
+    return sum;
+}
+
+/************************************************************************
+* NAME: fnet_checksum_copy
+*
+* DESCRIPTION: Copies "length" bytes from "src" to "dest" and returns 
+*              the 16-bit partial sum (not complemented) of the data.
+*              The data are read only once. 32-bit words are used if both 
+*              buffers are 32-bit aligned, 16-bit words if they are 
+*              16-bit aligned.
+*************************************************************************/
+fnet_uint16_t fnet_checksum_copy(void *dest, const void *src, fnet_size_t length)
+{
+    fnet_uint32_t   sum = 0u;
+    fnet_int32_t    current_length = (fnet_int32_t)length;
+    fnet_uint16_t   *d_ptr = (fnet_uint16_t *)dest;
+    const fnet_uint16_t *s_ptr = (const fnet_uint16_t *)src;
+    fnet_uint16_t   p_byte1;
+
+    if((((fnet_uint32_t)dest | (fnet_uint32_t)src) & 1u) != 0u)
+    {
+        /* Not 16-bit aligned. Copy, then sum the destination in the cache.*/
+        fnet_memcpy(dest, src, length);
+        sum = fnet_checksum_low(0u, length, (const fnet_uint16_t *)dest);
+    }
+    else
+    {
+        if((((fnet_uint32_t)dest | (fnet_uint32_t)src) & 3u) == 0u)
+        {
+            fnet_uint32_t       *dw_ptr = (fnet_uint32_t *)dest;
+            const fnet_uint32_t *sw_ptr = (const fnet_uint32_t *)src;
+            fnet_uint32_t       w_sum = 0u;
+            fnet_uint32_t       carry = 0u;
+            fnet_uint32_t       w;
 
-            if(tmp_nb->length > (fnet_size_t)len)
+            while((current_length -= 16) >= 0)
             {
-                current_length = len;
+                w = *sw_ptr++; *dw_ptr++ = w; w_sum += w; carry += (w_sum < w) ? 1u : 0u;
+                w = *sw_ptr++; *dw_ptr++ = w; w_sum += w; carry += (w_sum < w) ? 1u : 0u;
+                w = *sw_ptr++; *dw_ptr++ = w; w_sum += w; carry += (w_sum < w) ? 1u : 0u;
+                w = *sw_ptr++; *dw_ptr++ = w; w_sum += w; carry += (w_sum < w) ? 1u : 0u;
             }
-            else
+            current_length += 16;
+
+            while((current_length -= 4) >= 0)
             {
-                current_length += (fnet_int32_t)tmp_nb->length;
+                w = *sw_ptr++; *dw_ptr++ = w; w_sum += w; carry += (w_sum < w) ? 1u : 0u;
             }
+            current_length += 4;
+
+            /* Both halves are 16-bit words in memory order.*/
+            sum = (w_sum & 0xffffu) + (w_sum >> 16) + carry;
+
+            d_ptr = (fnet_uint16_t *)dw_ptr;
+            s_ptr = (const fnet_uint16_t *)sw_ptr;
+        }
+
+        while((current_length -= 8) >= 0)
+        {
+            sum += (*d_ptr++ = *s_ptr++);
+            sum += (*d_ptr++ = *s_ptr++);
+            sum += (*d_ptr++ = *s_ptr++);
+            sum += (*d_ptr++ = *s_ptr++);
+        }
+        current_length += 8;
+
+        while((current_length -= 2) >= 0)
+        {
+            sum += (*d_ptr++ = *s_ptr++);
+        }
+        current_length += 2;
+
+        if(current_length)
+        {
+            /* The last octet is padded on the right with zero.*/
+            p_byte1 = 0u;
+            *((fnet_uint8_t *)&p_byte1) = *((fnet_uint8_t *)d_ptr) = *((const fnet_uint8_t *)s_ptr);
+            sum += p_byte1;
         }
     }
 
-    return sum;
+    return (fnet_uint16_t)fnet_checksum_fold(sum);
+}
+
+/************************************************************************
+* NAME: fnet_checksum_copy_append
+*
+* DESCRIPTION: Copies "length" bytes from "src" to "dest", which follows
+*              "sum_length" bytes summed to "sum", and returns 
+*              the 16-bit partial sum of all data.
+*************************************************************************/
+fnet_uint16_t fnet_checksum_copy_append(fnet_uint16_t sum, fnet_size_t sum_length, void *dest, const void *src, fnet_size_t length)
+{
+    fnet_uint32_t part = fnet_checksum_copy(dest, src, length);
+
+    if((sum_length & 1u) != 0u)
+    {
+        part = fnet_checksum_swap(part);
+    }
+
+    return (fnet_uint16_t)fnet_checksum_fold(part + sum);
 }
 
 /************************************************************************
@@ -298,4 +501,44 @@ fnet_uint16_t fnet_checksum_pseudo_end( fnet_uint16_t sum_s, const fnet_uint8_t
     return (fnet_uint16_t)(0xffffu & ~sum);
 }
 
+/************************************************************************
+* NAME: fnet_checksum_update16
+*
+* DESCRIPTION: Updates the Internet checksum "checksum" of a header, 
+*              after its 16-bit field is changed from "old_value" to 
+*              "new_value" (RFC1624, eqn. 3: HC' = ~(~HC + ~m + m')).
+*              All values are in the same (network) byte order, 
+*              as they are stored in the header.
+*************************************************************************/
+fnet_uint16_t fnet_checksum_update16( fnet_uint16_t checksum, fnet_uint16_t old_value, fnet_uint16_t new_value )
+{
+    fnet_uint32_t sum;
+
+    sum = (fnet_uint32_t)(fnet_uint16_t)~checksum + (fnet_uint32_t)(fnet_uint16_t)~old_value + (fnet_uint32_t)new_value;
 
+    /* Add accumulated carries */
+    sum = fnet_checksum_fold(sum);
+
+    return (fnet_uint16_t)(0xffffu & ~sum);
+}
+
+/************************************************************************
+* NAME: fnet_checksum_update32
+*
+* DESCRIPTION: Updates the Internet checksum "checksum" of a header, 
+*              after its 32-bit field (e.g. an address or a sequence 
+*              number) is changed from "old_value" to "new_value".
+*************************************************************************/
+fnet_uint16_t fnet_checksum_update32( fnet_uint16_t checksum, fnet_uint32_t old_value, fnet_uint32_t new_value )
+{
+    fnet_uint32_t sum;
+
+    sum = (fnet_uint32_t)(fnet_uint16_t)~checksum 
+        + (fnet_uint32_t)(fnet_uint16_t)~(old_value >> 16) + (fnet_uint32_t)(fnet_uint16_t)~old_value 
+        + (new_value >> 16) + (new_value & 0xffffu);
+
+    /* Add accumulated carries */
+    sum = fnet_checksum_fold(sum);
+
+    return (fnet_uint16_t)(0xffffu & ~sum);
+}
@@ -43,6 +43,10 @@ fnet_uint16_t fnet_checksum_buf(fnet_uint8_t *buf, fnet_size_t buf_len);
 fnet_uint16_t fnet_checksum_pseudo_buf(fnet_uint8_t *buf, fnet_uint16_t buf_len, fnet_uint16_t protocol, const fnet_uint8_t *ip_src, const fnet_uint8_t *ip_dest, fnet_size_t addr_size);
 fnet_uint16_t fnet_checksum(fnet_netbuf_t * nb, fnet_size_t len);
 fnet_uint16_t fnet_checksum_pseudo_start( fnet_netbuf_t *nb, fnet_uint16_t protocol, fnet_uint16_t protocol_len );
+fnet_uint16_t fnet_checksum_update16( fnet_uint16_t checksum, fnet_uint16_t old_value, fnet_uint16_t new_value );
+fnet_uint16_t fnet_checksum_update32( fnet_uint16_t checksum, fnet_uint32_t old_value, fnet_uint32_t new_value );
+fnet_uint16_t fnet_checksum_copy(void *dest, const void *src, fnet_size_t length);
+fnet_uint16_t fnet_checksum_copy_append(fnet_uint16_t sum, fnet_size_t sum_length, void *dest, const void *src, fnet_size_t length);
 fnet_uint16_t fnet_checksum_pseudo_end( fnet_uint16_t sum_s, const fnet_uint8_t *ip_src, const fnet_uint8_t *ip_dest, fnet_size_t addr_size );
 
 #if defined(__cplusplus)
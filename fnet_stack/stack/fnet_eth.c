@@ -250,10 +250,8 @@ fnet_return_t fnet_eth_init( fnet_netif_t *netif)
 {
     fnet_return_t result;
 
-#if !FNET_CFG_CPU_ETH_MIB 
     /* Clear Ethernet statistics. */
     fnet_memset_zero(&((fnet_eth_if_t *)(netif->if_ptr))->statistics, sizeof(struct fnet_netif_statistics));
-#endif 
 
 #if FNET_CFG_IP4   
     result = fnet_arp_init(netif); /* Init ARP for this interface.*/
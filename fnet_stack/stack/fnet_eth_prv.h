@@ -93,9 +93,7 @@ typedef struct fnet_eth_if
 #if FNET_CFG_IP6   
     fnet_nd6_if_t       nd6_if;
 #endif 
-#if !FNET_CFG_CPU_ETH_MIB     
-    struct fnet_netif_statistics statistics;
-#endif    
+    struct fnet_netif_statistics statistics; /* Packet counters are not used if FNET_CFG_CPU_ETH_MIB is set.*/
 } fnet_eth_if_t;
 
 /************************************************************************
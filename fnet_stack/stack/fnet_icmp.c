@@ -44,7 +44,7 @@
 *     Function Prototypes
 *************************************************************************/
 static void fnet_icmp_input(fnet_netif_t *netif, struct sockaddr *src_addr,  struct sockaddr *dest_addr, fnet_netbuf_t *nb, fnet_netbuf_t *ip4_nb);
-static void fnet_icmp_output( fnet_netif_t *netif, fnet_ip4_addr_t src_ip, fnet_ip4_addr_t dest_ip, fnet_netbuf_t *nb );
+static void fnet_icmp_output( fnet_netif_t *netif, fnet_ip4_addr_t src_ip, fnet_ip4_addr_t dest_ip, fnet_netbuf_t *nb, fnet_bool_t checksum_valid );
 static void fnet_icmp_notify_protocol(fnet_netif_t *netif, fnet_prot_notify_t prot_cmd, fnet_netbuf_t *nb );
                         
 #if FNET_CFG_DEBUG_TRACE_ICMP && FNET_CFG_DEBUG_TRACE
@@ -67,7 +67,8 @@ fnet_prot_if_t fnet_icmp_prot_if =
     fnet_icmp_input,        /* Protocol input function.*/
     0,                      /* Protocol input control function.*/     
     0,                      /* protocol drain function.*/
-    0                       /* Socket API */
+    0,                      /* Socket API */
+    0                       /* Port lookup table.*/
 };
 
 /************************************************************************
@@ -123,9 +124,21 @@ static void fnet_icmp_input(fnet_netif_t *netif, struct sockaddr *src_addr,  str
                     goto DISCARD;
                 }
 
+                /* The reply is built in place. Do not touch data shared with other net_bufs (e.g. RAW sockets).*/
+                if(fnet_netbuf_cow(&nb, sizeof(fnet_icmp_echo_header_t)) == FNET_ERR)
+                {
+                    goto DISCARD;
+                }
+                hdr = (fnet_icmp_header_t *)nb->data_ptr;
+
+                /* Only the type is changed, so the checksum is updated incrementally (RFC1624),
+                 * without a pass over the echo data.*/
+                hdr->checksum = fnet_checksum_update16(hdr->checksum, 
+                                                       fnet_htons((fnet_uint16_t)(((fnet_uint16_t)FNET_ICMP_ECHO << 8) | hdr->code)),
+                                                       fnet_htons((fnet_uint16_t)(((fnet_uint16_t)FNET_ICMP_ECHOREPLY << 8) | hdr->code)));
                 hdr->type = FNET_ICMP_ECHOREPLY;
 
-                fnet_icmp_output(netif, dest_ip, src_ip, nb);
+                fnet_icmp_output(netif, dest_ip, src_ip, nb, FNET_TRUE);
                 break;
 #if 0 /* Optional functionality.*/                
             /************************
@@ -149,7 +162,7 @@ static void fnet_icmp_input(fnet_netif_t *netif, struct sockaddr *src_addr,  str
 
                 dest_ip = netif->ip4_addr.address;
 
-                fnet_icmp_output(netif, dest_ip, src_ip, nb);
+                fnet_icmp_output(netif, dest_ip, src_ip, nb, FNET_FALSE);
                 break;
             /************************
              * Address Mask Query
@@ -169,7 +182,7 @@ static void fnet_icmp_input(fnet_netif_t *netif, struct sockaddr *src_addr,  str
 
                 dest_ip = netif->ip4_addr.address;
 
-                fnet_icmp_output(netif, dest_ip, src_ip, nb);
+                fnet_icmp_output(netif, dest_ip, src_ip, nb, FNET_FALSE);
                 break;
 #endif                
             /**************************
@@ -328,23 +341,31 @@ DISCARD:
 * NAME: fnet_icmp_output
 *
 * DESCRIPTION: ICMP output function.
+*              If "checksum_valid" is FNET_TRUE, the checksum field 
+*              is already updated by the caller.
 *************************************************************************/
 static void fnet_icmp_output( fnet_netif_t *netif, fnet_ip4_addr_t src_ip, 
-                                fnet_ip4_addr_t dest_ip, fnet_netbuf_t *nb )
+                                fnet_ip4_addr_t dest_ip, fnet_netbuf_t *nb, fnet_bool_t checksum_valid )
 {
     fnet_icmp_header_t *hdr = (fnet_icmp_header_t *)nb->data_ptr;
 
-    hdr->checksum = 0u;
 #if FNET_CFG_CPU_ETH_HW_TX_PROTOCOL_CHECKSUM 
     if( netif 
             && (netif->features & FNET_NETIF_FEATURE_HW_TX_PROTOCOL_CHECKSUM)
             && (fnet_ip_will_fragment(netif, nb->total_length) == FNET_FALSE) /* Fragmented packets are not inspected.*/  ) 
     {
+        hdr->checksum = 0u;
         nb->flags |= FNET_NETBUF_FLAG_HW_PROTOCOL_CHECKSUM;
     }
     else
 #endif
+    if(checksum_valid == FNET_FALSE)
+    {
+        hdr->checksum = 0u;
         hdr->checksum = fnet_checksum(nb, nb->total_length);
+    }
+    else
+    {}
 
     fnet_ip_output(netif, src_ip, dest_ip, FNET_IP_PROTOCOL_ICMP, FNET_ICMP_TOS, FNET_ICMP_TTL, nb, FNET_FALSE, FNET_FALSE, 0);
 }
@@ -423,7 +444,7 @@ void fnet_icmp_error( fnet_netif_t *netif, fnet_uint8_t type, fnet_uint8_t code,
 
         nb = fnet_netbuf_concat(nb_header, nb);
 
-        fnet_icmp_output(netif, destination_addr, source_addr, nb);
+        fnet_icmp_output(netif, destination_addr, source_addr, nb, FNET_FALSE);
 
         return;
 
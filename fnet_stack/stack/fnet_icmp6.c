@@ -59,7 +59,8 @@ fnet_prot_if_t fnet_icmp6_prot_if =
     fnet_icmp6_input,       /* Protocol input function,.*/
     0,                      /* Protocol input control function.*/     
     0,                      /* protocol drain function.*/
-    0                       /* Socket API */
+    0,                      /* Socket API */
+    0                       /* Port lookup table.*/
 };
 
 /************************************************************************
@@ -148,6 +149,13 @@ static void fnet_icmp6_input(fnet_netif_t *netif, struct sockaddr *src_addr,  st
              * receives Echo Requests and originates corresponding Echo Replies.             
              **************************/
             case FNET_ICMP6_TYPE_ECHO_REQ:
+                /* The reply is built in place. Do not touch data shared with other net_bufs (e.g. RAW sockets).*/
+                if(fnet_netbuf_cow(&nb, sizeof(fnet_icmp6_header_t)) == FNET_ERR)
+                {
+                    goto DISCARD;
+                }
+                hdr = (fnet_icmp6_header_t *)nb->data_ptr;
+
                 hdr->type = FNET_ICMP6_TYPE_ECHO_REPLY;
                 
                 /* RFC4443: the source address of the reply MUST be a unicast 
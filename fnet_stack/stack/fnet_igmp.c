@@ -82,7 +82,8 @@ fnet_prot_if_t fnet_igmp_prot_if =
     fnet_igmp_input,        /* Protocol input function.*/
     0,                      /* Protocol input control function.*/     
     0,                      /* protocol drain function.*/
-    0                       /* Socket API */
+    0,                      /* Socket API */
+    0                       /* Port lookup table.*/
 };
 
 /************************************************************************
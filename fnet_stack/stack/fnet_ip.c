@@ -69,6 +69,10 @@ static fnet_event_desc_t ip_event;
 *     Function Prototypes
 *************************************************************************/
 static void fnet_ip_netif_output(struct fnet_netif *netif, fnet_ip4_addr_t dest_ip_addr, fnet_netbuf_t* nb, fnet_bool_t do_not_route);
+static void fnet_ip_header_checksum(struct fnet_netif *netif, fnet_netbuf_t* nb);
+#if FNET_CFG_IP4_FRAGMENTATION
+static void fnet_ip_header_set16(fnet_netbuf_t* nb, FNET_COMP_PACKED_VAR fnet_uint16_t *field, fnet_uint16_t value);
+#endif
 static void fnet_ip_input_low(fnet_uint32_t cookie );
 static fnet_error_t fnet_ip4_getsockopt(fnet_socket_if_t *sock, fnet_socket_options_t optname, void *optval, fnet_size_t *optlen );
 static fnet_error_t fnet_ip4_setsockopt( fnet_socket_if_t *sock, fnet_socket_options_t optname, const void *optval, fnet_size_t optlen ); 
@@ -241,12 +245,13 @@ fnet_error_t fnet_ip_output( fnet_netif_t *netif,    fnet_ip4_addr_t src_ip, fne
         goto DROP;
     }
 
-    /* Construct IP header */
-    if((nb_header = fnet_netbuf_new(sizeof(fnet_ip_header_t), FNET_TRUE)) == 0)
+    /* Construct IP header, in the headroom of the first net_buf if possible */
+    if((nb_header = fnet_netbuf_push(nb, sizeof(fnet_ip_header_t), FNET_TRUE)) == 0)
     {
         error_code = FNET_ERR_NOMEM;   
         goto DROP;
     }
+    nb = nb_header;
     
     /* Pseudo checksum. */
     if(checksum)
@@ -260,7 +265,7 @@ fnet_error_t fnet_ip_output( fnet_netif_t *netif,    fnet_ip4_addr_t src_ip, fne
     ipheader->id = fnet_htons(ip_id++);              /* Id */
 
     ipheader->tos = tos;                 /* Type of service */
-    total_length = (fnet_uint16_t)(nb->total_length + sizeof(fnet_ip_header_t)); /* total length*/
+    total_length = (fnet_uint16_t)nb->total_length; /* total length*/
     FNET_IP_HEADER_SET_HEADER_LENGTH(ipheader, sizeof(fnet_ip_header_t) >> 2);
     ipheader->flags_fragment_offset = 0x0000u; /* flags & fragment offset field */
 
@@ -275,8 +280,6 @@ fnet_error_t fnet_ip_output( fnet_netif_t *netif,    fnet_ip4_addr_t src_ip, fne
     ipheader->desination_addr = dest_ip; /* destination address */
 
     ipheader->total_length = fnet_htons((fnet_uint16_t)total_length);
-    
-    nb = fnet_netbuf_concat(nb_header, nb);
 
     if(total_length > netif->mtu) /* IP Fragmentation. */ 
     {
@@ -291,6 +294,7 @@ fnet_error_t fnet_ip_output( fnet_netif_t *netif,    fnet_ip4_addr_t src_ip, fne
         fnet_size_t         new_header_length;
         fnet_size_t         header_length = (fnet_size_t)(FNET_IP_HEADER_GET_HEADER_LENGTH(ipheader) << 2);
         fnet_ip_header_t    *new_ipheader;
+        fnet_uint16_t       frag_offset;
 
         frag_length = (netif->mtu - header_length) & ~7u; /* rounded down to an 8-byte boundary.*/
         first_frag_length = frag_length;
@@ -311,6 +315,10 @@ fnet_error_t fnet_ip_output( fnet_netif_t *netif,    fnet_ip4_addr_t src_ip, fne
 
         ipheader = (fnet_ip_header_t *)nb->data_ptr;
 
+        /* The checksum of the original header is calculated once. 
+         * The fragment headers are its copies with few changed fields.*/
+        fnet_ip_header_checksum(netif, nb);
+
         nb_prev = nb;
         
         total_length = fnet_ntohs(ipheader->total_length);
@@ -328,12 +336,13 @@ fnet_error_t fnet_ip_output( fnet_netif_t *netif,    fnet_ip4_addr_t src_ip, fne
                 goto FRAG_END;
             }
 
-            fnet_memcpy(nb->data_ptr, ipheader, header_length); /* Copy IP header.*/
+            fnet_memcpy(nb->data_ptr, ipheader, header_length); /* Copy IP header (with its checksum).*/
             new_ipheader = (fnet_ip_header_t *)nb->data_ptr;
             new_header_length = sizeof(fnet_ip_header_t);
+            nb->flags |= (nb_prev->flags & FNET_NETBUF_FLAG_HW_IP_CHECKSUM);
 
             FNET_IP_HEADER_SET_HEADER_LENGTH(new_ipheader, (fnet_uint8_t)(new_header_length >> 2)); 
-            new_ipheader->flags_fragment_offset = fnet_htons((fnet_uint16_t)((offset - header_length) >> 3));
+            frag_offset = fnet_htons((fnet_uint16_t)((offset - header_length) >> 3));
 
             if(offset + frag_length >= total_length)  
             {
@@ -341,9 +350,11 @@ fnet_error_t fnet_ip_output( fnet_netif_t *netif,    fnet_ip4_addr_t src_ip, fne
             }
             else
             {
-                new_ipheader->flags_fragment_offset |= FNET_HTONS(FNET_IP_MF);
+                frag_offset |= FNET_HTONS(FNET_IP_MF);
             }
 
+            fnet_ip_header_set16(nb, &new_ipheader->flags_fragment_offset, frag_offset);
+
             /* Copy the data from the original packet into the fragment.*/
             if((nb_tmp = fnet_netbuf_copy(nb_prev, offset, frag_length, FNET_FALSE)) == 0)
             {
@@ -354,7 +365,12 @@ fnet_error_t fnet_ip_output( fnet_netif_t *netif,    fnet_ip4_addr_t src_ip, fne
 
             nb = fnet_netbuf_concat(nb, nb_tmp);
 
-            new_ipheader->total_length = fnet_htons((fnet_uint16_t)nb->total_length); 
+            fnet_ip_header_set16(nb, &new_ipheader->total_length, fnet_htons((fnet_uint16_t)nb->total_length)); 
+
+            if(new_header_length != header_length) /* Options are not copied.*/
+            {
+                fnet_ip_header_checksum(netif, nb);
+            }
 
             *nb_next_ptr = nb;
             nb_next_ptr = &nb->next_chain;
@@ -363,8 +379,8 @@ fnet_error_t fnet_ip_output( fnet_netif_t *netif,    fnet_ip4_addr_t src_ip, fne
         /* Update the first fragment.*/
         nb = nb_prev;
         fnet_netbuf_trim(&nb, (fnet_int32_t)(header_length + first_frag_length - fnet_ntohs(ipheader->total_length)));
-        ipheader->total_length = fnet_htons((fnet_uint16_t)nb->total_length);
-        ipheader->flags_fragment_offset |= FNET_HTONS(FNET_IP_MF);
+        fnet_ip_header_set16(nb, &ipheader->total_length, fnet_htons((fnet_uint16_t)nb->total_length));
+        fnet_ip_header_set16(nb, &ipheader->flags_fragment_offset, (fnet_uint16_t)(ipheader->flags_fragment_offset | FNET_HTONS(FNET_IP_MF)));
 
 FRAG_END:
         for (nb = nb_prev; nb; nb = nb_prev)    /* Send each fragment.*/
@@ -393,6 +409,7 @@ FRAG_END:
     }
     else
     {
+        fnet_ip_header_checksum(netif, nb);
         fnet_ip_netif_output(netif, dest_ip, nb, do_not_route);
     }
 
@@ -406,14 +423,15 @@ DROP:
 }
 
 /************************************************************************
-* NAME: fnet_ip_netif_output
+* NAME: fnet_ip_header_checksum
 *
-* DESCRIPTION:
+* DESCRIPTION: Calculates the IPv4 header checksum, 
+*              or leaves it to the hardware.
 *************************************************************************/
-static void fnet_ip_netif_output(struct fnet_netif *netif, fnet_ip4_addr_t dest_ip_addr, fnet_netbuf_t* nb, fnet_bool_t do_not_route)
+static void fnet_ip_header_checksum(struct fnet_netif *netif, fnet_netbuf_t* nb)
 {
     fnet_ip_header_t        *ipheader = (fnet_ip_header_t *)nb->data_ptr;
-    
+
     /* IPv4 Header Checksum*/
     ipheader->checksum = 0u;
 
@@ -421,10 +439,40 @@ static void fnet_ip_netif_output(struct fnet_netif *netif, fnet_ip4_addr_t dest_
     if(netif->features & FNET_NETIF_FEATURE_HW_TX_IP_CHECKSUM)
         nb->flags |= FNET_NETBUF_FLAG_HW_IP_CHECKSUM;
     else
+#else
+    FNET_COMP_UNUSED_ARG(netif);
 #endif    
         ipheader->checksum = fnet_checksum(nb, (fnet_size_t)FNET_IP_HEADER_GET_HEADER_LENGTH(ipheader) << 2); /* IP checksum*/
+}
+
+#if FNET_CFG_IP4_FRAGMENTATION
+/************************************************************************
+* NAME: fnet_ip_header_set16
+*
+* DESCRIPTION: Changes the 16-bit field of the IPv4 header in "nb" 
+*              and updates the header checksum incrementally (RFC1624).
+*************************************************************************/
+static void fnet_ip_header_set16(fnet_netbuf_t* nb, FNET_COMP_PACKED_VAR fnet_uint16_t *field, fnet_uint16_t value)
+{
+    fnet_ip_header_t        *ipheader = (fnet_ip_header_t *)nb->data_ptr;
+
+    if((nb->flags & FNET_NETBUF_FLAG_HW_IP_CHECKSUM) == 0u) /* The HW needs the zero checksum field.*/
+    {
+        ipheader->checksum = fnet_checksum_update16(ipheader->checksum, *field, value);
+    }
+
+    *field = value;
+}
+#endif /* FNET_CFG_IP4_FRAGMENTATION */
 
-     
+/************************************************************************
+* NAME: fnet_ip_netif_output
+*
+* DESCRIPTION: Passes the IPv4 datagram, with calculated header 
+*              checksum, to the interface.
+*************************************************************************/
+static void fnet_ip_netif_output(struct fnet_netif *netif, fnet_ip4_addr_t dest_ip_addr, fnet_netbuf_t* nb, fnet_bool_t do_not_route)
+{
     if( /* Datagrams sent to a broadcast address */
         (fnet_ip_addr_is_broadcast (dest_ip_addr, netif))
         /* Datagrams sent to a multicast address. */
@@ -678,8 +726,8 @@ static fnet_netbuf_t *fnet_ip_reassembly( fnet_netbuf_t ** nb_ptr )
     fnet_uint16_t           offset;
     fnet_size_t             hdr_length;
     
-    /* For this algorithm the all datagram must reside in contiguous area of memory.*/
-    if(fnet_netbuf_pullup(nb_ptr, (*nb_ptr)->total_length) == FNET_ERR) 
+    /* For this algorithm the all datagram must reside in contiguous and writable area of memory.*/
+    if(fnet_netbuf_cow(nb_ptr, (*nb_ptr)->total_length) == FNET_ERR) 
     {
         goto DROP_FRAG;
     }
@@ -1591,7 +1639,18 @@ fnet_return_t fnet_ip_queue_append( fnet_ip_queue_t *queue, fnet_netif_t *netif,
     queue->count += nb->total_length;
 
     nb = fnet_netbuf_concat(nb_netif, nb);
-    fnet_netbuf_add_chain(&queue->head, nb);
+
+    /* Add the datagram to the end of the queue.*/
+    if(queue->head == 0)
+    {
+        queue->head = nb;
+    }
+    else
+    {
+        queue->tail->next_chain = nb;
+    }
+
+    queue->tail = nb;
     
     fnet_isr_unlock();
     return FNET_OK;
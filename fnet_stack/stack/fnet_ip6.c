@@ -1120,6 +1120,8 @@ fnet_error_t fnet_ip6_output(fnet_netif_t *netif /*optional*/, const fnet_ip6_ad
     fnet_netbuf_t       *nb_header;
     fnet_ip6_header_t   *ip6_header;
     fnet_size_t          mtu;
+    fnet_size_t          payload_length;
+    fnet_bool_t          is_fragmented;
 
 
     /* Check maximum packet size. */
@@ -1186,19 +1188,61 @@ fnet_error_t fnet_ip6_output(fnet_netif_t *netif /*optional*/, const fnet_ip6_ad
         *checksum = fnet_checksum_pseudo_end( *checksum, (fnet_uint8_t *)src_ip, (const fnet_uint8_t *)dest_ip, sizeof(fnet_ip6_addr_t) );    
     }
     
+    mtu = fnet_ip6_mtu(netif); 
+    payload_length = nb->total_length;
+
+    is_fragmented = (
+#if FNET_CFG_IP6_PMTU_DISCOVERY
+    /*
+     * In response to an IPv6 packet that is sent to an IPv4 destination
+     * (i.e., a packet that undergoes translation from IPv6 to IPv4), the
+     * originating IPv6 node may receive an ICMP Packet Too Big message
+     * reporting a Next-Hop MTU less than 1280.  In that case, the IPv6 node
+     * is not required to reduce the size of subsequent packets to less than
+     * 1280, but must include a Fragment header in those packets so that the
+     * IPv6-to-IPv4 translating router can obtain a suitable Identification
+     * value to use in resulting IPv4 fragments.  Note that this means the
+     * payload may have to be reduced to 1232 octets (1280 minus 40 for the
+     * IPv6 header and 8 for the Fragment header), and smaller still if
+     * additional extension headers are used.
+     */
+      
+        ((netif->pmtu) /* If PMTU is enabled.*/ &&  ((payload_length + sizeof(fnet_ip6_header_t)) > netif->pmtu)) ||
+        ( (!netif->pmtu) &&
+#endif   
+        ((payload_length + sizeof(fnet_ip6_header_t)) > mtu)
+#if FNET_CFG_IP6_PMTU_DISCOVERY
+        )
+#endif
+    ) ? FNET_TRUE : FNET_FALSE;
+
+#if FNET_CFG_IP6_FRAGMENTATION
+    if(is_fragmented)
+    {
+        /* Fragment header, placed between IPv6 header and payload.*/
+        if((nb_header = fnet_netbuf_push(nb, sizeof(fnet_ip6_fragment_header_t), FNET_TRUE)) == 0)
+        {
+            error_code = FNET_ERR_NOMEM;   
+            goto DROP;
+        }
+        nb = nb_header;
+    }
+#endif
+
     /****** Construct IP header. ******/
-    if((nb_header = fnet_netbuf_new(sizeof(fnet_ip6_header_t), FNET_TRUE)) == 0)
+    if((nb_header = fnet_netbuf_push(nb, sizeof(fnet_ip6_header_t), FNET_TRUE)) == 0)
     {
         error_code = FNET_ERR_NOMEM;   
         goto DROP;
     }
+    nb = nb_header;
     
-    ip6_header = (fnet_ip6_header_t *)nb_header->data_ptr;
+    ip6_header = (fnet_ip6_header_t *)nb->data_ptr;
     
     ip6_header->version__tclass = FNET_IP6_VERSION<<4;
     ip6_header->tclass__flowl = 0u;
     ip6_header->flowl = 0u;
-    ip6_header->length = fnet_htons((fnet_uint16_t)nb->total_length);
+    ip6_header->length = fnet_htons((fnet_uint16_t)payload_length);
     ip6_header->next_header = protocol;
     
     /* Set Hop Limit.*/
@@ -1212,32 +1256,7 @@ fnet_error_t fnet_ip6_output(fnet_netif_t *netif /*optional*/, const fnet_ip6_ad
     FNET_IP6_ADDR_COPY(src_ip, &ip6_header->source_addr);
     FNET_IP6_ADDR_COPY(dest_ip, &ip6_header->destination_addr);
     
-    mtu = fnet_ip6_mtu(netif); 
-
-    if(
-#if FNET_CFG_IP6_PMTU_DISCOVERY
-    /*
-     * In response to an IPv6 packet that is sent to an IPv4 destination
-     * (i.e., a packet that undergoes translation from IPv6 to IPv4), the
-     * originating IPv6 node may receive an ICMP Packet Too Big message
-     * reporting a Next-Hop MTU less than 1280.  In that case, the IPv6 node
-     * is not required to reduce the size of subsequent packets to less than
-     * 1280, but must include a Fragment header in those packets so that the
-     * IPv6-to-IPv4 translating router can obtain a suitable Identification
-     * value to use in resulting IPv4 fragments.  Note that this means the
-     * payload may have to be reduced to 1232 octets (1280 minus 40 for the
-     * IPv6 header and 8 for the Fragment header), and smaller still if
-     * additional extension headers are used.
-     */
-      
-        ((netif->pmtu) /* If PMTU is enabled.*/ &&  ((nb->total_length + nb_header->total_length) > netif->pmtu)) ||
-        ( (!netif->pmtu) &&
-#endif   
-        ((nb->total_length + nb_header->total_length) > mtu)
-#if FNET_CFG_IP6_PMTU_DISCOVERY
-        )/* IP Fragmentation. */
-#endif
- 	)
+    if(is_fragmented) /* IP Fragmentation. */
     {
 
 #if FNET_CFG_IP6_FRAGMENTATION
@@ -1253,7 +1272,6 @@ fnet_error_t fnet_ip6_output(fnet_netif_t *netif /*optional*/, const fnet_ip6_ad
         fnet_ip6_header_t           *ip6_header_new;
         fnet_ip6_fragment_header_t  *ip6_fragment_header;
         fnet_ip6_fragment_header_t  *ip6_fragment_header_new;
-        fnet_netbuf_t               *nb_frag_header;
         fnet_size_t                 total_length;
         static fnet_uint32_t        ip6_id = 0u;
         
@@ -1263,24 +1281,12 @@ fnet_error_t fnet_ip6_output(fnet_netif_t *netif /*optional*/, const fnet_ip6_ad
         if(tmp < 8)             /* The MTU is too small.*/
         {
             error_code = FNET_ERR_MSGSIZE; 
-            fnet_netbuf_free_chain(nb_header);            
             goto DROP; 
         }
         frag_length = (fnet_size_t)tmp;
 
         first_frag_length = frag_length;
         
-        if((nb_frag_header = fnet_netbuf_new(sizeof(fnet_ip6_fragment_header_t), FNET_TRUE)) == 0)
-        {
-            error_code = FNET_ERR_NOMEM; 
-            fnet_netbuf_free_chain(nb_header);   
-            goto DROP;
-        }
-        
-        
-        nb = fnet_netbuf_concat(nb_frag_header, nb);
-        nb = fnet_netbuf_concat(nb_header, nb);
-        
         nb_next_ptr = &nb->next_chain;
 
         /* The header (and options) must reside in contiguous area of memory.*/
@@ -1386,7 +1392,6 @@ FRAG_END:
     }
     else
     {
-        nb = fnet_netbuf_concat(nb_header, nb);
         fnet_ip6_netif_output(netif, src_ip, dest_ip, nb);
     }
     
@@ -204,6 +204,7 @@ FNET_COMP_PACKED_END
 typedef struct                              /* IP input queue.*/
 {
     fnet_netbuf_t   *head;                  /* Pointer to the queue head.*/
+    fnet_netbuf_t   *tail;                  /* Pointer to the queue tail (valid if head is not 0).*/
     fnet_size_t     count;                  /* Number of data in buffer.*/
 } fnet_ip_queue_t;
 
@@ -35,6 +35,7 @@
 #include "fnet_loop.h"
 #include "fnet_ip_prv.h"
 #include "fnet_ip6_prv.h"
+#include "fnet_timer_prv.h"
 
 #if (FNET_CFG_LOOPBACK_MTU < 200u)
     #error  "FNET_CFG_LOOPBACK_MTU must be more than 200."
@@ -79,6 +80,30 @@ const struct fnet_netif_api fnet_loop_api =
 };
 
 
+/* Percentage of the outgoing packets, dropped by the loopback interface.*/
+static fnet_index_t fnet_loop_loss = 0u;
+
+#if FNET_CFG_LOOPBACK_DELAY_QUEUE
+/* Packet delayed by the loopback interface.*/
+typedef struct
+{
+    fnet_netbuf_t   *nb;        /* Packet.*/
+    fnet_time_t     time;       /* Time when the packet is sent (ms).*/
+    fnet_bool_t     is_ip6;     /* FNET_TRUE if it is IPv6 packet.*/
+} fnet_loop_delayed_t;
+
+static fnet_loop_delayed_t  fnet_loop_delay_queue[FNET_CFG_LOOPBACK_DELAY_QUEUE];
+static fnet_index_t         fnet_loop_delay_head = 0u;  /* Oldest packet.*/
+static fnet_index_t         fnet_loop_delay_count = 0u; /* Number of delayed packets.*/
+static fnet_time_t          fnet_loop_delay = 0u;       /* One-way delay (ms).*/
+static fnet_timer_desc_t    fnet_loop_delay_timer = FNET_NULL;
+
+static void fnet_loop_delay_timeo( fnet_uint32_t cookie );
+static void fnet_loop_delay_input( fnet_bool_t all );
+#endif
+
+static void fnet_loop_input( fnet_netif_t *netif, fnet_netbuf_t *nb, fnet_bool_t is_ip6 );
+
 /* Loopback Interface structure.*/
 fnet_netif_t fnet_loop_if = 
 {
@@ -91,48 +116,187 @@ fnet_netif_t fnet_loop_if =
 };
 
 /************************************************************************
-* NAME: fnet_loop_output_ip4
+* NAME: fnet_loop_set_loss
 *
-* DESCRIPTION: This function just only sends outgoing packets to IP layer.
+* DESCRIPTION: This function sets the percentage of outgoing packets,
+*              randomly dropped by the loopback interface.
+*              It is used for testing of the loss recovery only.
 *************************************************************************/
-#if FNET_CFG_IP4
-void fnet_loop_output_ip4(fnet_netif_t *netif, fnet_ip4_addr_t dest_ip_addr, fnet_netbuf_t* nb)
+void fnet_loop_set_loss(fnet_index_t percent)
 {
-    FNET_COMP_UNUSED_ARG(dest_ip_addr);
+    fnet_loop_loss = percent;
+}
+
+/************************************************************************
+* NAME: fnet_loop_drop
+*
+* DESCRIPTION: This function returns FNET_TRUE if the outgoing packet 
+*              must be dropped.
+*************************************************************************/
+static fnet_bool_t fnet_loop_drop(void)
+{
+    fnet_bool_t result = FNET_FALSE;
     
-    fnet_isr_lock();
+    if(fnet_loop_loss && ((fnet_rand() % 100u) < fnet_loop_loss))
+    {
+        result = FNET_TRUE;
+    }
     
-    /* MTU check */
-    if (nb->total_length <= netif->mtu)
+    return result;
+}
+
+#if FNET_CFG_LOOPBACK_DELAY_QUEUE
+/************************************************************************
+* NAME: fnet_loop_set_delay
+*
+* DESCRIPTION: This function sets the one-way delay of outgoing packets
+*              of the loopback interface, simulating the path with 
+*              the round trip time of two delays.
+*              It is used for benchmarks only.
+*************************************************************************/
+void fnet_loop_set_delay(fnet_time_t delay_ms)
+{
+    fnet_isr_lock();
+
+    if(delay_ms)
     {
-        fnet_ip_input(netif, nb);
+        if(fnet_loop_delay_timer == FNET_NULL)
+        {
+            fnet_loop_delay_timer = fnet_timer_new(1u, fnet_loop_delay_timeo, 0u);
+        }
+
+        fnet_loop_delay = (fnet_loop_delay_timer != FNET_NULL) ? delay_ms : 0u;
     }
     else
     {
-        fnet_netbuf_free_chain(nb);
+        fnet_loop_delay = 0u;
+
+        if(fnet_loop_delay_timer)
+        {
+            fnet_timer_free(fnet_loop_delay_timer);
+            fnet_loop_delay_timer = FNET_NULL;
+        }
     }
-        
+
     fnet_isr_unlock();
+
+    if(delay_ms == 0u)
+    {
+        /* Pass the delayed packets.*/
+        fnet_loop_delay_input(FNET_TRUE);
+    }
 }
-#endif /* FNET_CFG_IP4 */
 
 /************************************************************************
-* NAME: fnet_loop_output_ip6
+* NAME: fnet_loop_delay_timeo
 *
-* DESCRIPTION: This function just only sends outgoing packets to IPv6 layer.
+* DESCRIPTION: Timer handler, passing the delayed packets.
 *************************************************************************/
-#if FNET_CFG_IP6
-void fnet_loop_output_ip6(struct fnet_netif *netif, const fnet_ip6_addr_t *src_ip_addr, const fnet_ip6_addr_t *dest_ip_addr, fnet_netbuf_t* nb)
+static void fnet_loop_delay_timeo( fnet_uint32_t cookie )
 {
-    FNET_COMP_UNUSED_ARG(dest_ip_addr);
-    FNET_COMP_UNUSED_ARG(src_ip_addr);
+    FNET_COMP_UNUSED_ARG(cookie);
     
+    fnet_loop_delay_input(FNET_FALSE);
+}
+
+/************************************************************************
+* NAME: fnet_loop_delay_input
+*
+* DESCRIPTION: This function passes the delayed packets to the IP layer, 
+*              if their delay is expired (or all packets if "all" is set).
+*              The packets are passed one by one outside of the lock, 
+*              so every packet is processed before the next one is 
+*              queued to the IP layer.
+*************************************************************************/
+static void fnet_loop_delay_input( fnet_bool_t all )
+{
+    fnet_loop_delayed_t delayed;
+    fnet_bool_t         is_due;
+
+    do
+    {
+        fnet_isr_lock();
+
+        is_due = ((fnet_loop_delay_count > 0u)
+                  && ((all == FNET_TRUE) || ((fnet_time_t)(fnet_timer_ms() - fnet_loop_delay_queue[fnet_loop_delay_head].time) >= fnet_loop_delay)));
+        if(is_due)
+        {
+            delayed = fnet_loop_delay_queue[fnet_loop_delay_head];
+
+            fnet_loop_delay_head = (fnet_loop_delay_head + 1u) % FNET_CFG_LOOPBACK_DELAY_QUEUE;
+            fnet_loop_delay_count--;
+        }
+
+        fnet_isr_unlock();
+
+        if(is_due)
+        {
+            fnet_loop_input(&fnet_loop_if, delayed.nb, delayed.is_ip6);
+        }
+    }
+    while(is_due);
+}
+#endif /* FNET_CFG_LOOPBACK_DELAY_QUEUE */
+
+/************************************************************************
+* NAME: fnet_loop_input
+*
+* DESCRIPTION: This function passes the packet to the IP layer.
+*************************************************************************/
+static void fnet_loop_input( fnet_netif_t *netif, fnet_netbuf_t *nb, fnet_bool_t is_ip6 )
+{
+#if FNET_CFG_IP6
+    if(is_ip6 == FNET_TRUE)
+    {
+        fnet_ip6_input(netif, nb);
+    }
+    else
+#else
+    FNET_COMP_UNUSED_ARG(is_ip6);
+#endif
+    {
+#if FNET_CFG_IP4
+        fnet_ip_input(netif, nb);
+#endif
+    }
+}
+
+/************************************************************************
+* NAME: fnet_loop_send
+*
+* DESCRIPTION: This function passes the outgoing packet to the IP layer,
+*              dropping or delaying it if it is requested.
+*************************************************************************/
+static void fnet_loop_send( fnet_netif_t *netif, fnet_netbuf_t *nb, fnet_bool_t is_ip6 )
+{
     fnet_isr_lock();
- 
+    
     /* MTU check */
-    if (nb->total_length <= netif->mtu)
+    if ((nb->total_length <= netif->mtu) && (fnet_loop_drop() == FNET_FALSE))
     {
-        fnet_ip6_input(netif, nb);
+    #if FNET_CFG_LOOPBACK_DELAY_QUEUE
+        if(fnet_loop_delay)
+        {
+            if(fnet_loop_delay_count < FNET_CFG_LOOPBACK_DELAY_QUEUE)
+            {
+                fnet_loop_delayed_t *delayed = &fnet_loop_delay_queue[(fnet_loop_delay_head + fnet_loop_delay_count) % FNET_CFG_LOOPBACK_DELAY_QUEUE];
+
+                delayed->nb = nb;
+                delayed->time = fnet_timer_ms();
+                delayed->is_ip6 = is_ip6;
+                fnet_loop_delay_count++;
+            }
+            else
+            {
+                /* The queue is overflowed.*/
+                fnet_netbuf_free_chain(nb);
+            }
+        }
+        else
+    #endif
+        {
+            fnet_loop_input(netif, nb, is_ip6);
+        }
     }
     else
     {
@@ -141,6 +305,34 @@ void fnet_loop_output_ip6(struct fnet_netif *netif, const fnet_ip6_addr_t *src_i
         
     fnet_isr_unlock();
 }
+
+/************************************************************************
+* NAME: fnet_loop_output_ip4
+*
+* DESCRIPTION: This function just only sends outgoing packets to IP layer.
+*************************************************************************/
+#if FNET_CFG_IP4
+void fnet_loop_output_ip4(fnet_netif_t *netif, fnet_ip4_addr_t dest_ip_addr, fnet_netbuf_t* nb)
+{
+    FNET_COMP_UNUSED_ARG(dest_ip_addr);
+
+    fnet_loop_send(netif, nb, FNET_FALSE);
+}
+#endif /* FNET_CFG_IP4 */
+
+/************************************************************************
+* NAME: fnet_loop_output_ip6
+*
+* DESCRIPTION: This function just only sends outgoing packets to IPv6 layer.
+*************************************************************************/
+#if FNET_CFG_IP6
+void fnet_loop_output_ip6(struct fnet_netif *netif, const fnet_ip6_addr_t *src_ip_addr, const fnet_ip6_addr_t *dest_ip_addr, fnet_netbuf_t* nb)
+{
+    FNET_COMP_UNUSED_ARG(dest_ip_addr);
+    FNET_COMP_UNUSED_ARG(src_ip_addr);
+
+    fnet_loop_send(netif, nb, FNET_TRUE);
+}
 #endif /* FNET_CFG_IP6 */
 
 #endif /* FNET_CFG_LOOPBACK */
@@ -56,6 +56,10 @@ extern "C" {
 
 void fnet_loop_output_ip4(fnet_netif_t *netif, fnet_ip4_addr_t dest_ip_addr, fnet_netbuf_t *nb);
 void fnet_loop_output_ip6(struct fnet_netif *netif, const fnet_ip6_addr_t *src_ip_addr,  const fnet_ip6_addr_t *dest_ip_addr, fnet_netbuf_t* nb);
+void fnet_loop_set_loss(fnet_index_t percent);
+#if FNET_CFG_LOOPBACK_DELAY_QUEUE
+void fnet_loop_set_delay(fnet_time_t delay_ms);
+#endif
 
 #if defined(__cplusplus)
 }
@@ -34,12 +34,44 @@
 
 #define FNET_DEBUG_MEMPOOL_CHECK        (0)
 
+#if FNET_CFG_HEAP_SLAB
+
+/* Free slab block. The link is stored in the block itself.*/
+typedef struct fnet_mempool_slab_block
+{
+    struct fnet_mempool_slab_block  *next;  /* Pointer to the next free block. */
+}
+fnet_mempool_slab_block_t;
+
+/* Slab size class. */
+struct fnet_mempool_slab
+{
+    fnet_mempool_slab_block_t   *free_ptr;      /* List of free blocks. */
+    fnet_uint8_t                *start;         /* Start address of the slab region. */
+    fnet_uint8_t                *end;           /* End address of the slab region. */
+    fnet_size_t                 size;           /* Block size (aligned). */
+    fnet_size_t                 free_number;    /* Number of free blocks. */
+};
+
+#endif /* FNET_CFG_HEAP_SLAB */
+
 struct fnet_mempool
 {
     fnet_mempool_unit_header_t *    free_ptr;
     fnet_size_t                     unit_size;
+#if FNET_CFG_HEAP_SLAB
+    struct fnet_mempool_slab        slab[FNET_MEMPOOL_SLAB_CLASS_MAX]; /* Sorted by block size. */
+    fnet_index_t                    slab_number;
+#endif
 };
 
+static void fnet_mempool_arena_free( fnet_mempool_desc_t mpool, void *ap );
+static void *fnet_mempool_arena_malloc( fnet_mempool_desc_t mpool, fnet_size_t nbytes );
+#if FNET_CFG_HEAP_SLAB
+static void *fnet_mempool_slab_malloc( struct fnet_mempool *mempool, fnet_size_t nbytes );
+static fnet_bool_t fnet_mempool_slab_free( struct fnet_mempool *mempool, void *ap );
+#endif
+
 #if FNET_DEBUG_MEMPOOL_CHECK
     #define DEBUG_ALLOCATED_ADDR_MAX    200
 
@@ -77,6 +109,9 @@ fnet_mempool_desc_t fnet_mempool_init( void *pool_ptr, fnet_size_t pool_size, fn
         mempool = (struct fnet_mempool *) pool_ptr;
         
         mempool->unit_size = (fnet_size_t)alignment+1u;
+#if FNET_CFG_HEAP_SLAB
+        mempool->slab_number = 0u;
+#endif
         
         
         p = (fnet_mempool_unit_header_t *)heap_ptr;
@@ -98,15 +133,56 @@ void fnet_mempool_release( fnet_mempool_desc_t mpool )
 {
     struct fnet_mempool * mempool = (struct fnet_mempool *)mpool;
     mempool->free_ptr = 0;
+#if FNET_CFG_HEAP_SLAB
+    mempool->slab_number = 0u;
+#endif
 }
 
 /************************************************************************
-* NAME: fnet_free
+* NAME: fnet_mempool_free
 *
 * DESCRIPTION: Frees memory in the mempool.
 *              
 *************************************************************************/
 void fnet_mempool_free( fnet_mempool_desc_t mpool, void *ap )
+{
+#if FNET_CFG_HEAP_SLAB
+    if(fnet_mempool_slab_free((struct fnet_mempool *)mpool, ap) == FNET_FALSE)
+#endif
+    {
+        fnet_mempool_arena_free(mpool, ap);
+    }
+}
+
+/************************************************************************
+* NAME: fnet_mempool_malloc
+*
+* DESCRIPTION: Allocates memory in the memory pool.
+*              
+*************************************************************************/
+void *fnet_mempool_malloc( fnet_mempool_desc_t mpool, fnet_size_t nbytes )
+{
+    void    *res;
+
+#if FNET_CFG_HEAP_SLAB
+    /* Try a fixed-size block first, O(1). */
+    res = fnet_mempool_slab_malloc((struct fnet_mempool *)mpool, nbytes);
+    if(res == 0)
+#endif
+    {
+        res = fnet_mempool_arena_malloc(mpool, nbytes);
+    }
+
+    return res;
+}
+
+/************************************************************************
+* NAME: fnet_mempool_arena_free
+*
+* DESCRIPTION: Frees memory in the mempool arena.
+*              
+*************************************************************************/
+static void fnet_mempool_arena_free( fnet_mempool_desc_t mpool, void *ap )
 {
     struct fnet_mempool * mempool = (struct fnet_mempool *)mpool;
     
@@ -196,13 +272,13 @@ void fnet_mempool_free( fnet_mempool_desc_t mpool, void *ap )
 }
 
 /************************************************************************
-* NAME: fnet_mempool_malloc
+* NAME: fnet_mempool_arena_malloc
 *
-* DESCRIPTION: Allocates memory in the memory pool.
+* DESCRIPTION: Allocates memory in the memory pool arena.
 *              
 *************************************************************************/
 #if FNET_MEMPOOL_MALLOC_BEST_CHOICE /* Choose the best. */
-void *fnet_mempool_malloc(fnet_mempool_desc_t mpool, fnet_size_t nbytes )
+static void *fnet_mempool_arena_malloc( fnet_mempool_desc_t mpool, fnet_size_t nbytes )
 {
     struct fnet_mempool         *mempool = (struct fnet_mempool *)mpool;
     fnet_mempool_unit_header_t  *p, *prevp;
@@ -292,7 +368,7 @@ void *fnet_mempool_malloc(fnet_mempool_desc_t mpool, fnet_size_t nbytes )
 
 #else /* Choose the first. */
 
-void *fnet_mempool_malloc(fnet_mempool_desc_t mpool, fnet_size_t nbytes )
+static void *fnet_mempool_arena_malloc( fnet_mempool_desc_t mpool, fnet_size_t nbytes )
 {
     struct fnet_mempool         *mempool = (struct fnet_mempool *)mpool;
     fnet_mempool_unit_header_t  *p, *prevp;
@@ -372,16 +448,33 @@ fnet_size_t fnet_mempool_free_mem_status( fnet_mempool_desc_t mpool)
         }
     }
 
+#if FNET_CFG_HEAP_SLAB
+    {
+        fnet_index_t i;
+
+        total_size *= mempool->unit_size;
+
+        for(i = 0u; i < mempool->slab_number; i++)
+        {
+            total_size += mempool->slab[i].free_number * mempool->slab[i].size;
+        }
+    }
+
+    fnet_isr_unlock();
+
+    return total_size;
+#else
     fnet_isr_unlock();
 
     return (total_size * mempool->unit_size);
+#endif
 }
 
 /************************************************************************
 * NAME: fnet_malloc_max
 *
 * DESCRIPTION: Returns a maximum size of posible allocated memory chunk.
-*              
+*              Slab blocks are not counted, as they serve fixed sizes only.
 *************************************************************************/
 fnet_size_t fnet_mempool_malloc_max( fnet_mempool_desc_t mpool )
 {
@@ -423,6 +516,164 @@ fnet_size_t fnet_mempool_malloc_max( fnet_mempool_desc_t mpool )
     return (max * mempool->unit_size);
 }
 
+#if FNET_CFG_HEAP_SLAB
+/************************************************************************
+* NAME: fnet_mempool_slab_init
+*
+* DESCRIPTION: Carves fixed-size block classes from the mempool arena.
+*              Allocations that fit a class are served in O(1), 
+*              the rest falls back to the arena.
+*************************************************************************/
+fnet_return_t fnet_mempool_slab_init( fnet_mempool_desc_t mpool, const fnet_mempool_slab_class_t *classes, fnet_index_t class_number )
+{
+    struct fnet_mempool         *mempool = (struct fnet_mempool *)mpool;
+    struct fnet_mempool_slab    *slab;
+    struct fnet_mempool_slab    slab_tmp;
+    fnet_mempool_slab_block_t   *block;
+    fnet_index_t                i;
+    fnet_index_t                j;
+    fnet_size_t                 k;
+    fnet_return_t               result = FNET_OK;
+
+    if((mempool == 0) || (classes == 0) || (class_number > FNET_MEMPOOL_SLAB_CLASS_MAX) || (mempool->slab_number != 0u))
+    {
+        result = FNET_ERR;
+    }
+    else
+    {
+        for(i = 0u; i < class_number; i++)
+        {
+            if((classes[i].size == 0u) || (classes[i].number == 0u))
+            {
+                continue; /* Skip empty class. */
+            }
+
+            slab = &mempool->slab[mempool->slab_number];
+
+            /* Round the block size up to the allocation unit.*/
+            slab->size = ((classes[i].size + mempool->unit_size - 1u) / mempool->unit_size) * mempool->unit_size;
+            slab->start = (fnet_uint8_t *)fnet_mempool_arena_malloc(mpool, slab->size * classes[i].number);
+
+            if(slab->start == 0)
+            {
+                /* Not enough memory, return already carved regions back to the arena.*/
+                while(mempool->slab_number)
+                {
+                    mempool->slab_number--;
+                    fnet_mempool_arena_free(mpool, mempool->slab[mempool->slab_number].start);
+                }
+                result = FNET_ERR;
+                break;
+            }
+
+            slab->end = slab->start + (slab->size * classes[i].number);
+            slab->free_number = classes[i].number;
+
+            /* Build the free list.*/
+            slab->free_ptr = 0;
+            for(k = classes[i].number; k > 0u; k--)
+            {
+                block = (fnet_mempool_slab_block_t *)(slab->start + ((k - 1u) * slab->size));
+                block->next = slab->free_ptr;
+                slab->free_ptr = block;
+            }
+
+            /* Keep classes sorted by block size (insertion sort).*/
+            for(j = mempool->slab_number; (j > 0u) && (mempool->slab[j - 1u].size > mempool->slab[j].size); j--)
+            {
+                slab_tmp = mempool->slab[j - 1u];
+                mempool->slab[j - 1u] = mempool->slab[j];
+                mempool->slab[j] = slab_tmp;
+            }
+
+            mempool->slab_number++;
+        }
+    }
+
+    return result;
+}
+
+/************************************************************************
+* NAME: fnet_mempool_slab_malloc
+*
+* DESCRIPTION: Allocates a block from the smallest fitting slab class.
+*              If the class is exhausted, the next larger class is tried.
+*              Returns 0 if all fitting classes are exhausted, 
+*              or the request wastes more than half of a block.
+*************************************************************************/
+static void *fnet_mempool_slab_malloc( struct fnet_mempool *mempool, fnet_size_t nbytes )
+{
+    struct fnet_mempool_slab    *slab;
+    fnet_index_t                i;
+    void                        *res = 0;
+
+    fnet_isr_lock();
+
+    for(i = 0u; i < mempool->slab_number; i++)
+    {
+        slab = &mempool->slab[i];
+
+        if(nbytes <= slab->size)
+        {
+            /* Small requests go to the arena, not to waste more than half of a block.*/
+            if(nbytes <= (slab->size / 2u))
+            {
+                break;
+            }
+            
+            if(slab->free_ptr)
+            {
+                res = slab->free_ptr;
+                slab->free_ptr = slab->free_ptr->next;
+                slab->free_number--;
+                break;
+            }
+            /* The class is exhausted, try the next larger one.*/
+        }
+    }
+
+    fnet_isr_unlock();
+
+    return res;
+}
+
+/************************************************************************
+* NAME: fnet_mempool_slab_free
+*
+* DESCRIPTION: Returns a block to its slab class. 
+*              Returns FNET_FALSE if the block does not belong to a slab.
+*************************************************************************/
+static fnet_bool_t fnet_mempool_slab_free( struct fnet_mempool *mempool, void *ap )
+{
+    struct fnet_mempool_slab    *slab;
+    fnet_mempool_slab_block_t   *block;
+    fnet_index_t                i;
+    fnet_bool_t                 result = FNET_FALSE;
+
+    fnet_isr_lock();
+
+    for(i = 0u; i < mempool->slab_number; i++)
+    {
+        slab = &mempool->slab[i];
+
+        if(((fnet_uint8_t *)ap >= slab->start) && ((fnet_uint8_t *)ap < slab->end))
+        {
+            block = (fnet_mempool_slab_block_t *)ap;
+            block->next = slab->free_ptr;
+            slab->free_ptr = block;
+            slab->free_number++;
+            result = FNET_TRUE;
+            break;
+        }
+    }
+
+    fnet_isr_unlock();
+
+    return result;
+}
+
+#endif /* FNET_CFG_HEAP_SLAB */
+
 #if 0 /* For Debug needs.*/
 fnet_return_t fnet_mempool_check( fnet_mempool_desc_t mpool )
 {
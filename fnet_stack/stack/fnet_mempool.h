@@ -61,6 +61,26 @@ typedef enum
 }
 fnet_mempool_align_t;
 
+#if FNET_CFG_HEAP_SLAB
+
+/* Maximum number of slab size classes per memory pool.*/
+#define FNET_MEMPOOL_SLAB_CLASS_MAX     (4u)
+
+/**************************************************************************/ /*!
+ * @internal
+ * @brief Slab size class. It is a pre-allocated set of fixed-size blocks,
+ *        carved from the memory pool arena.
+ * @see fnet_mempool_slab_init()
+ ******************************************************************************/
+typedef struct
+{
+    fnet_size_t     size;       /* Block size of the class. */
+    fnet_size_t     number;     /* Number of blocks of the class. */
+}
+fnet_mempool_slab_class_t;
+
+#endif /* FNET_CFG_HEAP_SLAB */
+
 #if defined(__cplusplus)
 extern "C" {
 #endif
@@ -71,6 +91,9 @@ void fnet_mempool_free( fnet_mempool_desc_t mpool, void *ap );
 void *fnet_mempool_malloc(fnet_mempool_desc_t mpool, fnet_size_t nbytes );
 fnet_size_t fnet_mempool_free_mem_status( fnet_mempool_desc_t mpool);
 fnet_size_t fnet_mempool_malloc_max( fnet_mempool_desc_t mpool );
+#if FNET_CFG_HEAP_SLAB
+fnet_return_t fnet_mempool_slab_init( fnet_mempool_desc_t mpool, const fnet_mempool_slab_class_t *classes, fnet_index_t class_number );
+#endif
 
 #if 0 /* For Debug needs.*/
 fnet_return_t fnet_mempool_check( fnet_mempool_desc_t mpool );
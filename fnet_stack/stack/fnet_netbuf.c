@@ -32,6 +32,7 @@
 #include "fnet.h"
 #include "fnet_prot.h"
 #include "fnet_mempool.h"
+#include "fnet_checksum.h"
 
 
 #define FNET_HEAP_SPLIT     (0) /* If 1 the main heap will be splitted to two parts. 
@@ -48,6 +49,37 @@ static fnet_mempool_desc_t fnet_mempool_main = 0; /* Main memory pool. */
 
 fnet_netbuf_t *dm_nb;
 
+#if FNET_CFG_CHECKSUM_COPY
+static void fnet_netbuf_copy_checksum( fnet_netbuf_t *dst_nb, const fnet_netbuf_t *src_nb, fnet_size_t offset );
+#endif
+
+#if FNET_CFG_HEAP_SLAB
+/* Heap slab classes, for the most frequent allocations. 
+ * Net_bufs and data buffers are allocated from the netbuf memory pool.*/
+static const fnet_mempool_slab_class_t fnet_heap_slab_classes[] =
+{
+    {sizeof(fnet_netbuf_t), FNET_CFG_HEAP_SLAB_NETBUF_NUM},
+#if !FNET_HEAP_SPLIT
+    {sizeof(fnet_socket_if_t), FNET_CFG_HEAP_SLAB_SOCKET_NUM},
+#if FNET_CFG_TCP
+    {sizeof(fnet_tcp_control_t), FNET_CFG_HEAP_SLAB_SOCKET_NUM},
+#endif
+#endif
+    {FNET_CFG_HEAP_SLAB_DATA_SIZE, FNET_CFG_HEAP_SLAB_DATA_NUM}
+};
+
+#if FNET_HEAP_SPLIT
+/* Sockets and TCP control blocks are allocated from the main memory pool.*/
+static const fnet_mempool_slab_class_t fnet_heap_slab_classes_main[] =
+{
+    {sizeof(fnet_socket_if_t), FNET_CFG_HEAP_SLAB_SOCKET_NUM},
+#if FNET_CFG_TCP
+    {sizeof(fnet_tcp_control_t), FNET_CFG_HEAP_SLAB_SOCKET_NUM},
+#endif
+};
+#endif
+#endif
+
 /************************************************************************
 * NAME: fnet_netbuf_new
 *
@@ -55,6 +87,19 @@ fnet_netbuf_t *dm_nb;
 *              for a new data buffer. 
 *************************************************************************/
 fnet_netbuf_t *fnet_netbuf_new( fnet_size_t len, fnet_bool_t drain )
+{
+    return fnet_netbuf_new_headroom(len, 0u, drain);
+}
+
+/************************************************************************
+* NAME: fnet_netbuf_new_headroom
+*
+* DESCRIPTION: Creates a new net_buf and allocates memory
+*              for a new data buffer, reserving "headroom" bytes 
+*              in front of the data for headers prepended later 
+*              by fnet_netbuf_push().
+*************************************************************************/
+fnet_netbuf_t *fnet_netbuf_new_headroom( fnet_size_t len, fnet_size_t headroom, fnet_bool_t drain )
 {
     fnet_netbuf_t   *nb;
     void            *nb_d;
@@ -72,12 +117,15 @@ fnet_netbuf_t *fnet_netbuf_new( fnet_size_t len, fnet_bool_t drain )
         return (fnet_netbuf_t *)0;
     }
 
-    nb_d = fnet_malloc_netbuf(len + sizeof(fnet_uint32_t)/* For reference_counter */);
+    /* Keep the payload 32-bit aligned.*/
+    headroom = (headroom + 3u) & ~3u;
+
+    nb_d = fnet_malloc_netbuf(headroom + len + sizeof(fnet_uint32_t)/* For reference_counter */);
 
     if((nb_d == 0) && drain )
     {
         fnet_prot_drain();
-        nb_d = fnet_malloc_netbuf(len + sizeof(fnet_uint32_t)/* For reference_counter */);
+        nb_d = fnet_malloc_netbuf(headroom + len + sizeof(fnet_uint32_t)/* For reference_counter */);
     }
 
     if(nb_d == 0) /* If FNET_NETBUF_MALLOC_NOWAIT and no free memory for data.*/
@@ -93,14 +141,62 @@ fnet_netbuf_t *fnet_netbuf_new( fnet_size_t len, fnet_bool_t drain )
     
     ((fnet_uint32_t *)nb_d)[0] = 1u; /* First element is used by the reference_counter.*/
     nb->data = &((fnet_uint32_t *)nb_d)[0];
-    nb->data_ptr = &((fnet_uint32_t *)nb_d)[1];
+    nb->data_ptr = (fnet_uint8_t *)&((fnet_uint32_t *)nb_d)[1] + headroom;
     nb->length = len;
     nb->total_length = len;
     nb->flags = 0u;
+#if FNET_CFG_CHECKSUM_COPY
+    nb->checksum_length = 0u;
+#endif
 
     return (nb);
 }
 
+/************************************************************************
+* NAME: fnet_netbuf_push
+*
+* DESCRIPTION: Prepends "len" bytes in front of the data of the chain.
+*              If the first net_buf owns its data buffer and has enough 
+*              headroom, the space is taken in place. Otherwise a new 
+*              net_buf is allocated and concatenated in front of the chain.
+*              Returns the new chain head, or 0 if no free memory.
+*              In the latter case the original chain is left intact.
+*************************************************************************/
+fnet_netbuf_t *fnet_netbuf_push( fnet_netbuf_t *nb, fnet_size_t len, fnet_bool_t drain )
+{
+    fnet_netbuf_t   *nb_header;
+    fnet_size_t     headroom;
+
+    headroom = (fnet_size_t)((fnet_uint8_t *)nb->data_ptr - (fnet_uint8_t *)&((fnet_uint32_t *)nb->data)[1]);
+
+    if((((fnet_uint32_t *)nb->data)[0] == 1u) && (headroom >= len))
+    {
+#if FNET_CFG_CHECKSUM_COPY
+        /* The cached sum is not valid any more, if its data were trimmed 
+         * from the front and are going to be overwritten now.*/
+        if(nb->checksum_length > nb->length)
+        {
+            nb->checksum_length = 0u;
+        }
+#endif
+        nb->data_ptr = (fnet_uint8_t *)nb->data_ptr - len;
+        nb->length += len;
+        nb->total_length += len;
+        nb_header = nb;
+    }
+    else
+    {
+        nb_header = fnet_netbuf_new_headroom(len, FNET_CFG_NETBUF_HEADROOM, drain);
+        
+        if(nb_header)
+        {
+            nb_header = fnet_netbuf_concat(nb_header, nb);
+        }
+    }
+
+    return (nb_header);
+}
+
 /************************************************************************
 * NAME: fnet_netbuf_copy
 *
@@ -185,6 +281,14 @@ fnet_netbuf_t *fnet_netbuf_copy( fnet_netbuf_t *nb, fnet_size_t offset, fnet_siz
     else
     {
         loc_nb->length = tmp_nb->length - tot_offset;
+    }
+
+#if FNET_CFG_CHECKSUM_COPY
+    fnet_netbuf_copy_checksum(loc_nb, tmp_nb, tot_offset);
+#endif
+
+    if(tot_len > 0)
+    {
 
         do
         {
@@ -232,6 +336,9 @@ fnet_netbuf_t *fnet_netbuf_copy( fnet_netbuf_t *nb, fnet_size_t offset, fnet_siz
             {
                 loc_nb->length = tmp_nb->length;
             }
+#if FNET_CFG_CHECKSUM_COPY
+            fnet_netbuf_copy_checksum(loc_nb, tmp_nb, 0u);
+#endif
         } 
         while (tot_len > 0);
     }
@@ -241,6 +348,29 @@ fnet_netbuf_t *fnet_netbuf_copy( fnet_netbuf_t *nb, fnet_size_t offset, fnet_siz
     return (loc_nb_head);
 }
 
+#if FNET_CFG_CHECKSUM_COPY
+/************************************************************************
+* NAME: fnet_netbuf_copy_checksum
+*
+* DESCRIPTION: Passes the cached partial sum of "src_nb" to "dst_nb", 
+*              which refers to its data starting from "offset".
+*              The sum is valid only if both end at the same byte 
+*              and "dst_nb" covers all summed data.
+*************************************************************************/
+static void fnet_netbuf_copy_checksum( fnet_netbuf_t *dst_nb, const fnet_netbuf_t *src_nb, fnet_size_t offset )
+{
+    if(((offset + dst_nb->length) == src_nb->length) && (src_nb->checksum_length <= dst_nb->length))
+    {
+        dst_nb->checksum = src_nb->checksum;
+        dst_nb->checksum_length = src_nb->checksum_length;
+    }
+    else
+    {
+        dst_nb->checksum_length = 0u;
+    }
+}
+#endif /* FNET_CFG_CHECKSUM_COPY */
+
 /************************************************************************
 * NAME: fnet_netbuf_from_buf
 *
@@ -248,10 +378,21 @@ fnet_netbuf_t *fnet_netbuf_copy( fnet_netbuf_t *nb, fnet_size_t offset, fnet_siz
 *              the external data buffer. 
 *************************************************************************/
 fnet_netbuf_t *fnet_netbuf_from_buf( void *data_ptr, fnet_size_t len, fnet_bool_t drain )
+{
+    return fnet_netbuf_from_buf_headroom(data_ptr, len, 0u, drain);
+}
+
+/************************************************************************
+* NAME: fnet_netbuf_from_buf_headroom
+*
+* DESCRIPTION: Creates a new net_buf with reserved headroom and fills it 
+*              by a content of the external data buffer. 
+*************************************************************************/
+fnet_netbuf_t *fnet_netbuf_from_buf_headroom( void *data_ptr, fnet_size_t len, fnet_size_t headroom, fnet_bool_t drain )
 {
     fnet_netbuf_t *nb;
     
-    nb = fnet_netbuf_new(len, drain);
+    nb = fnet_netbuf_new_headroom(len, headroom, drain);
 
     if(nb)
     {
@@ -261,6 +402,73 @@ fnet_netbuf_t *fnet_netbuf_from_buf( void *data_ptr, fnet_size_t len, fnet_bool_
     return (nb);
 }
 
+#if FNET_CFG_CHECKSUM_COPY
+/************************************************************************
+* NAME: fnet_netbuf_from_buf_checksum
+*
+* DESCRIPTION: Creates a new net_buf with reserved headroom and fills it 
+*              by a content of the external data buffer. 
+*              The partial Internet checksum is calculated during 
+*              the copying and cached in the net_buf.
+*************************************************************************/
+fnet_netbuf_t *fnet_netbuf_from_buf_checksum( void *data_ptr, fnet_size_t len, fnet_size_t headroom, fnet_bool_t drain )
+{
+    fnet_netbuf_t *nb;
+    
+    nb = fnet_netbuf_new_headroom(len, headroom, drain);
+
+    if(nb)
+    {
+        nb->checksum = fnet_checksum_copy(nb->data_ptr, data_ptr, len);
+        nb->checksum_length = (fnet_uint16_t)len;
+    }
+
+    return (nb);
+}
+#endif /* FNET_CFG_CHECKSUM_COPY */
+
+/************************************************************************
+* NAME: fnet_netbuf_from_data
+*
+* DESCRIPTION: Creates a new net_buf for the existing data buffer 
+*              "data", allocated by fnet_malloc_netbuf(). 
+*              Its first word is used by the reference_counter, 
+*              "data_ptr" points to the "len" bytes of actual data 
+*              inside the buffer. 
+*              The net_buf takes over the data buffer, it is released 
+*              to the netbuf heap together with the net_buf.
+*************************************************************************/
+fnet_netbuf_t *fnet_netbuf_from_data( void *data, void *data_ptr, fnet_size_t len, fnet_bool_t drain )
+{
+    fnet_netbuf_t *nb;
+
+    nb = (fnet_netbuf_t *)fnet_malloc_netbuf(sizeof(fnet_netbuf_t));
+
+    if((nb == 0) && drain)
+    {
+        fnet_prot_drain();
+        nb = (fnet_netbuf_t *)fnet_malloc_netbuf(sizeof(fnet_netbuf_t));
+    }
+
+    if(nb)
+    {
+        nb->next = (fnet_netbuf_t *)0;
+        nb->next_chain = (fnet_netbuf_t *)0;
+        
+        ((fnet_uint32_t *)data)[0] = 1u; /* First element is used by the reference_counter.*/
+        nb->data = data;
+        nb->data_ptr = data_ptr;
+        nb->length = len;
+        nb->total_length = len;
+        nb->flags = 0u;
+#if FNET_CFG_CHECKSUM_COPY
+        nb->checksum_length = 0u;
+#endif
+    }
+
+    return (nb);
+}
+
 /************************************************************************
 * NAME: fnet_netbuf_to_buf
 *
@@ -503,6 +711,9 @@ fnet_return_t fnet_netbuf_pullup( fnet_netbuf_t **nb_ptr, fnet_size_t len)
     nb->next = nb_run;
 
     nb->length = (fnet_size_t)len;
+#if FNET_CFG_CHECKSUM_COPY
+    nb->checksum_length = 0u;
+#endif
 
     *nb_ptr = nb;
 
@@ -510,6 +721,50 @@ fnet_return_t fnet_netbuf_pullup( fnet_netbuf_t **nb_ptr, fnet_size_t len)
 }
 
 
+/************************************************************************
+* NAME: fnet_netbuf_cow
+*
+* DESCRIPTION: Makes the first len bytes of the chain contiguous and 
+*              writable (copy-on-write). If the data buffer of the first 
+*              net_buf is shared with other net_bufs, it is duplicated. 
+*************************************************************************/
+fnet_return_t fnet_netbuf_cow( fnet_netbuf_t **nb_ptr, fnet_size_t len )
+{
+    fnet_netbuf_t   *nb = *nb_ptr;
+    void            *new_buf;
+    fnet_return_t   result = FNET_OK;
+
+    if(nb->length < len)
+    {
+        /* Pull-up always creates a new (not shared) data buffer.*/
+        result = fnet_netbuf_pullup(nb_ptr, len);
+    }
+    else if(((fnet_uint32_t *)nb->data)[0] > 1u) /* Shared data buffer.*/
+    {
+        new_buf = fnet_malloc_netbuf(nb->length + sizeof(fnet_uint32_t)/* For reference_counter */);
+
+        if(new_buf == 0)
+        {
+            result = FNET_ERR;
+        }
+        else
+        {
+            ((fnet_uint32_t *)new_buf)[0] = 1u; /* First element is used by the reference_counter.*/
+            fnet_memcpy(&((fnet_uint32_t *)new_buf)[1], nb->data_ptr, nb->length);
+
+            /* Release the shared data buffer.*/
+            ((fnet_uint32_t *)nb->data)[0] = ((fnet_uint32_t *)nb->data)[0] - 1u;
+
+            nb->data = &((fnet_uint32_t *)new_buf)[0];
+            nb->data_ptr = &((fnet_uint32_t *)new_buf)[1];
+        }
+    }
+    else
+    {}
+
+    return result;
+}
+
 /************************************************************************
 * NAME: fnet_netbuf_trim
 *
@@ -581,6 +836,9 @@ void fnet_netbuf_trim( fnet_netbuf_t **nb_ptr, fnet_int32_t len )
         if(nb != 0)
         {
             nb->length += ((fnet_size_t)len + total_rem - tot_len);
+#if FNET_CFG_CHECKSUM_COPY
+            nb->checksum_length = 0u;
+#endif
 
             while(nb->next != 0) /* Cut the redundant net_bufs. */
             {
@@ -673,10 +931,13 @@ fnet_netbuf_t *fnet_netbuf_cut_center( fnet_netbuf_t ** nb_ptr, fnet_size_t offs
                         (fnet_uint8_t *)nb->data_ptr + nb->length - tot_len + offset + len,
                         (fnet_size_t)(tot_len - offset - len));
             nb->length -= len;
+#if FNET_CFG_CHECKSUM_COPY
+            nb->checksum_length = 0u;
+#endif
         }
-        else
+        else /* Shared data buffer. Split the net_buf, the tail shares the same data buffer.*/
         {
-            head_nb = fnet_netbuf_new(tot_len - offset - len, FNET_FALSE);
+            head_nb = (fnet_netbuf_t *)fnet_malloc_netbuf(sizeof(fnet_netbuf_t));
 
             if(head_nb == 0) /* If no free memory.*/
             {
@@ -685,15 +946,26 @@ fnet_netbuf_t *fnet_netbuf_cut_center( fnet_netbuf_t ** nb_ptr, fnet_size_t offs
                 return (0);
             }
 
-            fnet_memcpy(head_nb->data_ptr,
-                        (fnet_uint8_t *)nb->data_ptr + nb->length - tot_len + offset + len,
-                        (fnet_size_t)(tot_len - offset - len));
+            head_nb->next_chain = (fnet_netbuf_t *)0;
+            head_nb->data = nb->data;
+            head_nb->data_ptr = (fnet_uint8_t *)nb->data_ptr + nb->length - tot_len + offset + len;
+            head_nb->length = (fnet_size_t)(tot_len - offset - len);
+            head_nb->total_length = head_nb->length;
+            head_nb->flags = nb->flags;
+#if FNET_CFG_CHECKSUM_COPY
+            fnet_netbuf_copy_checksum(head_nb, nb, (fnet_size_t)(nb->length - tot_len + offset + len));
+#endif
+
+            ((fnet_uint32_t *)nb->data)[0] = ((fnet_uint32_t *)nb->data)[0] + 1u; /* Increment the the reference_counter.*/
 
             head_nb->next = nb->next;
 
             nb->next = head_nb;
 
             nb->length -= tot_len - offset;
+#if FNET_CFG_CHECKSUM_COPY
+            nb->checksum_length = 0u;
+#endif
         }
 
         return ((fnet_netbuf_t *) *nb_ptr);
@@ -702,6 +974,9 @@ fnet_netbuf_t *fnet_netbuf_cut_center( fnet_netbuf_t ** nb_ptr, fnet_size_t offs
     if(tot_len - offset == len) /* If we cut from the middle of buffer to the end only.*/
     {
         nb->length -= len;
+#if FNET_CFG_CHECKSUM_COPY
+        nb->checksum_length = 0u;
+#endif
 
         head_nb->total_length -= len;
 
@@ -710,6 +985,9 @@ fnet_netbuf_t *fnet_netbuf_cut_center( fnet_netbuf_t ** nb_ptr, fnet_size_t offs
     else                                /* Cut from the middle of net_buf to the end and trim remaining info*/
     {                                   /* (tot_len-offset < len)*/
         nb->length -= tot_len - offset;
+#if FNET_CFG_CHECKSUM_COPY
+        nb->checksum_length = 0u;
+#endif
 
         nb->next->total_length = head_nb->total_length; /* For correct fnet_netbuf_trim execution. */
         fnet_netbuf_trim(&nb->next, (fnet_int32_t)(len - (tot_len - offset)));
@@ -844,6 +1122,16 @@ fnet_return_t fnet_heap_init( void *heap_ptr, fnet_size_t heap_size )
 #endif
     {
         result = FNET_OK;
+
+    #if FNET_CFG_HEAP_SLAB
+        result = fnet_mempool_slab_init(fnet_mempool_netbuf, fnet_heap_slab_classes, sizeof(fnet_heap_slab_classes)/sizeof(fnet_heap_slab_classes[0]));
+        #if FNET_HEAP_SPLIT
+        if(result == FNET_OK)
+        {
+            result = fnet_mempool_slab_init(fnet_mempool_main, fnet_heap_slab_classes_main, sizeof(fnet_heap_slab_classes_main)/sizeof(fnet_heap_slab_classes_main[0]));
+        }
+        #endif
+    #endif
     }
     else
     {
@@ -72,6 +72,10 @@ typedef struct fnet_netbuf
     fnet_size_t         length;         /**< amount of actual data in this net_buf */
     fnet_size_t         total_length;   /**< length of buffer + additionally chained buffers (only for first netbuf)*/
     fnet_flag_t         flags;
+#if FNET_CFG_CHECKSUM_COPY
+    fnet_uint16_t       checksum;       /**< cached partial sum of the last "checksum_length" bytes of data */
+    fnet_uint16_t       checksum_length;/**< amount of data covered by "checksum", 0 if there is no cached sum */
+#endif
 } fnet_netbuf_t;
 
 #define FNET_NETBUF_COPYALL   ((fnet_size_t)(-1))
@@ -97,12 +101,20 @@ void fnet_mem_release_netbuf( void );
 
 /* Netbuf service routines */
 fnet_netbuf_t *fnet_netbuf_new( fnet_size_t len, fnet_bool_t drain );
+fnet_netbuf_t *fnet_netbuf_new_headroom( fnet_size_t len, fnet_size_t headroom, fnet_bool_t drain );
+fnet_netbuf_t *fnet_netbuf_push( fnet_netbuf_t *nb, fnet_size_t len, fnet_bool_t drain );
 fnet_netbuf_t *fnet_netbuf_free( fnet_netbuf_t *nb );
 fnet_netbuf_t *fnet_netbuf_copy( fnet_netbuf_t *nb, fnet_size_t offset, fnet_size_t len, fnet_bool_t drain );
 fnet_netbuf_t *fnet_netbuf_from_buf( void *data_ptr, fnet_size_t len, fnet_bool_t drain );
+fnet_netbuf_t *fnet_netbuf_from_buf_headroom( void *data_ptr, fnet_size_t len, fnet_size_t headroom, fnet_bool_t drain );
+#if FNET_CFG_CHECKSUM_COPY
+fnet_netbuf_t *fnet_netbuf_from_buf_checksum( void *data_ptr, fnet_size_t len, fnet_size_t headroom, fnet_bool_t drain );
+#endif
+fnet_netbuf_t *fnet_netbuf_from_data( void *data, void *data_ptr, fnet_size_t len, fnet_bool_t drain );
 fnet_netbuf_t *fnet_netbuf_concat( fnet_netbuf_t *nb1, fnet_netbuf_t *nb2 );
 void fnet_netbuf_to_buf( fnet_netbuf_t *nb, fnet_size_t offset, fnet_size_t len, void *data_ptr );
 fnet_return_t fnet_netbuf_pullup( fnet_netbuf_t **nb_ptr, fnet_size_t len);
+fnet_return_t fnet_netbuf_cow( fnet_netbuf_t **nb_ptr, fnet_size_t len );
 void fnet_netbuf_trim( fnet_netbuf_t ** nb_ptr, fnet_int32_t len );
 fnet_netbuf_t *fnet_netbuf_cut_center( fnet_netbuf_t ** nb_ptr, fnet_size_t offset, fnet_size_t len);
 void fnet_netbuf_add_chain( fnet_netbuf_t ** nb_ptr, fnet_netbuf_t *nb_chain );
@@ -68,6 +68,9 @@ struct fnet_netif_statistics
                               */
     fnet_uint32_t rx_packet; /**< @brief Rx packet count.
                               */
+    fnet_uint32_t tx_drop;   /**< @brief Tx packets dropped by the driver 
+                              * (e.g. the transmit queue is full).
+                              */
 };
 
 /**************************************************************************/ /*!
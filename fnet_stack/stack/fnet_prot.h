@@ -75,6 +75,8 @@ typedef struct fnet_prot_if
     void                    (*prot_control_input)(fnet_prot_notify_t command, struct sockaddr *src_addr,  struct sockaddr *dest_addr, fnet_netbuf_t *nb);  /* (Optional) Protocol input control function.*/ 
     void                    (*prot_drain)( void );      /* Protocol drain function. */
     const fnet_socket_prot_if_t *socket_api;            /* Pointer to Transport Protocol API structure.*/
+    fnet_socket_if_t        **port_hash;                /* (Optional) Local-port lookup table of the protocol's sockets, 
+                                                         * FNET_CFG_SOCKET_PORT_HASH_SIZE buckets.*/
 } fnet_prot_if_t;
 
 /************************************************************************
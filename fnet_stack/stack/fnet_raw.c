@@ -43,6 +43,8 @@ static fnet_return_t fnet_raw_detach( fnet_socket_if_t *sk );
 static fnet_return_t fnet_raw_connect( fnet_socket_if_t *sk, struct sockaddr *foreign_addr);
 static fnet_int32_t fnet_raw_snd( fnet_socket_if_t *sk, fnet_uint8_t *buf, fnet_size_t len, fnet_flag_t flags, const struct sockaddr *addr);
 static fnet_int32_t fnet_raw_rcv(fnet_socket_if_t *sk, fnet_uint8_t *buf, fnet_size_t len, fnet_flag_t flags, struct sockaddr *addr);
+static fnet_int32_t fnet_raw_snd_netbuf( fnet_socket_if_t *sk, fnet_netbuf_t *nb, fnet_flag_t flags, const struct sockaddr *addr);
+static fnet_int32_t fnet_raw_rcv_netbuf(fnet_socket_if_t *sk, fnet_netbuf_t **nb_ptr, fnet_size_t len, fnet_flag_t flags, struct sockaddr *addr);
 static fnet_return_t fnet_raw_shutdown( fnet_socket_if_t *sk, fnet_sd_flags_t how );
 static void fnet_raw_release(void);
 static fnet_error_t fnet_raw_output(struct sockaddr *src_addr, const struct sockaddr *dest_addr, fnet_uint8_t protocol_number, fnet_socket_option_t *sockoption, fnet_netbuf_t *nb);
@@ -51,6 +53,9 @@ static fnet_error_t fnet_raw_output(struct sockaddr *src_addr, const struct sock
 *     Global Data Structures
 *************************************************************************/
 
+/* Sockets, hashed by local port.*/
+static fnet_socket_if_t *fnet_raw_port_hash[FNET_CFG_SOCKET_PORT_HASH_SIZE];
+
 /************************************************************************
  * Protocol API structures.
  ************************************************************************/
@@ -67,6 +72,9 @@ static const fnet_socket_prot_if_t fnet_raw_socket_api =
     fnet_ip_setsockopt,     /* Protocol "setsockopt" function.*/
     fnet_ip_getsockopt,     /* Protocol "getsockopt" function.*/
     0,                      /* Protocol "listen" function.*/
+    0,                      /* Protocol "poll" function.*/
+    fnet_raw_rcv_netbuf,    /* Protocol zero-copy "receive" function.*/
+    fnet_raw_snd_netbuf     /* Protocol zero-copy "send" function.*/
 };
 
 fnet_prot_if_t fnet_raw_prot_if =
@@ -80,7 +88,8 @@ fnet_prot_if_t fnet_raw_prot_if =
     fnet_raw_input,         /* Protocol input function,.*/
     0,                      /* Protocol input control function.*/     
     0,                      /* protocol drain function.*/
-    &fnet_raw_socket_api    /* Socket API */
+    &fnet_raw_socket_api,   /* Socket API */
+    fnet_raw_port_hash       /* Port lookup table.*/
 };
 
 /************************************************************************
@@ -260,6 +269,10 @@ void fnet_raw_input(fnet_netif_t *netif, struct sockaddr *foreign_addr,  struct
                         {
                             fnet_netbuf_free_chain(nb_tmp);
                         }
+                        else
+                        {
+                            fnet_socket_poll_update(last);
+                        }
                     }
                 }
                 last = sock;
@@ -283,6 +296,8 @@ void fnet_raw_input(fnet_netif_t *netif, struct sockaddr *foreign_addr,  struct
                     fnet_netbuf_free_chain(nb_tmp);
                     goto BAD;
                 }
+
+                fnet_socket_poll_update(last);
             }
             else
             {
@@ -291,7 +306,7 @@ void fnet_raw_input(fnet_netif_t *netif, struct sockaddr *foreign_addr,  struct
         }
         else /* For unicast datagram.*/
         {
-            sock = fnet_socket_lookup(fnet_raw_prot_if.head, local_addr, foreign_addr, protocol_number);
+            sock = fnet_socket_lookup(&fnet_raw_prot_if, local_addr, foreign_addr, protocol_number);
 
             if(sock)
             {
@@ -308,6 +323,8 @@ void fnet_raw_input(fnet_netif_t *netif, struct sockaddr *foreign_addr,  struct
                         fnet_netbuf_free_chain(nb_tmp);
                         goto BAD;
                     }
+
+                    fnet_socket_poll_update(sock);
                 }
                 else
                 {
@@ -389,7 +406,9 @@ static fnet_return_t fnet_raw_connect( fnet_socket_if_t *sk, struct sockaddr *fo
     fnet_isr_lock();
 
     fnet_memcpy(&sk->foreign_addr, foreign_addr, sizeof(sk->foreign_addr));
+    fnet_socket_hash_del(sk);
     sk->local_addr.sa_port = 0u;
+    fnet_socket_hash_add(sk);
     sk->foreign_addr.sa_port = 0u;
     sk->state = SS_CONNECTED;
     fnet_socket_buffer_release(&sk->receive_buffer);
@@ -406,9 +425,34 @@ static fnet_return_t fnet_raw_connect( fnet_socket_if_t *sk, struct sockaddr *fo
 static fnet_int32_t fnet_raw_snd( fnet_socket_if_t *sk, fnet_uint8_t *buf, fnet_size_t len, fnet_flag_t flags, const struct sockaddr *addr)
 {
     fnet_netbuf_t           *nb;
+
+    if(len > sk->send_buffer.count_max)
+    {
+        fnet_socket_set_error(sk, FNET_ERR_MSGSIZE);   /* Message too long, do not copy it.*/
+        return (FNET_ERR);
+    }
+
+    if((nb = fnet_netbuf_from_buf_headroom(buf, len, FNET_CFG_NETBUF_HEADROOM, FNET_FALSE)) == 0)
+    {
+        fnet_socket_set_error(sk, FNET_ERR_NOMEM);     /* Cannot allocate memory.*/
+        return (FNET_ERR);
+    }
+
+    return fnet_raw_snd_netbuf(sk, nb, flags, addr);
+}
+
+/************************************************************************
+* NAME: fnet_raw_snd_netbuf
+*
+* DESCRIPTION: RAW send function. The IP header is prepended 
+*              to the net_buf chain, which is always freed.
+*************************************************************************/
+static fnet_int32_t fnet_raw_snd_netbuf( fnet_socket_if_t *sk, fnet_netbuf_t *nb, fnet_flag_t flags, const struct sockaddr *addr)
+{
     fnet_error_t            error = FNET_ERR_OK;
     const struct sockaddr   *foreign_addr;
     fnet_bool_t             flags_save = FNET_FALSE;
+    fnet_size_t             len = nb->total_length;
 
     if(len > sk->send_buffer.count_max)
     {
@@ -425,12 +469,6 @@ static fnet_int32_t fnet_raw_snd( fnet_socket_if_t *sk, fnet_uint8_t *buf, fnet_
         foreign_addr = &sk->foreign_addr;
     }
 
-    if((nb = fnet_netbuf_from_buf(buf, len, FNET_FALSE)) == 0)
-    {
-        error = FNET_ERR_NOMEM;     /* Cannot allocate memory.*/
-        goto ERROR;
-    }
-
     if((flags & MSG_DONTROUTE) != 0u) /* Save */
     {
         flags_save = sk->options.so_dontroute; 
@@ -438,6 +476,7 @@ static fnet_int32_t fnet_raw_snd( fnet_socket_if_t *sk, fnet_uint8_t *buf, fnet_
     }
 
     error = fnet_raw_output(&sk->local_addr, foreign_addr, (fnet_uint8_t)sk->protocol_number, &(sk->options), nb);
+    nb = 0; /* It is freed by fnet_raw_output().*/
 
     if((flags & MSG_DONTROUTE) != 0u) /* Restore.*/
     {
@@ -450,6 +489,11 @@ static fnet_int32_t fnet_raw_snd( fnet_socket_if_t *sk, fnet_uint8_t *buf, fnet_
     }
 
 ERROR:
+    if(nb)
+    {
+        fnet_netbuf_free_chain(nb);
+    }
+
     fnet_socket_set_error(sk, error);
     return (FNET_ERR);
 }
@@ -497,4 +541,47 @@ ERROR:
     return (FNET_ERR);
 }
 
+/************************************************************************
+* NAME: fnet_raw_rcv_netbuf
+*
+* DESCRIPTION :RAW zero-copy receive function.
+*************************************************************************/
+static fnet_int32_t fnet_raw_rcv_netbuf(fnet_socket_if_t *sk, fnet_netbuf_t **nb_ptr, fnet_size_t len, fnet_flag_t flags, struct sockaddr *addr)
+{
+    fnet_error_t    error;
+    fnet_int32_t    length;
+    struct sockaddr foreign_addr;
+
+    FNET_COMP_UNUSED_ARG(flags);
+
+    if((length = fnet_socket_buffer_take_address(&(sk->receive_buffer), nb_ptr, len, &foreign_addr)) == FNET_ERR)
+    {
+        /* The message was too large to fit into the specified length and was discarded.*/
+        error = FNET_ERR_MSGSIZE;
+        goto ERROR;
+    }
+
+    if(sk->options.local_error == FNET_ERR_OK) /* We get RAW or ICMP error.*/
+    {
+        if(addr)
+        {
+            fnet_socket_addr_copy(&foreign_addr, addr);
+        }
+        
+        return (length);
+    }
+
+    error = sk->options.local_error;
+
+ERROR:
+    if(*nb_ptr)
+    {
+        fnet_netbuf_free_chain(*nb_ptr);
+        *nb_ptr = 0;
+    }
+
+    fnet_socket_set_error(sk, error);
+    return (FNET_ERR);
+}
+
 #endif  /* FNET_CFG_RAW */
@@ -52,6 +52,9 @@ static void fnet_socket_desc_set(fnet_socket_t desc, fnet_socket_if_t *sock);
 static void fnet_socket_desc_free(fnet_socket_t desc);
 static fnet_socket_if_t *fnet_socket_desc_find(fnet_socket_t desc);
 static fnet_error_t fnet_socket_addr_check_len(const struct sockaddr *addr, fnet_size_t addr_len);
+static fnet_index_t fnet_socket_hash_key( fnet_uint16_t port );
+static fnet_socket_if_t *fnet_socket_port_first( fnet_prot_if_t *prot, fnet_uint16_t port );
+static fnet_socket_if_t *fnet_socket_port_next( fnet_prot_if_t *prot, fnet_socket_if_t *sock );
 
 /************************************************************************
 * NAME: fnet_socket_init
@@ -79,6 +82,59 @@ void fnet_socket_set_error( fnet_socket_if_t *sock, fnet_error_t error )
     sock->options.error = error;
     
     fnet_error_set(error);
+
+    fnet_socket_poll_update(sock);
+}
+
+/************************************************************************
+* NAME: fnet_socket_poll_update
+*
+* DESCRIPTION: This function recalculates the socket readiness. 
+*              It is called by the socket layer and by protocols, 
+*              when socket buffers, state or error are changed.
+*************************************************************************/
+void fnet_socket_poll_update( fnet_socket_if_t *sock )
+{
+    fnet_flag_t events;
+    fnet_flag_t raised;
+
+    fnet_isr_lock(); /* Input may change the socket in between.*/
+
+    if(sock->protocol_interface->socket_api->prot_poll)
+    {
+        events = sock->protocol_interface->socket_api->prot_poll(sock);
+    }
+    else /* Default for datagram sockets.*/
+    {
+        events = 0u;
+
+        if(sock->receive_buffer.record_num)
+        {
+            events |= FNET_SOCKET_POLL_READ;
+        }
+
+        if(sock->send_buffer.is_shutdown == FNET_FALSE)
+        {
+            events |= FNET_SOCKET_POLL_WRITE;
+        }
+
+        if(sock->options.local_error != FNET_ERR_OK)
+        {
+            events |= FNET_SOCKET_POLL_ERROR;
+        }
+    }
+
+    raised = events & (fnet_flag_t)(~sock->poll_events);
+    sock->poll_events = events;
+
+    fnet_isr_unlock();
+
+    /* Notify the application about the raised events.
+     * Not accepted yet sockets have no descriptor, so wait for accept().*/
+    if(raised && sock->callback && (sock->descriptor != FNET_SOCKET_DESC_RESERVED))
+    {
+        sock->callback(sock->descriptor, raised, sock->callback_cookie);
+    }
 }
 
 /************************************************************************
@@ -204,6 +260,7 @@ static fnet_socket_if_t *fnet_socket_desc_find( fnet_socket_t desc )
 void fnet_socket_release( fnet_socket_if_t ** head, fnet_socket_if_t *sock )
 {
     fnet_isr_lock();
+    fnet_socket_hash_del(sock);
     fnet_socket_list_del(head, sock);
     fnet_socket_buffer_release(&sock->receive_buffer);
     fnet_socket_buffer_release(&sock->send_buffer);
@@ -211,16 +268,114 @@ void fnet_socket_release( fnet_socket_if_t ** head, fnet_socket_if_t *sock )
     fnet_isr_unlock();
 }
 
+/************************************************************************
+* NAME: fnet_socket_hash_key
+*
+* DESCRIPTION: This function calculates the port lookup-table bucket index.
+*              Consecutive ports fall into different buckets.
+*************************************************************************/
+static fnet_index_t fnet_socket_hash_key( fnet_uint16_t port )
+{
+    return (fnet_index_t)(((fnet_uint32_t)port ^ ((fnet_uint32_t)port >> 8)) & (FNET_CFG_SOCKET_PORT_HASH_SIZE - 1u));
+}
+
+/************************************************************************
+* NAME: fnet_socket_hash_add
+*
+* DESCRIPTION: This function adds the socket to the port lookup table
+*              of its protocol, if the protocol has one.
+*************************************************************************/
+void fnet_socket_hash_add( fnet_socket_if_t *sock )
+{
+    fnet_socket_if_t **bucket;
+
+    if(sock->protocol_interface->port_hash)
+    {
+        fnet_isr_lock();
+        bucket = &sock->protocol_interface->port_hash[fnet_socket_hash_key(sock->local_addr.sa_port)];
+        sock->hash_next = *bucket;
+        *bucket = sock;
+        fnet_isr_unlock();
+    }
+}
+
+/************************************************************************
+* NAME: fnet_socket_hash_del
+*
+* DESCRIPTION: This function removes the socket from the port lookup table
+*              of its protocol. It must be called before the local port
+*              of the socket is changed.
+*************************************************************************/
+void fnet_socket_hash_del( fnet_socket_if_t *sock )
+{
+    fnet_socket_if_t **bucket;
+
+    if(sock->protocol_interface->port_hash)
+    {
+        fnet_isr_lock();
+        bucket = &sock->protocol_interface->port_hash[fnet_socket_hash_key(sock->local_addr.sa_port)];
+
+        while((*bucket) && ((*bucket) != sock))
+        {
+            bucket = &(*bucket)->hash_next;
+        }
+
+        if(*bucket)
+        {
+            *bucket = sock->hash_next;
+        }
+
+        sock->hash_next = 0;
+        fnet_isr_unlock();
+    }
+}
+
+/************************************************************************
+* NAME: fnet_socket_hash_head
+*
+* DESCRIPTION: This function returns the first socket of the port lookup 
+*              table bucket, the rest are linked by hash_next.
+*              The bucket contains all protocol sockets bound to the port.
+*              The protocol must have the port lookup table.
+*************************************************************************/
+fnet_socket_if_t *fnet_socket_hash_head( fnet_prot_if_t *prot, fnet_uint16_t port )
+{
+    return prot->port_hash[fnet_socket_hash_key(port)];
+}
+
+/************************************************************************
+* NAME: fnet_socket_port_first
+*
+* DESCRIPTION: This function returns the first socket to be checked 
+*              for the local port. If the protocol has no port lookup 
+*              table, it is the head of the protocol socket list.
+*************************************************************************/
+static fnet_socket_if_t *fnet_socket_port_first( fnet_prot_if_t *prot, fnet_uint16_t port )
+{
+    return (prot->port_hash) ? prot->port_hash[fnet_socket_hash_key(port)] : prot->head;
+}
+
+/************************************************************************
+* NAME: fnet_socket_port_next
+*
+* DESCRIPTION: This function returns the next socket to be checked 
+*              for the local port.
+*************************************************************************/
+static fnet_socket_if_t *fnet_socket_port_next( fnet_prot_if_t *prot, fnet_socket_if_t *sock )
+{
+    return (prot->port_hash) ? sock->hash_next : sock->next;
+}
+
 /************************************************************************
 * NAME: fnet_socket_conflict
 *
 * DESCRIPTION: Return FNET_TRUE if there's a socket whose addresses 'confict' 
 *              with the supplied addresses.
 *************************************************************************/
-fnet_bool_t fnet_socket_conflict( fnet_socket_if_t *head,  const struct sockaddr *local_addr, 
+fnet_bool_t fnet_socket_conflict( fnet_prot_if_t *prot,  const struct sockaddr *local_addr, 
                           const struct sockaddr *foreign_addr /*optional*/, fnet_bool_t wildcard )
 {
-    fnet_socket_if_t *sock = head;
+    fnet_socket_if_t *sock = fnet_socket_port_first(prot, local_addr->sa_port);
 
     while(sock != 0)
     {
@@ -232,8 +387,16 @@ fnet_bool_t fnet_socket_conflict( fnet_socket_if_t *head,  const struct sockaddr
             return (FNET_TRUE);
         }
 
-        sock = sock->next;
+        sock = fnet_socket_port_next(prot, sock);
+    }
+
+#if FNET_CFG_TCP && FNET_CFG_TCP_TIMEWAIT_SIZE
+    /* The TCP connections in the TIME_WAIT state are kept without sockets.*/
+    if(prot == &fnet_tcp_prot_if)
+    {
+        return fnet_tcp_timewait_conflict(local_addr, foreign_addr, wildcard);
     }
+#endif
 
     return (FNET_FALSE);
 }
@@ -244,14 +407,14 @@ fnet_bool_t fnet_socket_conflict( fnet_socket_if_t *head,  const struct sockaddr
 * DESCRIPTION: This function looks for a socket with the best match 
 *              to the local and foreign address parameters.
 *************************************************************************/
-fnet_socket_if_t *fnet_socket_lookup( fnet_socket_if_t *head,  struct sockaddr *local_addr, struct sockaddr *foreign_addr, fnet_uint32_t protocol_number)
+fnet_socket_if_t *fnet_socket_lookup( fnet_prot_if_t *prot,  struct sockaddr *local_addr, struct sockaddr *foreign_addr, fnet_uint32_t protocol_number)
 {
     fnet_socket_if_t   *sock;
     fnet_socket_if_t   *match_sock = 0;
     fnet_index_t    match_wildcard = 3u;
     fnet_index_t    wildcard;
 
-    for (sock = head; sock != 0; sock = sock->next)
+    for (sock = fnet_socket_port_first(prot, local_addr->sa_port); sock != 0; sock = fnet_socket_port_next(prot, sock))
     {
         /* Compare protocol number.*/
         if(sock->protocol_number != protocol_number)
@@ -341,8 +504,12 @@ fnet_socket_if_t *fnet_socket_lookup( fnet_socket_if_t *head,  struct sockaddr *
 *              list starting at 'head'. The port will always be
 *	           FNET_SOCKET_PORT_RESERVED < local_port <= FNET_SOCKET_PORT_USERRESERVED (ephemeral port).
 *              In network byte order.
+*              For protocols with the port lookup table, every probe 
+*              checks only one bucket and the next probe goes to 
+*              the next bucket, so the expected cost does not depend
+*              on the number of sockets.
 *************************************************************************/
-fnet_uint16_t fnet_socket_get_uniqueport( fnet_socket_if_t *head, struct sockaddr *local_addr )
+fnet_uint16_t fnet_socket_get_uniqueport( fnet_prot_if_t *prot, struct sockaddr *local_addr )
 {
     fnet_uint16_t   local_port = fnet_port_last; 
     struct sockaddr local_addr_tmp;
@@ -360,7 +527,7 @@ fnet_uint16_t fnet_socket_get_uniqueport( fnet_socket_if_t *head, struct sockadd
         
         local_addr_tmp.sa_port = fnet_htons(local_port);    
     } 
-    while (fnet_socket_conflict(head, &local_addr_tmp, FNET_NULL, FNET_TRUE));
+    while (fnet_socket_conflict(prot, &local_addr_tmp, FNET_NULL, FNET_TRUE));
     
     fnet_port_last = local_port;
     
@@ -385,6 +552,7 @@ fnet_socket_if_t *fnet_socket_copy( fnet_socket_if_t *sock )
 
         sock_cp->next = 0;
         sock_cp->prev = 0;
+        sock_cp->hash_next = 0;
         sock_cp->descriptor = FNET_SOCKET_DESC_RESERVED;
         sock_cp->state = SS_UNCONNECTED;
         sock_cp->protocol_control = 0;
@@ -397,6 +565,7 @@ fnet_socket_if_t *fnet_socket_copy( fnet_socket_if_t *sock )
         sock_cp->send_buffer.net_buf_chain = 0;
         sock_cp->options.error = FNET_ERR_OK;
         sock_cp->options.local_error = FNET_ERR_OK;
+        sock_cp->poll_events = 0u;
         return (sock_cp);
     }
     else
@@ -460,6 +629,7 @@ fnet_socket_t fnet_socket( fnet_address_family_t family, fnet_socket_type_t type
     sock->foreign_addr.sa_family = family;
     
     fnet_socket_list_add(&prot->head, sock);
+    fnet_socket_hash_add(sock);
 
     if((prot->socket_api->prot_attach) && (prot->socket_api->prot_attach(sock) == FNET_ERR))
     {
@@ -468,6 +638,8 @@ fnet_socket_t fnet_socket( fnet_address_family_t family, fnet_socket_type_t type
         goto ERROR_2;
     }
 
+    fnet_socket_poll_update(sock);
+
     fnet_os_mutex_unlock();
     return (res);
 
@@ -588,17 +760,19 @@ fnet_return_t fnet_socket_connect( fnet_socket_t s, struct sockaddr *name, fnet_
 
         if(local_addr_tmp.sa_port == 0u)
         {
-            local_addr_tmp.sa_port = fnet_socket_get_uniqueport(sock->protocol_interface->head,
+            local_addr_tmp.sa_port = fnet_socket_get_uniqueport(sock->protocol_interface,
                                                 &local_addr_tmp); /* Get ephemeral port.*/
         }
             
-        if(fnet_socket_conflict(sock->protocol_interface->head, &local_addr_tmp, &foreign_addr, FNET_TRUE))
+        if(fnet_socket_conflict(sock->protocol_interface, &local_addr_tmp, &foreign_addr, FNET_TRUE))
         {
             error = FNET_ERR_ADDRINUSE; /* Address already in use. */
             goto ERROR_SOCK;
         }
 
+        fnet_socket_hash_del(sock);
         fnet_memcpy(&sock->local_addr, &local_addr_tmp, sizeof(sock->local_addr));
+        fnet_socket_hash_add(sock);
         
         /* Start the appropriate protocol connection.*/
         if(sock->protocol_interface->socket_api->prot_connect)
@@ -609,6 +783,8 @@ fnet_return_t fnet_socket_connect( fnet_socket_t s, struct sockaddr *name, fnet_
         {
             result = FNET_OK;
         }
+
+        fnet_socket_poll_update(sock);
     }
     else
     {
@@ -661,23 +837,25 @@ fnet_return_t fnet_socket_bind( fnet_socket_t s, const struct sockaddr *name, fn
                 }
                 
                 if((name->sa_port != 0u)
-                     && (fnet_socket_conflict(sock->protocol_interface->head, name, FNET_NULL, FNET_FALSE)))
+                     && (fnet_socket_conflict(sock->protocol_interface, name, FNET_NULL, FNET_FALSE)))
                 {
                     error = FNET_ERR_ADDRINUSE; /* Address already in use. */
                     goto ERROR_SOCK;
                 }
             }
 
+            fnet_socket_hash_del(sock);
             fnet_socket_ip_addr_copy(name , &sock->local_addr);
 
             if((name->sa_port == 0u) && (sock->protocol_interface->type != SOCK_RAW))
             {
-                sock->local_addr.sa_port = fnet_socket_get_uniqueport(sock->protocol_interface->head, &sock->local_addr); /* Get ephemeral port.*/
+                sock->local_addr.sa_port = fnet_socket_get_uniqueport(sock->protocol_interface, &sock->local_addr); /* Get ephemeral port.*/
             }
             else
             {
                 sock->local_addr.sa_port = name->sa_port;
             }
+            fnet_socket_hash_add(sock);
 
             fnet_socket_buffer_release(&sock->receive_buffer);
             fnet_socket_buffer_release(&sock->send_buffer);
@@ -750,6 +928,9 @@ fnet_return_t fnet_socket_close( fnet_socket_t s )
         }                        
 #endif
 
+        /* The socket may live on in background (TCP graceful close), stop notifications.*/
+        sock->callback = 0;
+
         if(sock->protocol_interface->socket_api->prot_detach)
         {
             result = sock->protocol_interface->socket_api->prot_detach(sock);
@@ -793,6 +974,7 @@ fnet_return_t fnet_socket_shutdown( fnet_socket_t s, fnet_sd_flags_t how )
         if((sock->protocol_interface) && (sock->protocol_interface->socket_api->prot_shutdown))
         {
             result = sock->protocol_interface->socket_api->prot_shutdown(sock, how);
+            fnet_socket_poll_update(sock);
         }
     }
     else
@@ -841,6 +1023,7 @@ fnet_return_t fnet_socket_listen( fnet_socket_t s, fnet_size_t backlog )
         if((sock->protocol_interface) && (sock->protocol_interface->socket_api->prot_listen))
         {
             result = sock->protocol_interface->socket_api->prot_listen(sock, backlog);
+            fnet_socket_poll_update(sock);
         }
         else
         {
@@ -911,6 +1094,13 @@ fnet_socket_t fnet_socket_accept( fnet_socket_t s, struct sockaddr *addr, fnet_s
 
                 fnet_socket_desc_set(desc, sock_new);
                 fnet_socket_list_add(&sock->protocol_interface->head, sock_new);
+
+                fnet_socket_poll_update(sock);
+                
+                /* Events raised in the accept queue were not reported, 
+                 * the inherited callback gets them once now.*/
+                sock_new->poll_events = 0u;
+                fnet_socket_poll_update(sock_new);
                 
                 fnet_isr_unlock();
                 
@@ -1000,6 +1190,7 @@ fnet_int32_t fnet_socket_sendto( fnet_socket_t s, fnet_uint8_t *buf, fnet_size_t
             if(sock->protocol_interface->socket_api->prot_snd)
             {
                 result = sock->protocol_interface->socket_api->prot_snd(sock, buf, len, flags, to);
+                fnet_socket_poll_update(sock);
             }
             else
             {
@@ -1084,6 +1275,7 @@ fnet_int32_t fnet_socket_recvfrom( fnet_socket_t s, fnet_uint8_t *buf, fnet_size
             if(sock->protocol_interface->socket_api->prot_rcv)
             {
                 result = sock->protocol_interface->socket_api->prot_rcv(sock, buf, len, flags, (from && fromlen) ? from : FNET_NULL);
+                fnet_socket_poll_update(sock);
             }
             else
             {
@@ -1124,6 +1316,202 @@ fnet_int32_t fnet_socket_recv( fnet_socket_t s, fnet_uint8_t *buf, fnet_size_t l
     return fnet_socket_recvfrom(s, buf, len, flags, FNET_NULL, FNET_NULL);
 }
 
+/************************************************************************
+* NAME: fnet_socket_send_netbuf
+*
+* DESCRIPTION: This function sends the application net_buf chain 
+*              to a specific destination, without copying. 
+*              The chain is owned by the stack, unless 0 is returned.
+*************************************************************************/
+fnet_int32_t fnet_socket_send_netbuf( fnet_socket_t s, fnet_netbuf_t *nb, fnet_flag_t flags, const struct sockaddr *to, fnet_size_t tolen )
+{
+    fnet_socket_if_t   *sock;
+#if FNET_CFG_CHECKSUM_COPY
+    fnet_netbuf_t      *tmp_nb;
+#endif
+    fnet_error_t    error;
+    fnet_int32_t    result = 0;
+
+    fnet_os_mutex_lock();
+
+    if((sock = fnet_socket_desc_find(s)) != 0)
+    {
+        if((to == FNET_NULL) || (tolen == 0u))
+        {
+            if(fnet_socket_addr_is_unspecified(&sock->foreign_addr))
+            {
+                error = FNET_ERR_NOTCONN; /* Socket is not connected.*/
+                goto ERROR_SOCK;
+            }
+            
+            to = FNET_NULL;
+        }
+        else
+        {
+            if((error = fnet_socket_addr_check_len(to, tolen)) != FNET_ERR_OK)
+            {
+                goto ERROR_SOCK;
+            }     
+
+            if(fnet_socket_addr_is_unspecified(to))
+            {
+                error = FNET_ERR_DESTADDRREQ; /* Destination address required.*/
+                goto ERROR_SOCK;
+            }
+        }    
+        
+        if(nb && (nb->total_length != 0u))
+        {
+            /* The out-of-band data are sent by fnet_socket_send().*/
+            if((flags & MSG_OOB) != 0u)
+            {
+                error = FNET_ERR_OPNOTSUPP; /* Operation not supported.*/
+                goto ERROR_SOCK;
+            }
+
+            /* If the socket is shutdowned, return.*/
+            if(sock->send_buffer.is_shutdown)
+            {
+                error = FNET_ERR_SHUTDOWN;
+                goto ERROR_SOCK;
+            }
+
+            if(sock->protocol_interface->socket_api->prot_snd_netbuf)
+            {
+                /* The application net_bufs may be received ones, clear their receive state.*/
+                nb->next_chain = 0;
+                nb->flags = FNET_NETBUF_FLAG_NONE;
+
+            #if FNET_CFG_CHECKSUM_COPY
+                /* The data may be modified by the application, the cached sums are not valid.*/
+                for(tmp_nb = nb; tmp_nb != 0; tmp_nb = tmp_nb->next)
+                {
+                    tmp_nb->checksum_length = 0u;
+                }
+            #endif
+
+                result = sock->protocol_interface->socket_api->prot_snd_netbuf(sock, nb, flags, to);
+                fnet_socket_poll_update(sock);
+            }
+            else
+            {
+                error = FNET_ERR_OPNOTSUPP; /* Operation not supported.*/
+                goto ERROR_SOCK;
+            }
+        }
+        else
+        {
+            error = FNET_ERR_INVAL; /* Invalid argument.*/
+            goto ERROR_SOCK;
+        }
+    }
+    else
+    {
+        fnet_error_set(FNET_ERR_BAD_DESC);/* Bad descriptor.*/
+        goto ERROR;
+    }
+
+    fnet_os_mutex_unlock();
+    return (result);
+
+ERROR_SOCK:
+    fnet_socket_set_error(sock, error);
+
+ERROR:
+    fnet_os_mutex_unlock();
+
+    if(nb)
+    {
+        fnet_netbuf_free_chain(nb);
+    }
+
+    return (FNET_ERR);
+}
+
+/************************************************************************
+* NAME: fnet_socket_recv_netbuf
+*
+* DESCRIPTION: This function passes the incoming data of socket 
+*              to the application as a net_buf chain, without copying. 
+*              And captures the address from which the data was sent.
+*************************************************************************/
+fnet_int32_t fnet_socket_recv_netbuf( fnet_socket_t s, fnet_netbuf_t **nb_ptr, fnet_size_t len, fnet_flag_t flags, struct sockaddr *from, fnet_size_t *fromlen )
+{
+    fnet_socket_if_t   *sock;
+    fnet_error_t    error;
+    fnet_int32_t    result = 0;
+
+    fnet_os_mutex_lock();
+
+    if((sock = fnet_socket_desc_find(s)) != 0)
+    {
+        if(nb_ptr)
+        {
+            *nb_ptr = 0;
+
+            /* The out-of-band data and the peeking are supported by fnet_socket_recv().*/
+            if((flags & (MSG_OOB | MSG_PEEK)) != 0u)
+            {
+                error = FNET_ERR_OPNOTSUPP; /* Operation not supported.*/
+                goto ERROR_SOCK;
+            }
+
+            /* The sockets must be bound before calling recv.*/
+            if((sock->local_addr.sa_port == 0u) && (sock->protocol_interface->type != SOCK_RAW))
+            {
+                error = FNET_ERR_BOUNDREQ; /* The socket has not been bound with fnet_socket_bind().*/
+                goto ERROR_SOCK;
+            }
+
+            if(from && fromlen)
+            {
+                if((error = fnet_socket_addr_check_len(&sock->local_addr, (*fromlen) )) != FNET_ERR_OK )
+                {
+                    goto ERROR_SOCK;
+                }
+            }
+            
+            /* If the socket is shutdowned, return.*/
+            if(sock->receive_buffer.is_shutdown)
+            {
+                error = FNET_ERR_SHUTDOWN;
+                goto ERROR_SOCK;
+            }
+
+            if(sock->protocol_interface->socket_api->prot_rcv_netbuf)
+            {
+                result = sock->protocol_interface->socket_api->prot_rcv_netbuf(sock, nb_ptr, len, flags, (from && fromlen) ? from : FNET_NULL);
+                fnet_socket_poll_update(sock);
+            }
+            else
+            {
+                error = FNET_ERR_OPNOTSUPP; /* Operation not supported.*/
+                goto ERROR_SOCK;
+            }
+        }
+        else
+        {
+            error = FNET_ERR_INVAL; /* Invalid argument.*/
+            goto ERROR_SOCK;
+        }
+    }
+    else
+    {
+        fnet_error_set(FNET_ERR_BAD_DESC);/* Bad descriptor.*/
+        goto ERROR;
+    }
+
+    fnet_os_mutex_unlock();
+    return (result);
+
+ERROR_SOCK:
+    fnet_socket_set_error(sock, error);
+
+ERROR:
+    fnet_os_mutex_unlock();
+    return (FNET_ERR);
+}
+
 /************************************************************************
 * NAME: getsockname
 *
@@ -1226,6 +1614,83 @@ ERROR:
     return (FNET_ERR);
 }
 
+/************************************************************************
+* NAME: fnet_socket_poll
+*
+* DESCRIPTION: This function reports readiness of the set of sockets.
+*              It only reads the readiness kept by fnet_socket_poll_update().
+*************************************************************************/
+fnet_size_t fnet_socket_poll( fnet_socket_poll_desc_t *desc, fnet_size_t desc_num )
+{
+    fnet_socket_if_t    *sock;
+    fnet_size_t         ready = 0u;
+    fnet_index_t        i;
+
+    fnet_os_mutex_lock();
+
+    for(i = 0u; i < desc_num; i++)
+    {
+        if((sock = fnet_socket_desc_find(desc[i].s)) != 0)
+        {
+            desc[i].revents = sock->poll_events & (desc[i].events | FNET_SOCKET_POLL_ERROR);
+        }
+        else
+        {
+            desc[i].revents = FNET_SOCKET_POLL_ERROR; /* Bad descriptor.*/
+        }
+
+        if(desc[i].revents)
+        {
+            ready++;
+        }
+    }
+
+    fnet_os_mutex_unlock();
+
+    return ready;
+}
+
+/************************************************************************
+* NAME: fnet_socket_set_callback
+*
+* DESCRIPTION: This function registers the readiness callback of the socket.
+*              The events, which are already pending, are reported 
+*              to the new callback once.
+*************************************************************************/
+fnet_return_t fnet_socket_set_callback( fnet_socket_t s, fnet_socket_callback_t callback, void *cookie )
+{
+    fnet_socket_if_t    *sock;
+    fnet_flag_t         events;
+
+    fnet_os_mutex_lock();
+
+    if((sock = fnet_socket_desc_find(s)) != 0)
+    {
+        fnet_isr_lock();
+        sock->callback = callback;
+        sock->callback_cookie = cookie;
+        events = sock->poll_events;
+        fnet_isr_unlock();
+
+        if(callback && events)
+        {
+            callback(s, events, cookie);
+        }
+    }
+    else
+    {
+        fnet_error_set(FNET_ERR_BAD_DESC);/* Bad descriptor.*/
+        goto ERROR;
+    }
+
+    fnet_os_mutex_unlock();
+    return (FNET_OK);
+
+ERROR:
+    fnet_os_mutex_unlock();
+    return (FNET_ERR);
+}
+
 /************************************************************************
 * NAME: setsockopt
 *
@@ -1249,6 +1714,7 @@ fnet_return_t fnet_socket_setopt( fnet_socket_t s, fnet_protocol_t level, fnet_s
                 if((sock->protocol_interface) && (sock->protocol_interface->socket_api->prot_setsockopt))
                 {
                     result = sock->protocol_interface->socket_api->prot_setsockopt(sock, level, optname, optval, optvallen);
+                    fnet_socket_poll_update(sock);
                 }
                 else
                 {
@@ -1313,6 +1779,8 @@ fnet_return_t fnet_socket_setopt( fnet_socket_t s, fnet_protocol_t level, fnet_s
                             sock->receive_buffer.count_max = *((const fnet_uint32_t *)optval);
                         }
 
+                        fnet_socket_poll_update(sock);
+
                         break;
                     default:
                         error = FNET_ERR_NOPROTOOPT; /* The option is unknown or unsupported. */
@@ -1554,6 +2022,7 @@ void fnet_socket_buffer_release( fnet_socket_buffer_t *sb )
 
         sb->net_buf_chain = 0;
         sb->count = 0u;
+        sb->record_num = 0u;
     }
 
     fnet_isr_unlock();
@@ -1574,14 +2043,46 @@ fnet_return_t fnet_socket_buffer_append_record( fnet_socket_buffer_t *sb, fnet_n
         return FNET_ERR;
     }
 
-    sb->net_buf_chain = fnet_netbuf_concat(sb->net_buf_chain, nb);
+    fnet_socket_buffer_concat(sb, nb);
 
-    sb->count += nb->total_length;
     fnet_isr_unlock();
 
     return FNET_OK;
 }
 
+/************************************************************************
+* NAME: fnet_socket_buffer_concat
+*
+* DESCRIPTION: Appends the data to the end of the stream socket buffer,
+*              without the buffer limit check. 
+*              The tail pointer avoids walking through the buffer.
+*              Should be called with locked interrupts.
+*************************************************************************/
+void fnet_socket_buffer_concat( fnet_socket_buffer_t *sb, fnet_netbuf_t *nb )
+{
+    fnet_size_t len = nb->total_length;
+
+    if(sb->net_buf_chain == 0)
+    {
+        sb->net_buf_chain = nb;
+    }
+    else
+    {
+        sb->net_buf_tail->next = nb;
+        sb->net_buf_chain->flags |= nb->flags;
+        sb->net_buf_chain->total_length += len;
+    }
+
+    /* Move the tail to the end of the appended data.*/
+    while(nb->next != 0)
+    {
+        nb = nb->next;
+    }
+
+    sb->net_buf_tail = nb;
+    sb->count += len;
+}
+
 /************************************************************************
 * NAME: fnet_socket_buffer_append_address
 *
@@ -1613,7 +2114,19 @@ fnet_return_t fnet_socket_buffer_append_address( fnet_socket_buffer_t *sb, fnet_
     sb->count += nb->total_length;
 
     nb = fnet_netbuf_concat(nb_addr, nb);
-    fnet_netbuf_add_chain(&sb->net_buf_chain, nb);
+
+    /* Add the chain to the end of the queue.*/
+    if(sb->net_buf_chain == 0)
+    {
+        sb->net_buf_chain = nb;
+    }
+    else
+    {
+        sb->net_buf_tail->next_chain = nb;
+    }
+
+    sb->net_buf_tail = nb;
+    sb->record_num++;
     fnet_isr_unlock();
     
 	/* Wake-up user application.*/
@@ -1703,6 +2216,7 @@ fnet_int32_t fnet_socket_buffer_read_address( fnet_socket_buffer_t *sb, fnet_uin
                 sb->count -= nb->total_length;
             }
             fnet_netbuf_del_chain(&sb->net_buf_chain, nb_addr);
+            sb->record_num--;
             
             fnet_isr_unlock();
         }
@@ -1715,6 +2229,99 @@ fnet_int32_t fnet_socket_buffer_read_address( fnet_socket_buffer_t *sb, fnet_uin
     return (fnet_int32_t)len;
 }
 
+/************************************************************************
+* NAME: fnet_socket_buffer_take_address
+*
+* DESCRIPTION: This function removes the first datagram from socket buffer
+*              and passes its net_buf chain to the application, 
+*              without copying. 
+*              And captures the address information from which the data was sent. 
+*              If the datagram is larger than "len", it is discarded.
+*************************************************************************/
+fnet_int32_t fnet_socket_buffer_take_address( fnet_socket_buffer_t *sb, fnet_netbuf_t **nb_ptr, fnet_size_t len, struct sockaddr *foreign_addr )
+{
+    fnet_netbuf_t   *nb;
+    fnet_netbuf_t   *nb_addr;
+    fnet_int32_t    result = 0;
+
+    fnet_isr_lock();
+
+    if((nb_addr = sb->net_buf_chain) != 0)
+    {
+        fnet_memcpy(foreign_addr, &((fnet_socket_buffer_addr_t *)(nb_addr->data_ptr))->addr_s, sizeof(*foreign_addr));
+
+        if((nb = nb_addr->next) != 0)
+        {
+            sb->count -= nb->total_length;
+
+            if(nb->total_length > len)
+            {
+                result = FNET_ERR;
+            }
+            else
+            {
+                /* Detach the data from the address net_buf.*/
+                nb_addr->next = 0;
+                nb_addr->total_length = nb_addr->length;
+
+                *nb_ptr = nb;
+                result = (fnet_int32_t)nb->total_length;
+            }
+        }
+
+        fnet_netbuf_del_chain(&sb->net_buf_chain, nb_addr);
+        sb->record_num--;
+    }
+
+    fnet_isr_unlock();
+
+    return result;
+}
+
+/************************************************************************
+* NAME: fnet_socket_buffer_take_record
+*
+* DESCRIPTION: This function removes up to "len" bytes from the stream 
+*              socket buffer and passes them to the application 
+*              as a net_buf chain, without copying. 
+*              If only a part of the buffer is taken, the returned 
+*              net_bufs share the data buffers with the socket buffer.
+*
+* RETURNS: The net_buf chain, or 0 if no free memory.
+*************************************************************************/
+fnet_netbuf_t *fnet_socket_buffer_take_record( fnet_socket_buffer_t *sb, fnet_size_t len )
+{
+    fnet_netbuf_t   *nb = 0;
+
+    fnet_isr_lock();
+
+    if(sb->net_buf_chain && len)
+    {
+        if(len >= sb->net_buf_chain->total_length)
+        {
+            /* Take the whole buffer.*/
+            len = sb->net_buf_chain->total_length;
+            nb = sb->net_buf_chain;
+            sb->net_buf_chain = 0;
+        }
+        else if((nb = fnet_netbuf_copy(sb->net_buf_chain, 0u, len, FNET_FALSE)) != 0)
+        {
+            fnet_netbuf_trim(&sb->net_buf_chain, (fnet_int32_t)len);
+        }
+        else
+        {}
+
+        if(nb)
+        {
+            sb->count -= len;
+        }
+    }
+
+    fnet_isr_unlock();
+
+    return nb;
+}
+
 /************************************************************************
 * NAME: fnet_socket_addr_check_len
 *
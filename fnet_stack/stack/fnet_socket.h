@@ -36,6 +36,7 @@
 #include "fnet.h"
 #include "fnet_ip.h"
 #include "fnet_ip6.h"
+#include "fnet_netbuf.h"
 
 /*! @addtogroup fnet_socket 
 * The Socket Application Program Interface (API) defines the way, in which the 
@@ -356,6 +357,20 @@ typedef enum
                              */
 } fnet_socket_state_t;
 
+/**************************************************************************/ /*!
+ * @brief TCP congestion control algorithms, 
+ * used by the @ref TCP_CONGESTION option.
+ ******************************************************************************/
+typedef enum
+{
+    TCP_CONGESTION_NEWRENO = (0),   /**< @brief NewReno (RFC5681, RFC6582). 
+                                     */
+    TCP_CONGESTION_CUBIC   = (1)    /**< @brief CUBIC (RFC8312).@n
+                                     *   It is avalable only if 
+                                     *   @ref FNET_CFG_TCP_CUBIC is set to @c 1.
+                                     */
+} fnet_tcp_congestion_t;
+
 /**************************************************************************/ /*!
  * @brief Protocol numbers and Level numbers for the @ref fnet_socket_setopt() 
  * and the @ref fnet_socket_getopt().
@@ -442,6 +457,9 @@ typedef enum
  *<td>@ref TCP_NODELAY</td><td>fnet_uint32_t</td><td>1</td><td>RW</td>
  *</tr>
  *<tr>
+ *<td>@ref TCP_CORK</td><td>fnet_uint32_t</td><td>0</td><td>RW</td>
+ *</tr>
+ *<tr>
  *<td>@ref TCP_FINRCVD</td><td>fnet_uint32_t</td><td>0</td><td>R</td>
  *</tr>
  *<tr>
@@ -457,6 +475,24 @@ typedef enum
  *<td>@ref TCP_KEEPCNT</td><td>fnet_uint32_t</td><td>8</td><td>RW</td>
  *</tr> 
  *<tr>
+ *<td>@ref TCP_RCVBUF_AUTO</td><td>fnet_uint32_t</td><td>1</td><td>RW</td>
+ *</tr> 
+ *<tr>
+ *<td>@ref TCP_CONGESTION</td><td>fnet_uint32_t</td><td>@ref FNET_CFG_TCP_CONGESTION</td><td>RW</td>
+ *</tr> 
+ *<tr>
+ *<td>@ref TCP_RTO_MIN</td><td>fnet_uint32_t</td><td>@ref FNET_CFG_TCP_RTO_MIN</td><td>RW</td>
+ *</tr> 
+ *<tr>
+ *<td>@ref TCP_RTO_MAX</td><td>fnet_uint32_t</td><td>@ref FNET_CFG_TCP_RTO_MAX</td><td>RW</td>
+ *</tr> 
+ *<tr>
+ *<td>@ref TCP_SYNCOOKIES_SENT</td><td>fnet_uint32_t</td><td>0</td><td>R</td>
+ *</tr> 
+ *<tr>
+ *<td>@ref TCP_SYNCOOKIES_VALID</td><td>fnet_uint32_t</td><td>0</td><td>R</td>
+ *</tr> 
+ *<tr>
  *<td>@ref IP_TOS</td><td>fnet_uint32_t</td><td>0</td><td>RW</td>
  *</tr>
  *<tr>
@@ -518,7 +554,11 @@ typedef enum
                                *   buffer size for output data.
                                */
     SO_RCVBUF, /**< @brief This option defines the maximum per-socket 
-                               *   buffer size for input data.
+                               *   buffer size for input data.@n
+                               *   For TCP, it is also the maximum receive window
+                               *   of the connection. If it is greater than 64KB, the window 
+                               *   scale option is used. It must be set before 
+                               *   the connection is established.
                                */
     SO_STATE, /**< @brief This option defines the current state of the socket.@n
                                *   This is the read-only option and it is defined by the @ref fnet_socket_state_t type.
@@ -588,6 +628,14 @@ typedef enum
                              *   But for some applications this algorithm can impede 
                              *   performance, especially for a bulky data transfer.
                              */
+    TCP_CORK,      /**< @brief If this option is set to @c 1, partial segments 
+                             *   are not sent. Only full-size segments are sent, 
+                             *   until the option is cleared, the socket is shut down for sending, 
+                             *   or the retransmission timeout passes.@n
+                             *   Clearing the option sends the pending data immediately.@n
+                             *   It allows to combine several small writes 
+                             *   (for example, a header and a body) into one segment.
+                             */
     TCP_FINRCVD,   /**< @brief This option is set when the final (FIN) segment arrives. @n 
                              *   This option indicates that another side will not send any data 
                              *   in the current connection.@n
@@ -622,6 +670,46 @@ typedef enum
                              *   @ref TCP_KEEPCNT option can be used to affect this value for a given socket,
                              *   and specifies the maximum number of keepalive probes to be sent.
                              */  
+    TCP_RCVBUF_AUTO, /**< @brief If this option is set to @c 1 (default value), 
+                             *   the receive window starts at @ref FNET_CFG_TCP_RCVBUF_AUTO_INIT 
+                             *   and grows towards the measured bandwidth-delay product, 
+                             *   up to the @ref SO_RCVBUF value.@n
+                             *   If this option is set to @c 0, the receive window 
+                             *   is defined by the @ref SO_RCVBUF value.@n
+                             *   It must be set before the connection is established.@n
+                             *   This option is avalable only if 
+                             *   @ref FNET_CFG_TCP_RCVBUF_AUTO is set to @c 1.
+                             */
+    TCP_CONGESTION, /**< @brief This option selects the congestion control 
+                             *   algorithm of the socket. It is defined 
+                             *   by the @ref fnet_tcp_congestion_t type.@n
+                             *   The default value is defined by 
+                             *   @ref FNET_CFG_TCP_CONGESTION.
+                             */
+    TCP_RTO_MIN,    /**< @brief This option specifies the lower bound of the 
+                             *   retransmission timeout, in milliseconds.@n
+                             *   It must not be greater than the @ref TCP_RTO_MAX value.@n
+                             *   The default value is defined by 
+                             *   @ref FNET_CFG_TCP_RTO_MIN.
+                             */
+    TCP_RTO_MAX,    /**< @brief This option specifies the upper bound of the 
+                             *   retransmission timeout, in milliseconds. 
+                             *   The retransmission timeout is doubled after each timeout 
+                             *   up to this value.@n
+                             *   It must not be less than the @ref TCP_RTO_MIN value.@n
+                             *   The default value is defined by 
+                             *   @ref FNET_CFG_TCP_RTO_MAX.
+                             */
+    TCP_SYNCOOKIES_SENT,  /**< @brief This option returns the number of SYN cookies 
+                             *   sent by the listening socket.@n
+                             *   This option is avalable only if 
+                             *   @ref FNET_CFG_TCP_SYN_COOKIES is set to @c 1.
+                             */
+    TCP_SYNCOOKIES_VALID, /**< @brief This option returns the number of connections 
+                             *   created by the listening socket from valid SYN cookies.@n
+                             *   This option is avalable only if 
+                             *   @ref FNET_CFG_TCP_SYN_COOKIES is set to @c 1.
+                             */
 
     /* IPv4 level (IPPROTO_IP) options */
 
@@ -703,9 +791,13 @@ typedef enum
     MSG_PEEK      = (0x2U),  /**< @brief Receive a copy of the 
                              * data without consuming it.
                              */
-    MSG_DONTROUTE = (0x4U)   /**< @brief Send without using 
+    MSG_DONTROUTE = (0x4U),  /**< @brief Send without using 
                              * routing tables.
                              */
+    MSG_MORE      = (0x8U)   /**< @brief The caller has more data to send. @n
+                             *   The partial TCP segment is held 
+                             *   (as if @ref TCP_CORK is set) until the next call without this flag.
+                             */
 } fnet_msg_flags_t;
 
 /**************************************************************************/ /*!
@@ -724,6 +816,50 @@ typedef enum
                                      */
 } fnet_sd_flags_t;
 
+/**************************************************************************/ /*!
+ * @brief The readiness flags used by @ref fnet_socket_poll().
+ *
+ * They can be combined by using the bitwise OR.
+ ******************************************************************************/
+typedef enum
+{
+    FNET_SOCKET_POLL_READ  = (0x1U), /**< @brief Data can be received without blocking. @n
+                                      * It is also set for a listening socket with a pending 
+                                      * connection, and when the peer has closed the connection
+                                      * (the next @ref fnet_socket_recv() returns @c 0 or an error).
+                                      */
+    FNET_SOCKET_POLL_WRITE = (0x2U), /**< @brief Data can be sent, there is free space 
+                                      * in the socket send buffer.
+                                      */
+    FNET_SOCKET_POLL_ERROR = (0x4U)  /**< @brief The socket has a pending error 
+                                      * (see the @ref SO_ERROR option). @n
+                                      * It is always reported, even if not requested.
+                                      */
+} fnet_socket_poll_flags_t;
+
+/**************************************************************************/ /*!
+ * @brief Socket descriptor entry used by @ref fnet_socket_poll().
+ ******************************************************************************/
+typedef struct
+{
+    fnet_socket_t   s;          /**< @brief Socket descriptor to be checked. */
+    fnet_flag_t     events;     /**< @brief Requested events, defined by @ref fnet_socket_poll_flags_t. */
+    fnet_flag_t     revents;    /**< @brief Returned events, set by @ref fnet_socket_poll(). */
+} fnet_socket_poll_desc_t;
+
+/**************************************************************************/ /*!
+ * @brief Socket readiness callback function prototype.
+ *
+ * @param s         Socket descriptor.
+ *
+ * @param events    Newly raised events, defined by @ref fnet_socket_poll_flags_t.
+ *
+ * @param cookie    Callback-handler specific parameter.
+ *
+ * @see fnet_socket_set_callback()
+ ******************************************************************************/
+typedef void(*fnet_socket_callback_t)(fnet_socket_t s, fnet_flag_t events, void *cookie);
+
 #if defined(__cplusplus)
 extern "C" {
 #endif
@@ -1152,6 +1288,116 @@ fnet_int32_t fnet_socket_send( fnet_socket_t s, fnet_uint8_t *buf, fnet_size_t l
  ******************************************************************************/
 fnet_int32_t fnet_socket_sendto( fnet_socket_t s, fnet_uint8_t *buf, fnet_size_t len, fnet_flag_t flags, const struct sockaddr *to, fnet_size_t tolen );
 
+/***************************************************************************/ /*!
+ *
+ * @brief    Sends the net_buf chain to a specific destination, without copying.
+ *
+ *
+ * @param s      Descriptor identifying a socket.
+ *
+ * @param nb     Net_buf chain containing the data to be transmitted. @n
+ *               It should be allocated by @ref fnet_netbuf_new_headroom() 
+ *               with @ref FNET_CFG_NETBUF_HEADROOM, or received by 
+ *               @ref fnet_socket_recv_netbuf().
+ *
+ * @param flags  Optional flag specifying the way, in which the call is made. 
+ *               It can be constructed by using the bitwise OR operator with
+ *               any of the values defined by the @ref fnet_msg_flags_t, 
+ *               except the @ref MSG_OOB.
+ *
+ * @param to     Optional pointer to the address of the target socket.
+ *
+ * @param tolen  Size of the address in @c to.
+ *
+ *
+ * @return This function returns:
+ *   - The total number of bytes sent, if no error occurs. @n
+ *     The chain is owned by the stack.
+ *   - Zero, if there is no free space in the output buffer 
+ *     of a stream socket (@ref SOCK_STREAM). @n
+ *     The chain is still owned by the application, 
+ *     and it can be sent again later.
+ *   - @ref FNET_ERR if an error occurs. @n 
+ *     The chain is freed by the stack. @n
+ *     The specific error code can be retrieved using the @ref fnet_error_get().
+ *
+ * @see fnet_socket_sendto(), fnet_socket_recv_netbuf()
+ *
+ ******************************************************************************
+ *
+ * This function is the zero-copy equivalent of @ref fnet_socket_sendto().@n
+ * The application builds the data directly in the net_bufs and 
+ * hands them over to the stack, so the data is not copied to 
+ * the stack buffers. The protocol headers are prepended in the headroom 
+ * of the first net_buf, if it is not shared with another net_buf chain.@n
+ * @n
+ * For stream-oriented sockets (@ref SOCK_STREAM), the chain is 
+ * added to the output buffer only as a whole.@n
+ * For message-oriented sockets (@ref SOCK_DGRAM), the chain is sent 
+ * as one datagram. A zero-length datagram is sent by 
+ * @ref fnet_socket_sendto().@n
+ * @n
+ * The application must not access the chain after it is owned by the stack.
+ *
+ ******************************************************************************/
+fnet_int32_t fnet_socket_send_netbuf( fnet_socket_t s, fnet_netbuf_t *nb, fnet_flag_t flags, const struct sockaddr *to, fnet_size_t tolen );
+
+/***************************************************************************/ /*!
+ *
+ * @brief    Receives the data as a net_buf chain, without copying, 
+ *           and captures the address, from which the data was sent.
+ *
+ *
+ * @param s         Descriptor identifying a bound socket.
+ *
+ * @param nb_ptr    Pointer to the net_buf chain pointer, which is set 
+ *                  to the received data. @n
+ *                  It is set to @c 0, if no data is received.
+ *
+ * @param len       Maximal length of the received data.
+ *
+ * @param flags     Optional flag specifying the way, in which the call is made. 
+ *                  It can be constructed by using the bitwise OR operator with
+ *                  any of the values defined by the @ref fnet_msg_flags_t, 
+ *                  except the @ref MSG_OOB and @ref MSG_PEEK.
+ *
+ * @param from      Optional pointer to a buffer that will hold the 
+ *                  source address upon return.
+ *
+ * @param fromlen   Optional pointer to the size of the @c from buffer.
+ *
+ *
+ * @return This function returns:
+ *   - The number of bytes received, if no error occurs. 
+ *     The return value is set to zero, if there
+ *     is no input data.
+ *   - @ref FNET_ERR if an error occurs. @n 
+ *     The specific error code can be retrieved using the @ref fnet_error_get().
+ *
+ * @see fnet_socket_recvfrom(), fnet_socket_send_netbuf()
+ *
+ ******************************************************************************
+ *
+ * This function is the zero-copy equivalent of @ref fnet_socket_recvfrom().@n
+ * The received net_bufs are passed to the application, instead of copying 
+ * the data to the application buffer. The data of a net_buf chain can be 
+ * non-contiguous, the @c data_ptr and @c length fields of every net_buf 
+ * in the chain, linked by the @c next field, describe its parts.@n
+ * The application owns the chain and it must free it by 
+ * @ref fnet_netbuf_free_chain(), or pass it to @ref fnet_socket_send_netbuf(). 
+ * The chain holds the memory of the received frames, so it should 
+ * be released early.@n
+ * @n
+ * For stream-oriented sockets (@ref SOCK_STREAM), up to @c len bytes 
+ * are received.@n
+ * For message-oriented sockets (@ref SOCK_DGRAM), the first enqueued 
+ * datagram is received. If the datagram is larger than @c len, 
+ * the function generates the error @ref FNET_ERR_MSGSIZE, 
+ * and the datagram is lost.
+ *
+ ******************************************************************************/
+fnet_int32_t fnet_socket_recv_netbuf( fnet_socket_t s, fnet_netbuf_t **nb_ptr, fnet_size_t len, fnet_flag_t flags, struct sockaddr *from, fnet_size_t *fromlen );
+
 /***************************************************************************/ /*!
  *
  * @brief    Terminates the connection in one or both directions.
@@ -1357,6 +1603,81 @@ fnet_return_t fnet_socket_getpeername( fnet_socket_t s, struct sockaddr *name, f
  ******************************************************************************/
 fnet_return_t fnet_socket_getname( fnet_socket_t s, struct sockaddr *name, fnet_size_t *namelen );
 
+/***************************************************************************/ /*!
+ *
+ * @brief    Checks the readiness of several sockets in one call.
+ *
+ *
+ * @param desc      Array of socket descriptor entries. @n
+ *                  The @c revents field of every entry is set by this function.
+ *
+ * @param desc_num  Number of entries in the @c desc array.
+ *
+ *
+ * @return This function returns the number of entries with 
+ *         non-zero @c revents. @n
+ *         It returns @c 0 if no socket is ready.
+ *
+ * @see fnet_socket_poll_flags_t
+ *
+ ******************************************************************************
+ *
+ * This function reports, which of the sockets listed in the @c desc array 
+ * are readable, writable or have a pending error. @n
+ * The readiness of every socket is kept by the stack, when its buffers, 
+ * connection state or error change, so the cost of this call does not depend
+ * on the amount of queued data. @n
+ * An entry with an invalid descriptor gets @ref FNET_SOCKET_POLL_ERROR.@n
+ * The function is non-blocking, and returns immediately. 
+ * An application polls the set from its main loop 
+ * (for example from a service registered by @ref fnet_poll_service_register()), 
+ * instead of calling @ref fnet_socket_recv() on every socket.
+ *
+ ******************************************************************************/
+fnet_size_t fnet_socket_poll( fnet_socket_poll_desc_t *desc, fnet_size_t desc_num );
+
+/***************************************************************************/ /*!
+ *
+ * @brief    Registers the readiness callback of a socket.
+ *
+ *
+ * @param s         Descriptor identifying a socket.
+ *
+ * @param callback  Pointer to the callback function, defined by 
+ *                  @ref fnet_socket_callback_t. @n
+ *                  @c 0 unregisters the callback.
+ *
+ * @param cookie    Optional application-specific parameter. @n 
+ *                  It's passed to the @c callback function as input parameter.
+ *
+ *
+ * @return This function returns:
+ *   - @ref FNET_OK if no error occurs.
+ *   - @ref FNET_ERR if an error occurs. @n 
+ *     The specific error code can be retrieved using the @ref fnet_error_get().
+ *
+ * @see fnet_socket_poll()
+ *
+ ******************************************************************************
+ *
+ * This function registers the @c callback function, which is called 
+ * when the socket becomes readable, writable or gets an error, 
+ * that is when data arrive, send buffer space is freed, a connection 
+ * is completed or accepted, the peer closes the connection or 
+ * an error occurs. @n
+ * Only newly raised events are passed. The events that are already 
+ * pending at registration are passed once, by this function. @n
+ * Sockets created by @ref fnet_socket_accept() inherit the callback 
+ * of the listening socket. The events raised while the connection 
+ * waited in the accept queue are passed once, by @ref fnet_socket_accept(). @n
+ * The callback is called from the stack context, which may be an 
+ * interrupt handler. It must be short and must not call the socket API. 
+ * With an RTOS, it is intended to signal an event or semaphore,
+ * that an application task is blocked on.
+ *
+ ******************************************************************************/
+fnet_return_t fnet_socket_set_callback( fnet_socket_t s, fnet_socket_callback_t callback, void *cookie );
+
 /***************************************************************************/ /*!
  *
  * @brief    Compares socket addresses.
@@ -68,6 +68,8 @@ typedef struct
     fnet_size_t     count;              /**< Aactual chars in buffer.*/
     fnet_size_t     count_max;          /**< Max actual char count (9*1024).*/
     fnet_netbuf_t   *net_buf_chain;     /**< The net_buf chain.*/
+    fnet_netbuf_t   *net_buf_tail;      /**< The last net_buf (stream data) or the last chain (datagrams), valid if net_buf_chain is not 0.*/
+    fnet_size_t     record_num;         /**< Number of queued datagrams.*/
     fnet_bool_t     is_shutdown;        /**< The socket has been shut down for read/write.*/    
 } fnet_socket_buffer_t;
 
@@ -128,6 +130,7 @@ typedef struct _fnet_socket_if_t
     fnet_size_t             incoming_con_len;       /**< Number of connections on incoming_con.*/
     fnet_size_t             con_limit;              /**< Max number queued connections (specified  by "listen").*/
     struct _fnet_socket_if_t   *head_con;              /**< Back pointer to accept socket.*/
+    struct _fnet_socket_if_t   *hash_next;             /**< Next socket in the protocol lookup-table bucket.*/
 
     fnet_socket_buffer_t    receive_buffer;         /**< Socket buffer for incoming data.*/
     fnet_socket_buffer_t    send_buffer;            /**< Socket buffer for outgoing data.*/
@@ -136,6 +139,9 @@ typedef struct _fnet_socket_if_t
     struct sockaddr         foreign_addr;           /**< Foreign socket address.*/
     struct sockaddr         local_addr;             /**< Lockal socket address.*/
     fnet_socket_option_t    options;                /**< Collection of socket options.*/
+    fnet_flag_t             poll_events;            /**< Current readiness (FNET_SOCKET_POLL_xxx), kept by fnet_socket_poll_update().*/
+    fnet_socket_callback_t  callback;               /**< Readiness callback (optional).*/
+    void                    *callback_cookie;       /**< Readiness callback parameter.*/
     
 #if FNET_CFG_MULTICAST 
     /* Multicast params.*/
@@ -166,6 +172,9 @@ typedef struct fnet_socket_prot_if
     fnet_return_t  (*prot_setsockopt)(fnet_socket_if_t *sk, fnet_protocol_t level, fnet_socket_options_t optname, const void *optval, fnet_size_t optlen);       /* Protocol "setsockopt" function. */
     fnet_return_t  (*prot_getsockopt)(fnet_socket_if_t *sk, fnet_protocol_t level, fnet_socket_options_t optname, void *optval, fnet_size_t *optlen);            /* Protocol "getsockopt" function. */
     fnet_return_t  (*prot_listen)(fnet_socket_if_t *sk, fnet_size_t backlog);                                                      /* Protocol "listen" function.*/
+    fnet_flag_t    (*prot_poll)(fnet_socket_if_t *sk);                                                                         /* Protocol "poll" function (optional).*/
+    fnet_int32_t  (*prot_rcv_netbuf)(fnet_socket_if_t *sk, fnet_netbuf_t **nb_ptr, fnet_size_t len, fnet_flag_t flags, struct sockaddr *foreign_addr );   /* Protocol zero-copy "receive" function (optional).*/
+    fnet_int32_t  (*prot_snd_netbuf)(fnet_socket_if_t *sk, fnet_netbuf_t *nb, fnet_flag_t flags, const struct sockaddr *foreign_addr );            /* Protocol zero-copy "send" function (optional).*/
 } fnet_socket_prot_if_t;
 
 /************************************************************************
@@ -179,15 +188,22 @@ void fnet_socket_init( void );
 void fnet_socket_list_add( fnet_socket_if_t ** head, fnet_socket_if_t *s );
 void fnet_socket_list_del( fnet_socket_if_t ** head, fnet_socket_if_t *s );
 void fnet_socket_set_error( fnet_socket_if_t *sock, fnet_error_t error );
-fnet_socket_if_t *fnet_socket_lookup( fnet_socket_if_t *head,  struct sockaddr *local_addr, struct sockaddr *foreign_addr, fnet_uint32_t protocol_number);
-fnet_uint16_t  fnet_socket_get_uniqueport(fnet_socket_if_t *head, struct sockaddr *local_addr);
-fnet_bool_t fnet_socket_conflict( fnet_socket_if_t *head,  const struct sockaddr *local_addr, const struct sockaddr *foreign_addr /*optional*/, fnet_bool_t wildcard );
+void fnet_socket_poll_update( fnet_socket_if_t *sock );
+fnet_socket_if_t *fnet_socket_lookup( struct fnet_prot_if *prot,  struct sockaddr *local_addr, struct sockaddr *foreign_addr, fnet_uint32_t protocol_number);
+fnet_uint16_t  fnet_socket_get_uniqueport(struct fnet_prot_if *prot, struct sockaddr *local_addr);
+fnet_bool_t fnet_socket_conflict( struct fnet_prot_if *prot,  const struct sockaddr *local_addr, const struct sockaddr *foreign_addr /*optional*/, fnet_bool_t wildcard );
+void fnet_socket_hash_add( fnet_socket_if_t *sock );
+void fnet_socket_hash_del( fnet_socket_if_t *sock );
+fnet_socket_if_t *fnet_socket_hash_head( struct fnet_prot_if *prot, fnet_uint16_t port );
 fnet_socket_if_t *fnet_socket_copy( fnet_socket_if_t *sock );
 void fnet_socket_release( fnet_socket_if_t ** head, fnet_socket_if_t *sock );
 fnet_return_t fnet_socket_buffer_append_address( fnet_socket_buffer_t *sb, fnet_netbuf_t *nb, struct sockaddr *addr);
 fnet_return_t fnet_socket_buffer_append_record( fnet_socket_buffer_t *sb, fnet_netbuf_t *nb );
+void fnet_socket_buffer_concat( fnet_socket_buffer_t *sb, fnet_netbuf_t *nb );
 fnet_int32_t fnet_socket_buffer_read_address( fnet_socket_buffer_t *sb, fnet_uint8_t *buf, fnet_size_t len, struct sockaddr *foreign_addr, fnet_bool_t remove );
 fnet_size_t fnet_socket_buffer_read_record( fnet_socket_buffer_t *sb, fnet_uint8_t *buf, fnet_size_t len, fnet_bool_t remove );
+fnet_int32_t fnet_socket_buffer_take_address( fnet_socket_buffer_t *sb, fnet_netbuf_t **nb_ptr, fnet_size_t len, struct sockaddr *foreign_addr );
+fnet_netbuf_t *fnet_socket_buffer_take_record( fnet_socket_buffer_t *sb, fnet_size_t len );
 void fnet_socket_buffer_release( fnet_socket_buffer_t *sb );
 fnet_return_t fnet_ip_setsockopt( fnet_socket_if_t *sock, fnet_protocol_t level, fnet_socket_options_t optname, const void *optval, fnet_size_t optlen );
 fnet_return_t fnet_ip_getsockopt( fnet_socket_if_t *sock, fnet_protocol_t level, fnet_socket_options_t optname, void *optval, fnet_size_t *optlen );
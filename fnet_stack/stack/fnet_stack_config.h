@@ -410,6 +410,20 @@
     #define FNET_CFG_LOOPBACK_MTU           (1576U)
 #endif
 
+/**************************************************************************/ /*!
+ * @def      FNET_CFG_LOOPBACK_DELAY_QUEUE
+ * @brief    Maximal number of packets delayed by the Loopback interface.@n
+ *           If it is non-zero, the outgoing loopback packets can be 
+ *           delayed by fnet_loop_set_delay() in order to simulate 
+ *           a path with the round trip time (used by benchmarks only).@n
+ *           Default value is @b @c 0 (the delay is not supported).
+ * @see FNET_CFG_LOOPBACK
+ * @showinitializer 
+ ******************************************************************************/
+#ifndef FNET_CFG_LOOPBACK_DELAY_QUEUE
+    #define FNET_CFG_LOOPBACK_DELAY_QUEUE   (0U)
+#endif
+
 /**************************************************************************/ /*!
  * @def      FNET_CFG_DEFAULT_IF
  * @brief    Descriptor of a default network interface set during stack initialisation.@n
@@ -510,6 +524,256 @@
     #define FNET_CFG_TCP_DISCARD_OUT_OF_ORDER   (0)
 #endif
 
+/**************************************************************************/ /*!
+ * @def      FNET_CFG_TCP_REASS_INTERVALS
+ * @brief    Maximum number of separate blocks of out-of-order data, 
+ *           kept by a TCP connection.@n
+ *           Adjacent and overlapping segments are merged into one block.
+ *           If a new block does not fit, the block with the highest
+ *           sequence number is dropped to make room for it, 
+ *           or the new segment is dropped.@n
+ *           It is used only if @ref FNET_CFG_TCP_DISCARD_OUT_OF_ORDER is @c 0. @n
+ *           Default value is @b @c 8.
+ * @showinitializer 
+ ******************************************************************************/
+#ifndef FNET_CFG_TCP_REASS_INTERVALS
+    #define FNET_CFG_TCP_REASS_INTERVALS        (8U)
+#endif
+
+/**************************************************************************/ /*!
+ * @def      FNET_CFG_TCP_SACK
+ * @brief    TCP Selective Acknowledgment (SACK) option, defined by RFC2018:
+ *               - @b @c 1 = is enabled (Default value).@n
+ *                 The SACK-permitted option is negotiated during 
+ *                 the connection establishment. 
+ *                 The sender retransmits only the data reported as missing 
+ *                 by the SACK blocks of another side.
+ *                 The receiver reports its out-of-order data in SACK blocks,
+ *                 if @ref FNET_CFG_TCP_DISCARD_OUT_OF_ORDER is @c 0.
+ *               - @c 0 = is disabled.@n
+ * @showinitializer 
+ ******************************************************************************/
+#ifndef FNET_CFG_TCP_SACK
+    #define FNET_CFG_TCP_SACK                   (1)
+#endif
+
+/**************************************************************************/ /*!
+ * @def      FNET_CFG_TCP_TIMESTAMPS
+ * @brief    TCP Timestamps option, defined by RFC7323:
+ *               - @b @c 1 = is enabled (Default value).@n
+ *                 The Timestamps option is negotiated during 
+ *                 the connection establishment and is sent in every
+ *                 segment. The round trip time is measured on every 
+ *                 acknowledgment, and old duplicate segments are rejected 
+ *                 by the PAWS mechanism.@n
+ *                 The timestamp clock has millisecond units. 
+ *                 It has millisecond granularity if the hardware timer 
+ *                 provides it (@ref FNET_CFG_CPU_TIMER_FINE), otherwise 
+ *                 it advances with the stack timer, i.e. with the granularity 
+ *                 of @ref FNET_TIMER_PERIOD_MS (100 ms), and a round trip 
+ *                 time shorter than the timer period is measured as 
+ *                 0 or one period.
+ *               - @c 0 = is disabled.@n
+ * @showinitializer 
+ ******************************************************************************/
+#ifndef FNET_CFG_TCP_TIMESTAMPS
+    #define FNET_CFG_TCP_TIMESTAMPS             (1)
+#endif
+
+/**************************************************************************/ /*!
+ * @def      FNET_CFG_TCP_RCVBUF_AUTO
+ * @brief    TCP receive buffer auto-tuning:
+ *               - @c 1 = is enabled.@n
+ *                 The receive window of a new connection starts at 
+ *                 @ref FNET_CFG_TCP_RCVBUF_AUTO_INIT and grows towards twice
+ *                 the amount of data received during one round trip time 
+ *                 (bandwidth-delay product). 
+ *                 The @ref SO_RCVBUF socket option defines the upper limit. 
+ *                 At runtime, it can be switched off for a socket
+ *                 by the @ref TCP_RCVBUF_AUTO socket option.
+ *               - @b @c 0 = is disabled (Default value).@n
+ *                 The receive window is defined by the @ref SO_RCVBUF
+ *                 socket option.
+ * @showinitializer 
+ ******************************************************************************/
+#ifndef FNET_CFG_TCP_RCVBUF_AUTO
+    #define FNET_CFG_TCP_RCVBUF_AUTO            (0)
+#endif
+
+/**************************************************************************/ /*!
+ * @def      FNET_CFG_TCP_RCVBUF_AUTO_INIT
+ * @brief    Initial receive window of a connection, if the receive buffer 
+ *           auto-tuning is enabled (@ref FNET_CFG_TCP_RCVBUF_AUTO).@n
+ *           Default value is @b @c 4096.
+ * @showinitializer 
+ ******************************************************************************/
+#ifndef FNET_CFG_TCP_RCVBUF_AUTO_INIT
+    #define FNET_CFG_TCP_RCVBUF_AUTO_INIT       (4U * 1024U)
+#endif
+
+/**************************************************************************/ /*!
+ * @def      FNET_CFG_TCP_CUBIC
+ * @brief    CUBIC congestion control algorithm (RFC8312):
+ *               - @b @c 1 = is included (Default value).@n
+ *                 It can be selected by the @ref TCP_CONGESTION socket option.
+ *               - @c 0 = is excluded. Only NewReno is available.
+ * @showinitializer 
+ ******************************************************************************/
+#ifndef FNET_CFG_TCP_CUBIC
+    #define FNET_CFG_TCP_CUBIC                  (1)
+#endif
+
+/**************************************************************************/ /*!
+ * @def      FNET_CFG_TCP_CONGESTION
+ * @brief    Default congestion control algorithm of TCP sockets:
+ *               - @b @c 0 = NewReno (@ref TCP_CONGESTION_NEWRENO) (Default value).
+ *               - @c 1 = CUBIC (@ref TCP_CONGESTION_CUBIC). 
+ *                 It requires @ref FNET_CFG_TCP_CUBIC to be set to @c 1.
+ *
+ *           It can be changed for a socket by the @ref TCP_CONGESTION socket option.
+ * @showinitializer 
+ ******************************************************************************/
+#ifndef FNET_CFG_TCP_CONGESTION
+    #define FNET_CFG_TCP_CONGESTION             (0)
+#endif
+
+/**************************************************************************/ /*!
+ * @def      FNET_CFG_TCP_RTO_MIN
+ * @brief    Default lower bound of the TCP retransmission timeout, 
+ *           in milliseconds.@n
+ *           The timers of TCP connections are checked every 
+ *           @ref FNET_TIMER_PERIOD_MS.@n
+ *           It can be changed for a socket by the @ref TCP_RTO_MIN socket option.@n
+ *           Default value is @b @c 200.
+ * @showinitializer 
+ ******************************************************************************/
+#ifndef FNET_CFG_TCP_RTO_MIN
+    #define FNET_CFG_TCP_RTO_MIN                (200U)
+#endif
+
+/**************************************************************************/ /*!
+ * @def      FNET_CFG_TCP_RTO_MAX
+ * @brief    Default upper bound of the TCP retransmission timeout, 
+ *           in milliseconds.@n
+ *           It can be changed for a socket by the @ref TCP_RTO_MAX socket option.@n
+ *           Default value is @b @c 60000.
+ * @showinitializer 
+ ******************************************************************************/
+#ifndef FNET_CFG_TCP_RTO_MAX
+    #define FNET_CFG_TCP_RTO_MAX                (60000U)
+#endif
+
+/**************************************************************************/ /*!
+ * @def      FNET_CFG_TCP_TLP
+ * @brief    TCP Tail Loss Probe and time-based loss detection:
+ *               - @b @c 1 = is enabled (Default value).@n
+ *                 If no acknowledgment arrives within about two smoothed 
+ *                 round trip times, the last sent segment is retransmitted 
+ *                 as a probe, so a tail loss is repaired by the fast recovery 
+ *                 instead of the retransmission timeout.
+ *                 The first unacknowledged segment is considered lost, if it is not 
+ *                 acknowledged within a quarter of the round trip time 
+ *                 after a repeated acknowledgment, 
+ *                 without waiting for three repeated acknowledgments.
+ *               - @c 0 = is disabled.@n
+ * @showinitializer 
+ ******************************************************************************/
+#ifndef FNET_CFG_TCP_TLP
+    #define FNET_CFG_TCP_TLP                    (1)
+#endif
+
+/**************************************************************************/ /*!
+ * @def      FNET_CFG_TCP_SYN_BACKLOG
+ * @brief    Maximum number of half-open (SYN received) connections 
+ *           of a listening TCP socket.@n
+ *           When it is reached, new connection requests are answered 
+ *           with SYN cookies (if @ref FNET_CFG_TCP_SYN_COOKIES is set) 
+ *           or dropped.@n
+ *           Default value is @b @c 8.
+ * @showinitializer 
+ ******************************************************************************/
+#ifndef FNET_CFG_TCP_SYN_BACKLOG
+    #define FNET_CFG_TCP_SYN_BACKLOG            (8U)
+#endif
+
+/**************************************************************************/ /*!
+ * @def      FNET_CFG_TCP_SYN_COOKIES
+ * @brief    TCP SYN cookies:
+ *               - @b @c 1 = is enabled (Default value).@n
+ *                 If the half-open connection queue of a listening socket 
+ *                 is full, the connection state is encoded into the initial 
+ *                 sequence number of the SYN-ACK segment, and the connection 
+ *                 is created only when a valid acknowledgment arrives.
+ *                 The window scale, SACK and timestamps options are not 
+ *                 negotiated for such connections.
+ *                 An acknowledgment is checked as a SYN cookie only within 
+ *                 two cookie periods (128 seconds) after the listening socket 
+ *                 sent its last SYN cookie.
+ *                 The cookie is protected by a keyed hash (HalfSipHash).
+ *                 Its 64-bit secret key is created on the first use and 
+ *                 is changed every 256 seconds; the previous key is still 
+ *                 accepted.
+ *               - @c 0 = is disabled.@n
+ * @showinitializer 
+ ******************************************************************************/
+#ifndef FNET_CFG_TCP_SYN_COOKIES
+    #define FNET_CFG_TCP_SYN_COOKIES            (1)
+#endif
+
+/**************************************************************************/ /*!
+ * @def      FNET_CFG_TCP_TIMEWAIT_SIZE
+ * @brief    Number of compact TIME_WAIT records.@n
+ *           When a closed TCP socket enters the TIME_WAIT state, 
+ *           the socket and its control block are freed, and only 
+ *           the addresses, sequence numbers and expiration time of 
+ *           the connection are kept in a record of the static table.
+ *           The record acknowledges retransmitted final segments 
+ *           until the TIME_WAIT timeout expires.
+ *           The connection can not be reopened, and its local port 
+ *           is not selected as an ephemeral port, until the record expires.@n
+ *           If the table is full, the record that expires first is reused,
+ *           so its connection loses the TIME_WAIT protection early.
+ *           This trade-off bounds the memory used under a high connection
+ *           churn, the table should be sized to the expected number of
+ *           connections closed during the TIME_WAIT timeout.@n
+ *           If it is set to @c 0, the socket is kept allocated 
+ *           during the TIME_WAIT state.@n
+ *           Default value is @b @c 16.
+ * @showinitializer 
+ ******************************************************************************/
+#ifndef FNET_CFG_TCP_TIMEWAIT_SIZE
+    #define FNET_CFG_TCP_TIMEWAIT_SIZE          (16U)
+#endif
+
+/**************************************************************************/ /*!
+ * @def      FNET_CFG_TCP_SEND_COALESCE
+ * @brief    Coalescing of small writes in the TCP output buffer:
+ *               - @b @c 1 = is enabled (Default value).@n
+ *                 A net_buf of the output buffer, which is smaller than MSS,
+ *                 is allocated with MSS size, and the next writes fill 
+ *                 its spare space before a new net_buf is allocated.
+ *                 So the output buffer is a short chain of MSS-sized 
+ *                 net_bufs, regardless of the write size.
+ *               - @c 0 = is disabled. Every write gets its own net_buf.@n
+ * @showinitializer 
+ ******************************************************************************/
+#ifndef FNET_CFG_TCP_SEND_COALESCE
+    #define FNET_CFG_TCP_SEND_COALESCE          (1)
+#endif
+
+/**************************************************************************/ /*!
+ * @def      FNET_CFG_TCP_HASH_SIZE
+ * @brief    Number of buckets in each of the TCP socket lookup tables
+ *           (connections hashed by 4-tuple, listening sockets hashed by
+ *           local port).@n
+ *           It must be a power of two. @n
+ *           Default value is @b @c 16.
+ * @showinitializer 
+ ******************************************************************************/
+#ifndef FNET_CFG_TCP_HASH_SIZE
+    #define FNET_CFG_TCP_HASH_SIZE              (16U)
+#endif
+
 /**************************************************************************/ /*!
  * @def      FNET_CFG_TCP_URGENT
  * @brief    TCP "urgent" (out-of-band) data processing:
@@ -579,6 +843,83 @@
     #define FNET_CFG_HEAP_SIZE                  (50U * 1024U)
 #endif
 
+/**************************************************************************/ /*!
+ * @def      FNET_CFG_HEAP_SLAB
+ * @brief    Segregated size-class (slab) allocation in the FNET heap:
+ *               - @c 1 = is enabled. @n
+ *                 Fixed-size blocks for netbuf headers, socket and TCP
+ *                 control blocks, and MTU-sized data buffers are carved
+ *                 from the heap during initialization. They are allocated 
+ *                 and freed in constant time. If its class is exhausted, 
+ *                 a request takes a block of the next larger class, 
+ *                 up to twice its size. Other requests fall back 
+ *                 to the general heap.
+ *               - @b @c 0 = is disabled (Default value).@n
+ * @see FNET_CFG_HEAP_SLAB_NETBUF_NUM, FNET_CFG_HEAP_SLAB_SOCKET_NUM,
+ *      FNET_CFG_HEAP_SLAB_DATA_SIZE, FNET_CFG_HEAP_SLAB_DATA_NUM
+ * @showinitializer
+ ******************************************************************************/
+#ifndef FNET_CFG_HEAP_SLAB
+    #define FNET_CFG_HEAP_SLAB                  (0)
+#endif
+
+/**************************************************************************/ /*!
+ * @def      FNET_CFG_HEAP_SLAB_NETBUF_NUM
+ * @brief    Number of pre-allocated netbuf header blocks.@n
+ *           It is used only if @ref FNET_CFG_HEAP_SLAB is set to @c 1.
+ * @showinitializer
+ ******************************************************************************/
+#ifndef FNET_CFG_HEAP_SLAB_NETBUF_NUM
+    #define FNET_CFG_HEAP_SLAB_NETBUF_NUM       (32U)
+#endif
+
+/**************************************************************************/ /*!
+ * @def      FNET_CFG_HEAP_SLAB_SOCKET_NUM
+ * @brief    Number of pre-allocated socket control blocks 
+ *           (and TCP control blocks, if TCP is enabled).@n
+ *           It is used only if @ref FNET_CFG_HEAP_SLAB is set to @c 1.
+ * @showinitializer
+ ******************************************************************************/
+#ifndef FNET_CFG_HEAP_SLAB_SOCKET_NUM
+    #define FNET_CFG_HEAP_SLAB_SOCKET_NUM       (4U)
+#endif
+
+/**************************************************************************/ /*!
+ * @def      FNET_CFG_HEAP_SLAB_DATA_SIZE
+ * @brief    Size of a pre-allocated data block. @n
+ *           It should fit a full-size frame data buffer, including 
+ *           @ref FNET_CFG_NETBUF_HEADROOM.
+ *           It is used only if @ref FNET_CFG_HEAP_SLAB is set to @c 1.
+ * @showinitializer
+ ******************************************************************************/
+#ifndef FNET_CFG_HEAP_SLAB_DATA_SIZE
+    #define FNET_CFG_HEAP_SLAB_DATA_SIZE        (1600U)
+#endif
+
+/**************************************************************************/ /*!
+ * @def      FNET_CFG_HEAP_SLAB_DATA_NUM
+ * @brief    Number of pre-allocated data blocks.@n
+ *           It is used only if @ref FNET_CFG_HEAP_SLAB is set to @c 1.
+ * @showinitializer
+ ******************************************************************************/
+#ifndef FNET_CFG_HEAP_SLAB_DATA_NUM
+    #define FNET_CFG_HEAP_SLAB_DATA_NUM         (4U)
+#endif
+
+/**************************************************************************/ /*!
+ * @def      FNET_CFG_NETBUF_HEADROOM
+ * @brief    Number of bytes reserved in front of the payload of a net_buf 
+ *           allocated by the transport layers for outgoing packets.@n
+ *           Lower-layer headers (UDP, IPv4, IPv6 and the IPv6 Fragment header)
+ *           are prepended in place into this space by @ref fnet_netbuf_push(), 
+ *           instead of allocating and chaining a separate net_buf per header.@n
+ *           Value @c 0 disables the headroom reservation.
+ * @showinitializer
+ ******************************************************************************/
+#ifndef FNET_CFG_NETBUF_HEADROOM
+    #define FNET_CFG_NETBUF_HEADROOM            (64U)
+#endif
+
 /**************************************************************************/ /*!
  * @def      FNET_CFG_SOCKET_MAX
  * @brief    Maximum number of sockets that can exist at the same time.
@@ -588,6 +929,18 @@
     #define FNET_CFG_SOCKET_MAX                 (10U)
 #endif
 
+/**************************************************************************/ /*!
+ * @def      FNET_CFG_SOCKET_PORT_HASH_SIZE
+ * @brief    Number of buckets in the local-port lookup tables of 
+ *           the UDP and RAW sockets.@n
+ *           It must be a power of two. @n
+ *           Default value is @b @c 16.
+ * @showinitializer
+ ******************************************************************************/
+#ifndef FNET_CFG_SOCKET_PORT_HASH_SIZE
+    #define FNET_CFG_SOCKET_PORT_HASH_SIZE      (16U)
+#endif
+
 /**************************************************************************/ /*!
  * @def      FNET_CFG_SOCKET_BSD_NAMES
  * @brief    BSD Socket API names:
@@ -705,6 +1058,37 @@
     #define FNET_CFG_IP_MAX_PACKET              (10U*1024U)  
 #endif
 
+/**************************************************************************/ /*!
+ * @def      FNET_CFG_CHECKSUM_LOW_WIDE
+ * @brief    Internet checksum calculation kernel:
+ *               - @c 1 = 32-bit word loads with an end-around carry 
+ *                 accumulator. It halves the number of memory loads on 
+ *                 32-bit cores. @n
+ *                 Data starting at an odd address falls back to 16-bit words.
+ *               - @b @c 0 = 16-bit word loads (Default value).@n
+ *           It is ignored if the kernel is overloaded by the platform 
+ *           assembly version (@c FNET_CFG_OVERLOAD_CHECKSUM_LOW).
+ * @showinitializer
+ ******************************************************************************/
+#ifndef FNET_CFG_CHECKSUM_LOW_WIDE
+    #define FNET_CFG_CHECKSUM_LOW_WIDE          (0)
+#endif
+
+/**************************************************************************/ /*!
+ * @def      FNET_CFG_CHECKSUM_COPY
+ * @brief    Fused copy-and-checksum of the socket send data:
+ *               - @b @c 1 = is enabled (Default value). @n
+ *                 User data is summed while it is copied into a net_buf. 
+ *                 The partial sum is cached in the net_buf descriptor and 
+ *                 reused by the UDP and TCP checksum calculation, 
+ *                 so the payload is not read a second time.
+ *               - @c 0 = is disabled.
+ * @showinitializer
+ ******************************************************************************/
+#ifndef FNET_CFG_CHECKSUM_COPY
+    #define FNET_CFG_CHECKSUM_COPY              (1)
+#endif
+
 /*****************************************************************************
  * Function Overload
  *****************************************************************************/
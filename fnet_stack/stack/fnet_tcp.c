@@ -60,10 +60,12 @@ struct fnet_tcp_segment
 /************************************************************************
 *     Function Prototypes
 *************************************************************************/
-static void fnet_tcp_slowtimo( fnet_uint32_t cookie );
-static void fnet_tcp_fasttimo( fnet_uint32_t cookie );
-static void fnet_tcp_slowtimosk( fnet_socket_if_t *sk );
-static void fnet_tcp_fasttimosk( fnet_socket_if_t *sk );
+static void fnet_tcp_timo( fnet_uint32_t cookie );
+static void fnet_tcp_deadline_check( void );
+static void fnet_tcp_deadline_add( fnet_time_t deadline );
+static void fnet_tcp_timosk( fnet_socket_if_t *sk, fnet_time_t now );
+static void fnet_tcp_settimer( fnet_time_t *timer, fnet_time_t timeout );
+static fnet_bool_t fnet_tcp_expired( fnet_time_t *timer, fnet_time_t now );
 static fnet_bool_t fnet_tcp_inputsk( fnet_socket_if_t *sk, fnet_netbuf_t *insegment, struct sockaddr *src_addr,  struct sockaddr *dest_addr);
 static void fnet_tcp_initconnection( fnet_socket_if_t *sk );
 static fnet_bool_t fnet_tcp_dataprocess( fnet_socket_if_t *sk, fnet_netbuf_t *insegment, fnet_flag_t *ackparam );
@@ -77,15 +79,63 @@ static void fnet_tcp_sendack( fnet_socket_if_t *sk );
 static void fnet_tcp_abortsk( fnet_socket_if_t *sk );
 static void fnet_tcp_setsynopt( fnet_socket_if_t *sk, fnet_uint8_t *options, fnet_uint8_t *optionlen );
 static void fnet_tcp_getsynopt( fnet_socket_if_t *sk );
+#if FNET_CFG_TCP_SYN_COOKIES
+static void fnet_tcp_cookie_sipround( fnet_uint32_t *v );
+static fnet_uint32_t fnet_tcp_cookie_keyedhash( const fnet_uint32_t *key, const fnet_uint32_t *data, fnet_size_t words );
+static void fnet_tcp_cookie_rekey( void );
+static fnet_uint32_t fnet_tcp_cookie_hash( fnet_index_t key_index, struct sockaddr *local_addr, struct sockaddr *foreign_addr, fnet_uint32_t isn, fnet_uint32_t param );
+static void fnet_tcp_cookie_send( fnet_socket_if_t *sk, fnet_netbuf_t *insegment, struct sockaddr *src_addr, struct sockaddr *dest_addr );
+static fnet_socket_if_t *fnet_tcp_cookie_check( fnet_socket_if_t *sk, fnet_netbuf_t *insegment, struct sockaddr *dest_addr );
+#endif
 static fnet_error_t fnet_tcp_addopt( fnet_netbuf_t *segment, fnet_size_t len, void *data );
 static void fnet_tcp_getopt( fnet_socket_if_t *sk, fnet_netbuf_t *segment );
 static fnet_uint32_t fnet_tcp_getsize( fnet_uint32_t pos1, fnet_uint32_t pos2 );
+#if FNET_CFG_TCP_SACK
+static fnet_uint8_t fnet_tcp_setsackopt( fnet_socket_if_t *sk, fnet_uint32_t *options );
+static void fnet_tcp_sack_add( fnet_tcp_control_t *cb, fnet_uint32_t left, fnet_uint32_t right );
+static void fnet_tcp_sack_ack( fnet_tcp_control_t *cb );
+static fnet_size_t fnet_tcp_sack_count( fnet_tcp_control_t *cb );
+static fnet_bool_t fnet_tcp_sack_retransmit( fnet_socket_if_t *sk );
+#endif
+#if FNET_CFG_TCP_TIMESTAMPS
+static fnet_uint8_t fnet_tcp_settimestampopt( fnet_uint32_t tsrecent, fnet_uint8_t *options );
+static fnet_uint8_t fnet_tcp_addtimestampopt( fnet_tcp_control_t *cb, fnet_uint32_t *tsoptions, void **options, fnet_uint8_t optlen );
+static fnet_bool_t fnet_tcp_paws( fnet_tcp_control_t *cb, fnet_uint8_t sgmtype );
+#endif
+static void fnet_tcp_rttupdate( fnet_socket_if_t *sk, fnet_time_t rtt );
+static void fnet_tcp_rexmtfirst( fnet_socket_if_t *sk );
+static void fnet_tcp_recovery( fnet_socket_if_t *sk );
+#if FNET_CFG_TCP_TLP
+static void fnet_tcp_tlpset( fnet_socket_if_t *sk );
+static void fnet_tcp_tlptimeo( fnet_socket_if_t *sk );
+#endif
+static const fnet_tcp_cc_t *fnet_tcp_cc_get( fnet_tcp_congestion_t congestion );
+static void fnet_tcp_newreno_init( fnet_tcp_control_t *cb );
+static void fnet_tcp_newreno_ack( fnet_tcp_control_t *cb, fnet_size_t size );
+static void fnet_tcp_newreno_loss( fnet_tcp_control_t *cb );
+static void fnet_tcp_newreno_rto( fnet_tcp_control_t *cb );
+static void fnet_tcp_newreno_idle( fnet_tcp_control_t *cb );
+#if FNET_CFG_TCP_CUBIC
+static void fnet_tcp_cubic_init( fnet_tcp_control_t *cb );
+static void fnet_tcp_cubic_ack( fnet_tcp_control_t *cb, fnet_size_t size );
+static void fnet_tcp_cubic_loss( fnet_tcp_control_t *cb );
+static void fnet_tcp_cubic_rto( fnet_tcp_control_t *cb );
+static void fnet_tcp_cubic_idle( fnet_tcp_control_t *cb );
+static fnet_uint32_t fnet_tcp_cubic_cbrt( fnet_uint32_t x );
+#endif
+#if FNET_CFG_TCP_RCVBUF_AUTO
+static void fnet_tcp_rcvbuf_auto( fnet_tcp_control_t *cb );
+#endif
 static void fnet_tcp_rtimeo( fnet_socket_if_t *sk );
 static void fnet_tcp_ktimeo( fnet_socket_if_t *sk );
 static void fnet_tcp_ptimeo( fnet_socket_if_t *sk );
 static fnet_bool_t fnet_tcp_hit( fnet_uint32_t startpos, fnet_uint32_t endpos, fnet_uint32_t pos );
 static fnet_bool_t fnet_tcp_addinpbuf( fnet_socket_if_t *sk, fnet_netbuf_t *insegment, fnet_flag_t *ackparam );
 static fnet_socket_if_t *fnet_tcp_findsk( struct sockaddr *src_addr,  struct sockaddr *dest_addr );
+static fnet_index_t fnet_tcp_hash_key( fnet_uint16_t local_port, const struct sockaddr *foreign_addr );
+static void fnet_tcp_hash_add( fnet_socket_if_t *sk );
+static void fnet_tcp_hash_del( fnet_socket_if_t *sk );
+static fnet_socket_if_t *fnet_tcp_newpartialsk( fnet_socket_if_t *mainsk, struct sockaddr *local_addr, fnet_uint32_t isn, fnet_uint32_t foreign_isn );
 static void fnet_tcp_addpartialsk( fnet_socket_if_t *mainsk, fnet_socket_if_t *partialsk );
 static void fnet_tcp_movesk2incominglist( fnet_socket_if_t *sk );
 static void fnet_tcp_closesk( fnet_socket_if_t *sk );
@@ -94,6 +144,9 @@ static void fnet_tcp_delincomingsk( fnet_socket_if_t *sk );
 static void fnet_tcp_delcb( fnet_tcp_control_t *cb );
 #if !FNET_CFG_TCP_DISCARD_OUT_OF_ORDER
 static void fnet_tcp_deletetmpbuf( fnet_tcp_control_t *cb );
+static void fnet_tcp_reass_input( fnet_socket_if_t *sk, fnet_flag_t *ackparam );
+static void fnet_tcp_reass_link( fnet_tcp_reass_block_t *block, fnet_netbuf_t *head, fnet_netbuf_t *tail );
+static fnet_netbuf_t *fnet_tcp_reass_tail( fnet_netbuf_t *nb );
 #endif
 static void fnet_tcp_delsk( fnet_socket_if_t ** head, fnet_socket_if_t *sk );
 static fnet_bool_t fnet_tcp_sendanydata( fnet_socket_if_t *sk, fnet_bool_t oneexec );
@@ -101,6 +154,11 @@ static fnet_bool_t fnet_tcp_sendanydata( fnet_socket_if_t *sk, fnet_bool_t oneex
 static void fnet_tcp_urgprocessing( fnet_socket_if_t *sk, fnet_netbuf_t ** segment, fnet_size_t repdatasize, fnet_flag_t *ackparam );
 #endif
 static void fnet_tcp_finprocessing( fnet_socket_if_t *sk, fnet_uint32_t ack );
+#if FNET_CFG_TCP_TIMEWAIT_SIZE
+static fnet_tcp_timewait_t *fnet_tcp_timewait_find( const struct sockaddr *local_addr, const struct sockaddr *foreign_addr );
+static void fnet_tcp_timewait_add( fnet_socket_if_t *sk );
+static fnet_bool_t fnet_tcp_timewait_input( fnet_netbuf_t *insegment, struct sockaddr *src_addr,  struct sockaddr *dest_addr );
+#endif
 static fnet_return_t fnet_tcp_init( void );
 static void fnet_tcp_release( void );
 static void fnet_tcp_input(fnet_netif_t *netif, struct sockaddr *src_addr,  struct sockaddr *dest_addr, fnet_netbuf_t *nb, fnet_netbuf_t *ip_nb);
@@ -111,10 +169,16 @@ static fnet_return_t fnet_tcp_connect( fnet_socket_if_t *sk, struct sockaddr *fo
 static fnet_socket_if_t *fnet_tcp_accept( fnet_socket_if_t *listensk );
 static fnet_int32_t fnet_tcp_rcv( fnet_socket_if_t *sk, fnet_uint8_t *buf, fnet_size_t len, fnet_flag_t flags, struct sockaddr *foreign_addr);
 static fnet_int32_t fnet_tcp_snd( fnet_socket_if_t *sk, fnet_uint8_t *buf, fnet_size_t len, fnet_flag_t flags, const struct sockaddr *foreign_addr);
+static fnet_int32_t fnet_tcp_rcv_netbuf( fnet_socket_if_t *sk, fnet_netbuf_t **nb_ptr, fnet_size_t len, fnet_flag_t flags, struct sockaddr *foreign_addr);
+static fnet_int32_t fnet_tcp_snd_netbuf( fnet_socket_if_t *sk, fnet_netbuf_t *nb, fnet_flag_t flags, const struct sockaddr *foreign_addr);
+static fnet_int32_t fnet_tcp_rcv_data( fnet_socket_if_t *sk, fnet_uint8_t *buf, fnet_netbuf_t **nb_ptr, fnet_size_t len, fnet_flag_t flags, struct sockaddr *foreign_addr);
+static fnet_int32_t fnet_tcp_snd_data( fnet_socket_if_t *sk, fnet_uint8_t *buf, fnet_netbuf_t *nb, fnet_size_t len, fnet_flag_t flags);
 static fnet_return_t fnet_tcp_shutdown( fnet_socket_if_t *sk, fnet_sd_flags_t how );
+static fnet_size_t fnet_tcp_sndbuf_append( fnet_socket_if_t *sk, fnet_uint8_t *buf, fnet_size_t len );
 static fnet_return_t fnet_tcp_setsockopt( fnet_socket_if_t *sk, fnet_protocol_t level, fnet_socket_options_t optname, const void *optval, fnet_size_t optlen );
 static fnet_return_t fnet_tcp_getsockopt( fnet_socket_if_t *sk, fnet_protocol_t level, fnet_socket_options_t optname, void *optval, fnet_size_t *optlen );
 static fnet_return_t fnet_tcp_listen( fnet_socket_if_t *sk, fnet_size_t backlog );
+static fnet_flag_t fnet_tcp_poll( fnet_socket_if_t *sk );
 static void fnet_tcp_drain( void );
 
 #if FNET_CFG_DEBUG_TRACE_TCP && FNET_CFG_DEBUG_TRACE
@@ -137,8 +201,49 @@ static void fnet_tcp_drain( void );
 static fnet_uint32_t fnet_tcp_isntime = 1u;
 
 /* Timers.*/
-static fnet_timer_desc_t fnet_tcp_fasttimer;
-static fnet_timer_desc_t fnet_tcp_slowtimer;
+static fnet_timer_desc_t fnet_tcp_timer;
+static fnet_time_t fnet_tcp_deadline = FNET_TCP_TIMER_OFF;  /* The earliest deadline of the timers.*/
+static fnet_bool_t fnet_tcp_deadline_busy;                  /* The timers are being processed.*/
+
+/* Socket lookup tables.*/
+static fnet_socket_if_t *fnet_tcp_hash[FNET_CFG_TCP_HASH_SIZE];         /* Connections, hashed by 4-tuple.*/
+static fnet_socket_if_t *fnet_tcp_listen_hash[FNET_CFG_TCP_HASH_SIZE];  /* Listening sockets, hashed by local port.*/
+
+#if FNET_CFG_TCP_TIMEWAIT_SIZE
+/* Connections in the TIME_WAIT state.*/
+static fnet_tcp_timewait_t fnet_tcp_timewait[FNET_CFG_TCP_TIMEWAIT_SIZE];
+#endif
+
+#if FNET_CFG_TCP_SYN_COOKIES
+/* Secret keys of SYN cookies (the current and the previous one).*/
+static fnet_uint32_t fnet_tcp_cookie_key[2][2];
+static fnet_index_t fnet_tcp_cookie_key_num;    /* Number of the valid keys.*/
+static fnet_time_t fnet_tcp_cookie_key_time;    /* Time when the current key is created (sec).*/
+
+/* MSS values, encoded by SYN cookies.*/
+static const fnet_uint16_t fnet_tcp_cookie_mss[FNET_TCP_COOKIE_MSS_MASK + 1u] = {216u, 536u, 1024u, 1220u, 1360u, 1440u, 1460u, 4312u};
+#endif
+
+/* Congestion control algorithms.*/
+static const fnet_tcp_cc_t fnet_tcp_cc_newreno =
+{
+    fnet_tcp_newreno_init,
+    fnet_tcp_newreno_ack,
+    fnet_tcp_newreno_loss,
+    fnet_tcp_newreno_rto,
+    fnet_tcp_newreno_idle
+};
+
+#if FNET_CFG_TCP_CUBIC
+static const fnet_tcp_cc_t fnet_tcp_cc_cubic =
+{
+    fnet_tcp_cubic_init,
+    fnet_tcp_cubic_ack,
+    fnet_tcp_cubic_loss,
+    fnet_tcp_cubic_rto,
+    fnet_tcp_cubic_idle
+};
+#endif
 
 
 /*****************************************************************************
@@ -156,7 +261,10 @@ static const fnet_socket_prot_if_t fnet_tcp_socket_api =
     fnet_tcp_shutdown,
     fnet_tcp_setsockopt, 
     fnet_tcp_getsockopt,
-    fnet_tcp_listen   
+    fnet_tcp_listen,
+    fnet_tcp_poll,
+    fnet_tcp_rcv_netbuf,
+    fnet_tcp_snd_netbuf
 };
 
 /* Protocol structure.*/
@@ -171,7 +279,8 @@ fnet_prot_if_t fnet_tcp_prot_if =
     fnet_tcp_input,
     fnet_tcp_control_input, /* Control input (from below).*/
     fnet_tcp_drain, 
-    &fnet_tcp_socket_api    /* Socket API */
+    &fnet_tcp_socket_api,   /* Socket API */
+    0                       /* Port lookup table (TCP uses its own lookup tables).*/
 };
 
 /************************************************************************
@@ -184,25 +293,37 @@ fnet_prot_if_t fnet_tcp_prot_if =
 *************************************************************************/
 static fnet_return_t fnet_tcp_init( void )
 {
+#if FNET_CFG_TCP_TIMEWAIT_SIZE
+    fnet_index_t i;
+#endif
 
-    /* Create the slow timer.*/
-    fnet_tcp_fasttimer = fnet_timer_new(FNET_TCP_FASTTIMO / FNET_TIMER_PERIOD_MS, fnet_tcp_fasttimo, 0u);
+    fnet_memset_zero(fnet_tcp_hash, sizeof(fnet_tcp_hash));
+    fnet_memset_zero(fnet_tcp_listen_hash, sizeof(fnet_tcp_listen_hash));
 
-    if(!fnet_tcp_fasttimer)
+#if FNET_CFG_TCP_TIMEWAIT_SIZE
+    for(i = 0u; i < FNET_CFG_TCP_TIMEWAIT_SIZE; i++)
     {
-        return FNET_ERR;
+        fnet_tcp_timewait[i].expiry = FNET_TCP_TIMER_OFF;
     }
+#endif
+
+    fnet_tcp_deadline = FNET_TCP_TIMER_OFF;
+    fnet_tcp_deadline_busy = FNET_FALSE;
 
-    /* Create the fast timer.*/
-    fnet_tcp_slowtimer = fnet_timer_new(FNET_TCP_SLOWTIMO / FNET_TIMER_PERIOD_MS, fnet_tcp_slowtimo, 0u);
+    /* Create the timer.*/
+    fnet_tcp_timer = fnet_timer_new(FNET_TCP_TIMER_PERIOD / FNET_TIMER_PERIOD_MS, fnet_tcp_timo, 0u);
 
-    if(!fnet_tcp_slowtimer)
+    if(!fnet_tcp_timer)
     {
-        fnet_timer_free(fnet_tcp_fasttimer);
-        fnet_tcp_fasttimer = 0;
         return FNET_ERR;
     }
 
+#if FNET_CFG_TCP_SYN_COOKIES
+    /* The key is created on the first use, after the random generator 
+     * is seeded by the network interfaces.*/
+    fnet_tcp_cookie_key_num = 0u;
+#endif
+
     return FNET_OK;
 }
 
@@ -227,12 +348,10 @@ static void fnet_tcp_release( void )
         fnet_tcp_abortsk(fnet_tcp_prot_if.head);
     }
 
-    /* Free timers.*/
-    fnet_timer_free(fnet_tcp_fasttimer);
-    fnet_timer_free(fnet_tcp_slowtimer);
+    /* Free the timer.*/
+    fnet_timer_free(fnet_tcp_timer);
 
-    fnet_tcp_fasttimer = 0;
-    fnet_tcp_slowtimer = 0;
+    fnet_tcp_timer = 0;
 
     fnet_isr_unlock();
 }
@@ -298,6 +417,14 @@ static void fnet_tcp_input(fnet_netif_t *netif, struct sockaddr *src_addr,  stru
     
     sk = fnet_tcp_findsk(src_addr,  dest_addr);
 
+#if FNET_CFG_TCP_TIMEWAIT_SIZE
+    /* The connection may be in the TIME_WAIT state.*/
+    if(((!sk) || (sk->state == SS_LISTENING)) && (fnet_tcp_timewait_input(nb, src_addr, dest_addr) == FNET_TRUE))
+    {
+        goto DROP;
+    }
+#endif
+
     if(sk)
     {
         if(sk->state == SS_LISTENING)
@@ -326,6 +453,9 @@ static void fnet_tcp_input(fnet_netif_t *netif, struct sockaddr *src_addr,  stru
 	/* Wake-up user application.*/
  	fnet_os_event_raise(); 
 
+    /* Process the timers expired since the last timer tick.*/
+    fnet_tcp_deadline_check();
+
     return;
     
 DROP:
@@ -334,6 +464,9 @@ DROP:
  
  	/* Delete the segment.*/
     fnet_netbuf_free_chain(nb);
+
+    /* Process the timers expired since the last timer tick.*/
+    fnet_tcp_deadline_check();
 }
 
 
@@ -373,14 +506,17 @@ static void fnet_tcp_control_input(fnet_prot_notify_t command, struct sockaddr *
                   break;
                 case FNET_PROT_NOTIFY_MSGSIZE:          /* Message size forced drop.*/
                   sk->options.local_error = FNET_ERR_MSGSIZE;
+                  fnet_socket_poll_update(sk);
                   break;
                 case FNET_PROT_NOTIFY_UNREACH_HOST:     /* No route to host.*/
                 case FNET_PROT_NOTIFY_UNREACH_NET:      /* No route to network.*/
                 case FNET_PROT_NOTIFY_UNREACH_SRCFAIL:  /* Source route failed.*/
                   sk->options.local_error = FNET_ERR_HOSTUNREACH;
+                  fnet_socket_poll_update(sk);
                   break;
                 case FNET_PROT_NOTIFY_PARAMPROB:                 /* Header incorrect.*/
                   sk->options.local_error = FNET_ERR_NOPROTOOPT; /* Bad protocol option.*/
+                  fnet_socket_poll_update(sk);
                   break;
                 case FNET_PROT_NOTIFY_UNREACH_PORT:              /* bad port #.*/
                 case FNET_PROT_NOTIFY_UNREACH_PROTOCOL:
@@ -433,6 +569,12 @@ static fnet_return_t fnet_tcp_attach( fnet_socket_if_t *sk )
     sk->options.tcp_opt.keep_idle = FNET_TCP_KEEPIDLE_DEFAULT;      /* TCP_KEEPIDLE option. */
     sk->options.tcp_opt.keep_intvl = FNET_TCP_KEEPINTVL_DEFAULT;    /* TCP_KEEPINTVL option. */
     sk->options.tcp_opt.keep_cnt = FNET_TCP_KEEPCNT_DEFAULT;        /* TCP_KEEPCNT option. */
+    sk->options.tcp_opt.rto_min = FNET_CFG_TCP_RTO_MIN;             /* TCP_RTO_MIN option. */
+    sk->options.tcp_opt.rto_max = FNET_CFG_TCP_RTO_MAX;             /* TCP_RTO_MAX option. */
+#if FNET_CFG_TCP_RCVBUF_AUTO
+    sk->options.tcp_opt.rcvbuf_auto = FNET_TRUE;                    /* TCP_RCVBUF_AUTO option. */
+#endif
+    sk->options.tcp_opt.congestion = (fnet_tcp_congestion_t)FNET_CFG_TCP_CONGESTION; /* TCP_CONGESTION option. */
     
     sk->options.so_dontroute = FNET_FALSE;
     sk->options.so_keepalive = FNET_TRUE;
@@ -527,18 +669,24 @@ static fnet_return_t fnet_tcp_close( fnet_socket_if_t *sk )
     {
         fnet_tcp_closesk(sk);
     }
+#if FNET_CFG_TCP_TIMEWAIT_SIZE
+    else if(cb->tcpcb_connection_state == FNET_TCP_CS_TIME_WAIT)
+    {
+        /* Only the compact record is kept in the TIME_WAIT state.*/
+        fnet_tcp_timewait_add(sk);
+    }
+#endif
     else
     {
         if(cb->tcpcb_connection_state != FNET_TCP_CS_TIME_WAIT)
         {
             if((sk->options.so_linger == FNET_TRUE) && (sk->options.linger_ticks))
             {
-                cb->tcpcb_timers.connection = ((sk->options.linger_ticks * FNET_TIMER_PERIOD_MS)
-                                                                 / FNET_TCP_SLOWTIMO);
+                fnet_tcp_settimer(&cb->tcpcb_timers.connection, sk->options.linger_ticks * FNET_TIMER_PERIOD_MS);
             }
             else
             {
-                cb->tcpcb_timers.connection = FNET_TCP_ABORT_INTERVAL;
+                fnet_tcp_settimer(&cb->tcpcb_timers.connection, FNET_TCP_ABORT_INTERVAL);
             }
 
             sk->receive_buffer.is_shutdown = FNET_TRUE;
@@ -601,7 +749,9 @@ static fnet_return_t fnet_tcp_connect( fnet_socket_if_t *sk, struct sockaddr *fo
 #endif /* FNET_CFG_TCP_URGENT */
 
     /* Set the foreign address.*/
+    fnet_tcp_hash_del(sk);
     sk->foreign_addr = *foreign_addr; 
+    fnet_tcp_hash_add(sk);
 
     fnet_isr_lock();
 
@@ -623,8 +773,8 @@ static fnet_return_t fnet_tcp_connect( fnet_socket_if_t *sk, struct sockaddr *fo
     fnet_tcp_isntime += FNET_TCP_STEPISN;
 
     /* Initialize Abort Timer.*/
-    cb->tcpcb_timers.retransmission = cb->tcpcb_rto;
-    cb->tcpcb_timers.connection = FNET_TCP_ABORT_INTERVAL_CON;
+    fnet_tcp_settimer(&cb->tcpcb_timers.retransmission, cb->tcpcb_rto);
+    fnet_tcp_settimer(&cb->tcpcb_timers.connection, FNET_TCP_ABORT_INTERVAL_CON);
 
     fnet_isr_unlock();
 
@@ -683,6 +833,34 @@ static fnet_socket_if_t *fnet_tcp_accept( fnet_socket_if_t *listensk )
 *          of the received data. Otherwise, it returns FNET_ERR.
 *************************************************************************/
 static fnet_int32_t fnet_tcp_rcv( fnet_socket_if_t *sk, fnet_uint8_t *buf, fnet_size_t len, fnet_flag_t flags, struct sockaddr *foreign_addr)
+{
+    return fnet_tcp_rcv_data(sk, buf, 0, len, flags, foreign_addr);
+}
+
+/************************************************************************
+* NAME: fnet_tcp_rcv_netbuf
+*
+* DESCRIPTION: This function passes the received data to the application
+*              as a net_buf chain, without copying.
+* 
+* RETURNS: If no error occurs, this function returns the length
+*          of the received data. Otherwise, it returns FNET_ERR.
+*************************************************************************/
+static fnet_int32_t fnet_tcp_rcv_netbuf( fnet_socket_if_t *sk, fnet_netbuf_t **nb_ptr, fnet_size_t len, fnet_flag_t flags, struct sockaddr *foreign_addr)
+{
+    return fnet_tcp_rcv_data(sk, 0, nb_ptr, len, flags, foreign_addr);
+}
+
+/************************************************************************
+* NAME: fnet_tcp_rcv_data
+*
+* DESCRIPTION: This function copies the received data to "buf", or passes
+*              them in "nb_ptr", and sends the acknowledgment.
+* 
+* RETURNS: If no error occurs, this function returns the length
+*          of the received data. Otherwise, it returns FNET_ERR.
+*************************************************************************/
+static fnet_int32_t fnet_tcp_rcv_data( fnet_socket_if_t *sk, fnet_uint8_t *buf, fnet_netbuf_t **nb_ptr, fnet_size_t len, fnet_flag_t flags, struct sockaddr *foreign_addr)
 {
     fnet_tcp_control_t  *cb = (fnet_tcp_control_t *)sk->protocol_control;
     fnet_bool_t         flag_remove; /* Remove flag. 1 means that the data must be deleted
@@ -753,8 +931,20 @@ static fnet_int32_t fnet_tcp_rcv( fnet_socket_if_t *sk, fnet_uint8_t *buf, fnet_
         len = sk->receive_buffer.count;
     }
 
-    /* Copy the data to the buffer.*/
-    len = fnet_socket_buffer_read_record(&sk->receive_buffer, buf, len, flag_remove); 
+    if(nb_ptr)
+    {
+        /* Pass the net_bufs to the application.*/
+        if(len && ((*nb_ptr = fnet_socket_buffer_take_record(&sk->receive_buffer, len)) == 0))
+        {
+            error_code = FNET_ERR_NOMEM;
+            goto ERROR_UNLOCK;
+        }
+    }
+    else
+    {
+        /* Copy the data to the buffer.*/
+        len = fnet_socket_buffer_read_record(&sk->receive_buffer, buf, len, flag_remove); 
+    }
 
     /* Remove the data from input buffer.*/
     if(flag_remove)
@@ -816,9 +1006,52 @@ ERROR:
 *          Otherwise, it returns FNET_ERR.
 *************************************************************************/
 static fnet_int32_t fnet_tcp_snd( fnet_socket_if_t *sk, fnet_uint8_t *buf, fnet_size_t len, fnet_flag_t flags, const struct sockaddr *foreign_addr)
+{
+    FNET_COMP_UNUSED_ARG(foreign_addr);
+
+    return fnet_tcp_snd_data(sk, buf, 0, len, flags);
+}
+
+/************************************************************************
+* NAME: fnet_tcp_snd_netbuf
+*
+* DESCRIPTION: This function adds the net_buf chain to the output buffer,
+*              without copying, and sends the data that can be sent.
+*              The chain is added only as a whole.
+*
+* RETURNS: If no error occurs, this function returns the length
+*          of the chain, or 0 if there is no free space in the output
+*          buffer. In the latter case the chain is not freed.
+*          Otherwise, it frees the chain and returns FNET_ERR.
+*************************************************************************/
+static fnet_int32_t fnet_tcp_snd_netbuf( fnet_socket_if_t *sk, fnet_netbuf_t *nb, fnet_flag_t flags, const struct sockaddr *foreign_addr)
+{
+    fnet_int32_t    result;
+
+    FNET_COMP_UNUSED_ARG(foreign_addr);
+
+    if((result = fnet_tcp_snd_data(sk, 0, nb, nb->total_length, flags)) == FNET_ERR)
+    {
+        fnet_netbuf_free_chain(nb);
+    }
+
+    return result;
+}
+
+/************************************************************************
+* NAME: fnet_tcp_snd_data
+*
+* DESCRIPTION: This function adds the data of "buf", or the net_buf 
+*              chain "nb", to the output buffer and sends the data 
+*              that can be sent.
+*
+* RETURNS: If no error occurs, this function returns the length
+*          of the data that is added to the output buffer.
+*          Otherwise, it returns FNET_ERR.
+*************************************************************************/
+static fnet_int32_t fnet_tcp_snd_data( fnet_socket_if_t *sk, fnet_uint8_t *buf, fnet_netbuf_t *nb, fnet_size_t len, fnet_flag_t flags)
 {
     fnet_tcp_control_t  *cb = (fnet_tcp_control_t *)sk->protocol_control; 
-    fnet_netbuf_t       *netbuf;                                             
     fnet_size_t         sendlength = len;   /* Size of the data that must be sent.*/
     fnet_size_t         sentlength = 0u;    /* Length of the sent data.*/
     fnet_size_t         freespace;          /* Free space in the output buffer.*/
@@ -827,8 +1060,6 @@ static fnet_int32_t fnet_tcp_snd( fnet_socket_if_t *sk, fnet_uint8_t *buf, fnet_
     fnet_size_t         malloc_max;
     fnet_error_t        error_code;
 
-    FNET_COMP_UNUSED_ARG(foreign_addr);
-
     /* If the size of the data greater than the maximal size of the output buffer, return*/
     if(sendlength > FNET_TCP_MAX_BUFFER)
     {
@@ -869,8 +1100,9 @@ static fnet_int32_t fnet_tcp_snd( fnet_socket_if_t *sk, fnet_uint8_t *buf, fnet_
         /* If the function is nonblocking and the data length greater than the freespace, recalculate the size of the data*/
         if(freespace < sendlength)
         {
-            /* If the data can't be added to the output buffer, return*/
-            if(freespace == 0u)
+            /* If the data can't be added to the output buffer, return.
+             * The net_buf chain is added only as a whole.*/
+            if((freespace == 0u) || (nb != 0))
             {
                 fnet_isr_unlock();
                 return 0;
@@ -917,6 +1149,23 @@ static fnet_int32_t fnet_tcp_snd( fnet_socket_if_t *sk, fnet_uint8_t *buf, fnet_
             sk->options.so_dontroute = FNET_TRUE;
         }
     
+        /* Restart the congestion window after the idle period (RFC5681).*/
+        if((sk->send_buffer.count == 0u) 
+            && ((fnet_time_t)(fnet_timer_fine_ms() - cb->tcpcb_sndtime) > cb->tcpcb_rto))
+        {
+            cb->tcpcb_cc->on_idle(cb);
+        }
+
+        /* Hold the partial segment, if more data follows.*/
+        if((flags & MSG_MORE) != 0u)
+        {
+            cb->tcpcb_flags |= FNET_TCP_CBF_MORE;
+        }
+        else
+        {
+            cb->tcpcb_flags &= ~FNET_TCP_CBF_MORE;
+        }
+
         /* Try to add the data.*/
         if(freespace > 0u)
         {
@@ -932,59 +1181,61 @@ static fnet_int32_t fnet_tcp_snd( fnet_socket_if_t *sk, fnet_uint8_t *buf, fnet_
                 currentlen = sendlength;
             }
 
-            netbuf = fnet_netbuf_from_buf(&buf[sentlength], currentlen, FNET_TRUE);
+            /* Add the data to the output buffer.*/
+            if(nb)
+            {
+                fnet_socket_buffer_concat(&sk->send_buffer, nb);
+            #if FNET_CFG_TCP_SEND_COALESCE
+                /* The spare space of the application net_bufs is not used.*/
+                cb->tcpcb_sndtailroom = 0u;
+            #endif
+            }
+            else
+            {
+                currentlen = fnet_tcp_sndbuf_append(sk, &buf[sentlength], currentlen);
+            }
 
             /* Check the memory allocation.*/
-            if(netbuf) 
+            if(currentlen) 
             {
                 sentlength += currentlen;
 
-                if(fnet_socket_buffer_append_record(&sk->send_buffer, netbuf) == FNET_OK)
+                /* If the window of another side is closed, set the persist timer.*/
+                if(!cb->tcpcb_sndwnd)
                 {
-
-                    /* If the window of another side is closed, set the persist timer.*/
-                    if(!cb->tcpcb_sndwnd)
+                    if(cb->tcpcb_timers.persist == FNET_TCP_TIMER_OFF)
                     {
-                        if(cb->tcpcb_timers.persist == FNET_TCP_TIMER_OFF)
-                        {
-                            cb->tcpcb_cprto = cb->tcpcb_rto;
-                            cb->tcpcb_timers.persist = cb->tcpcb_cprto;
-                        }
+                        cb->tcpcb_cprto = cb->tcpcb_rto;
+                        fnet_tcp_settimer(&cb->tcpcb_timers.persist, cb->tcpcb_cprto);
                     }
-                    else
-                    {
-                        fnet_flag_t sendanydata = FNET_TRUE;
+                }
+                else
+                {
+                    fnet_flag_t sendanydata = FNET_TRUE;
 
-                        /* Try to send the data.*/
-                        while(sendanydata)
+                    /* Try to send the data.*/
+                    while(sendanydata)
+                    {
+                        /* If the connection is not established, delete the data. Otherwise try to send the data*/
+                        if(sk->state == SS_CONNECTED)
                         {
-                            /* If the connection is not established, delete the data. Otherwise try to send the data*/
-                            if(sk->state == SS_CONNECTED)
-                            {
-                                if(!fnet_tcp_sendanydata(sk, FNET_TRUE))
-                                {
-                                    cb->tcpcb_flags &= ~FNET_TCP_CBF_INSND;
-
-                                    sendanydata = FNET_FALSE;
-                                }
-                            }
-                            else
+                            if(!fnet_tcp_sendanydata(sk, FNET_TRUE))
                             {
-                                /* If socket is not connected, delete the output buffer.*/
-                                fnet_socket_buffer_release(&sk->send_buffer);
                                 cb->tcpcb_flags &= ~FNET_TCP_CBF_INSND;
 
                                 sendanydata = FNET_FALSE;
                             }
                         }
-                    }                    
-                }
-                else /* Not able to add to the socket send buffer.*/
-                {
-                    fnet_netbuf_free( netbuf );
-                    fnet_isr_unlock();
-                    return 0;
-                }
+                        else
+                        {
+                            /* If socket is not connected, delete the output buffer.*/
+                            fnet_socket_buffer_release(&sk->send_buffer);
+                            cb->tcpcb_flags &= ~FNET_TCP_CBF_INSND;
+
+                            sendanydata = FNET_FALSE;
+                        }
+                    }
+                }                    
             }
         }
             
@@ -1011,6 +1262,150 @@ ERROR:
     return FNET_ERR;
 }
 
+/************************************************************************
+* NAME: fnet_tcp_sndbuf_append
+*
+* DESCRIPTION: Copies the user data to the end of the output buffer.
+*              With FNET_CFG_TCP_SEND_COALESCE, the data fill the spare 
+*              space of the last net_buf first. If the data are going 
+*              to wait in the buffer (unsent data or corked), the last 
+*              new net_buf is allocated with MSS size, so small writes
+*              build MSS-sized net_bufs. Otherwise the data are likely sent
+*              at once, and the spare space would be held by the segment.
+*              With FNET_CFG_CHECKSUM_COPY, the data are copied to 
+*              MSS-sized net_bufs and summed during the copying, 
+*              so the segments made of whole net_bufs reuse the cached sum.
+*
+* RETURNS: The length of the added data, 0 if no free memory.
+*************************************************************************/
+static fnet_size_t fnet_tcp_sndbuf_append( fnet_socket_if_t *sk, fnet_uint8_t *buf, fnet_size_t len )
+{
+#if FNET_CFG_CHECKSUM_COPY || FNET_CFG_TCP_SEND_COALESCE
+    fnet_tcp_control_t  *cb = (fnet_tcp_control_t *)sk->protocol_control;
+#endif
+    fnet_netbuf_t       *netbuf = 0;
+    fnet_netbuf_t       *netbuf_tail = 0;
+    fnet_netbuf_t       *nb;
+    fnet_size_t         filled_len = 0u;
+    fnet_size_t         offset;
+    fnet_size_t         current_len;
+    fnet_size_t         nb_size = 0u;
+#if FNET_CFG_CHECKSUM_COPY
+    fnet_size_t         chunk_size = (cb->tcpcb_sndmss) ? cb->tcpcb_sndmss : len;
+#endif
+#if FNET_CFG_TCP_SEND_COALESCE
+    fnet_bool_t         coalesce = ((sk->send_buffer.count != 0u) || (sk->options.tcp_opt.tcp_cork == FNET_TRUE) 
+                                    || ((cb->tcpcb_flags & FNET_TCP_CBF_MORE) != 0u)) ? FNET_TRUE : FNET_FALSE;
+
+    /* Fill the spare space of the last net_buf.*/
+    if((sk->send_buffer.net_buf_chain) && (cb->tcpcb_sndtailroom))
+    {
+        nb = sk->send_buffer.net_buf_tail;
+        filled_len = (len < cb->tcpcb_sndtailroom) ? len : cb->tcpcb_sndtailroom;
+
+    #if FNET_CFG_CHECKSUM_COPY
+        /* Extend the cached sum, if it is still valid.*/
+        if((nb->checksum_length != 0u) && (nb->checksum_length <= nb->length))
+        {
+            nb->checksum = fnet_checksum_copy_append(nb->checksum, nb->checksum_length, 
+                                                     (fnet_uint8_t *)nb->data_ptr + nb->length, buf, filled_len);
+            nb->checksum_length += (fnet_uint16_t)filled_len;
+        }
+        else
+        {
+            nb->checksum = fnet_checksum_copy((fnet_uint8_t *)nb->data_ptr + nb->length, buf, filled_len);
+            nb->checksum_length = (fnet_uint16_t)filled_len;
+        }
+    #else
+        fnet_memcpy((fnet_uint8_t *)nb->data_ptr + nb->length, buf, filled_len);
+    #endif
+
+        nb->length += filled_len;
+        sk->send_buffer.net_buf_chain->total_length += filled_len;
+        sk->send_buffer.count += filled_len;
+        cb->tcpcb_sndtailroom -= filled_len;
+    }
+#endif /* FNET_CFG_TCP_SEND_COALESCE */
+
+    /* Copy the rest of the data to new net_bufs.*/
+    for(offset = filled_len; offset < len; offset += current_len)
+    {
+        current_len = len - offset;
+
+    #if FNET_CFG_CHECKSUM_COPY
+        if(current_len > chunk_size)
+        {
+            current_len = chunk_size;
+        }
+    #endif
+
+        nb_size = current_len;
+
+    #if FNET_CFG_TCP_SEND_COALESCE
+        /* Leave the spare space for the next writes, up to MSS.*/
+        if((coalesce == FNET_TRUE) && (nb_size < cb->tcpcb_sndmss))
+        {
+            nb_size = cb->tcpcb_sndmss;
+        }
+
+        if(((nb = fnet_netbuf_new(nb_size, FNET_TRUE)) == 0) && (nb_size > current_len))
+        {
+            nb_size = current_len;
+            nb = fnet_netbuf_new(nb_size, FNET_TRUE);
+        }
+    #else
+        nb = fnet_netbuf_new(nb_size, FNET_TRUE);
+    #endif
+
+        if(nb == 0)
+        {
+            if(netbuf)
+            {
+                fnet_netbuf_free_chain(netbuf);
+            }
+            
+            return filled_len;
+        }
+
+        nb->length = current_len;
+        nb->total_length = current_len;
+
+    #if FNET_CFG_CHECKSUM_COPY
+        nb->checksum = fnet_checksum_copy(nb->data_ptr, &buf[offset], current_len);
+        nb->checksum_length = (fnet_uint16_t)current_len;
+    #else
+        fnet_memcpy(nb->data_ptr, &buf[offset], current_len);
+    #endif
+
+        if(netbuf == 0)
+        {
+            netbuf = nb;
+        }
+        else
+        {
+            netbuf_tail->next = nb;
+            netbuf->total_length += current_len;
+        }
+
+        netbuf_tail = nb;
+    }
+
+    if(netbuf)
+    {
+        if(fnet_socket_buffer_append_record(&sk->send_buffer, netbuf) == FNET_ERR)
+        {
+            fnet_netbuf_free_chain(netbuf);
+            return filled_len;
+        }
+
+    #if FNET_CFG_TCP_SEND_COALESCE
+        cb->tcpcb_sndtailroom = nb_size - netbuf_tail->length;
+    #endif
+    }
+
+    return len;
+}
+
 /************************************************************************
 * NAME: fnet_tcp_shutdown
 *
@@ -1067,7 +1462,9 @@ static fnet_return_t fnet_tcp_shutdown( fnet_socket_if_t *sk, fnet_sd_flags_t ho
 *************************************************************************/
 static fnet_return_t fnet_tcp_setsockopt( fnet_socket_if_t *sk, fnet_protocol_t level, fnet_socket_options_t optname, const void *optval, fnet_size_t optlen )
 {
-    fnet_error_t error_code;
+    fnet_error_t        error_code;
+    fnet_tcp_control_t  *cb = (fnet_tcp_control_t *)sk->protocol_control;
+    const fnet_tcp_cc_t *cc;
     
     /* If the level is not IPPROTO_TCP, go to IP processing.*/
     if(level == IPPROTO_TCP)
@@ -1080,9 +1477,16 @@ static fnet_return_t fnet_tcp_setsockopt( fnet_socket_if_t *sk, fnet_protocol_t
             case TCP_KEEPINTVL:
             case TCP_KEEPIDLE:
             case TCP_NODELAY:
+            case TCP_CORK:
         #if FNET_CFG_TCP_URGENT            
             case TCP_BSD:
         #endif            
+        #if FNET_CFG_TCP_RCVBUF_AUTO
+            case TCP_RCVBUF_AUTO:
+        #endif
+            case TCP_CONGESTION:
+            case TCP_RTO_MIN:
+            case TCP_RTO_MAX:
                 if(optlen != sizeof(fnet_uint32_t))
                 {
                     error_code = FNET_ERR_INVAL;
@@ -1120,23 +1524,25 @@ static fnet_return_t fnet_tcp_setsockopt( fnet_socket_if_t *sk, fnet_protocol_t
                 break;
             /* Keepalive retransmit interval.*/
             case TCP_KEEPINTVL:
-                if(!(*((const fnet_uint32_t *)(optval))))
+                /* The value is in seconds, the timeout in ms is limited.*/
+                if((!(*((const fnet_uint32_t *)(optval)))) || ((*((const fnet_uint32_t *)(optval))) > (FNET_TCP_TIMEOUT_MAX / 1000u)))
                 {
                     error_code = FNET_ERR_INVAL;
                     goto ERROR;
                 }
 
-                sk->options.tcp_opt.keep_intvl = (*((const fnet_uint32_t *)(optval))*(1000u/FNET_TCP_SLOWTIMO));
+                sk->options.tcp_opt.keep_intvl = (*((const fnet_uint32_t *)(optval))*1000u);
                 break;            
             /* Time between keepalive probes.*/
             case TCP_KEEPIDLE:
-                if(!(*((const fnet_uint32_t *)(optval))))
+                /* The value is in seconds, the timeout in ms is limited.*/
+                if((!(*((const fnet_uint32_t *)(optval)))) || ((*((const fnet_uint32_t *)(optval))) > (FNET_TCP_TIMEOUT_MAX / 1000u)))
                 {
                     error_code = FNET_ERR_INVAL;
                     goto ERROR;
                 }
 
-                sk->options.tcp_opt.keep_idle = (*((const fnet_uint32_t *)(optval))*(1000u/FNET_TCP_SLOWTIMO));
+                sk->options.tcp_opt.keep_idle = (*((const fnet_uint32_t *)(optval))*1000u);
                 break;
         #if FNET_CFG_TCP_URGENT                            
             /* BSD interpretation of the urgent pointer.*/
@@ -1162,6 +1568,91 @@ static fnet_return_t fnet_tcp_setsockopt( fnet_socket_if_t *sk, fnet_protocol_t
                     sk->options.tcp_opt.tcp_nodelay = FNET_FALSE;
                 }
                 break;
+            /* TCP_CORK option.*/
+            case TCP_CORK:
+                if(*((const fnet_uint32_t *)(optval)))
+                {
+                    sk->options.tcp_opt.tcp_cork = FNET_TRUE;
+                }
+                else
+                {
+                    sk->options.tcp_opt.tcp_cork = FNET_FALSE;
+
+                    /* Send the held data.*/
+                    fnet_isr_lock();
+                    if(sk->state == SS_CONNECTED)
+                    {
+                        fnet_tcp_sendanydata(sk, FNET_FALSE);
+                    }
+                    fnet_isr_unlock();
+                }
+                break;
+        #if FNET_CFG_TCP_RCVBUF_AUTO
+            /* Receive buffer auto-tuning.*/
+            case TCP_RCVBUF_AUTO:
+                if(*((const fnet_uint32_t *)(optval)))
+                {
+                    sk->options.tcp_opt.rcvbuf_auto = FNET_TRUE;
+                }
+                else
+                {
+                    sk->options.tcp_opt.rcvbuf_auto = FNET_FALSE;
+                }
+                break;
+        #endif
+            /* Congestion control algorithm.*/
+            case TCP_CONGESTION:
+                cc = fnet_tcp_cc_get((fnet_tcp_congestion_t)(*((const fnet_uint32_t *)(optval))));
+                if(cc == 0)
+                {
+                    error_code = FNET_ERR_INVAL;
+                    goto ERROR;
+                }
+
+                sk->options.tcp_opt.congestion = (fnet_tcp_congestion_t)(*((const fnet_uint32_t *)(optval)));
+
+                /* Change the algorithm of the existing connection.*/
+                fnet_isr_lock();
+                if((cb->tcpcb_cc != 0) && (cb->tcpcb_cc != cc))
+                {
+                    cb->tcpcb_cc = cc;
+                    cc->init(cb);
+                }
+                fnet_isr_unlock();
+                break;
+            /* Bounds of the retransmission timeout.*/
+            case TCP_RTO_MIN:
+                if((!(*((const fnet_uint32_t *)(optval)))) || (*((const fnet_uint32_t *)(optval)) > sk->options.tcp_opt.rto_max))
+                {
+                    error_code = FNET_ERR_INVAL;
+                    goto ERROR;
+                }
+
+                sk->options.tcp_opt.rto_min = *((const fnet_uint32_t *)(optval));
+
+                fnet_isr_lock();
+                if(cb->tcpcb_rto < sk->options.tcp_opt.rto_min)
+                {
+                    cb->tcpcb_rto = sk->options.tcp_opt.rto_min;
+                }
+                fnet_isr_unlock();
+                break;
+            case TCP_RTO_MAX:
+                if(*((const fnet_uint32_t *)(optval)) < sk->options.tcp_opt.rto_min)
+                {
+                    error_code = FNET_ERR_INVAL;
+                    goto ERROR;
+                }
+
+                sk->options.tcp_opt.rto_max = *((const fnet_uint32_t *)(optval));
+
+                fnet_isr_lock();
+                if(cb->tcpcb_rto > sk->options.tcp_opt.rto_max)
+                {
+                    cb->tcpcb_rto = sk->options.tcp_opt.rto_max;
+                }
+                fnet_isr_unlock();
+                break;
             default:
                 break;
         }
@@ -1201,10 +1692,10 @@ static fnet_return_t fnet_tcp_getsockopt( fnet_socket_if_t *sk, fnet_protocol_t
                 *((fnet_uint32_t *)(optval)) = sk->options.tcp_opt.keep_cnt;
                 break;
             case TCP_KEEPINTVL:
-                *((fnet_uint32_t *)(optval)) = (sk->options.tcp_opt.keep_intvl/(1000u/FNET_TCP_SLOWTIMO));
+                *((fnet_uint32_t *)(optval)) = (sk->options.tcp_opt.keep_intvl/1000u);
                 break;
             case TCP_KEEPIDLE:
-                *((fnet_uint32_t *)(optval)) = (sk->options.tcp_opt.keep_idle/(1000u/FNET_TCP_SLOWTIMO));
+                *((fnet_uint32_t *)(optval)) = (sk->options.tcp_opt.keep_idle/1000u);
                 break;
         #if FNET_CFG_TCP_URGENT                
             case TCP_BSD:
@@ -1214,6 +1705,31 @@ static fnet_return_t fnet_tcp_getsockopt( fnet_socket_if_t *sk, fnet_protocol_t
             case TCP_NODELAY:
                 *((fnet_uint32_t *)(optval)) = sk->options.tcp_opt.tcp_nodelay;
                 break;
+            case TCP_CORK:
+                *((fnet_uint32_t *)(optval)) = sk->options.tcp_opt.tcp_cork;
+                break;
+        #if FNET_CFG_TCP_RCVBUF_AUTO
+            case TCP_RCVBUF_AUTO:
+                *((fnet_uint32_t *)(optval)) = sk->options.tcp_opt.rcvbuf_auto;
+                break;
+        #endif
+            case TCP_CONGESTION:
+                *((fnet_uint32_t *)(optval)) = (fnet_uint32_t)sk->options.tcp_opt.congestion;
+                break;
+            case TCP_RTO_MIN:
+                *((fnet_uint32_t *)(optval)) = sk->options.tcp_opt.rto_min;
+                break;
+            case TCP_RTO_MAX:
+                *((fnet_uint32_t *)(optval)) = sk->options.tcp_opt.rto_max;
+                break;
+        #if FNET_CFG_TCP_SYN_COOKIES
+            case TCP_SYNCOOKIES_SENT:
+                *((fnet_uint32_t *)(optval)) = cb->tcpcb_cookies_sent;
+                break;
+            case TCP_SYNCOOKIES_VALID:
+                *((fnet_uint32_t *)(optval)) = cb->tcpcb_cookies_valid;
+                break;
+        #endif
             case TCP_FINRCVD:
                 if((cb->tcpcb_flags & FNET_TCP_CBF_FIN_RCVD) != 0u)
                 {
@@ -1285,6 +1801,7 @@ static fnet_return_t fnet_tcp_listen( fnet_socket_if_t *sk, fnet_size_t backlog
     }
     else
     {
+        fnet_tcp_hash_del(sk);
         fnet_tcp_initconnection(sk);
 
         /* Foreign address must be any.*/
@@ -1296,23 +1813,67 @@ static fnet_return_t fnet_tcp_listen( fnet_socket_if_t *sk, fnet_size_t backlog
         /* Change the state.*/
         cb->tcpcb_connection_state = FNET_TCP_CS_LISTENING;
         sk->state = SS_LISTENING;
+        fnet_tcp_hash_add(sk);
     }
     
     return FNET_OK;
 }
 
 /************************************************************************
-* NAME: fnet_tcp_drain
+* NAME: fnet_tcp_poll
 *
-* DESCRIPTION: fnet_tcp_drain removes the temporary data.
+* DESCRIPTION: This function calculates the socket readiness.
 *
-* RETURNS: None.          
+* RETURNS: FNET_SOCKET_POLL_xxx flags.
 *************************************************************************/
-static void fnet_tcp_drain( void )
+static fnet_flag_t fnet_tcp_poll( fnet_socket_if_t *sk )
 {
-    fnet_socket_if_t       *sk; 
-    fnet_socket_if_t       *delsk;
-    fnet_tcp_control_t  *cb;    
+    fnet_tcp_control_t  *cb = (fnet_tcp_control_t *)sk->protocol_control;
+    fnet_flag_t         events = 0u;
+
+    if(sk->state == SS_LISTENING)
+    {
+        /* A connection is ready to be accepted.*/
+        if(sk->incoming_con_len)
+        {
+            events |= FNET_SOCKET_POLL_READ;
+        }
+    }
+    else
+    {
+        /* The data are received, or the peer has closed the connection.*/
+        if((sk->receive_buffer.count) || ((cb->tcpcb_flags & FNET_TCP_CBF_FIN_RCVD) != 0u))
+        {
+            events |= FNET_SOCKET_POLL_READ;
+        }
+
+        if((sk->state == SS_CONNECTED) && (sk->send_buffer.is_shutdown == FNET_FALSE)
+            && (sk->send_buffer.count < sk->send_buffer.count_max))
+        {
+            events |= FNET_SOCKET_POLL_WRITE;
+        }
+    }
+
+    if(sk->options.local_error != FNET_ERR_OK)
+    {
+        events |= FNET_SOCKET_POLL_ERROR;
+    }
+
+    return events;
+}
+
+/************************************************************************
+* NAME: fnet_tcp_drain
+*
+* DESCRIPTION: fnet_tcp_drain removes the temporary data.
+*
+* RETURNS: None.          
+*************************************************************************/
+static void fnet_tcp_drain( void )
+{
+    fnet_socket_if_t       *sk; 
+    fnet_socket_if_t       *delsk;
+    fnet_tcp_control_t  *cb;    
 
 
     fnet_isr_lock();
@@ -1394,12 +1955,22 @@ static void fnet_tcp_initconnection( fnet_socket_if_t *sk )
         cb->tcpcb_rcvmss = (fnet_uint16_t)cb->tcpcb_rcvcountmax;
     }
 
-    /* Receive a scale of the input window.*/
+    /* Receive a scale of the input window 
+     * (it is used only if the buffer is greater than the maximal window).*/
     while(((fnet_uint32_t)FNET_TCP_MAXWIN << cb->tcpcb_recvscale) < cb->tcpcb_rcvcountmax)
     {
         cb->tcpcb_recvscale++;
     }
 
+#if FNET_CFG_TCP_RCVBUF_AUTO
+    /* The window starts small and grows up to the buffer size.*/
+    if((sk->options.tcp_opt.rcvbuf_auto == FNET_TRUE) && (cb->tcpcb_rcvcountmax > FNET_CFG_TCP_RCVBUF_AUTO_INIT))
+    {
+        cb->tcpcb_rcvcountcap = cb->tcpcb_rcvcountmax;
+        cb->tcpcb_rcvcountmax = FNET_CFG_TCP_RCVBUF_AUTO_INIT;
+    }
+#endif
+
     /* Stop all timers.*/
     cb->tcpcb_timers.retransmission = FNET_TCP_TIMER_OFF;
     cb->tcpcb_timers.connection = FNET_TCP_TIMER_OFF;
@@ -1408,10 +1979,24 @@ static void fnet_tcp_initconnection( fnet_socket_if_t *sk )
     cb->tcpcb_timers.persist = FNET_TCP_TIMER_OFF;
     cb->tcpcb_timers.keepalive = FNET_TCP_TIMER_OFF;
     cb->tcpcb_timers.delayed_ack = FNET_TCP_TIMER_OFF;
+#if FNET_CFG_TCP_TLP
+    cb->tcpcb_timers.tlp = FNET_TCP_TIMER_OFF;
+#endif
 
     /* Initialize the retransmission timeout.*/
     cb->tcpcb_rto = FNET_TCP_TIMERS_INIT;
-    cb->tcpcb_crto = FNET_TCP_TIMERS_INIT;
+
+    if(cb->tcpcb_rto < sk->options.tcp_opt.rto_min)
+    {
+        cb->tcpcb_rto = sk->options.tcp_opt.rto_min;
+    }
+
+    if(cb->tcpcb_rto > sk->options.tcp_opt.rto_max)
+    {
+        cb->tcpcb_rto = sk->options.tcp_opt.rto_max;
+    }
+
+    cb->tcpcb_crto = cb->tcpcb_rto;
 
 #if FNET_CFG_TCP_URGENT
     /* Initialize the receive urgent mark.*/
@@ -1421,6 +2006,13 @@ static void fnet_tcp_initconnection( fnet_socket_if_t *sk )
     /* Initialize Slow Start Threshold.*/
     cb->tcpcb_ssthresh = FNET_TCP_MAX_BUFFER;
 
+    /* Select the congestion control algorithm.*/
+    cb->tcpcb_cc = fnet_tcp_cc_get(sk->options.tcp_opt.congestion);
+    if(cb->tcpcb_cc == 0)
+    {
+        cb->tcpcb_cc = &fnet_tcp_cc_newreno;
+    }
+
     /* Clear the input buffer.*/
     if(sk->receive_buffer.count)
     {
@@ -1453,10 +2045,27 @@ static fnet_bool_t fnet_tcp_inputsk( fnet_socket_if_t *sk, fnet_netbuf_t *insegm
     fnet_size_t         tcp_length = (fnet_size_t)FNET_TCP_LENGTH(insegment);
     fnet_uint32_t       tcp_ack = fnet_ntohl(FNET_TCP_ACK(insegment));
     fnet_bool_t         exit_flag = FNET_FALSE;	
+    fnet_uint32_t       wnd;                    /* Previous send window.*/
 
     /* Get the flags.*/
     sgmtype = (fnet_uint8_t)(FNET_TCP_FLAGS(insegment));
-    
+
+#if FNET_CFG_TCP_SACK || FNET_CFG_TCP_TIMESTAMPS
+    /* Receive the SACK blocks and the timestamps 
+     * (the options of the SYN segment are processed later).*/
+    if(((sgmtype & FNET_TCP_SGT_SYN) == 0u) && (tcp_length > FNET_TCP_SIZE_HEADER)
+        && ((cb->tcpcb_flags & (FNET_TCP_CBF_SACK | FNET_TCP_CBF_TIMESTAMP)) != 0u))
+    {
+        fnet_tcp_getopt(sk, insegment);
+    }
+#if FNET_CFG_TCP_TIMESTAMPS
+    else
+    {
+        cb->tcpcb_flags &= ~FNET_TCP_CBF_TIMESTAMP_RCVD;
+    }
+#endif
+#endif
+
     /* Check the sequence number.*/
     switch(cb->tcpcb_connection_state)
     {
@@ -1464,6 +2073,15 @@ static fnet_bool_t fnet_tcp_inputsk( fnet_socket_if_t *sk, fnet_netbuf_t *insegm
         case FNET_TCP_CS_LISTENING:
             break;
         default:
+        #if FNET_CFG_TCP_TIMESTAMPS
+            /* Drop the old duplicate segment.*/
+            if(fnet_tcp_paws(cb, sgmtype) == FNET_FALSE)
+            {
+                fnet_tcp_sendack(sk);
+                return FNET_TRUE;
+            }
+        #endif
+
             if((cb->tcpcb_connection_state) == FNET_TCP_CS_SYN_RCVD)
             {
                 if((cb->tcpcb_prev_connection_state == FNET_TCP_CS_SYN_SENT) && ((sgmtype & FNET_TCP_SGT_SYN) != 0u))
@@ -1484,6 +2102,12 @@ static fnet_bool_t fnet_tcp_inputsk( fnet_socket_if_t *sk, fnet_netbuf_t *insegm
                     repsize = fnet_tcp_getsize(tcp_seq, cb->tcpcb_sndack);
                     fnet_netbuf_cut_center(&insegment, tcp_length, repsize);
 
+                    /* The header is updated in place, it must not be shared.*/
+                    if(fnet_netbuf_cow(&insegment, tcp_length) == FNET_ERR)
+                    {
+                        return FNET_TRUE;
+                    }
+
                     /* If urgent  flag is present, recalculate of the urgent pointer.*/
                     if((sgmtype & FNET_TCP_SGT_URG) != 0u)
                     {
@@ -1532,6 +2156,20 @@ static fnet_bool_t fnet_tcp_inputsk( fnet_socket_if_t *sk, fnet_netbuf_t *insegm
                     ackparam |= FNET_TCP_AP_SEND_IMMEDIATELLY;
                 }
             }
+
+        #if FNET_CFG_TCP_TIMESTAMPS
+            /* Save the timestamp to be echoed, if the segment 
+             * starts at or before the last acknowledged sequence number.*/
+            if(((cb->tcpcb_flags & FNET_TCP_CBF_TIMESTAMP_RCVD) != 0u) 
+                && (fnet_tcp_hit(tcp_seq, tcp_seq + insegment->total_length - tcp_length + (((sgmtype & FNET_TCP_SGT_FIN) != 0u) ? 1u : 0u), cb->tcpcb_tslastack)))
+            {
+                if((fnet_int32_t)(cb->tcpcb_tsval - cb->tcpcb_tsrecent) >= 0)
+                {
+                    cb->tcpcb_tsrecent = cb->tcpcb_tsval;
+                    cb->tcpcb_tsrecent_age = fnet_timer_ms();
+                }
+            }
+        #endif
             break;
     }
 
@@ -1600,6 +2238,15 @@ static fnet_bool_t fnet_tcp_inputsk( fnet_socket_if_t *sk, fnet_netbuf_t *insegm
             case FNET_TCP_CS_LISTENING:
                 if((sgmtype & FNET_TCP_SGT_ACK) != 0u)
                 {
+                #if FNET_CFG_TCP_SYN_COOKIES
+                    /* The acknowledgment of the SYN cookie creates the connection.*/
+                    psk = fnet_tcp_cookie_check(sk, insegment, dest_addr);
+
+                    if(psk)
+                    {
+                        return fnet_tcp_inputsk(psk, insegment, src_addr, dest_addr);
+                    }
+                #endif
                     /* Send the reset segment.*/
                     fnet_tcp_sendrst(&sk->options, insegment, dest_addr, src_addr);
                 }
@@ -1682,6 +2329,8 @@ static fnet_bool_t fnet_tcp_inputsk( fnet_socket_if_t *sk, fnet_netbuf_t *insegm
     }					
 
     /* Set the window size (of another side).*/
+    wnd = cb->tcpcb_sndwnd;
+
     if((sgmtype & FNET_TCP_SGT_SYN) != 0u)
     {
         cb->tcpcb_sndwnd = fnet_ntohs(FNET_TCP_WND(insegment));
@@ -1691,6 +2340,11 @@ static fnet_bool_t fnet_tcp_inputsk( fnet_socket_if_t *sk, fnet_netbuf_t *insegm
         cb->tcpcb_sndwnd = ((fnet_uint32_t)fnet_ntohs(FNET_TCP_WND(insegment)) << cb->tcpcb_sendscale);
     }
 
+    if(cb->tcpcb_sndwnd != wnd)
+    {
+        ackparam |= (fnet_flag_t)FNET_TCP_AP_WND_UPDATE;
+    }
+
     if(cb->tcpcb_maxwnd < cb->tcpcb_sndwnd)
     {
         cb->tcpcb_maxwnd = cb->tcpcb_sndwnd;
@@ -1734,11 +2388,12 @@ static fnet_bool_t fnet_tcp_inputsk( fnet_socket_if_t *sk, fnet_netbuf_t *insegm
                 /* Change the states.*/
                 cb->tcpcb_connection_state = FNET_TCP_CS_ESTABLISHED;
                 sk->state = SS_CONNECTED;
+                fnet_socket_poll_update(sk);
 
                 /* Initialize the keepalive timer.*/
                 if(sk->options.so_keepalive == FNET_TRUE)
                 {
-                    cb->tcpcb_timers.keepalive = sk->options.tcp_opt.keep_idle;
+                    fnet_tcp_settimer(&cb->tcpcb_timers.keepalive, sk->options.tcp_opt.keep_idle);
                 }
                 break;
           }
@@ -1746,7 +2401,7 @@ static fnet_bool_t fnet_tcp_inputsk( fnet_socket_if_t *sk, fnet_netbuf_t *insegm
           /* Process the simultaneous open.*/
           {
               /* Reinitialize the retrasmission timer.*/
-              cb->tcpcb_timers.retransmission = cb->tcpcb_rto;
+              fnet_tcp_settimer(&cb->tcpcb_timers.retransmission, cb->tcpcb_rto);
 
               /* Receive the options.*/
               fnet_tcp_getopt(sk, insegment);
@@ -1778,8 +2433,15 @@ static fnet_bool_t fnet_tcp_inputsk( fnet_socket_if_t *sk, fnet_netbuf_t *insegm
         case FNET_TCP_CS_LISTENING:
 
             /* If socket can't be created, return.*/
-            if(sk->partial_con_len + sk->incoming_con_len >= sk->con_limit)
+            if((sk->partial_con_len >= FNET_CFG_TCP_SYN_BACKLOG) || (sk->partial_con_len + sk->incoming_con_len >= sk->con_limit))
             {
+            #if FNET_CFG_TCP_SYN_COOKIES
+                /* Answer by the SYN cookie, if the connection can be accepted later.*/
+                if(sk->incoming_con_len < sk->con_limit)
+                {
+                    fnet_tcp_cookie_send(sk, insegment, src_addr, dest_addr);
+                }
+            #endif
                 fnet_memset_zero(&sk->foreign_addr, sizeof(sk->foreign_addr));
                 cb->tcpcb_sndwnd = 0u;
                 cb->tcpcb_maxwnd = 0u;
@@ -1787,9 +2449,7 @@ static fnet_bool_t fnet_tcp_inputsk( fnet_socket_if_t *sk, fnet_netbuf_t *insegm
             }
 
             /* Create the socket.*/
-            psk = fnet_socket_copy(sk);
-
-            fnet_memset_zero(&sk->foreign_addr, sizeof(sk->foreign_addr));         
+            psk = fnet_tcp_newpartialsk(sk, dest_addr, fnet_tcp_isntime, tcp_seq);
 
             /* Check the memory allocation.*/
             if(!psk)
@@ -1799,24 +2459,7 @@ static fnet_bool_t fnet_tcp_inputsk( fnet_socket_if_t *sk, fnet_netbuf_t *insegm
                 break;
             }
 
-            /* Set the local address.*/
-            fnet_memcpy(&psk->local_addr, dest_addr, sizeof(psk->local_addr));
-
-            /* Create the control block.*/
-            pcb = (fnet_tcp_control_t *)fnet_malloc_zero(sizeof(fnet_tcp_control_t));
-
-            /* Check the memory allocation.*/
-            if(!pcb)
-            {
-                fnet_free(psk);
-                cb->tcpcb_sndwnd = 0u;
-                cb->tcpcb_maxwnd = 0u;
-                break;
-            }
-
-            /* Initialize the pointer.*/
-            psk->protocol_control = (void *)pcb;
-            fnet_tcp_initconnection(psk);
+            pcb = (fnet_tcp_control_t *)psk->protocol_control;
 
             /* Copy the control block parameters.*/
             pcb->tcpcb_sndwnd = cb->tcpcb_sndwnd;
@@ -1824,25 +2467,6 @@ static fnet_bool_t fnet_tcp_inputsk( fnet_socket_if_t *sk, fnet_netbuf_t *insegm
             cb->tcpcb_sndwnd = 0u;
             cb->tcpcb_maxwnd = 0u;
 
-            /* Add the new socket to the partial list.*/
-            fnet_tcp_addpartialsk(sk, psk);
-
-            /* Initialize the parameters of the control block.*/
-            pcb->tcpcb_sndack = tcp_seq + 1u;
-            pcb->tcpcb_sndseq = fnet_tcp_isntime;
-            pcb->tcpcb_maxrcvack = fnet_tcp_isntime + 1u;
-          
-
-#if FNET_CFG_TCP_URGENT  
-            pcb->tcpcb_sndurgseq = pcb->tcpcb_sndseq;        
-            pcb->tcpcb_rcvurgseq = tcp_seq;
-#endif /* FNET_CFG_TCP_URGENT */
-
-            /* Change the states.*/
-            psk->state = SS_CONNECTING;
-            pcb->tcpcb_prev_connection_state = FNET_TCP_CS_LISTENING;
-            pcb->tcpcb_connection_state = FNET_TCP_CS_SYN_RCVD;
-
             /* Receive the options.*/
             fnet_tcp_getopt(psk, insegment);
             fnet_tcp_getsynopt(psk);
@@ -1865,8 +2489,8 @@ static fnet_bool_t fnet_tcp_inputsk( fnet_socket_if_t *sk, fnet_netbuf_t *insegm
             fnet_tcp_isntime += FNET_TCP_STEPISN;
 
             /* Initialization the connection timer.*/
-            pcb->tcpcb_timers.connection = FNET_TCP_ABORT_INTERVAL_CON;
-            pcb->tcpcb_timers.retransmission = pcb->tcpcb_rto;
+            fnet_tcp_settimer(&pcb->tcpcb_timers.connection, FNET_TCP_ABORT_INTERVAL_CON);
+            fnet_tcp_settimer(&pcb->tcpcb_timers.retransmission, pcb->tcpcb_rto);
             break;
 
         case FNET_TCP_CS_SYN_RCVD:
@@ -1874,6 +2498,7 @@ static fnet_bool_t fnet_tcp_inputsk( fnet_socket_if_t *sk, fnet_netbuf_t *insegm
             /* Change the states.*/
             cb->tcpcb_connection_state = FNET_TCP_CS_ESTABLISHED;
             sk->state = SS_CONNECTED;
+            fnet_socket_poll_update(sk);
 
             /* Stop the connection and retransmission timers.*/
             cb->tcpcb_timers.connection = FNET_TCP_TIMER_OFF;
@@ -1903,7 +2528,7 @@ static fnet_bool_t fnet_tcp_inputsk( fnet_socket_if_t *sk, fnet_netbuf_t *insegm
                     /* Initialize the keepalive timer.*/
                     if(sk->options.so_keepalive == FNET_TRUE)
                     {
-                        cb->tcpcb_timers.keepalive = sk->options.tcp_opt.keep_idle;
+                        fnet_tcp_settimer(&cb->tcpcb_timers.keepalive, sk->options.tcp_opt.keep_idle);
                     }
                 }
             }
@@ -1939,7 +2564,7 @@ static fnet_bool_t fnet_tcp_inputsk( fnet_socket_if_t *sk, fnet_netbuf_t *insegm
             {
                 cb->tcpcb_connection_state = FNET_TCP_CS_TIME_WAIT;
                 /* Set the  timeout of the TIME_WAIT state.*/
-                cb->tcpcb_timers.connection = FNET_TCP_TIME_WAIT;
+                fnet_tcp_settimer(&cb->tcpcb_timers.connection, FNET_TCP_TIME_WAIT);
                 cb->tcpcb_timers.retransmission = FNET_TCP_TIMER_OFF;
                 cb->tcpcb_timers.keepalive = FNET_TCP_TIMER_OFF;
             }
@@ -1956,6 +2581,14 @@ static fnet_bool_t fnet_tcp_inputsk( fnet_socket_if_t *sk, fnet_netbuf_t *insegm
 			   return FNET_TRUE;
     }			
 		
+#if FNET_CFG_TCP_TIMEWAIT_SIZE
+    /* The closed socket is replaced by the compact record in the TIME_WAIT state.*/
+    if((cb->tcpcb_connection_state == FNET_TCP_CS_TIME_WAIT) && ((cb->tcpcb_flags & FNET_TCP_CBF_CLOSE) != 0u))
+    {
+        fnet_tcp_timewait_add(sk);
+        return result;
+    }
+#endif
 
     /* If the input buffer is closed, delete the input data.*/
     if((sk->receive_buffer.is_shutdown) && (sk->receive_buffer.count))
@@ -1978,15 +2611,14 @@ static fnet_bool_t fnet_tcp_dataprocess( fnet_socket_if_t *sk, fnet_netbuf_t *in
 {
     fnet_tcp_control_t  *cb = (fnet_tcp_control_t *)sk->protocol_control;       
     fnet_size_t         size;                                     
-    fnet_int32_t        err;
     fnet_bool_t         delflag = FNET_TRUE;
-    fnet_uint32_t       seq;
     fnet_uint32_t       tcp_ack = fnet_ntohl(FNET_TCP_ACK(insegment));
+    fnet_uint32_t       tcp_flags = (fnet_uint32_t)FNET_TCP_FLAGS(insegment); /* The segment may be consumed by fnet_tcp_addinpbuf().*/
 
     /* Reinitialize the keepalive timer.*/
     if(sk->options.so_keepalive == FNET_TRUE)
     {
-        cb->tcpcb_timers.keepalive = sk->options.tcp_opt.keep_idle;
+        fnet_tcp_settimer(&cb->tcpcb_timers.keepalive, sk->options.tcp_opt.keep_idle);
     }
     else
     {
@@ -2006,53 +2638,59 @@ static fnet_bool_t fnet_tcp_dataprocess( fnet_socket_if_t *sk, fnet_netbuf_t *in
               the ACK has outstanding data, (b) the incoming acknowledgment
               carries no data, (c) the SYN and FIN bits are both off, (d) the
               acknowledgment number is equal to the greatest acknowledgment
-              received on the given connection (TCP.UNA from [RFC793]) and (e)-TBD
+              received on the given connection (TCP.UNA from [RFC793]) and (e)
               the advertised window in the incoming acknowledgment equals the
               advertised window in the last incoming acknowledgment.*/
         if((cb->tcpcb_sndseq != cb->tcpcb_rcvack) && (sk->send_buffer.count != 0u) && 
+            ((*ackparam & FNET_TCP_AP_WND_UPDATE) == 0u) &&
             ((insegment->total_length - (fnet_size_t)FNET_TCP_LENGTH(insegment)) == 0u) &&
             ((FNET_TCP_FLAGS(insegment) & (FNET_TCP_SGT_FIN | FNET_TCP_SGT_SYN)) == 0u))
         {
             /* Increase the timer of repeated acknowledgments.*/
             cb->tcpcb_fastretrcounter++;
 
-            /* If the number of repeated acknowledgments is FNET_TCP_NUMBER_FOR_FAST_RET,
-             * process the fast retransmission.*/
-            if(cb->tcpcb_fastretrcounter == FNET_TCP_NUMBER_FOR_FAST_RET)
+            if((cb->tcpcb_flags & FNET_TCP_CBF_RECOVERY) != 0u)
             {
-                /* Increase the timer of repeated acknowledgments.*/  
-                cb->tcpcb_fastretrcounter++;
-
-                /* Recalculate the congestion window and slow start threshold values.*/
-                if(cb->tcpcb_cwnd > cb->tcpcb_sndwnd)
-                {
-                    cb->tcpcb_ssthresh = cb->tcpcb_sndwnd >> 1;
-                }
-                else
-                {
-                    cb->tcpcb_ssthresh = cb->tcpcb_cwnd >> 1;
-                }
+                /* Each repeated acknowledgment means that a segment has left the network,
+                 * inflate the congestion window (RFC6582).*/
+                cb->tcpcb_cwnd += cb->tcpcb_sndmss;
 
-                if(cb->tcpcb_ssthresh < ((fnet_uint32_t)cb->tcpcb_sndmss << 1))
+#if FNET_CFG_TCP_SACK
+                /* Each repeated acknowledgment allows to retransmit the next hole.*/
+                if(((cb->tcpcb_flags & FNET_TCP_CBF_SACK) != 0u) && (fnet_tcp_sack_retransmit(sk) == FNET_TRUE))
                 {
-                    cb->tcpcb_ssthresh = ((fnet_uint32_t)cb->tcpcb_sndmss << 1);
+                    *ackparam |= (fnet_flag_t)FNET_TCP_AP_NO_SENDING;
                 }
-
-                cb->tcpcb_cwnd = cb->tcpcb_ssthresh;
-
-                /* Retransmit the segment.*/
-                seq = cb->tcpcb_sndseq;
-                cb->tcpcb_sndseq = cb->tcpcb_rcvack;
-                fnet_tcp_senddataseg(sk, 0, 0u, (fnet_size_t)cb->tcpcb_sndmss);
-                cb->tcpcb_sndseq = seq;
+#endif
+            }
+            /* If the number of repeated acknowledgments is FNET_TCP_NUMBER_FOR_FAST_RET,
+             * or the data above the first unacknowledged segment is selectively acknowledged,
+             * process the fast retransmission.*/
+            else if((cb->tcpcb_fastretrcounter == FNET_TCP_NUMBER_FOR_FAST_RET)
+        #if FNET_CFG_TCP_SACK
+                || ((cb->tcpcb_fastretrcounter < FNET_TCP_NUMBER_FOR_FAST_RET) 
+                    && (fnet_tcp_sack_count(cb) > ((FNET_TCP_NUMBER_FOR_FAST_RET - 1u) * cb->tcpcb_sndmss)))
+        #endif
+              )
+            {
+                fnet_tcp_recovery(sk);
 
                 /* Acknowledgment is sent in retransmited segment.*/
                 *ackparam |= (fnet_flag_t)FNET_TCP_AP_NO_SENDING;
+            }
+#if FNET_CFG_TCP_TLP
+            else if(cb->tcpcb_fastretrcounter == 1u)
+            {
+                /* Start the reordering timer. If the first unacknowledged segment
+                 * is not acknowledged during a quarter of the round trip time,
+                 * it is considered lost.*/
+                size = ((fnet_uint32_t)cb->tcpcb_srtt >> FNET_TCP_RTT_SHIFT) >> 2;
 
-                /* Round trip time can't be measured in this case.*/
-                cb->tcpcb_timers.round_trip = FNET_TCP_TIMER_OFF;
-                cb->tcpcb_timing_state = TCP_TS_SEGMENT_LOST;
+                fnet_tcp_settimer(&cb->tcpcb_timers.tlp, (size > FNET_TCP_TIMER_PERIOD) ? size : FNET_TCP_TIMER_PERIOD);
             }
+#endif
+            else
+            {}
         }
     }
     else
@@ -2060,7 +2698,7 @@ static fnet_bool_t fnet_tcp_dataprocess( fnet_socket_if_t *sk, fnet_netbuf_t *in
         /* Reset the counter of repeated acknowledgments.*/
         cb->tcpcb_fastretrcounter = 0u;
 
-        /* Recalculate the congestion window and slow start threshold values.*/
+        /* Size of the acknowledged data.*/
         size = fnet_tcp_getsize(cb->tcpcb_rcvack, tcp_ack);
 
         if(size > sk->send_buffer.count)
@@ -2068,32 +2706,10 @@ static fnet_bool_t fnet_tcp_dataprocess( fnet_socket_if_t *sk, fnet_netbuf_t *in
             size = sk->send_buffer.count;
         }
 
-        if(cb->tcpcb_cwnd < FNET_TCP_MAX_BUFFER)
+        /* Recalculate the congestion window and slow start threshold values.*/
+        if((cb->tcpcb_flags & FNET_TCP_CBF_RECOVERY) == 0u)
         {
-            if(cb->tcpcb_cwnd > cb->tcpcb_ssthresh)
-            {
-                /* Congestion avoidance mode.*/
-                cb->tcpcb_pcount += size;
-            }
-            else
-            {
-                /* Slow start mode.*/
-                if(cb->tcpcb_cwnd + size > cb->tcpcb_ssthresh)
-                {
-                    cb->tcpcb_pcount = cb->tcpcb_pcount + cb->tcpcb_cwnd + size - cb->tcpcb_ssthresh;
-                    cb->tcpcb_cwnd = cb->tcpcb_ssthresh;
-                }
-                else
-                {
-                    cb->tcpcb_cwnd += size;
-                }
-            }
-
-            if(cb->tcpcb_pcount >= cb->tcpcb_cwnd)
-            {
-                cb->tcpcb_pcount -= cb->tcpcb_cwnd;
-                cb->tcpcb_cwnd += cb->tcpcb_sndmss;
-            }
+            cb->tcpcb_cc->on_ack(cb, size);
         }
 
         /* Delete the acknowledged data.*/
@@ -2108,41 +2724,92 @@ static fnet_bool_t fnet_tcp_dataprocess( fnet_socket_if_t *sk, fnet_netbuf_t *in
             cb->tcpcb_sndseq = cb->tcpcb_rcvack;
         }
 
-        /* Calculate the retransmission timeout ( using Jacobson method ).*/
-        if((FNET_TCP_COMP_GE(cb->tcpcb_rcvack, cb->tcpcb_timingack)) && ((cb->tcpcb_timing_state) == TCP_TS_SEGMENT_SENT))
+#if FNET_CFG_TCP_SACK
+        fnet_tcp_sack_ack(cb);
+#endif
+
+        if((cb->tcpcb_flags & FNET_TCP_CBF_RECOVERY) != 0u)
         {
-            if(cb->tcpcb_srtt)
+            if(FNET_TCP_COMP_GE(cb->tcpcb_rcvack, cb->tcpcb_recover))
             {
-                err = (fnet_int32_t)(cb->tcpcb_timers.round_trip - ((fnet_uint32_t)cb->tcpcb_srtt >> FNET_TCP_RTT_SHIFT));
+                /* All data sent before the loss is acknowledged (full acknowledgment), 
+                 * deflate the congestion window (RFC6582).*/
+                cb->tcpcb_flags &= ~FNET_TCP_CBF_RECOVERY;
 
-                if((cb->tcpcb_srtt += err) <= 0)
+                size = fnet_tcp_getsize(cb->tcpcb_rcvack, cb->tcpcb_maxrcvack);
+                if(size < cb->tcpcb_sndmss)
                 {
-                    cb->tcpcb_srtt = 1;
+                    size = cb->tcpcb_sndmss;
                 }
+                size += cb->tcpcb_sndmss;
+
+                cb->tcpcb_cwnd = (cb->tcpcb_ssthresh < size) ? cb->tcpcb_ssthresh : size;
+            }
+            else
+            {
+                /* Partial acknowledgment, the first unacknowledged segment is lost too.
+                 * Deflate the congestion window by the acknowledged data, 
+                 * and add back one segment (RFC6582).*/
+                cb->tcpcb_cwnd = (cb->tcpcb_cwnd > size) ? (cb->tcpcb_cwnd - size) : 0u;
 
-                if(err < 0)
+                if(size >= cb->tcpcb_sndmss)
                 {
-                    err = -err; 
+                    cb->tcpcb_cwnd += cb->tcpcb_sndmss;
                 }
 
-                err -= (fnet_int32_t)((fnet_uint32_t)cb->tcpcb_rttvar >> FNET_TCP_RTTVAR_SHIFT);
+                if(cb->tcpcb_cwnd < cb->tcpcb_sndmss)
+                {
+                    cb->tcpcb_cwnd = cb->tcpcb_sndmss;
+                }
 
-                if((cb->tcpcb_rttvar += err) <= 0)
+#if FNET_CFG_TCP_SACK
+                if(((cb->tcpcb_flags & FNET_TCP_CBF_SACK) != 0u) && (fnet_tcp_sack_retransmit(sk) == FNET_TRUE))
                 {
-                    cb->tcpcb_rttvar = 1;
+                    *ackparam |= (fnet_flag_t)FNET_TCP_AP_NO_SENDING;
+                }
+                else if(FNET_TCP_COMP_GE(cb->tcpcb_rcvack, cb->tcpcb_sackrxt))
+#endif
+                {
+                    fnet_tcp_rexmtfirst(sk);
+                    *ackparam |= (fnet_flag_t)FNET_TCP_AP_NO_SENDING;
                 }
             }
-            else
+        }
+
+#if FNET_CFG_TCP_TLP
+        /* The tail loss probe is acknowledged. 
+         * The loss, repaired by the probe, reduces the congestion window (RFC8985).*/
+        if(((cb->tcpcb_flags & FNET_TCP_CBF_TLP) != 0u) && (FNET_TCP_COMP_GE(cb->tcpcb_rcvack, cb->tcpcb_tlphigh)))
+        {
+            cb->tcpcb_flags &= ~FNET_TCP_CBF_TLP;
+
+            if((cb->tcpcb_flags & FNET_TCP_CBF_RECOVERY) == 0u)
             {
-                /* Initial calculation of the retransmission variables.*/
-                cb->tcpcb_srtt = (fnet_int32_t)(((fnet_uint32_t)cb->tcpcb_timers.round_trip + 1u) << FNET_TCP_RTT_SHIFT);
-                cb->tcpcb_rttvar = (fnet_int32_t)(((fnet_uint32_t)cb->tcpcb_timers.round_trip + 1u) << (FNET_TCP_RTTVAR_SHIFT - 1u)); 
+                cb->tcpcb_cc->on_loss(cb);
             }
+        }
+#endif
+
+#if FNET_CFG_TCP_TIMESTAMPS
+        /* Each acknowledgment of new data gives the round trip time sample,
+         * echoed in the timestamps option (retransmitted segments too).*/
+        if(((cb->tcpcb_flags & FNET_TCP_CBF_TIMESTAMP_RCVD) != 0u) && (cb->tcpcb_tsecr)
+            && ((fnet_time_t)(fnet_timer_fine_ms() - cb->tcpcb_tsecr) <= FNET_TCP_TIMESTAMP_RTT_MAX))
+        {
+            fnet_tcp_rttupdate(sk, (fnet_time_t)(fnet_timer_fine_ms() - cb->tcpcb_tsecr));
+        }
+        else
+#endif
+        /* Calculate the retransmission timeout ( using Jacobson method ).*/
+        if((FNET_TCP_COMP_GE(cb->tcpcb_rcvack, cb->tcpcb_timingack)) && ((cb->tcpcb_timing_state) == TCP_TS_SEGMENT_SENT))
+        {
+            fnet_tcp_rttupdate(sk, (fnet_time_t)(fnet_timer_fine_ms() - cb->tcpcb_timers.round_trip));
 
             cb->tcpcb_timing_state = TCP_TS_ACK_RECEIVED;
-            cb->tcpcb_rto = ((fnet_uint32_t)cb->tcpcb_srtt >> FNET_TCP_RTT_SHIFT) + (fnet_uint32_t)cb->tcpcb_rttvar;
             cb->tcpcb_timers.round_trip = FNET_TCP_TIMER_OFF;
         }
+        else
+        {}
     }
 
     /* If the final segment is not received, add the data to the input buffer.*/
@@ -2160,7 +2827,7 @@ static fnet_bool_t fnet_tcp_dataprocess( fnet_socket_if_t *sk, fnet_netbuf_t *in
 
     /* Acknowledgment of the final segment must be send immediatelly.*/
     if(((*ackparam & FNET_TCP_AP_FIN_ACK) != 0u)
-         ||((FNET_TCP_FLAGS(insegment) & FNET_TCP_SGT_PSH) != 0u))
+         ||((tcp_flags & FNET_TCP_SGT_PSH) != 0u))
     {
            fnet_tcp_sendack(sk);
     }
@@ -2171,6 +2838,9 @@ static fnet_bool_t fnet_tcp_dataprocess( fnet_socket_if_t *sk, fnet_netbuf_t *in
         *ackparam |= FNET_TCP_AP_NO_SENDING;
     }
 
+    /* The send buffer is trimmed and the data are received, update the readiness.*/
+    fnet_socket_poll_update(sk);
+
     /* If the window of another side is closed, turn on the persist timer.*/
     if((!cb->tcpcb_sndwnd) && (sk->send_buffer.count))
     {
@@ -2179,7 +2849,7 @@ static fnet_bool_t fnet_tcp_dataprocess( fnet_socket_if_t *sk, fnet_netbuf_t *in
             cb->tcpcb_cprto = cb->tcpcb_rto;
         }
 
-        cb->tcpcb_timers.persist = cb->tcpcb_cprto;
+        fnet_tcp_settimer(&cb->tcpcb_timers.persist, cb->tcpcb_cprto);
     }
     else
     {
@@ -2196,9 +2866,13 @@ static fnet_bool_t fnet_tcp_dataprocess( fnet_socket_if_t *sk, fnet_netbuf_t *in
     }
     else
     {
-        cb->tcpcb_timers.retransmission = cb->tcpcb_rto;
+        fnet_tcp_settimer(&cb->tcpcb_timers.retransmission, cb->tcpcb_rto);
     }
 
+#if FNET_CFG_TCP_TLP
+    fnet_tcp_tlpset(sk);
+#endif
+
     /* If the acknowledgment is sent, return
      * If the acnkowledgment must be sent immediatelly, send it
      * If the acnkowledgment must be sent after delay, turn on the acknowledgment timer.*/
@@ -2215,7 +2889,10 @@ static fnet_bool_t fnet_tcp_dataprocess( fnet_socket_if_t *sk, fnet_netbuf_t *in
 
     if((*ackparam & FNET_TCP_AP_SEND_WITH_DELAY) != 0u)
     {
-        cb->tcpcb_timers.delayed_ack = 1u; /* Delay 200 ms*/
+        if(cb->tcpcb_timers.delayed_ack == FNET_TCP_TIMER_OFF)
+        {
+            fnet_tcp_settimer(&cb->tcpcb_timers.delayed_ack, FNET_TCP_DELACK_TIMEOUT);
+        }
     }
 
     return delflag;
@@ -2247,11 +2924,7 @@ static fnet_bool_t fnet_tcp_addinpbuf( fnet_socket_if_t *sk, fnet_netbuf_t *inse
     }
     
     /* Process the segment that came in order.*/
-    if((fnet_ntohl(FNET_TCP_SEQ(insegment)) == (cb->tcpcb_sndack))
-        #if !FNET_CFG_TCP_DISCARD_OUT_OF_ORDER 
-            && (!cb->tcpcb_count)
-        #endif
-        )
+    if(fnet_ntohl(FNET_TCP_SEQ(insegment)) == (cb->tcpcb_sndack))
     {
     #if FNET_CFG_TCP_URGENT    
         if(tcp_flags & FNET_TCP_SGT_URG)
@@ -2273,6 +2946,10 @@ static fnet_bool_t fnet_tcp_addinpbuf( fnet_socket_if_t *sk, fnet_netbuf_t *inse
             fnet_tcp_finprocessing(sk, fnet_ntohl(FNET_TCP_ACK(insegment)));
             cb->tcpcb_sndack++;
             *ackparam |= FNET_TCP_AP_FIN_ACK;
+        #if !FNET_CFG_TCP_DISCARD_OUT_OF_ORDER
+            /* Nothing can follow the final segment.*/
+            fnet_tcp_deletetmpbuf(cb);
+        #endif
         }
 
         /* Delete the header.*/
@@ -2283,12 +2960,19 @@ static fnet_bool_t fnet_tcp_addinpbuf( fnet_socket_if_t *sk, fnet_netbuf_t *inse
         if(insegment)
         {
             cb->tcpcb_sndack += insegment->total_length;
-            sk->receive_buffer.net_buf_chain = fnet_netbuf_concat(sk->receive_buffer.net_buf_chain,
-                                                                  insegment);
-            sk->receive_buffer.count += insegment->total_length;
+            fnet_socket_buffer_concat(&sk->receive_buffer, insegment);
            
             *ackparam |= FNET_TCP_AP_SEND_WITH_DELAY;
         }
+
+    #if !FNET_CFG_TCP_DISCARD_OUT_OF_ORDER 
+        /* Move the queued data that is in order now.*/
+        fnet_tcp_reass_input(sk, ackparam);
+    #endif
+
+    #if FNET_CFG_TCP_RCVBUF_AUTO
+        fnet_tcp_rcvbuf_auto(cb);
+    #endif
         
         return FNET_TRUE;
     }
@@ -2296,158 +2980,365 @@ static fnet_bool_t fnet_tcp_addinpbuf( fnet_socket_if_t *sk, fnet_netbuf_t *inse
     result = FNET_FALSE; /* The data is not added to the buffer.*/
 
 #if !FNET_CFG_TCP_DISCARD_OUT_OF_ORDER 
+#if FNET_CFG_TCP_URGENT
+    /* Out-of-order urgent data is not queued, it will be retransmitted.*/
+    if((tcp_flags & FNET_TCP_SGT_URG) == 0u)
+#endif
     {
-        fnet_netbuf_t   *buf, *prevbuf; 
-        fnet_size_t     seq, size;
-    
-    
-        /* Add to the temporary input buffer.*/
-        if( ((cb->tcpcb_count + insegment->total_length) <= (cb->tcpcb_rcvcountmax))
-               || (fnet_ntohl(FNET_TCP_SEQ(insegment)) == cb->tcpcb_sndack))
-        {
-            /* Acknowledgement must be sent immediately.*/
-            *ackparam |= FNET_TCP_AP_SEND_IMMEDIATELLY;
-
-            /* Data is added to the buffer.*/
-            result = FNET_TRUE;
-
-            /* Add the segment to the temporary buffer (with sorting).*/
-            if(cb->tcpcb_rcvchain)
-            {
-                fnet_flag_t nextchain = FNET_TRUE;
-
-                buf = cb->tcpcb_rcvchain;
-                prevbuf = 0;
-
-                while(nextchain)
-                {
-                    if(FNET_TCP_COMP_G(fnet_ntohl(FNET_TCP_SEQ(buf)), fnet_ntohl(FNET_TCP_SEQ(insegment))))
-                    {
-                        if(prevbuf)
-                        {
-                            prevbuf->next_chain = insegment;
-                        }
-                        else
-                        {
-                            cb->tcpcb_rcvchain = insegment;
-                        }
+        fnet_uint32_t   seq = fnet_ntohl(FNET_TCP_SEQ(insegment));
 
-                        insegment->next_chain = buf;
-
-                        nextchain = FNET_FALSE;
-                    }
-                    else if(!buf->next_chain)
-                    {
-                        buf->next_chain = insegment;
-
-                        nextchain = FNET_FALSE;
-                    }
-                    else
-                    {
-                        prevbuf = buf;
-                        buf = buf->next_chain;
-                    }
-                }
-            }
-            else
-            {
-                cb->tcpcb_rcvchain = insegment;
-            }
+        /* Acknowledgement must be sent immediately.*/
+        *ackparam |= FNET_TCP_AP_SEND_IMMEDIATELLY;
 
-            cb->tcpcb_count += insegment->total_length;
+        /* Remember the final segment, it is processed when all data before it is received.*/
+        if((tcp_flags & FNET_TCP_SGT_FIN) != 0u)
+        {
+            cb->tcpcb_rcvfin = FNET_TRUE;
+            cb->tcpcb_rcvfinseq = seq + insegment->total_length - tcp_length;
+            cb->tcpcb_rcvfinack = fnet_ntohl(FNET_TCP_ACK(insegment));
         }
 
-        /* If the temporary buffer received the lost segment
-         * move the data from the temporary buffer to the input buffer of the socket.*/
-        if(fnet_ntohl(FNET_TCP_SEQ(insegment)) == cb->tcpcb_sndack) 
+        /* Delete the header and add the data to the reassembly queue.*/
+        fnet_netbuf_trim(&insegment, (fnet_int32_t)tcp_length);
+
+        if(insegment)
         {
-            seq = cb->tcpcb_sndack;
+            fnet_tcp_reass_add(&cb->tcpcb_reass, seq, insegment, cb->tcpcb_rcvcountmax);
+        }
 
-            while(cb->tcpcb_rcvchain)
-            {
-                if(FNET_TCP_COMP_GE(seq, fnet_ntohl(FNET_TCP_SEQ(cb->tcpcb_rcvchain))))
-                {
-                    if(FNET_TCP_COMP_GE(fnet_ntohl(FNET_TCP_SEQ(cb->tcpcb_rcvchain)) + cb->tcpcb_rcvchain->total_length 
-                                            - (fnet_size_t)FNET_TCP_LENGTH(cb->tcpcb_rcvchain),
-                                        seq))
-                    {
+        /* The segment is consumed.*/
+        result = FNET_TRUE;
+    }
+#endif 
 
-                        /* Receive the size of the repeated segment.*/
-                        size = fnet_tcp_getsize(fnet_ntohl(FNET_TCP_SEQ(cb->tcpcb_rcvchain)), seq);
+    return result;
+}
 
-                        /* Receive the new sequnce number.*/
-                        seq = fnet_ntohl(FNET_TCP_SEQ(cb->tcpcb_rcvchain)) + cb->tcpcb_rcvchain->total_length 
-                                  - (fnet_size_t)FNET_TCP_LENGTH(cb->tcpcb_rcvchain);
+#if !FNET_CFG_TCP_DISCARD_OUT_OF_ORDER
+/***********************************************************************
+* NAME: fnet_tcp_reass_input
+*
+* DESCRIPTION: This function moves the queued out-of-order data
+*              that became in order to the input buffer of the socket.
+*
+* RETURNS: None.
+*************************************************************************/
+static void fnet_tcp_reass_input( fnet_socket_if_t *sk, fnet_flag_t *ackparam )
+{
+    fnet_tcp_control_t  *cb = (fnet_tcp_control_t *)sk->protocol_control;
+    fnet_netbuf_t       *data;
 
-                        /* Set the size of the temporary buffer.*/
-                        cb->tcpcb_count -= cb->tcpcb_rcvchain->total_length;
+    if((cb->tcpcb_reass.block_num == 0u) && (cb->tcpcb_rcvfin == FNET_FALSE))
+    {
+        return;
+    }
 
-                        buf = cb->tcpcb_rcvchain;
-                        cb->tcpcb_rcvchain = cb->tcpcb_rcvchain->next_chain;
-                        buf->next_chain = 0;
+    /* The hole is (partially) filled, acknowledgement must be sent immediately.*/
+    *ackparam |= FNET_TCP_AP_SEND_IMMEDIATELLY;
 
-                    #if FNET_CFG_TCP_URGENT
-                        if(FNET_TCP_FLAGS(buf) & FNET_TCP_SGT_URG)
-                        {
-                            /* Process the urgent data.*/
-                            fnet_tcp_urgprocessing(sk, &buf, size, ackparam);
-                        }
-                        else
-                                           
-                        {
-                            /* Pull the receive urgent pointer
-                             * along with the receive window */
-                            cb->tcpcb_rcvurgseq = cb->tcpcb_sndack - 1;
-                        }
-                    #endif      
+#if FNET_CFG_TCP_URGENT
+    /* Pull the receive urgent pointer
+     * along with the receive window */
+    cb->tcpcb_rcvurgseq = cb->tcpcb_sndack - 1;
+#endif
 
+    while((data = fnet_tcp_reass_get(&cb->tcpcb_reass, &cb->tcpcb_sndack)) != 0)
+    {
+        fnet_socket_buffer_concat(&sk->receive_buffer, data);
+    }
 
-                        /* Process the final segment.*/
-                        if((FNET_TCP_FLAGS(buf) & FNET_TCP_SGT_FIN) != 0u)
-                        {
-                            fnet_tcp_finprocessing(sk, fnet_ntohl(FNET_TCP_ACK(buf)));
-                            *ackparam |= FNET_TCP_AP_FIN_ACK;
-                            seq++;
-                        }
+    /* Process the final segment.*/
+    if((cb->tcpcb_rcvfin == FNET_TRUE) && (cb->tcpcb_sndack == cb->tcpcb_rcvfinseq))
+    {
+        fnet_tcp_finprocessing(sk, cb->tcpcb_rcvfinack);
+        cb->tcpcb_sndack++;
+        *ackparam |= FNET_TCP_AP_FIN_ACK;
+        fnet_tcp_deletetmpbuf(cb);
+    }
+}
 
+/***********************************************************************
+* NAME: fnet_tcp_reass_tail
+*
+* DESCRIPTION: This function finds the last net_buf of the chain.
+*
+* RETURNS: The last net_buf.
+*************************************************************************/
+static fnet_netbuf_t *fnet_tcp_reass_tail( fnet_netbuf_t *nb )
+{
+    while(nb->next)
+    {
+        nb = nb->next;
+    }
 
-                        /* Delete the header and repeated part.*/
-                        fnet_netbuf_trim(&buf, (fnet_int32_t)((fnet_size_t)FNET_TCP_LENGTH(buf) + size));
+    return nb;
+}
 
-                        /* Add the data.*/
-                        if(buf)
-                        {
-                            sk->receive_buffer.count += buf->total_length;
-                            sk->receive_buffer.net_buf_chain =
-                                fnet_netbuf_concat(sk->receive_buffer.net_buf_chain,
-                                                   buf);
-                        }
+/***********************************************************************
+* NAME: fnet_tcp_reass_link
+*
+* DESCRIPTION: This function appends the data chain (head..tail) 
+*              to the block data.
+*
+* RETURNS: None.
+*************************************************************************/
+static void fnet_tcp_reass_link( fnet_tcp_reass_block_t *block, fnet_netbuf_t *head, fnet_netbuf_t *tail )
+{
+    if(head)
+    {
+        if(block->head)
+        {
+            block->tail->next = head;
+            block->head->total_length += head->total_length;
+            block->head->flags |= head->flags;
+        }
+        else
+        {
+            block->head = head;
+        }
 
-                        /* Set the  new acknowledgment number.*/
-                        cb->tcpcb_sndack = seq;
-                    }
-                    else
-                    {
-                        /* Delete the repeated segment.*/
-                        buf = cb->tcpcb_rcvchain;
-                        cb->tcpcb_rcvchain = cb->tcpcb_rcvchain->next_chain;
+        block->tail = tail;
+    }
+}
 
-                        /* Set the new size of the temporary buffer.*/
-                        cb->tcpcb_count -= cb->tcpcb_rcvchain->total_length;
-                        fnet_netbuf_free_chain(buf);
-                    }
-                }
-                else
+/***********************************************************************
+* NAME: fnet_tcp_reass_add
+*
+* DESCRIPTION: This function adds the out-of-order data to 
+*              the reassembly queue. 
+*              The block is found by binary search. The data is merged 
+*              with overlapping and adjacent blocks, only the parts 
+*              filling the gaps between them are taken from the new data.
+*              If the queue would exceed count_max bytes or 
+*              FNET_CFG_TCP_REASS_INTERVALS blocks, the blocks farthest 
+*              from the start of the window are dropped first.
+*              The data chain is always consumed.
+*
+* RETURNS: FNET_TRUE if the data is queued. Otherwise (no room, 
+*          no memory) it returns FNET_FALSE.
+*************************************************************************/
+fnet_bool_t fnet_tcp_reass_add( fnet_tcp_reass_t *reass, fnet_uint32_t seq, fnet_netbuf_t *data, fnet_size_t count_max )
+{
+    fnet_tcp_reass_block_t  *block = reass->block;
+    fnet_tcp_reass_block_t  merged;
+    fnet_netbuf_t           *piece[FNET_CFG_TCP_REASS_INTERVALS + 1u];
+    fnet_uint32_t           end = seq + data->total_length;
+    fnet_uint32_t           merged_end;
+    fnet_uint32_t           pos;
+    fnet_uint32_t           gap_end;
+    fnet_size_t             added;
+    fnet_index_t            first;
+    fnet_index_t            last;
+    fnet_index_t            high;
+    fnet_index_t            mid;
+    fnet_index_t            i;
+
+    reass->last_seq = seq;
+
+    /* Find the first block that ends at or after the start of the data.*/
+    first = 0u;
+    high = reass->block_num;
+
+    while(first < high)
+    {
+        mid = (first + high) >> 1;
+
+        if(FNET_TCP_COMP_GE(block[mid].seq + block[mid].length, seq))
+        {
+            high = mid;
+        }
+        else
+        {
+            first = mid + 1u;
+        }
+    }
+
+    /* Blocks [first, last) overlap the data or are adjacent to it.*/
+    last = first;
+    while((last < reass->block_num) && (FNET_TCP_COMP_GE(end, block[last].seq)))
+    {
+        last++;
+    }
+
+    if(first == last)
+    {
+        merged.seq = seq;
+        merged_end = end;
+        added = data->total_length;
+    }
+    else
+    {
+        merged.seq = (FNET_TCP_COMP_G(block[first].seq, seq)) ? seq : block[first].seq;
+        merged_end = block[last - 1u].seq + block[last - 1u].length;
+        if(FNET_TCP_COMP_G(end, merged_end))
+        {
+            merged_end = end;
+        }
+
+        added = merged_end - merged.seq;
+        for(i = first; i < last; i++)
+        {
+            added -= block[i].length;
+        }
+    }
+
+    /* Make room, dropping the blocks farthest from the start of the window.*/
+    while(((reass->count + added) > count_max) 
+          || ((first == last) && (reass->block_num == FNET_CFG_TCP_REASS_INTERVALS)))
+    {
+        if(reass->block_num > last)
+        {
+            reass->block_num--;
+            reass->count -= block[reass->block_num].length;
+            fnet_netbuf_free_chain(block[reass->block_num].head);
+        }
+        else
+        {
+            fnet_netbuf_free_chain(data);
+            return FNET_FALSE;
+        }
+    }
+
+    merged.length = merged_end - merged.seq;
+    merged.head = 0;
+    merged.tail = 0;
+
+    if(first == last)
+    {
+        /* New block.*/
+        fnet_tcp_reass_link(&merged, data, fnet_tcp_reass_tail(data));
+
+        for(i = reass->block_num; i > first; i--)
+        {
+            block[i] = block[i - 1u];
+        }
+
+        reass->block_num++;
+    }
+    else
+    {
+        /* Take the parts of the data that fill the gaps (they share the data buffers).*/
+        pos = merged.seq;
+        for(i = first; i <= last; i++)
+        {
+            gap_end = (i < last) ? block[i].seq : merged_end;
+            piece[i - first] = 0;
+
+            if(FNET_TCP_COMP_G(gap_end, pos))
+            {
+                if((piece[i - first] = fnet_netbuf_copy(data, pos - seq, gap_end - pos, FNET_FALSE)) == 0)
                 {
-                    break;
+                    while(i > first)
+                    {
+                        i--;
+                        fnet_netbuf_free_chain(piece[i - first]);
+                    }
+
+                    fnet_netbuf_free_chain(data);
+                    return FNET_FALSE;
                 }
             }
+
+            if(i < last)
+            {
+                pos = block[i].seq + block[i].length;
+            }
+        }
+
+        fnet_netbuf_free_chain(data);
+
+        /* Link the gaps and the blocks.*/
+        for(i = first; i <= last; i++)
+        {
+            if(piece[i - first])
+            {
+                fnet_tcp_reass_link(&merged, piece[i - first], fnet_tcp_reass_tail(piece[i - first]));
+            }
+
+            if(i < last)
+            {
+                fnet_tcp_reass_link(&merged, block[i].head, block[i].tail);
+            }
+        }
+
+        /* Leave one block instead of [first, last).*/
+        for(i = last; i < reass->block_num; i++)
+        {
+            block[i - (last - first) + 1u] = block[i];
         }
+
+        reass->block_num -= (last - first) - 1u;
     }
-#endif 
 
-    return result;
+    block[first] = merged;
+    reass->count += added;
+
+    return FNET_TRUE;
+}
+
+/***********************************************************************
+* NAME: fnet_tcp_reass_get
+*
+* DESCRIPTION: This function removes the first block from the 
+*              reassembly queue, if it starts at or before rcv_seq.
+*              The data before rcv_seq is deleted, rcv_seq is moved
+*              to the end of the block.
+*
+* RETURNS: The in-order data, or 0 if there is no such data.
+*************************************************************************/
+fnet_netbuf_t *fnet_tcp_reass_get( fnet_tcp_reass_t *reass, fnet_uint32_t *rcv_seq )
+{
+    fnet_tcp_reass_block_t  first;
+    fnet_netbuf_t           *data;
+    fnet_index_t            i;
+
+    while((reass->block_num) && (FNET_TCP_COMP_GE(*rcv_seq, reass->block[0].seq)))
+    {
+        first = reass->block[0];
+
+        for(i = 1u; i < reass->block_num; i++)
+        {
+            reass->block[i - 1u] = reass->block[i];
+        }
+
+        reass->block_num--;
+        reass->count -= first.length;
+
+        data = first.head;
+
+        if(FNET_TCP_COMP_G(first.seq + first.length, *rcv_seq))
+        {
+            /* Delete the repeated part.*/
+            fnet_netbuf_trim(&data, (fnet_int32_t)(*rcv_seq - first.seq));
+            *rcv_seq = first.seq + first.length;
+            return data;
+        }
+
+        /* The block is repeated.*/
+        fnet_netbuf_free_chain(data);
+    }
+
+    return 0;
+}
+
+/***********************************************************************
+* NAME: fnet_tcp_reass_free
+*
+* DESCRIPTION: This function deletes all data of the reassembly queue.
+*
+* RETURNS: None.
+*************************************************************************/
+void fnet_tcp_reass_free( fnet_tcp_reass_t *reass )
+{
+    while(reass->block_num)
+    {
+        reass->block_num--;
+        fnet_netbuf_free_chain(reass->block[reass->block_num].head);
+    }
+
+    reass->count = 0u;
 }
+#endif /* !FNET_CFG_TCP_DISCARD_OUT_OF_ORDER */
 
 /***********************************************************************
 * NAME: fnet_tcp_sendanydata
@@ -2467,6 +3358,7 @@ static fnet_bool_t fnet_tcp_sendanydata( fnet_socket_if_t *sk, fnet_bool_t oneex
     fnet_int32_t        wnd;        /* Windows */
     fnet_int32_t        datasize;   /* Size of the data that can be sent from the output buffer.*/
     fnet_bool_t         result = FNET_FALSE;
+    fnet_bool_t         cork;       /* Partial segments are held.*/
     
     /* Reset the silly window avoidance flag.*/
     cb->tcpcb_flags &= ~FNET_TCP_CBF_SEND_TIMEOUT;
@@ -2490,7 +3382,7 @@ static fnet_bool_t fnet_tcp_sendanydata( fnet_socket_if_t *sk, fnet_bool_t oneex
     datasize = (fnet_int32_t)(sk->send_buffer.count - sntdata);
 
     /* Congestion window.*/
-    cwnd = cb->tcpcb_cwnd - sntdata;
+    cwnd = (cb->tcpcb_cwnd > sntdata) ? (cb->tcpcb_cwnd - sntdata) : 0u;
     cwnd = ((fnet_uint32_t)(cwnd / cb->tcpcb_sndmss)) * cb->tcpcb_sndmss;
 
     /* Calculate sndwnd (size of the data that will be sent).*/
@@ -2519,9 +3411,13 @@ static fnet_bool_t fnet_tcp_sendanydata( fnet_socket_if_t *sk, fnet_bool_t oneex
             /* Reinitialize the retransmission timer.*/
             if(cb->tcpcb_timers.retransmission == FNET_TCP_TIMER_OFF)
             {
-                cb->tcpcb_timers.retransmission = cb->tcpcb_rto;
+                fnet_tcp_settimer(&cb->tcpcb_timers.retransmission, cb->tcpcb_rto);
             }
 
+#if FNET_CFG_TCP_TLP
+            fnet_tcp_tlpset(sk);
+#endif
+
             result = FNET_TRUE;
         }
 
@@ -2532,6 +3428,10 @@ static fnet_bool_t fnet_tcp_sendanydata( fnet_socket_if_t *sk, fnet_bool_t oneex
     /* The sntdata variable will include the size of the data that is sent.*/
     sntdata = 0u;
 
+    /* The partial segments are held by TCP_CORK or MSG_MORE, until the socket is shut down.*/
+    cork = (((sk->options.tcp_opt.tcp_cork == FNET_TRUE) || ((cb->tcpcb_flags & FNET_TCP_CBF_MORE) != 0u))
+            && (sk->send_buffer.is_shutdown == FNET_FALSE)) ? FNET_TRUE : FNET_FALSE;
+
     while(sndwnd > 0)
     {
         /* Sending of the maximal size segment.*/
@@ -2550,8 +3450,10 @@ static fnet_bool_t fnet_tcp_sendanydata( fnet_socket_if_t *sk, fnet_bool_t oneex
              * If the urgent data is present
              * If the size of the input buffer of another side greater than the half of its maximal size
              * If the Nagle algorithm is blocked and all data can be sent in this segment
-             * If all sent data is acknowledged and all data can be sent in this segment.*/
-            if((sndwnd > (fnet_int32_t)(cb->tcpcb_maxwnd >> 1)) 
+             * If all sent data is acknowledged and all data can be sent in this segment.
+             * The corked socket sends them only in the first two cases, 
+             * the timeout of the held data is processed as the silly window avoidance.*/
+            if(((sndwnd > (fnet_int32_t)(cb->tcpcb_maxwnd >> 1)) && (cork == FNET_FALSE))
                 || ((cb->tcpcb_flags & FNET_TCP_CBF_FORCE_SEND) != 0u)
             #if FNET_CFG_TCP_URGENT                      
                 || FNET_TCP_COMP_GE(cb->tcpcb_sndurgseq, cb->tcpcb_sndseq)
@@ -2564,27 +3466,27 @@ static fnet_bool_t fnet_tcp_sendanydata( fnet_socket_if_t *sk, fnet_bool_t oneex
             }
             else
             {
-                if((cb->tcpcb_rcvack == cb->tcpcb_sndseq) || (sk->options.tcp_opt.tcp_nodelay != FNET_FALSE))
+                if((cork == FNET_FALSE) && (sntdata + (fnet_size_t)sndwnd == (fnet_size_t)datasize)
+                   && ((cb->tcpcb_rcvack == cb->tcpcb_sndseq) || (sk->options.tcp_opt.tcp_nodelay != FNET_FALSE)))
+                {
+                    /* Send the partial segment.*/
+                    fnet_tcp_senddataseg(sk, 0, 0u, (fnet_uint32_t)sndwnd);
+                    sntdata += (fnet_size_t)sndwnd;
+                }
+                else if((cork == FNET_TRUE) || (cb->tcpcb_rcvack == cb->tcpcb_sndseq) || (sk->options.tcp_opt.tcp_nodelay != FNET_FALSE))
                 {
-                    if(sntdata + (fnet_size_t)sndwnd == (fnet_size_t)datasize)
+                    /* Set the silly window avoidance flag.*/
+                    if((cb->tcpcb_timers.persist == FNET_TCP_TIMER_OFF)
+                           || ((fnet_time_t)(cb->tcpcb_timers.persist - fnet_timer_fine_ms()) > cb->tcpcb_rto))
                     {
-                        /* Send the partial segment.*/
-                        fnet_tcp_senddataseg(sk, 0, 0u, (fnet_uint32_t)sndwnd);
-                        sntdata += (fnet_size_t)sndwnd;
+                        cb->tcpcb_cprto = cb->tcpcb_rto;
+                        fnet_tcp_settimer(&cb->tcpcb_timers.persist, cb->tcpcb_cprto);
                     }
-                    else
-                    {
-                        /* Set the silly window avoidance flag.*/
-                        if((cb->tcpcb_timers.persist == FNET_TCP_TIMER_OFF)
-                               || (cb->tcpcb_timers.persist > cb->tcpcb_rto))
-                        {
-                            cb->tcpcb_cprto = cb->tcpcb_rto;
-                            cb->tcpcb_timers.persist = cb->tcpcb_cprto;
-                        }
 
-                        cb->tcpcb_flags |= FNET_TCP_CBF_SEND_TIMEOUT;
-                    }
+                    cb->tcpcb_flags |= FNET_TCP_CBF_SEND_TIMEOUT;
                 }
+                else
+                {}
             }
 
             sndwnd = 0;
@@ -2601,12 +3503,17 @@ static fnet_bool_t fnet_tcp_sendanydata( fnet_socket_if_t *sk, fnet_bool_t oneex
     if(sntdata > 0u)
     {
 
-        /* Process the states of round trip time measurement.*/
-        if((cb->tcpcb_timing_state == TCP_TS_ACK_RECEIVED) || ((cb->tcpcb_timing_state == TCP_TS_SEGMENT_LOST)
+        /* Process the states of round trip time measurement 
+         * (it is not needed, if the timestamps are used).*/
+        if(((cb->tcpcb_timing_state == TCP_TS_ACK_RECEIVED) || ((cb->tcpcb_timing_state == TCP_TS_SEGMENT_LOST)
                && (FNET_TCP_COMP_G(cb->tcpcb_sndseq, cb->tcpcb_timingack))))
+    #if FNET_CFG_TCP_TIMESTAMPS
+            && ((cb->tcpcb_flags & FNET_TCP_CBF_TIMESTAMP) == 0u)
+    #endif
+          )
         {
             cb->tcpcb_timingack = cb->tcpcb_sndseq;
-            cb->tcpcb_timers.round_trip = FNET_TCP_TIMER_ON_INCREMENT;
+            cb->tcpcb_timers.round_trip = fnet_timer_fine_ms();
 
             cb->tcpcb_timing_state = TCP_TS_SEGMENT_SENT;
         }
@@ -2617,8 +3524,12 @@ static fnet_bool_t fnet_tcp_sendanydata( fnet_socket_if_t *sk, fnet_bool_t oneex
         /* Reinitialize the retransmission timer.*/
         if(cb->tcpcb_timers.retransmission == FNET_TCP_TIMER_OFF)
         {
-            cb->tcpcb_timers.retransmission = cb->tcpcb_rto;
+            fnet_tcp_settimer(&cb->tcpcb_timers.retransmission, cb->tcpcb_rto);
         }
+
+#if FNET_CFG_TCP_TLP
+        fnet_tcp_tlpset(sk);
+#endif
     }
 
     return result;
@@ -2740,9 +3651,9 @@ static void fnet_tcp_finprocessing( fnet_socket_if_t *sk, fnet_uint32_t ack )
         case FNET_TCP_CS_FIN_WAIT_2:
             cb->tcpcb_connection_state = FNET_TCP_CS_TIME_WAIT;
             /* Set timewait timeout.*/
-            if((cb->tcpcb_timers.connection == FNET_TCP_TIMER_OFF)||(cb->tcpcb_timers.connection == 0u)) /* If it was not already set before by other state. */          
+            if(cb->tcpcb_timers.connection == FNET_TCP_TIMER_OFF) /* If it was not already set before by other state. */
             {
-                cb->tcpcb_timers.connection = FNET_TCP_TIME_WAIT;
+                fnet_tcp_settimer(&cb->tcpcb_timers.connection, FNET_TCP_TIME_WAIT);
             }
           
             cb->tcpcb_timers.keepalive = FNET_TCP_TIMER_OFF;
@@ -2754,7 +3665,201 @@ static void fnet_tcp_finprocessing( fnet_socket_if_t *sk, fnet_uint32_t ack )
 
     cb->tcpcb_flags |= FNET_TCP_CBF_FIN_RCVD;
 
+    fnet_socket_poll_update(sk);
+}
+
+#if FNET_CFG_TCP_TIMEWAIT_SIZE
+/***********************************************************************
+* NAME: fnet_tcp_timewait_find
+*
+* DESCRIPTION: This function finds the TIME_WAIT record of the connection.
+*              The unspecified local address and the 0 foreign address 
+*              match any address.
+*     
+* RETURNS: If the record is found this function returns the pointer to the
+*          record. Otherwise, this function returns 0.
+*************************************************************************/
+static fnet_tcp_timewait_t *fnet_tcp_timewait_find( const struct sockaddr *local_addr, const struct sockaddr *foreign_addr )
+{
+    fnet_tcp_timewait_t *tw;
+    fnet_index_t        i;
+
+    for(i = 0u; i < FNET_CFG_TCP_TIMEWAIT_SIZE; i++)
+    {
+        tw = &fnet_tcp_timewait[i];
+
+        if((tw->expiry != FNET_TCP_TIMER_OFF)
+           && (tw->local_addr.sa_port == local_addr->sa_port) 
+           && ((fnet_socket_addr_is_unspecified(local_addr)) || (fnet_socket_addr_are_equal(&tw->local_addr, local_addr)))
+           && ((foreign_addr == 0) 
+               || ((tw->foreign_addr.sa_port == foreign_addr->sa_port) && (fnet_socket_addr_are_equal(&tw->foreign_addr, foreign_addr)))))
+        {
+            return tw;
+        }
+    }
+
+    return 0;
+}
+
+/***********************************************************************
+* NAME: fnet_tcp_timewait_conflict
+*
+* DESCRIPTION: This function checks the addresses against the connections
+*              in the TIME_WAIT state, which do not have sockets any more.
+*              It follows the rules of fnet_socket_conflict(), so
+*              the connection can not be reused during 2MSL, and its 
+*              local port is not selected as an ephemeral port.
+*     
+* RETURNS: FNET_TRUE if the addresses are used by a TIME_WAIT record.
+*************************************************************************/
+fnet_bool_t fnet_tcp_timewait_conflict( const struct sockaddr *local_addr, const struct sockaddr *foreign_addr, fnet_bool_t wildcard )
+{
+    fnet_bool_t result = FNET_FALSE;
+
+    if((wildcard) || ((foreign_addr) && (!fnet_socket_addr_is_unspecified(local_addr))))
+    {
+        fnet_isr_lock();
+        result = (fnet_tcp_timewait_find(local_addr, foreign_addr) != 0) ? FNET_TRUE : FNET_FALSE;
+        fnet_isr_unlock();
+    }
+
+    return result;
+}
+
+/***********************************************************************
+* NAME: fnet_tcp_timewait_add
+*
+* DESCRIPTION: This function moves the closed socket in the TIME_WAIT 
+*              state to the TIME_WAIT record and frees the socket.
+*              If no record is free, the record that expires first is reused.
+*     
+* RETURNS: None.         
+*************************************************************************/
+static void fnet_tcp_timewait_add( fnet_socket_if_t *sk )
+{
+    fnet_tcp_control_t  *cb = (fnet_tcp_control_t *)sk->protocol_control;
+    fnet_tcp_timewait_t *tw;
+    fnet_index_t        i;
+
+    tw = fnet_tcp_timewait_find(&sk->local_addr, &sk->foreign_addr);
+
+    if(!tw)
+    {
+        tw = &fnet_tcp_timewait[0];
+
+        for(i = 0u; (i < FNET_CFG_TCP_TIMEWAIT_SIZE) && (tw->expiry != FNET_TCP_TIMER_OFF); i++)
+        {
+            if((fnet_tcp_timewait[i].expiry == FNET_TCP_TIMER_OFF) 
+               || ((fnet_int32_t)(tw->expiry - fnet_tcp_timewait[i].expiry) > 0))
+            {
+                tw = &fnet_tcp_timewait[i];
+            }
+        }
+    }
+
+    fnet_memcpy(&tw->local_addr, &sk->local_addr, sizeof(tw->local_addr));
+    fnet_memcpy(&tw->foreign_addr, &sk->foreign_addr, sizeof(tw->foreign_addr));
+    tw->sndseq = cb->tcpcb_sndseq;
+    tw->sndack = cb->tcpcb_sndack;
+#if FNET_CFG_TCP_TIMESTAMPS
+    tw->timestamp = ((cb->tcpcb_flags & FNET_TCP_CBF_TIMESTAMP) != 0u) ? FNET_TRUE : FNET_FALSE;
+    tw->tsrecent = cb->tcpcb_tsrecent;
+#endif
+    tw->expiry = cb->tcpcb_timers.connection;
+
+    if(tw->expiry == FNET_TCP_TIMER_OFF)
+    {
+        fnet_tcp_settimer(&tw->expiry, FNET_TCP_TIME_WAIT);
+    }
+
+    fnet_tcp_closesk(sk);
+}
+
+/***********************************************************************
+* NAME: fnet_tcp_timewait_input
+*
+* DESCRIPTION: This function processes the segment of the connection 
+*              in the TIME_WAIT state.
+*              The retransmitted final segment is acknowledged and 
+*              restarts the TIME_WAIT timeout. The reset segment is 
+*              ignored (RFC1337). The new SYN segment with the greater
+*              sequence number ends the TIME_WAIT state (RFC1122).
+*              The acknowledgment carries the timestamps option, 
+*              if it is used by the connection.
+*     
+* RETURNS: FNET_TRUE if the segment is processed and must be deleted.
+*          FNET_FALSE if the connection is not in the TIME_WAIT state.
+*************************************************************************/
+static fnet_bool_t fnet_tcp_timewait_input( fnet_netbuf_t *insegment, struct sockaddr *src_addr,  struct sockaddr *dest_addr )
+{
+    fnet_tcp_timewait_t     *tw;
+    struct fnet_tcp_segment segment;
+    fnet_uint8_t            sgmtype = (fnet_uint8_t)(FNET_TCP_FLAGS(insegment));
+#if FNET_CFG_TCP_TIMESTAMPS
+    fnet_uint32_t           tsoptions[FNET_TCP_TIMESTAMP_SIZE / 4u];
+#endif
+
+    tw = fnet_tcp_timewait_find(dest_addr, src_addr);
+
+    if(!tw)
+    {
+        return FNET_FALSE;
+    }
+
+    if((sgmtype & FNET_TCP_SGT_RST) != 0u)
+    {
+        return FNET_TRUE;
+    }
+
+    if((sgmtype & FNET_TCP_SGT_SYN) != 0u)
+    {
+        if(((sgmtype & FNET_TCP_SGT_ACK) == 0u) && FNET_TCP_COMP_G(fnet_ntohl(FNET_TCP_SEQ(insegment)), tw->sndack))
+        {
+            /* New incarnation of the connection.*/
+            tw->expiry = FNET_TCP_TIMER_OFF;
+            return FNET_FALSE;
+        }
+    }
+    else if((sgmtype & FNET_TCP_SGT_FIN) != 0u)
+    {
+        /* Restart the TIME_WAIT timeout.*/
+        fnet_tcp_settimer(&tw->expiry, FNET_TCP_TIME_WAIT);
+    }
+    else if(insegment->total_length == (fnet_size_t)FNET_TCP_LENGTH(insegment))
+    {
+        /* Nothing to acknowledge.*/
+        return FNET_TRUE;
+    }
+    else
+    {}
+
+    /* Send the acknowledgment.*/
+    segment.sockoption = 0;
+    fnet_memcpy(&segment.src_addr, dest_addr, sizeof(segment.src_addr));
+    fnet_memcpy(&segment.dest_addr, src_addr, sizeof(segment.dest_addr));
+    segment.seq = tw->sndseq;
+    segment.ack = tw->sndack;
+    segment.flags = FNET_TCP_SGT_ACK;
+    segment.wnd = 0u;
+    segment.urgpointer = 0u;
+    segment.options = 0;
+    segment.optlen = 0u;
+    segment.data = 0;
+
+#if FNET_CFG_TCP_TIMESTAMPS
+    /* The timestamps are used by the connection, the peer may drop the acknowledgment without them (RFC7323).*/
+    if(tw->timestamp == FNET_TRUE)
+    {
+        segment.optlen = fnet_tcp_settimestampopt(tw->tsrecent, (fnet_uint8_t *)tsoptions);
+        segment.options = tsoptions;
+    }
+#endif
+
+    fnet_tcp_sendseg(&segment);
+
+    return FNET_TRUE;
 }
+#endif /* FNET_CFG_TCP_TIMEWAIT_SIZE */
 
 /***********************************************************************
 * NAME: tcp_rcvwnd
@@ -2798,33 +3903,76 @@ static fnet_uint32_t fnet_tcp_getrcvwnd( fnet_socket_if_t *sk )
 }
 
 /************************************************************************
-* NAME: fnet_tcp_slowtimo
+* NAME: fnet_tcp_timo
 *
-* DESCRIPTION: This function processes the timeouts. 
-*              (fnet_tcp_slowtimo is performed every 500 ms).
+* DESCRIPTION: This function processes the timeouts 
+*              (fnet_tcp_timo is performed every FNET_TCP_TIMER_PERIOD).
 *
 * RETURNS: None. 
 *************************************************************************/
-static void fnet_tcp_slowtimo(fnet_uint32_t cookie)
+static void fnet_tcp_timo(fnet_uint32_t cookie)
 {
-    fnet_socket_if_t *sk;               
-    fnet_socket_if_t *addedsk; 
-    fnet_socket_if_t *nextsk;
-
     FNET_COMP_UNUSED_ARG(cookie);      
 
     fnet_isr_lock();
-    sk = fnet_tcp_prot_if.head;
 
-    while(sk)
-    {
-        addedsk = sk->partial_con;
+    fnet_tcp_deadline_check();
 
-        while(addedsk)
-        {
+    fnet_tcp_isntime += FNET_TCP_STEPISN_PERIOD;
+
+    fnet_isr_unlock();
+}
+
+/************************************************************************
+* NAME: fnet_tcp_deadline_check
+*
+* DESCRIPTION: This function processes the timers of all connections,
+*              if the earliest deadline is expired. 
+*              It is called every FNET_TCP_TIMER_PERIOD and on every 
+*              input segment, so with the fine-grained time 
+*              (FNET_CFG_CPU_TIMER_FINE) the timers may expire between 
+*              the timer ticks.
+*
+* RETURNS: None. 
+*************************************************************************/
+static void fnet_tcp_deadline_check( void )
+{
+    fnet_socket_if_t *sk;               
+    fnet_socket_if_t *addedsk; 
+    fnet_socket_if_t *nextsk;
+    fnet_time_t      now;
+#if FNET_CFG_TCP_TIMEWAIT_SIZE
+    fnet_index_t     i;
+#endif
+
+    fnet_isr_lock();
+    now = fnet_timer_fine_ms();
+
+    /* No timer is expired, or the timers are being processed 
+     * (a segment is input while a timeout is processed).*/
+    if((fnet_tcp_deadline == FNET_TCP_TIMER_OFF) || ((fnet_int32_t)(now - fnet_tcp_deadline) < 0) 
+        || (fnet_tcp_deadline_busy == FNET_TRUE))
+    {
+        fnet_isr_unlock();
+        return;
+    }
+
+    fnet_tcp_deadline_busy = FNET_TRUE;
+
+    /* The earliest deadline is found again, by checking all timers.*/
+    fnet_tcp_deadline = FNET_TCP_TIMER_OFF;
+
+    sk = fnet_tcp_prot_if.head;
+
+    while(sk)
+    {
+        addedsk = sk->partial_con;
+
+        while(addedsk)
+        {
             nextsk = addedsk->next;
             /* Process the partial sockets.*/
-            fnet_tcp_slowtimosk(addedsk);
+            fnet_tcp_timosk(addedsk, now);
             addedsk = nextsk;
         }
 
@@ -2834,65 +3982,98 @@ static void fnet_tcp_slowtimo(fnet_uint32_t cookie)
         {
             nextsk = addedsk->next;
             /* Process the incoming sockets.*/
-            fnet_tcp_slowtimosk(addedsk);
+            fnet_tcp_timosk(addedsk, now);
             addedsk = nextsk;
         }
 
         /* Processg the main socket.*/
         nextsk = sk->next;
-        fnet_tcp_slowtimosk(sk);
+        fnet_tcp_timosk(sk, now);
         sk = nextsk;
     }
 
-    fnet_tcp_isntime += FNET_TCP_STEPISN;
+#if FNET_CFG_TCP_TIMEWAIT_SIZE
+    /* Free the expired TIME_WAIT records.*/
+    for(i = 0u; i < FNET_CFG_TCP_TIMEWAIT_SIZE; i++)
+    {
+        (void)fnet_tcp_expired(&fnet_tcp_timewait[i].expiry, now);
+    }
+#endif
+
+    fnet_tcp_deadline_busy = FNET_FALSE;
 
     fnet_isr_unlock();
 }
 
 /************************************************************************
-* NAME: fnet_tcp_fasttimo
+* NAME: fnet_tcp_deadline_add
 *
-* DESCRIPTION: This function processes the timeouts 
-*              (fnet_tcp_fasttimo is performed every 200 ms).
+* DESCRIPTION: This function updates the earliest deadline of the timers.
 *
 * RETURNS: None. 
 *************************************************************************/
-static void fnet_tcp_fasttimo( fnet_uint32_t cookie )
+static void fnet_tcp_deadline_add( fnet_time_t deadline )
 {
-    fnet_socket_if_t *sk; 
-    fnet_socket_if_t *addedsk;
-    
-    FNET_COMP_UNUSED_ARG(cookie);
-    
-    fnet_isr_lock();
-    sk = fnet_tcp_prot_if.head;
+    if((fnet_tcp_deadline == FNET_TCP_TIMER_OFF) || ((fnet_int32_t)(deadline - fnet_tcp_deadline) < 0))
+    {
+        fnet_tcp_deadline = deadline;
+    }
+}
 
-    while(sk)
+/************************************************************************
+* NAME: fnet_tcp_settimer
+*
+* DESCRIPTION: This function starts the timer, 
+*              which expires after the timeout (ms).
+*
+* RETURNS: None. 
+*************************************************************************/
+static void fnet_tcp_settimer( fnet_time_t *timer, fnet_time_t timeout )
+{
+    *timer = fnet_timer_fine_ms() + timeout;
+
+    /* The switch off value can not be used as the expiration time.*/
+    if(*timer == FNET_TCP_TIMER_OFF)
     {
-        fnet_tcp_fasttimosk(sk);
-        addedsk = sk->incoming_con;
+        (*timer)--;
+    }
 
-        while(addedsk)
+    fnet_tcp_deadline_add(*timer);
+}
+
+/************************************************************************
+* NAME: fnet_tcp_expired
+*
+* DESCRIPTION: This function checks the expiration of the timer. 
+*              The expired timer is switched off.
+*
+* RETURNS: FNET_TRUE if the timer is expired. Otherwise, FNET_FALSE.
+*************************************************************************/
+static fnet_bool_t fnet_tcp_expired( fnet_time_t *timer, fnet_time_t now )
+{
+    if(*timer != FNET_TCP_TIMER_OFF)
+    {
+        if((fnet_int32_t)(now - *timer) >= 0)
         {
-            fnet_tcp_fasttimosk(addedsk);
-            addedsk = addedsk->next;
+            *timer = FNET_TCP_TIMER_OFF;
+            return FNET_TRUE;
         }
 
-        sk = sk->next;
+        fnet_tcp_deadline_add(*timer);
     }
 
-    fnet_isr_unlock();
+    return FNET_FALSE;
 }
 
 /************************************************************************
-* NAME: fnet_tcp_slowtimosk
+* NAME: fnet_tcp_timosk
 *
 * DESCRIPTION: This function processes the timers of the socket 
-*              (fnet_tcp_slowtimosk is performed every 500 ms).
+*              (fnet_tcp_timosk is performed every FNET_TCP_TIMER_PERIOD).
 *
 * RETURNS: None. 
 *************************************************************************/
-static void fnet_tcp_slowtimosk( fnet_socket_if_t *sk )
+static void fnet_tcp_timosk( fnet_socket_if_t *sk, fnet_time_t now )
 {
 
     fnet_tcp_control_t *cb = (fnet_tcp_control_t *)sk->protocol_control;
@@ -2902,132 +4083,77 @@ static void fnet_tcp_slowtimosk( fnet_socket_if_t *sk )
     if(sk->state != SS_UNCONNECTED)
     {
         /* Check the abort timer.*/
-        if(cb->tcpcb_timers.abort != FNET_TCP_TIMER_OFF)
+        if(fnet_tcp_expired(&cb->tcpcb_timers.abort, now) == FNET_TRUE)
         {
-            cb->tcpcb_timers.abort--;
-
-            if(!cb->tcpcb_timers.abort)
+            if(sk->options.local_error != FNET_ERR_HOSTUNREACH)
             {
-                cb->tcpcb_timers.abort = FNET_TCP_TIMER_OFF;
-
-                if(sk->options.local_error != FNET_ERR_HOSTUNREACH)
-                {
-                    sk->options.local_error = FNET_ERR_CONNABORTED;
-                }
-
-                fnet_tcp_closesk(sk);
-                return;
+                sk->options.local_error = FNET_ERR_CONNABORTED;
             }
+
+            fnet_tcp_closesk(sk);
+            return;
         }
 
         /* Check the connection timer.*/
-        if(cb->tcpcb_timers.connection != FNET_TCP_TIMER_OFF)
+        if(fnet_tcp_expired(&cb->tcpcb_timers.connection, now) == FNET_TRUE)
         {
-            cb->tcpcb_timers.connection--;
-
-            if(!cb->tcpcb_timers.connection)
+            if((cb->tcpcb_flags & FNET_TCP_CBF_CLOSE) != 0u)
             {
-                cb->tcpcb_timers.connection = FNET_TCP_TIMER_OFF;
-
-                if((cb->tcpcb_flags & FNET_TCP_CBF_CLOSE) != 0u)
+                if(cb->tcpcb_connection_state == FNET_TCP_CS_TIME_WAIT)
                 {
-                    if(cb->tcpcb_connection_state == FNET_TCP_CS_TIME_WAIT)
-                    {
-                        fnet_tcp_closesk(sk);
-                    }
-                    else
-                    {
-                        fnet_tcp_abortsk(sk);
-                    }
+                    fnet_tcp_closesk(sk);
                 }
                 else
                 {
-                    if(((sk->options.local_error) != FNET_ERR_HOSTUNREACH)
-                           && ((sk->options.local_error) != FNET_ERR_NOPROTOOPT))
-                    {
-                        sk->options.local_error = FNET_ERR_TIMEDOUT;
-                    }
-
-                    fnet_tcp_closesk(sk);
+                    fnet_tcp_abortsk(sk);
+                }
+            }
+            else
+            {
+                if(((sk->options.local_error) != FNET_ERR_HOSTUNREACH)
+                       && ((sk->options.local_error) != FNET_ERR_NOPROTOOPT))
+                {
+                    sk->options.local_error = FNET_ERR_TIMEDOUT;
                 }
-                return;
+
+                fnet_tcp_closesk(sk);
             }
+            return;
         }
 
         /* Check the retransmission timer.*/
-        if(cb->tcpcb_timers.retransmission != FNET_TCP_TIMER_OFF)
+        if(fnet_tcp_expired(&cb->tcpcb_timers.retransmission, now) == FNET_TRUE)
         {
-            cb->tcpcb_timers.retransmission--;
-
-            if(!cb->tcpcb_timers.retransmission)
-            {
-                cb->tcpcb_timers.retransmission = FNET_TCP_TIMER_OFF;
-                fnet_tcp_rtimeo(sk);
-            }
+            fnet_tcp_rtimeo(sk);
         }
 
         /* Check the keepalive timer.*/
-        if(cb->tcpcb_timers.keepalive != FNET_TCP_TIMER_OFF)
+        if(fnet_tcp_expired(&cb->tcpcb_timers.keepalive, now) == FNET_TRUE)
         {
-            cb->tcpcb_timers.keepalive--;
-
-            if(!cb->tcpcb_timers.keepalive)
-            {
-                cb->tcpcb_timers.keepalive = FNET_TCP_TIMER_OFF;
-                fnet_tcp_ktimeo(sk);
-            }
+            fnet_tcp_ktimeo(sk);
         }
 
         /* Check the persist timer.*/
-        if(cb->tcpcb_timers.persist != FNET_TCP_TIMER_OFF)
+        if(fnet_tcp_expired(&cb->tcpcb_timers.persist, now) == FNET_TRUE)
         {
-            cb->tcpcb_timers.persist--;
-
-            if(!cb->tcpcb_timers.persist)
-            {
-                cb->tcpcb_timers.persist = FNET_TCP_TIMER_OFF;
-                fnet_tcp_ptimeo(sk);
-            }
+            fnet_tcp_ptimeo(sk);
         }
 
-        /* If the round trip timer is turned on, recalculate it.*/
-        if(cb->tcpcb_timers.round_trip != FNET_TCP_TIMER_OFF)
+#if FNET_CFG_TCP_TLP
+        /* Check the tail loss probe timer.*/
+        if(fnet_tcp_expired(&cb->tcpcb_timers.tlp, now) == FNET_TRUE)
         {
-            cb->tcpcb_timers.round_trip++;
+            fnet_tcp_tlptimeo(sk);
         }
-    }
-    
-}
+#endif
 
-/************************************************************************
-* NAME: fnet_tcp_fasttimosk
-*
-* DESCRIPTION: This function processes the delayed acknowledgment timer 
-*              of the socket (fnet_tcp_fasttimo is performed every 200 ms).
-*
-* RETURNS: None. 
-*************************************************************************/
-static void fnet_tcp_fasttimosk( fnet_socket_if_t *sk )
-{
-    fnet_tcp_control_t *cb = (fnet_tcp_control_t *)sk->protocol_control;
-    
-   
-    if(sk->state != SS_UNCONNECTED)
-    {
         /* Check the delayed acknowledgment timer.*/
-        if(cb->tcpcb_timers.delayed_ack != FNET_TCP_TIMER_OFF)
+        if(fnet_tcp_expired(&cb->tcpcb_timers.delayed_ack, now) == FNET_TRUE)
         {
-            cb->tcpcb_timers.delayed_ack--;
-
-            if(!cb->tcpcb_timers.delayed_ack)
-            {
-                cb->tcpcb_timers.delayed_ack = FNET_TCP_TIMER_OFF;
-                fnet_tcp_sendack(sk);
-                return;
-            }
+            fnet_tcp_sendack(sk);
         }
     }
-   
+    
 }
 
 /************************************************************************
@@ -3075,28 +4201,25 @@ static void fnet_tcp_rtimeo( fnet_socket_if_t *sk )
             /* Initialize of the abort timer.*/
             if(cb->tcpcb_timers.abort == FNET_TCP_TIMER_OFF)
             {
-                cb->tcpcb_timers.abort = FNET_TCP_ABORT_INTERVAL;
+                fnet_tcp_settimer(&cb->tcpcb_timers.abort, FNET_TCP_ABORT_INTERVAL);
             }
 
             /* Recalculate the sequence number.*/
             cb->tcpcb_sndseq = cb->tcpcb_rcvack;
 
-            /* Recalculate the congestion window and slow start threshold values (for case of  retransmission).*/
-            if(cb->tcpcb_cwnd > cb->tcpcb_sndwnd)
-            {
-                cb->tcpcb_ssthresh = cb->tcpcb_sndwnd >> 1;
-            }
-            else
-            {
-                cb->tcpcb_ssthresh = cb->tcpcb_cwnd >> 1;
-            }
-
-            if(cb->tcpcb_ssthresh < ((fnet_uint32_t)cb->tcpcb_sndmss << 1))
-            {
-                cb->tcpcb_ssthresh = ((fnet_uint32_t)cb->tcpcb_sndmss << 1);
-            }
+            /* Stop the fast recovery.*/
+            cb->tcpcb_flags &= ~FNET_TCP_CBF_RECOVERY;
+#if FNET_CFG_TCP_TLP
+            cb->tcpcb_flags &= ~FNET_TCP_CBF_TLP;
+            cb->tcpcb_timers.tlp = FNET_TCP_TIMER_OFF;
+#endif
+#if FNET_CFG_TCP_SACK
+            /* Another side may discard the selectively acknowledged data.*/
+            cb->tcpcb_sackblock_num = 0u;
+#endif
 
-            cb->tcpcb_cwnd = cb->tcpcb_sndmss;
+            /* Recalculate the congestion window and slow start threshold values (for case of  retransmission).*/
+            cb->tcpcb_cc->on_rto(cb);
 
             /* Round trip time can't be measured in this case.*/
             cb->tcpcb_timers.round_trip = FNET_TCP_TIMER_OFF;
@@ -3116,12 +4239,12 @@ static void fnet_tcp_rtimeo( fnet_socket_if_t *sk )
     }
 
     /* Recalculate the retransission timer.*/
-    if(cb->tcpcb_crto != FNET_TCP_TIMERS_LIMIT)
+    if(cb->tcpcb_crto != sk->options.tcp_opt.rto_max)
     {
-        if((cb->tcpcb_crto << 1) > FNET_TCP_TIMERS_LIMIT)
+        if((cb->tcpcb_crto << 1) > sk->options.tcp_opt.rto_max)
         {
-            /* Timeout must be less or equal than TIMER_LIMIT.*/
-            cb->tcpcb_crto = FNET_TCP_TIMERS_LIMIT;
+            /* Timeout must be less or equal than TCP_RTO_MAX.*/
+            cb->tcpcb_crto = sk->options.tcp_opt.rto_max;
         }
         else
         {
@@ -3130,7 +4253,7 @@ static void fnet_tcp_rtimeo( fnet_socket_if_t *sk )
         }
     }
 
-    cb->tcpcb_timers.retransmission = cb->tcpcb_crto;
+    fnet_tcp_settimer(&cb->tcpcb_timers.retransmission, cb->tcpcb_crto);
     
 }
 
@@ -3148,6 +4271,7 @@ static void fnet_tcp_ktimeo( fnet_socket_if_t *sk )
     fnet_uint16_t          rcvwnd; 
     fnet_tcp_control_t      *cb = (fnet_tcp_control_t *)sk->protocol_control;
     struct fnet_tcp_segment segment;
+    fnet_time_t             timeout;
     
     /* Create the keepalive segment.*/
     data = fnet_netbuf_new(1u, FNET_FALSE);
@@ -3179,11 +4303,22 @@ static void fnet_tcp_ktimeo( fnet_socket_if_t *sk )
     fnet_tcp_sendseg(&segment);    /* TBD res check */
 
     /* Set the timers.*/
-    cb->tcpcb_timers.keepalive = sk->options.tcp_opt.keep_intvl;
+    fnet_tcp_settimer(&cb->tcpcb_timers.keepalive, sk->options.tcp_opt.keep_intvl);
+
+    /* The time of all probes, limited by the maximal timeout.*/
+    if(sk->options.tcp_opt.keep_cnt > (FNET_TCP_TIMEOUT_MAX / sk->options.tcp_opt.keep_intvl))
+    {
+        timeout = FNET_TCP_TIMEOUT_MAX;
+    }
+    else
+    {
+        timeout = sk->options.tcp_opt.keep_cnt * sk->options.tcp_opt.keep_intvl;
+    }
 
-    if((cb->tcpcb_timers.abort == FNET_TCP_TIMER_OFF) || (cb->tcpcb_timers.abort > (sk->options.tcp_opt.keep_cnt * sk->options.tcp_opt.keep_intvl) ))
+    if((cb->tcpcb_timers.abort == FNET_TCP_TIMER_OFF) 
+        || ((fnet_time_t)(cb->tcpcb_timers.abort - fnet_timer_fine_ms()) > timeout))
     {
-        cb->tcpcb_timers.abort = sk->options.tcp_opt.keep_cnt * sk->options.tcp_opt.keep_intvl;
+        fnet_tcp_settimer(&cb->tcpcb_timers.abort, timeout);
     }
 }
 
@@ -3230,12 +4365,12 @@ static void fnet_tcp_ptimeo( fnet_socket_if_t *sk )
         }
     }
 
-    cb->tcpcb_timers.persist = cb->tcpcb_cprto;
+    fnet_tcp_settimer(&cb->tcpcb_timers.persist, cb->tcpcb_cprto);
 
     /* Initialize the abort timer.*/
     if(cb->tcpcb_timers.abort == FNET_TCP_TIMER_OFF)
     {
-        cb->tcpcb_timers.abort = FNET_TCP_ABORT_INTERVAL;
+        fnet_tcp_settimer(&cb->tcpcb_timers.abort, FNET_TCP_ABORT_INTERVAL);
     }
 }
 
@@ -3256,8 +4391,8 @@ static fnet_error_t fnet_tcp_sendseg(struct fnet_tcp_segment *segment)
 
     netif = (fnet_netif_t *)fnet_netif_get_by_scope_id( segment->dest_addr.sa_scope_id );
 
-    /* Create the header.*/
-    nb = fnet_netbuf_new(FNET_TCP_SIZE_HEADER, FNET_FALSE);
+    /* Create the header, leaving room for the IP header.*/
+    nb = fnet_netbuf_new_headroom(FNET_TCP_SIZE_HEADER, FNET_CFG_NETBUF_HEADROOM, FNET_FALSE);
 
     if(!nb)
     {
@@ -3390,6 +4525,9 @@ static fnet_error_t fnet_tcp_sendheadseg( fnet_socket_if_t *sk, fnet_uint8_t fla
     fnet_uint32_t   ack = 0u;         
     fnet_uint16_t   urgpointer = 0u;
     struct fnet_tcp_segment segment;
+#if FNET_CFG_TCP_TIMESTAMPS
+    fnet_uint32_t   tsoptions[FNET_TCP_SIZE_OPTIONS / 4u];
+#endif
 
     fnet_tcp_control_t *cb = (fnet_tcp_control_t *)sk->protocol_control;
 
@@ -3397,6 +4535,14 @@ static fnet_error_t fnet_tcp_sendheadseg( fnet_socket_if_t *sk, fnet_uint8_t fla
     /* Get the sequence number.*/
     seq = cb->tcpcb_sndseq;
 
+#if FNET_CFG_TCP_TIMESTAMPS
+    /* Add the timestamps option (the SYN segment has it in the synchronized options).*/
+    if((flags & FNET_TCP_SGT_SYN) == 0u)
+    {
+        optlen = fnet_tcp_addtimestampopt(cb, tsoptions, &options, optlen);
+    }
+#endif
+
     /* Get the window.*/
     cb->tcpcb_rcvwnd = fnet_tcp_getrcvwnd(sk);
 
@@ -3457,6 +4603,9 @@ static fnet_error_t fnet_tcp_sendheadseg( fnet_socket_if_t *sk, fnet_uint8_t fla
     if((flags & FNET_TCP_SGT_ACK) != 0u)
     {
         ack = cb->tcpcb_sndack;
+    #if FNET_CFG_TCP_TIMESTAMPS
+        cb->tcpcb_tslastack = ack;
+    #endif
     }
 
     /* Send the segment.*/ 
@@ -3510,6 +4659,12 @@ static fnet_error_t fnet_tcp_senddataseg( fnet_socket_if_t *sk, void *options, f
     fnet_uint32_t           tmp;
     struct fnet_tcp_segment segment;
     fnet_tcp_control_t      *cb = (fnet_tcp_control_t *)sk->protocol_control;
+#if FNET_CFG_TCP_TIMESTAMPS
+    fnet_uint32_t           tsoptions[FNET_TCP_SIZE_OPTIONS / 4u];
+
+    /* Add the timestamps option.*/
+    optlen = fnet_tcp_addtimestampopt(cb, tsoptions, &options, optlen);
+#endif
     
     /* Receive the sequence number.*/
     seq = cb->tcpcb_sndseq;
@@ -3532,9 +4687,9 @@ static fnet_error_t fnet_tcp_senddataseg( fnet_socket_if_t *sk, void *options, f
     tmp = 0u;
 #endif    
 
-    if((datasize + FNET_TCP_SIZE_HEADER) > tmp)
+    if((datasize + FNET_TCP_SIZE_HEADER + optlen) > tmp)
     {
-        datasize = (tmp - FNET_TCP_SIZE_HEADER);
+        datasize = (tmp - FNET_TCP_SIZE_HEADER - optlen);
     }
 
     /* Create the flags.*/
@@ -3603,6 +4758,8 @@ static fnet_error_t fnet_tcp_senddataseg( fnet_socket_if_t *sk, void *options, f
     /* If the data is present, add it.*/
     if(datasize)
     {
+        cb->tcpcb_sndtime = fnet_timer_fine_ms();
+
         data = fnet_netbuf_copy(sk->send_buffer.net_buf_chain, (sk->send_buffer.count - newdatasize), datasize, FNET_FALSE);
 
         /* Check the memory allocation.*/
@@ -3621,6 +4778,9 @@ static fnet_error_t fnet_tcp_senddataseg( fnet_socket_if_t *sk, void *options, f
     segment.ack = cb->tcpcb_sndack;
     segment.flags = flags;
     segment.wnd = (fnet_uint16_t)(cb->tcpcb_rcvwnd >> cb->tcpcb_recvscale);
+#if FNET_CFG_TCP_TIMESTAMPS
+    cb->tcpcb_tslastack = cb->tcpcb_sndack;
+#endif
     segment.urgpointer = (fnet_uint16_t)urgpointer;
     segment.options = options;
     segment.optlen = optlen;
@@ -3654,6 +4814,7 @@ static void fnet_tcp_sendack( fnet_socket_if_t *sk )
 {
     fnet_uint8_t        options[FNET_TCP_MAX_OPT_SIZE]; 
     fnet_uint8_t        optionlen;                     
+    fnet_uint32_t       ackoptions[FNET_TCP_SIZE_OPTIONS / 4u]; /* Options of the ACK segment (32-bit aligned).*/
 
     fnet_tcp_control_t  *cb = (fnet_tcp_control_t *)sk->protocol_control;
     
@@ -3683,16 +4844,21 @@ static void fnet_tcp_sendack( fnet_socket_if_t *sk )
           break;
 
         default:
+            optionlen = 0u;
+    #if FNET_CFG_TCP_SACK
+            /* Report the out-of-order data.*/
+            optionlen = fnet_tcp_setsackopt(sk, ackoptions);
+    #endif
     #if FNET_CFG_TCP_URGENT        
             /* If the urgent data is present, set the urgent flag.*/
             if(FNET_TCP_COMP_GE(cb->tcpcb_sndurgseq, cb->tcpcb_sndseq))
             {
-                fnet_tcp_sendheadseg(sk, FNET_TCP_SGT_ACK | FNET_TCP_SGT_URG, 0, 0);
+                fnet_tcp_sendheadseg(sk, FNET_TCP_SGT_ACK | FNET_TCP_SGT_URG, ackoptions, optionlen);
             }
             else
     #endif /* FNET_CFG_TCP_URGENT */
             {
-                fnet_tcp_sendheadseg(sk, FNET_TCP_SGT_ACK, 0, 0u);
+                fnet_tcp_sendheadseg(sk, FNET_TCP_SGT_ACK, ackoptions, optionlen);
             }
             break;
     }
@@ -3880,12 +5046,20 @@ static fnet_error_t fnet_tcp_addopt( fnet_netbuf_t *segment, fnet_size_t len, vo
 * NAME: fnet_tcp_getopt
 *
 * DESCRIPTION: This function processes the received options.
+*              The MSS, window scale and SACK-permitted options are 
+*              processed only in the SYN segment.
+*              The timestamps of other segments are saved in 
+*              the control block to be processed by the caller.
 *
 * RETURNS: None.
 *************************************************************************/
 static void fnet_tcp_getopt( fnet_socket_if_t *sk, fnet_netbuf_t *segment )
 {
-    fnet_index_t i; /* index variable.*/
+    fnet_index_t    i; /* index variable.*/
+    fnet_bool_t     syn;
+#if FNET_CFG_TCP_SACK
+    fnet_index_t    j;
+#endif
 
     fnet_tcp_control_t *cb = (fnet_tcp_control_t *)sk->protocol_control;
 
@@ -3894,6 +5068,12 @@ static void fnet_tcp_getopt( fnet_socket_if_t *sk, fnet_netbuf_t *segment )
         return;
     }
 
+    syn = ((FNET_TCP_FLAGS(segment) & FNET_TCP_SGT_SYN) != 0u) ? FNET_TRUE : FNET_FALSE;
+
+#if FNET_CFG_TCP_TIMESTAMPS
+    cb->tcpcb_flags &= ~FNET_TCP_CBF_TIMESTAMP_RCVD;
+#endif
+
     /* Start position of the options.*/
     i = FNET_TCP_SIZE_HEADER;
 
@@ -3906,7 +5086,8 @@ static void fnet_tcp_getopt( fnet_socket_if_t *sk, fnet_netbuf_t *segment )
         }
         else
         {
-            if(((i + 1u) >= FNET_TCP_LENGTH(segment)) || (i + FNET_TCP_GETUCHAR(segment->data_ptr, i + 1u) - 1u >= FNET_TCP_LENGTH(segment)))
+            if(((i + 1u) >= FNET_TCP_LENGTH(segment)) || (FNET_TCP_GETUCHAR(segment->data_ptr, i + 1u) < 2u)
+                || (i + FNET_TCP_GETUCHAR(segment->data_ptr, i + 1u) - 1u >= FNET_TCP_LENGTH(segment)))
             {
                 break;
             }
@@ -3915,19 +5096,67 @@ static void fnet_tcp_getopt( fnet_socket_if_t *sk, fnet_netbuf_t *segment )
             switch(FNET_TCP_GETUCHAR(segment->data_ptr, i))
             {
                 case FNET_TCP_OTYPES_MSS:
-                    cb->tcpcb_sndmss = fnet_ntohs(FNET_TCP_GETUSHORT(segment->data_ptr, i + 2u));
+                    if(syn == FNET_TRUE)
+                    {
+                        cb->tcpcb_sndmss = fnet_ntohs(FNET_TCP_GETUSHORT(segment->data_ptr, i + 2u));
+                    }
                     break;
 
                 case FNET_TCP_OTYPES_WINDOW:
-                    cb->tcpcb_sendscale = FNET_TCP_GETUCHAR(segment->data_ptr, i + 2u);
+                    if(syn == FNET_TRUE)
+                    {
+                        cb->tcpcb_sendscale = FNET_TCP_GETUCHAR(segment->data_ptr, i + 2u);
+
+                        if(cb->tcpcb_sendscale > FNET_TCP_MAX_WINSHIFT)
+                        {
+                            cb->tcpcb_sendscale = FNET_TCP_MAX_WINSHIFT;
+                        }
 
-                    if(cb->tcpcb_sendscale > FNET_TCP_MAX_WINSHIFT)
+                        cb->tcpcb_flags |= FNET_TCP_CBF_RCVD_SCALE;
+                    }
+                    break;
+#if FNET_CFG_TCP_SACK
+                case FNET_TCP_OTYPES_SACK_PERMITTED:
+                    if(syn == FNET_TRUE)
+                    {
+                        cb->tcpcb_flags |= FNET_TCP_CBF_SACK;
+                    }
+                    break;
+
+                case FNET_TCP_OTYPES_SACK:
+                    if((syn == FNET_FALSE) && ((cb->tcpcb_flags & FNET_TCP_CBF_SACK) != 0u))
                     {
-                        cb->tcpcb_sendscale = FNET_TCP_MAX_WINSHIFT;
+                        /* Add the blocks to the scoreboard.*/
+                        for(j = i + 2u; (j + FNET_TCP_SACK_BLOCK_SIZE) <= (i + FNET_TCP_GETUCHAR(segment->data_ptr, i + 1u)); j += FNET_TCP_SACK_BLOCK_SIZE)
+                        {
+                            fnet_tcp_sack_add(cb, fnet_ntohl(FNET_TCP_GETULONG(segment->data_ptr, j)),
+                                              fnet_ntohl(FNET_TCP_GETULONG(segment->data_ptr, j + 4u)));
+                        }
                     }
+                    break;
+#endif /* FNET_CFG_TCP_SACK */
+#if FNET_CFG_TCP_TIMESTAMPS
+                case FNET_TCP_OTYPES_TIMESTAMP:
+                    if(FNET_TCP_GETUCHAR(segment->data_ptr, i + 1u) == (FNET_TCP_TIMESTAMP_SIZE - 2u))
+                    {
+                        cb->tcpcb_tsval = fnet_ntohl(FNET_TCP_GETULONG(segment->data_ptr, i + 2u));
+                        cb->tcpcb_tsecr = fnet_ntohl(FNET_TCP_GETULONG(segment->data_ptr, i + 6u));
 
-                    cb->tcpcb_flags |= FNET_TCP_CBF_RCVD_SCALE;
+                        if(syn == FNET_TRUE)
+                        {
+                            cb->tcpcb_flags |= FNET_TCP_CBF_TIMESTAMP;
+                            cb->tcpcb_tsrecent = cb->tcpcb_tsval;
+                            cb->tcpcb_tsrecent_age = fnet_timer_ms();
+                        }
+                        else if((cb->tcpcb_flags & FNET_TCP_CBF_TIMESTAMP) != 0u)
+                        {
+                            cb->tcpcb_flags |= FNET_TCP_CBF_TIMESTAMP_RCVD;
+                        }
+                        else
+                        {}
+                    }
                     break;
+#endif /* FNET_CFG_TCP_TIMESTAMPS */
                 default:
                     break;
             }
@@ -3971,6 +5200,25 @@ static void fnet_tcp_setsynopt( fnet_socket_if_t *sk, fnet_uint8_t *options, fne
     *((fnet_uint32_t *)(options + *optionlen)) = fnet_htonl((fnet_uint32_t)(cb->tcpcb_rcvmss | FNET_TCP_MSS_HEADER));
     *optionlen += FNET_TCP_MSS_SIZE;
 
+#if FNET_CFG_TCP_SACK
+    /* Set the SACK-permitted option. 
+     * The answer to the SYN segment contains it only if another side permits SACK.*/
+    if((cb->tcpcb_connection_state != FNET_TCP_CS_SYN_RCVD) || ((cb->tcpcb_flags & FNET_TCP_CBF_SACK) != 0u))
+    {
+        *((fnet_uint32_t *)(options + *optionlen)) = fnet_htonl(FNET_TCP_SACK_PERMITTED_HEADER);
+        *optionlen += FNET_TCP_SACK_PERMITTED_SIZE;
+    }
+#endif
+
+#if FNET_CFG_TCP_TIMESTAMPS
+    /* Set the timestamps option. 
+     * The answer to the SYN segment contains it only if another side sends timestamps.*/
+    if((cb->tcpcb_connection_state != FNET_TCP_CS_SYN_RCVD) || ((cb->tcpcb_flags & FNET_TCP_CBF_TIMESTAMP) != 0u))
+    {
+        *optionlen += fnet_tcp_settimestampopt(cb->tcpcb_tsrecent, options + *optionlen);
+    }
+#endif
+
     /* Set the window scale option.*/
     *((fnet_uint32_t *)(options + *optionlen))
          = fnet_htonl((fnet_uint32_t)((cb->tcpcb_recvscale | FNET_TCP_WINDOW_HEADER) << 8));
@@ -4002,89 +5250,1457 @@ static void fnet_tcp_getsynopt( fnet_socket_if_t *sk )
         {
             cb->tcpcb_rcvcountmax = FNET_TCP_MAXWIN;
         }
+
+    #if FNET_CFG_TCP_RCVBUF_AUTO
+        if(cb->tcpcb_rcvcountcap > FNET_TCP_MAXWIN)
+        {
+            cb->tcpcb_rcvcountcap = FNET_TCP_MAXWIN;
+        }
+    #endif
+    }
+
+#if FNET_CFG_TCP_TIMESTAMPS
+    /* The timestamps option is sent in every segment, 
+     * it reduces the room for the data.*/
+    if(((cb->tcpcb_flags & FNET_TCP_CBF_TIMESTAMP) != 0u) && (cb->tcpcb_sndmss > (FNET_TCP_TIMESTAMP_SIZE << 1)))
+    {
+        cb->tcpcb_sndmss -= FNET_TCP_TIMESTAMP_SIZE;
     }
+#endif
 
     /* Initialize the congestion window.*/
     cb->tcpcb_cwnd = cb->tcpcb_sndmss;
+    cb->tcpcb_sndtime = fnet_timer_fine_ms();
+    cb->tcpcb_cc->init(cb);
 
+#if FNET_CFG_TCP_RCVBUF_AUTO
+    /* Start the measurement of the received data.*/
+    cb->tcpcb_autoseq = cb->tcpcb_sndack;
+    cb->tcpcb_autotime = fnet_timer_fine_ms();
+#endif
 }
 
+#if FNET_CFG_TCP_SYN_COOKIES
 /************************************************************************
-* NAME: fnet_tcp_findsk
+* NAME: fnet_tcp_cookie_sipround
 *
-* DESCRIPTION: This function finds the socket with parameters that allow
-*              to receive and process the segment. 
+* DESCRIPTION: This function makes one round of the HalfSipHash function.
 *
-* RETURNS: If the socket is found this function returns the pointer to the
-*          socket. Otherwise, this function returns 0.
+* RETURNS: None.
 *************************************************************************/
-static fnet_socket_if_t *fnet_tcp_findsk( struct sockaddr *src_addr,  struct sockaddr *dest_addr )                                       
+static void fnet_tcp_cookie_sipround( fnet_uint32_t *v )
 {
-    fnet_socket_if_t   *listensk = 0;
-    fnet_socket_if_t   *sk;
+    v[0] += v[1]; v[1] = FNET_TCP_COOKIE_ROTL(v[1], 5u);  v[1] ^= v[0]; v[0] = FNET_TCP_COOKIE_ROTL(v[0], 16u);
+    v[2] += v[3]; v[3] = FNET_TCP_COOKIE_ROTL(v[3], 8u);  v[3] ^= v[2];
+    v[0] += v[3]; v[3] = FNET_TCP_COOKIE_ROTL(v[3], 7u);  v[3] ^= v[0];
+    v[2] += v[1]; v[1] = FNET_TCP_COOKIE_ROTL(v[1], 13u); v[1] ^= v[2]; v[2] = FNET_TCP_COOKIE_ROTL(v[2], 16u);
+}
 
-    fnet_isr_lock();
-    
-    sk = fnet_tcp_prot_if.head;
+/************************************************************************
+* NAME: fnet_tcp_cookie_keyedhash
+*
+* DESCRIPTION: This function calculates HalfSipHash-2-4 of the 32-bit 
+*              words with the 64-bit key.
+*
+* RETURNS: Hash value.
+*************************************************************************/
+static fnet_uint32_t fnet_tcp_cookie_keyedhash( const fnet_uint32_t *key, const fnet_uint32_t *data, fnet_size_t words )
+{
+    fnet_uint32_t   v[4];
+    fnet_uint32_t   m;
+    fnet_index_t    i;
 
-    while(sk)
+    v[0] = key[0];
+    v[1] = key[1];
+    v[2] = key[0] ^ 0x6C796765u;
+    v[3] = key[1] ^ 0x74656462u;
+
+    for(i = 0u; i <= words; i++)
     {
-        if(sk->local_addr.sa_port == dest_addr->sa_port)
-        {
-            /* Listening socket.*/
-            if(sk->state == SS_LISTENING)
-            {
-                if((!listensk) && ((fnet_socket_addr_is_unspecified(&sk->local_addr)) || (fnet_socket_addr_are_equal(&sk->local_addr, dest_addr)) ))
-                {
-                    listensk = sk;
-                }
-            }
-            else
-            {
-                /* Not listening socket.*/
-                if((fnet_socket_addr_are_equal(&sk->local_addr, dest_addr)) && (sk->state != SS_UNCONNECTED) && 
-                   (fnet_socket_addr_are_equal(&sk->foreign_addr, src_addr)) && (sk->foreign_addr.sa_port == src_addr->sa_port))
-                {
-                     break;
-                }
-            }
-        }
-        sk = sk->next;
+        /* The last word is the message length.*/
+        m = (i < words) ? data[i] : ((fnet_uint32_t)words << 26);
+
+        v[3] ^= m;
+        fnet_tcp_cookie_sipround(v);
+        fnet_tcp_cookie_sipround(v);
+        v[0] ^= m;
     }
 
-    /* If the listening socket with the same local parameters (address and port) is present.*/
-    if((!sk) && listensk)
+    v[2] ^= 0xFFu;
+
+    for(i = 0u; i < 4u; i++)
     {
-        /* Search the partial socket with the same foreign parameters (address and port).*/
-        sk = listensk->partial_con;
+        fnet_tcp_cookie_sipround(v);
+    }
 
-        while(sk)
-        {
-            if((fnet_socket_addr_are_equal(&sk->foreign_addr, src_addr)) && (sk->foreign_addr.sa_port == src_addr->sa_port))
-            {
-                break;
-            }
+    return v[1] ^ v[3];
+}
 
-            sk = sk->next;
-        }
+/************************************************************************
+* NAME: fnet_tcp_cookie_rekey
+*
+* DESCRIPTION: This function creates the new secret key of SYN cookies,
+*              if there is no key or the current key is older than 
+*              FNET_TCP_COOKIE_REKEY_PERIOD. The previous key is kept 
+*              for the validation of the cookies, sent before. 
+*              The new key is the keyed hash of the random values, 
+*              the time, the ISN counter and the hardware address, 
+*              with the previous key, so the entropy is accumulated.
+*
+* RETURNS: None.
+*************************************************************************/
+static void fnet_tcp_cookie_rekey( void )
+{
+    fnet_uint32_t       data[7];
+    fnet_uint8_t        hw_addr[8];
+    fnet_netif_desc_t   netif = fnet_netif_get_default();
+    fnet_time_t         now = fnet_timer_seconds();
 
-        if(!sk)
-        {
-            /* Search the incoming socket with the same foreign parameters (address and port).*/
-            sk = listensk->incoming_con;
+    if((fnet_tcp_cookie_key_num > 0u) && ((now - fnet_tcp_cookie_key_time) < FNET_TCP_COOKIE_REKEY_PERIOD))
+    {
+        return;
+    }
 
-            while(sk)
-            {
-                if((fnet_socket_addr_are_equal(&sk->foreign_addr, src_addr)) && (sk->foreign_addr.sa_port == src_addr->sa_port))
-                {
-                    break;
+    fnet_memset_zero(hw_addr, sizeof(hw_addr));
+    if(netif)
+    {
+        fnet_netif_get_hw_addr(netif, hw_addr, 6u);
+    }
+
+    data[0] = ((fnet_uint32_t)fnet_rand() << 16) ^ (fnet_uint32_t)fnet_rand();
+    data[1] = ((fnet_uint32_t)fnet_rand() << 16) ^ (fnet_uint32_t)fnet_rand();
+    data[2] = fnet_timer_ms();
+    data[3] = fnet_tcp_isntime;
+    data[4] = ((fnet_uint32_t)hw_addr[0] << 24) | ((fnet_uint32_t)hw_addr[1] << 16) | ((fnet_uint32_t)hw_addr[2] << 8) | hw_addr[3];
+    data[5] = ((fnet_uint32_t)hw_addr[4] << 24) | ((fnet_uint32_t)hw_addr[5] << 16);
+
+    /* Keep the previous key.*/
+    fnet_tcp_cookie_key[1][0] = fnet_tcp_cookie_key[0][0];
+    fnet_tcp_cookie_key[1][1] = fnet_tcp_cookie_key[0][1];
+
+    data[6] = 0u;
+    fnet_tcp_cookie_key[0][0] = fnet_tcp_cookie_keyedhash(fnet_tcp_cookie_key[1], data, 7u);
+    data[6] = 1u;
+    fnet_tcp_cookie_key[0][1] = fnet_tcp_cookie_keyedhash(fnet_tcp_cookie_key[1], data, 7u);
+
+    if(fnet_tcp_cookie_key_num < 2u)
+    {
+        fnet_tcp_cookie_key_num++;
+    }
+
+    fnet_tcp_cookie_key_time = now;
+}
+
+/************************************************************************
+* NAME: fnet_tcp_cookie_hash
+*
+* DESCRIPTION: This function calculates the keyed hash of the connection 
+*              (addresses, ports, initial sequence number of another side),
+*              protecting the SYN cookie. "key_index" is 0 for the current
+*              key and 1 for the previous key.
+*
+* RETURNS: Hash value.
+*************************************************************************/
+static fnet_uint32_t fnet_tcp_cookie_hash( fnet_index_t key_index, struct sockaddr *local_addr, struct sockaddr *foreign_addr, fnet_uint32_t isn, fnet_uint32_t param )
+{
+    fnet_uint32_t   data[3u + (2u * sizeof(fnet_ip6_addr_t) / 4u)];
+    fnet_size_t     words;
+    fnet_size_t     addr_size;
+    fnet_index_t    i;
+
+    addr_size = (local_addr->sa_family == AF_INET6) ? sizeof(fnet_ip6_addr_t) : sizeof(fnet_ip4_addr_t);
+
+    data[0] = isn;
+    data[1] = param;
+    data[2] = ((fnet_uint32_t)local_addr->sa_port << 16) | foreign_addr->sa_port;
+    words = 3u;
+
+    for(i = 0u; i < addr_size; i += 4u)
+    {
+        data[words++] = ((fnet_uint32_t)local_addr->sa_data[i] << 24) | ((fnet_uint32_t)local_addr->sa_data[i + 1u] << 16)
+                        | ((fnet_uint32_t)local_addr->sa_data[i + 2u] << 8) | (fnet_uint32_t)local_addr->sa_data[i + 3u];
+        data[words++] = ((fnet_uint32_t)foreign_addr->sa_data[i] << 24) | ((fnet_uint32_t)foreign_addr->sa_data[i + 1u] << 16)
+                        | ((fnet_uint32_t)foreign_addr->sa_data[i + 2u] << 8) | (fnet_uint32_t)foreign_addr->sa_data[i + 3u];
+    }
+
+    return fnet_tcp_cookie_keyedhash(fnet_tcp_cookie_key[key_index], data, words);
+}
+
+/************************************************************************
+* NAME: fnet_tcp_cookie_send
+*
+* DESCRIPTION: This function answers the SYN segment by the SYN-ACK segment
+*              with the SYN cookie as the initial sequence number.
+*              No state is kept for the connection.
+*
+* RETURNS: None.
+*************************************************************************/
+static void fnet_tcp_cookie_send( fnet_socket_if_t *sk, fnet_netbuf_t *insegment, struct sockaddr *src_addr, struct sockaddr *dest_addr )
+{
+    fnet_tcp_control_t      *cb = (fnet_tcp_control_t *)sk->protocol_control;
+    struct fnet_tcp_segment segment;
+    fnet_uint32_t           options;
+    fnet_uint32_t           isn = fnet_ntohl(FNET_TCP_SEQ(insegment));
+    fnet_uint32_t           param;
+    fnet_uint16_t           sndmss = FNET_TCP_DEFAULT_MSS;
+    fnet_uint16_t           rcvmss;
+    fnet_index_t            mss_index;
+    fnet_index_t            i;
+
+    /* Find the MSS option.*/
+    i = FNET_TCP_SIZE_HEADER;
+
+    while((i < FNET_TCP_LENGTH(insegment)) && (FNET_TCP_GETUCHAR(insegment->data_ptr, i) != FNET_TCP_OTYPES_END))
+    {
+        if(FNET_TCP_GETUCHAR(insegment->data_ptr, i) == FNET_TCP_OTYPES_NOP)
+        {
+            ++i;
+        }
+        else
+        {
+            if(((i + 1u) >= FNET_TCP_LENGTH(insegment)) || (FNET_TCP_GETUCHAR(insegment->data_ptr, i + 1u) < 2u)
+                || (i + FNET_TCP_GETUCHAR(insegment->data_ptr, i + 1u) - 1u >= FNET_TCP_LENGTH(insegment)))
+            {
+                break;
+            }
+
+            if(FNET_TCP_GETUCHAR(insegment->data_ptr, i) == FNET_TCP_OTYPES_MSS)
+            {
+                sndmss = fnet_ntohs(FNET_TCP_GETUSHORT(insegment->data_ptr, i + 2u));
+            }
+
+            i += FNET_TCP_GETUCHAR(insegment->data_ptr, i + 1u);
+        }
+    }
+
+    /* Encode the largest MSS, not greater than MSS of another side.*/
+    for(mss_index = FNET_TCP_COOKIE_MSS_MASK; (mss_index > 0u) && (fnet_tcp_cookie_mss[mss_index] > sndmss); mss_index--)
+    {}
+
+    param = ((((fnet_uint32_t)fnet_timer_seconds() >> FNET_TCP_COOKIE_PERIOD_SHIFT) & FNET_TCP_COOKIE_COUNT_MASK) << FNET_TCP_COOKIE_COUNT_SHIFT)
+            | ((fnet_uint32_t)mss_index << FNET_TCP_COOKIE_MSS_SHIFT);
+
+    rcvmss = (cb->tcpcb_rcvmss) ? cb->tcpcb_rcvmss : (fnet_uint16_t)FNET_TCP_DEFAULT_MSS;
+    options = fnet_htonl((fnet_uint32_t)(rcvmss | FNET_TCP_MSS_HEADER));
+
+    segment.sockoption = &sk->options;
+    fnet_memcpy(&segment.src_addr, dest_addr, sizeof(segment.src_addr));
+    fnet_memcpy(&segment.dest_addr, src_addr, sizeof(segment.dest_addr));
+    fnet_tcp_cookie_rekey();
+
+    segment.seq = param | (fnet_tcp_cookie_hash(0u, dest_addr, src_addr, isn, param) & FNET_TCP_COOKIE_HASH_MASK);
+    segment.ack = isn + 1u;
+    segment.flags = FNET_TCP_SGT_SYN | FNET_TCP_SGT_ACK;
+    segment.wnd = (fnet_uint16_t)((cb->tcpcb_rcvcountmax > FNET_TCP_MAXWIN) ? FNET_TCP_MAXWIN : cb->tcpcb_rcvcountmax);
+    segment.urgpointer = 0u;
+    segment.options = &options;
+    segment.optlen = FNET_TCP_MSS_SIZE;
+    segment.data = 0;
+
+    fnet_tcp_sendseg(&segment);
+
+    cb->tcpcb_cookies_sent++;
+    cb->tcpcb_cookie_time = fnet_timer_seconds();
+}
+
+/************************************************************************
+* NAME: fnet_tcp_cookie_check
+*
+* DESCRIPTION: This function validates the acknowledgment of the SYN cookie
+*              and creates the partial socket of the connection.
+*
+* RETURNS: If the cookie is valid, this function returns the pointer 
+*          to the new socket. Otherwise it returns 0.
+*************************************************************************/
+static fnet_socket_if_t *fnet_tcp_cookie_check( fnet_socket_if_t *sk, fnet_netbuf_t *insegment, struct sockaddr *dest_addr )
+{
+    fnet_tcp_control_t  *cb = (fnet_tcp_control_t *)sk->protocol_control;
+    fnet_tcp_control_t  *pcb;
+    fnet_socket_if_t    *psk;
+    fnet_uint32_t       isn = fnet_ntohl(FNET_TCP_SEQ(insegment)) - 1u;
+    fnet_uint32_t       cookie = fnet_ntohl(FNET_TCP_ACK(insegment)) - 1u;
+    fnet_uint32_t       count = ((fnet_uint32_t)fnet_timer_seconds() >> FNET_TCP_COOKIE_PERIOD_SHIFT);
+    fnet_uint32_t       param = cookie & ~FNET_TCP_COOKIE_HASH_MASK;
+    fnet_index_t        i;
+
+    /* The acknowledgment is checked only within two counter periods 
+     * after the last SYN cookie is sent by the listening socket.*/
+    if((cb->tcpcb_cookies_sent == 0u) 
+        || ((fnet_timer_seconds() - cb->tcpcb_cookie_time) >= (2u << FNET_TCP_COOKIE_PERIOD_SHIFT)))
+    {
+        return 0;
+    }
+
+    /* The cookie is valid during two counter periods.*/
+    if(((count - (cookie >> FNET_TCP_COOKIE_COUNT_SHIFT)) & FNET_TCP_COOKIE_COUNT_MASK) > 1u)
+    {
+        return 0;
+    }
+
+    /* The cookie is made with the current or the previous key.*/
+    for(i = 0u; i < fnet_tcp_cookie_key_num; i++)
+    {
+        if((fnet_tcp_cookie_hash(i, dest_addr, &sk->foreign_addr, isn, param) & FNET_TCP_COOKIE_HASH_MASK) == (cookie & FNET_TCP_COOKIE_HASH_MASK))
+        {
+            break;
+        }
+    }
+
+    if(i == fnet_tcp_cookie_key_num)
+    {
+        return 0;
+    }
+
+    if(sk->incoming_con_len >= sk->con_limit)
+    {
+        return 0;
+    }
+
+    /* Create the socket.*/
+    psk = fnet_tcp_newpartialsk(sk, dest_addr, cookie, isn);
+
+    if(!psk)
+    {
+        return 0;
+    }
+
+    pcb = (fnet_tcp_control_t *)psk->protocol_control;
+
+    /* Restore the parameters of the control block. The SYN segment is sent.*/
+    pcb->tcpcb_rcvack = cookie;
+    pcb->tcpcb_sndseq = cookie + 1u;
+    pcb->tcpcb_sndmss = fnet_tcp_cookie_mss[(cookie >> FNET_TCP_COOKIE_MSS_SHIFT) & FNET_TCP_COOKIE_MSS_MASK];
+
+    if(pcb->tcpcb_rcvmss == 0u)
+    {
+        pcb->tcpcb_rcvmss = FNET_TCP_DEFAULT_MSS;
+    }
+
+    /* The options are not negotiated.*/
+    fnet_tcp_getsynopt(psk);
+    pcb->tcpcb_rcvwnd = fnet_tcp_getrcvwnd(psk);
+
+    cb->tcpcb_cookies_valid++;
+
+    return psk;
+}
+#endif /* FNET_CFG_TCP_SYN_COOKIES */
+
+#if FNET_CFG_TCP_RCVBUF_AUTO
+/************************************************************************
+* NAME: fnet_tcp_rcvbuf_auto
+*
+* DESCRIPTION: This function grows the receive window towards twice 
+*              the amount of data received during one round trip time,
+*              so that the window is not a bottleneck of the connection.
+*              If the window has been filled during the round trip time,
+*              it is doubled. 
+*              The window never grows above the receive buffer size. 
+*
+* RETURNS: None.
+*************************************************************************/
+static void fnet_tcp_rcvbuf_auto( fnet_tcp_control_t *cb )
+{
+    fnet_time_t     now;
+    fnet_time_t     rtt;
+    fnet_size_t     size;
+
+    /* Auto-tuning is off, or the window has reached the limit.*/
+    if(cb->tcpcb_rcvcountmax >= cb->tcpcb_rcvcountcap)
+    {
+        return;
+    }
+
+    now = fnet_timer_fine_ms();
+
+#if FNET_CFG_TCP_TIMESTAMPS
+    /* The data of another side is sent after our acknowledgment is received,
+     * so the echoed timestamp gives the round trip time.*/
+    if(((cb->tcpcb_flags & FNET_TCP_CBF_TIMESTAMP_RCVD) != 0u) && (cb->tcpcb_tsecr)
+        && ((fnet_time_t)(now - cb->tcpcb_tsecr) <= FNET_TCP_TIMESTAMP_RTT_MAX))
+    {
+        rtt = (fnet_time_t)(now - cb->tcpcb_tsecr);
+
+        if((!cb->tcpcb_rcvrtt) || (rtt < cb->tcpcb_rcvrtt))
+        {
+            cb->tcpcb_rcvrtt = rtt;
+        }
+        else
+        {
+            cb->tcpcb_rcvrtt += (rtt - cb->tcpcb_rcvrtt) >> FNET_TCP_RTT_SHIFT;
+        }
+    }
+#endif
+
+    /* Use the round trip time of the sender, if the receiver has not measured it.*/
+    rtt = cb->tcpcb_rcvrtt;
+
+    if((!rtt) && (cb->tcpcb_srtt))
+    {
+        rtt = ((fnet_uint32_t)cb->tcpcb_srtt >> FNET_TCP_RTT_SHIFT);
+    }
+
+    if(!rtt)
+    {
+        rtt = FNET_TCP_RTT_DEFAULT;
+    }
+
+    if(rtt < FNET_TIMER_PERIOD_MS)
+    {
+        rtt = FNET_TIMER_PERIOD_MS;
+    }
+
+    if((fnet_time_t)(now - cb->tcpcb_autotime) >= rtt)
+    {
+        size = fnet_tcp_getsize(cb->tcpcb_autoseq, cb->tcpcb_sndack);
+
+        /* The sender is limited by the window, if less than two segments 
+         * of the window are not used.*/
+        if((size + ((fnet_size_t)cb->tcpcb_rcvmss << 1)) >= cb->tcpcb_rcvcountmax)
+        {
+            size = cb->tcpcb_rcvcountmax;
+        }
+
+        size <<= 1;
+
+        if(size > cb->tcpcb_rcvcountmax)
+        {
+            cb->tcpcb_rcvcountmax = (size < cb->tcpcb_rcvcountcap) ? size : cb->tcpcb_rcvcountcap;
+        }
+
+        cb->tcpcb_autoseq = cb->tcpcb_sndack;
+        cb->tcpcb_autotime = now;
+    }
+}
+#endif /* FNET_CFG_TCP_RCVBUF_AUTO */
+
+/************************************************************************
+* NAME: fnet_tcp_rttupdate
+*
+* DESCRIPTION: This function updates the smoothed round trip time 
+*              and its variance by the new sample (using Jacobson method),
+*              and recalculates the retransmission timeout.
+*              The round trip variables are kept in milliseconds.
+*
+* RETURNS: None.
+*************************************************************************/
+static void fnet_tcp_rttupdate( fnet_socket_if_t *sk, fnet_time_t rtt )
+{
+    fnet_tcp_control_t  *cb = (fnet_tcp_control_t *)sk->protocol_control;
+    fnet_int32_t        err;
+    fnet_time_t         rto;
+
+    if(cb->tcpcb_srtt)
+    {
+        err = (fnet_int32_t)rtt - (fnet_int32_t)((fnet_uint32_t)cb->tcpcb_srtt >> FNET_TCP_RTT_SHIFT);
+
+        if((cb->tcpcb_srtt += err) <= 0)
+        {
+            cb->tcpcb_srtt = 1;
+        }
+
+        if(err < 0)
+        {
+            err = -err;
+        }
+
+        err -= (fnet_int32_t)((fnet_uint32_t)cb->tcpcb_rttvar >> FNET_TCP_RTTVAR_SHIFT);
+
+        if((cb->tcpcb_rttvar += err) <= 0)
+        {
+            cb->tcpcb_rttvar = 1;
+        }
+    }
+    else
+    {
+        /* Initial calculation of the retransmission variables.*/
+        cb->tcpcb_srtt = (fnet_int32_t)((rtt << FNET_TCP_RTT_SHIFT) | 1u);
+        cb->tcpcb_rttvar = (fnet_int32_t)((rtt << (FNET_TCP_RTTVAR_SHIFT - 1u)) | 1u);
+    }
+
+    /* RTO = SRTT + max(G, 4*RTTVAR) (RFC6298). 
+     * The granularity is the period of the timer.*/
+    rto = ((fnet_uint32_t)cb->tcpcb_srtt >> FNET_TCP_RTT_SHIFT);
+    rto += ((fnet_uint32_t)cb->tcpcb_rttvar > FNET_TCP_TIMER_PERIOD) ? (fnet_uint32_t)cb->tcpcb_rttvar : FNET_TCP_TIMER_PERIOD;
+
+    if(rto < sk->options.tcp_opt.rto_min)
+    {
+        rto = sk->options.tcp_opt.rto_min;
+    }
+
+    if(rto > sk->options.tcp_opt.rto_max)
+    {
+        rto = sk->options.tcp_opt.rto_max;
+    }
+
+    cb->tcpcb_rto = rto;
+}
+
+/************************************************************************
+* NAME: fnet_tcp_rexmtfirst
+*
+* DESCRIPTION: This function retransmits the first unacknowledged segment.
+*
+* RETURNS: None.
+*************************************************************************/
+static void fnet_tcp_rexmtfirst( fnet_socket_if_t *sk )
+{
+    fnet_tcp_control_t  *cb = (fnet_tcp_control_t *)sk->protocol_control;
+    fnet_uint32_t       seq;
+
+    seq = cb->tcpcb_sndseq;
+    cb->tcpcb_sndseq = cb->tcpcb_rcvack;
+    fnet_tcp_senddataseg(sk, 0, 0u, (fnet_size_t)cb->tcpcb_sndmss);
+    cb->tcpcb_sndseq = seq;
+
+#if FNET_CFG_TCP_SACK
+    cb->tcpcb_sackrxt = cb->tcpcb_rcvack + cb->tcpcb_sndmss;
+#endif
+}
+
+/************************************************************************
+* NAME: fnet_tcp_recovery
+*
+* DESCRIPTION: This function starts the fast recovery 
+*              and retransmits the first lost segment.
+*
+* RETURNS: None.
+*************************************************************************/
+static void fnet_tcp_recovery( fnet_socket_if_t *sk )
+{
+    fnet_tcp_control_t  *cb = (fnet_tcp_control_t *)sk->protocol_control;
+
+    /* Recalculate the congestion window and slow start threshold values.*/
+    cb->tcpcb_cc->on_loss(cb);
+
+    /* The segments, that have left the network, inflate the congestion window.*/
+    cb->tcpcb_cwnd += (fnet_uint32_t)cb->tcpcb_fastretrcounter * cb->tcpcb_sndmss;
+
+    /* Increase the timer of repeated acknowledgments.*/  
+    cb->tcpcb_fastretrcounter = FNET_TCP_NUMBER_FOR_FAST_RET + 1u;
+
+    /* Start the fast recovery.*/
+    cb->tcpcb_flags |= FNET_TCP_CBF_RECOVERY;
+    cb->tcpcb_recover = cb->tcpcb_maxrcvack;
+
+#if FNET_CFG_TCP_TLP
+    cb->tcpcb_timers.tlp = FNET_TCP_TIMER_OFF;
+#endif
+
+#if FNET_CFG_TCP_SACK
+    cb->tcpcb_sackrxt = cb->tcpcb_rcvack;
+
+    if(((cb->tcpcb_flags & FNET_TCP_CBF_SACK) == 0u) || (fnet_tcp_sack_retransmit(sk) == FNET_FALSE))
+#endif
+    {
+        fnet_tcp_rexmtfirst(sk);
+    }
+
+    /* Round trip time can't be measured in this case.*/
+    cb->tcpcb_timers.round_trip = FNET_TCP_TIMER_OFF;
+    cb->tcpcb_timing_state = TCP_TS_SEGMENT_LOST;
+}
+
+#if FNET_CFG_TCP_TLP
+/************************************************************************
+* NAME: fnet_tcp_tlpset
+*
+* DESCRIPTION: This function starts the tail loss probe timer 
+*              (PTO = 2*SRTT), if the sent data is not acknowledged.
+*
+* RETURNS: None.
+*************************************************************************/
+static void fnet_tcp_tlpset( fnet_socket_if_t *sk )
+{
+    fnet_tcp_control_t  *cb = (fnet_tcp_control_t *)sk->protocol_control;
+    fnet_uint32_t       flight;
+    fnet_time_t         pto;
+
+    /* The reordering timer is running.*/
+    if(cb->tcpcb_fastretrcounter)
+    {
+        return;
+    }
+
+    cb->tcpcb_timers.tlp = FNET_TCP_TIMER_OFF;
+
+    flight = fnet_tcp_getsize(cb->tcpcb_rcvack, cb->tcpcb_sndseq);
+
+    /* One probe is sent, only if the round trip time is measured. 
+     * It is not used in the recovery after the loss.
+     * After the final segment is sent, the probe repeats the last data 
+     * segment with the FIN flag, or the FIN alone. As the probe is not 
+     * repeated until it is acknowledged, an already probed FIN 
+     * is left to the retransmission timer.*/
+    if((flight == 0u) || (cb->tcpcb_srtt == 0) 
+        || (cb->tcpcb_sndseq != cb->tcpcb_maxrcvack)
+        || (cb->tcpcb_retrseq == cb->tcpcb_rcvack)
+        || ((cb->tcpcb_flags & (FNET_TCP_CBF_RECOVERY | FNET_TCP_CBF_TLP)) != 0u))
+    {
+        return;
+    }
+
+    pto = ((fnet_uint32_t)cb->tcpcb_srtt >> FNET_TCP_RTT_SHIFT) << 1;
+
+    /* The acknowledgment of a single segment may be delayed by another side.*/
+    if(flight <= cb->tcpcb_sndmss)
+    {
+        pto += FNET_TCP_TLP_DELACK;
+    }
+
+    if(pto < FNET_TCP_TIMER_PERIOD)
+    {
+        pto = FNET_TCP_TIMER_PERIOD;
+    }
+
+    /* The retransmission timer expires earlier.*/
+    if(pto < cb->tcpcb_rto)
+    {
+        fnet_tcp_settimer(&cb->tcpcb_timers.tlp, pto);
+    }
+}
+
+/************************************************************************
+* NAME: fnet_tcp_tlptimeo
+*
+* DESCRIPTION: This function processes the timeout of the tail loss probe 
+*              timer. After a repeated acknowledgment, the first 
+*              unacknowledged segment is considered lost. Otherwise, 
+*              the last segment is retransmitted, so its acknowledgment 
+*              reveals the lost segments.
+*
+* RETURNS: None.
+*************************************************************************/
+static void fnet_tcp_tlptimeo( fnet_socket_if_t *sk )
+{
+    fnet_tcp_control_t  *cb = (fnet_tcp_control_t *)sk->protocol_control;
+    fnet_uint32_t       seq;
+    fnet_size_t         size;
+    fnet_size_t         fin;
+
+    if(((cb->tcpcb_flags & FNET_TCP_CBF_RECOVERY) != 0u) || (cb->tcpcb_rcvack == cb->tcpcb_sndseq))
+    {
+        return;
+    }
+
+    if(cb->tcpcb_fastretrcounter)
+    {
+        /* Time-based loss detection.*/
+        fnet_tcp_recovery(sk);
+    }
+    else
+    {
+        /* The FIN flag takes the last sequence number.*/
+        fin = ((cb->tcpcb_flags & FNET_TCP_CBF_FIN_SENT) != 0u) ? 1u : 0u;
+
+        /* Retransmit the last segment. 
+         * The FIN flag is added, if the segment ends the output buffer.*/
+        size = fnet_tcp_getsize(cb->tcpcb_rcvack, cb->tcpcb_sndseq) - fin;
+        if(size > cb->tcpcb_sndmss)
+        {
+            size = cb->tcpcb_sndmss;
+        }
+
+        seq = cb->tcpcb_sndseq;
+        cb->tcpcb_sndseq -= (size + fin);
+        fnet_tcp_senddataseg(sk, 0, 0u, size);
+        cb->tcpcb_sndseq = seq;
+
+        cb->tcpcb_tlphigh = seq;
+        cb->tcpcb_flags |= FNET_TCP_CBF_TLP;
+
+        /* Round trip time can't be measured in this case.*/
+        cb->tcpcb_timers.round_trip = FNET_TCP_TIMER_OFF;
+        cb->tcpcb_timing_state = TCP_TS_SEGMENT_LOST;
+
+        /* Restart the retransmission timer.*/
+        fnet_tcp_settimer(&cb->tcpcb_timers.retransmission, cb->tcpcb_rto);
+    }
+}
+#endif /* FNET_CFG_TCP_TLP */
+
+/************************************************************************
+* NAME: fnet_tcp_cc_get
+*
+* DESCRIPTION: This function returns the congestion control algorithm.
+*
+* RETURNS: The pointer to the algorithm, or 0 if it is not supported.
+*************************************************************************/
+static const fnet_tcp_cc_t *fnet_tcp_cc_get( fnet_tcp_congestion_t congestion )
+{
+    const fnet_tcp_cc_t *cc;
+
+    switch(congestion)
+    {
+        case TCP_CONGESTION_NEWRENO:
+            cc = &fnet_tcp_cc_newreno;
+            break;
+    #if FNET_CFG_TCP_CUBIC
+        case TCP_CONGESTION_CUBIC:
+            cc = &fnet_tcp_cc_cubic;
+            break;
+    #endif
+        default:
+            cc = 0;
+            break;
+    }
+
+    return cc;
+}
+
+/************************************************************************
+* NAME: fnet_tcp_newreno_init
+*
+* DESCRIPTION: NewReno: initialization of the algorithm.
+*
+* RETURNS: None.
+*************************************************************************/
+static void fnet_tcp_newreno_init( fnet_tcp_control_t *cb )
+{
+    cb->tcpcb_pcount = 0u;
+}
+
+/************************************************************************
+* NAME: fnet_tcp_newreno_ack
+*
+* DESCRIPTION: NewReno: the congestion window grows by the acknowledged 
+*              data in the slow start mode, and by one segment 
+*              per window in the congestion avoidance mode.
+*
+* RETURNS: None.
+*************************************************************************/
+static void fnet_tcp_newreno_ack( fnet_tcp_control_t *cb, fnet_size_t size )
+{
+    if(cb->tcpcb_cwnd < FNET_TCP_MAX_BUFFER)
+    {
+        if(cb->tcpcb_cwnd > cb->tcpcb_ssthresh)
+        {
+            /* Congestion avoidance mode.*/
+            cb->tcpcb_pcount += size;
+        }
+        else
+        {
+            /* Slow start mode.*/
+            if(cb->tcpcb_cwnd + size > cb->tcpcb_ssthresh)
+            {
+                cb->tcpcb_pcount = cb->tcpcb_pcount + cb->tcpcb_cwnd + size - cb->tcpcb_ssthresh;
+                cb->tcpcb_cwnd = cb->tcpcb_ssthresh;
+            }
+            else
+            {
+                cb->tcpcb_cwnd += size;
+            }
+        }
+
+        if(cb->tcpcb_pcount >= cb->tcpcb_cwnd)
+        {
+            cb->tcpcb_pcount -= cb->tcpcb_cwnd;
+            cb->tcpcb_cwnd += cb->tcpcb_sndmss;
+        }
+    }
+}
+
+/************************************************************************
+* NAME: fnet_tcp_newreno_loss
+*
+* DESCRIPTION: NewReno: the congestion window is halved.
+*
+* RETURNS: None.
+*************************************************************************/
+static void fnet_tcp_newreno_loss( fnet_tcp_control_t *cb )
+{
+    if(cb->tcpcb_cwnd > cb->tcpcb_sndwnd)
+    {
+        cb->tcpcb_ssthresh = cb->tcpcb_sndwnd >> 1;
+    }
+    else
+    {
+        cb->tcpcb_ssthresh = cb->tcpcb_cwnd >> 1;
+    }
+
+    if(cb->tcpcb_ssthresh < ((fnet_uint32_t)cb->tcpcb_sndmss << 1))
+    {
+        cb->tcpcb_ssthresh = ((fnet_uint32_t)cb->tcpcb_sndmss << 1);
+    }
+
+    cb->tcpcb_cwnd = cb->tcpcb_ssthresh;
+    cb->tcpcb_pcount = 0u;
+}
+
+/************************************************************************
+* NAME: fnet_tcp_newreno_rto
+*
+* DESCRIPTION: NewReno: the slow start threshold is halved, 
+*              and the slow start begins from one segment.
+*
+* RETURNS: None.
+*************************************************************************/
+static void fnet_tcp_newreno_rto( fnet_tcp_control_t *cb )
+{
+    fnet_tcp_newreno_loss(cb);
+
+    cb->tcpcb_cwnd = cb->tcpcb_sndmss;
+}
+
+/************************************************************************
+* NAME: fnet_tcp_newreno_idle
+*
+* DESCRIPTION: NewReno: the congestion window is restarted 
+*              from the initial window.
+*
+* RETURNS: None.
+*************************************************************************/
+static void fnet_tcp_newreno_idle( fnet_tcp_control_t *cb )
+{
+    if(cb->tcpcb_cwnd > cb->tcpcb_sndmss)
+    {
+        cb->tcpcb_cwnd = cb->tcpcb_sndmss;
+    }
+}
+
+#if FNET_CFG_TCP_CUBIC
+/************************************************************************
+* NAME: fnet_tcp_cubic_init
+*
+* DESCRIPTION: CUBIC: initialization of the algorithm.
+*
+* RETURNS: None.
+*************************************************************************/
+static void fnet_tcp_cubic_init( fnet_tcp_control_t *cb )
+{
+    cb->tcpcb_pcount = 0u;
+    cb->tcpcb_cubic_wmax = 0u;
+    cb->tcpcb_cubic_wstart = 0u;
+}
+
+/************************************************************************
+* NAME: fnet_tcp_cubic_ack
+*
+* DESCRIPTION: CUBIC: the congestion window grows by the acknowledged 
+*              data in the slow start mode. In the congestion avoidance 
+*              mode, it follows the cubic function of the time elapsed 
+*              since the last reduction W(t) = C*(t-K)^3 + Wmax, 
+*              but not slower than the standard TCP (RFC8312).
+*
+* RETURNS: None.
+*************************************************************************/
+static void fnet_tcp_cubic_ack( fnet_tcp_control_t *cb, fnet_size_t size )
+{
+    fnet_time_t     now;
+    fnet_time_t     rtt;
+    fnet_time_t     t;
+    fnet_uint32_t   delta;
+    fnet_uint32_t   target;
+    fnet_uint32_t   west;
+
+    if(cb->tcpcb_cwnd >= FNET_TCP_MAX_BUFFER)
+    {
+        return;
+    }
+
+    /* Slow start mode.*/
+    if(cb->tcpcb_cwnd < cb->tcpcb_ssthresh)
+    {
+        cb->tcpcb_cwnd += size;
+        return;
+    }
+
+    now = fnet_timer_ms();
+
+    /* Start of the congestion avoidance epoch.*/
+    if(cb->tcpcb_cubic_wstart == 0u)
+    {
+        cb->tcpcb_cubic_epoch = now;
+        cb->tcpcb_cubic_wstart = cb->tcpcb_cwnd;
+        cb->tcpcb_pcount = 0u;
+
+        if(cb->tcpcb_cwnd < cb->tcpcb_cubic_wmax)
+        {
+            /* K = cubic_root((Wmax - cwnd)/C), in 1/64 seconds.
+             * The difference is in 1/16 segments.*/
+            delta = ((cb->tcpcb_cubic_wmax - cb->tcpcb_cwnd) << 4) / cb->tcpcb_sndmss;
+            if(delta > FNET_TCP_CUBIC_DELTA_MAX)
+            {
+                delta = FNET_TCP_CUBIC_DELTA_MAX;
+            }
+
+            cb->tcpcb_cubic_k = fnet_tcp_cubic_cbrt(delta * (64u * 64u * 64u * 10u / 4u / 16u));
+            cb->tcpcb_cubic_origin = cb->tcpcb_cubic_wmax;
+        }
+        else
+        {
+            cb->tcpcb_cubic_k = 0u;
+            cb->tcpcb_cubic_origin = cb->tcpcb_cwnd;
+        }
+    }
+
+    rtt = ((fnet_uint32_t)cb->tcpcb_srtt >> FNET_TCP_RTT_SHIFT);
+    if(rtt == 0u)
+    {
+        rtt = FNET_TCP_RTT_DEFAULT;
+    }
+
+    /* Time of the next round trip since the epoch start, in 1/64 seconds.*/
+    t = (fnet_time_t)(now - cb->tcpcb_cubic_epoch);
+    if(t > FNET_TCP_CUBIC_TIME_MAX)
+    {
+        t = FNET_TCP_CUBIC_TIME_MAX;
+    }
+    t = ((t + rtt) << 6) / 1000u;
+
+    /* |t - K|, in 1/64 seconds.*/
+    delta = (t > cb->tcpcb_cubic_k) ? (t - cb->tcpcb_cubic_k) : (cb->tcpcb_cubic_k - t);
+    if(delta > FNET_TCP_CUBIC_T_MAX)
+    {
+        delta = FNET_TCP_CUBIC_T_MAX;
+    }
+
+    /* C*(t - K)^3, in 1/16 segments (C = 0.4).*/
+    delta = ((((delta * delta) >> 6) * delta) >> 8) * 2u / 5u;
+    /* In bytes.*/
+    delta = ((delta >> 4) * cb->tcpcb_sndmss) + (((delta & 0xFu) * cb->tcpcb_sndmss) >> 4);
+
+    if(t > cb->tcpcb_cubic_k)
+    {
+        target = cb->tcpcb_cubic_origin + delta;
+    }
+    else
+    {
+        target = (cb->tcpcb_cubic_origin > delta) ? (cb->tcpcb_cubic_origin - delta) : 0u;
+    }
+
+    /* TCP-friendly region, the window of the standard TCP: 
+     * W_est = Wmax*beta + 3*(1-beta)/(1+beta) * t/RTT.*/
+    t = (fnet_time_t)(now - cb->tcpcb_cubic_epoch);
+    if(t > FNET_TCP_CUBIC_TIME_MAX)
+    {
+        t = FNET_TCP_CUBIC_TIME_MAX;
+    }
+    west = cb->tcpcb_cubic_wstart + ((((t / 17u) * 9u) / rtt) * cb->tcpcb_sndmss);
+
+    if(west > target)
+    {
+        target = west;
+    }
+
+    /* The window can not grow more than 1.5 times per round trip time.*/
+    if(target > (cb->tcpcb_cwnd + (cb->tcpcb_cwnd >> 1)))
+    {
+        target = cb->tcpcb_cwnd + (cb->tcpcb_cwnd >> 1);
+    }
+
+    /* cwnd += (target - cwnd)/cwnd per acknowledged segment.*/
+    if(target > cb->tcpcb_cwnd)
+    {
+        cb->tcpcb_pcount += ((target - cb->tcpcb_cwnd) / (cb->tcpcb_cwnd / cb->tcpcb_sndmss)) * size;
+
+        cb->tcpcb_cwnd += cb->tcpcb_pcount / cb->tcpcb_sndmss;
+        cb->tcpcb_pcount %= cb->tcpcb_sndmss;
+    }
+}
+
+/************************************************************************
+* NAME: fnet_tcp_cubic_loss
+*
+* DESCRIPTION: CUBIC: the congestion window is reduced by the factor 
+*              beta = 0.7. If the window has not reached the previous 
+*              maximum, the maximum is reduced further (fast convergence).
+*
+* RETURNS: None.
+*************************************************************************/
+static void fnet_tcp_cubic_loss( fnet_tcp_control_t *cb )
+{
+    fnet_uint32_t   cwnd;
+
+    cwnd = (cb->tcpcb_cwnd > cb->tcpcb_sndwnd) ? cb->tcpcb_sndwnd : cb->tcpcb_cwnd;
+
+    /* Fast convergence, Wmax = cwnd*(1 + beta)/2.*/
+    if(cwnd < cb->tcpcb_cubic_wmax)
+    {
+        cb->tcpcb_cubic_wmax = cwnd - ((cwnd / 20u) * 3u);
+    }
+    else
+    {
+        cb->tcpcb_cubic_wmax = cwnd;
+    }
+
+    cb->tcpcb_ssthresh = cwnd - ((cwnd / 10u) * 3u);
+
+    if(cb->tcpcb_ssthresh < ((fnet_uint32_t)cb->tcpcb_sndmss << 1))
+    {
+        cb->tcpcb_ssthresh = ((fnet_uint32_t)cb->tcpcb_sndmss << 1);
+    }
+
+    cb->tcpcb_cwnd = cb->tcpcb_ssthresh;
+
+    /* Start the new epoch.*/
+    cb->tcpcb_cubic_wstart = 0u;
+}
+
+/************************************************************************
+* NAME: fnet_tcp_cubic_rto
+*
+* DESCRIPTION: CUBIC: the slow start threshold is reduced, 
+*              and the slow start begins from one segment.
+*
+* RETURNS: None.
+*************************************************************************/
+static void fnet_tcp_cubic_rto( fnet_tcp_control_t *cb )
+{
+    fnet_tcp_cubic_loss(cb);
+
+    cb->tcpcb_cwnd = cb->tcpcb_sndmss;
+}
+
+/************************************************************************
+* NAME: fnet_tcp_cubic_idle
+*
+* DESCRIPTION: CUBIC: the congestion window is restarted 
+*              from the initial window, the new epoch is started.
+*
+* RETURNS: None.
+*************************************************************************/
+static void fnet_tcp_cubic_idle( fnet_tcp_control_t *cb )
+{
+    fnet_tcp_newreno_idle(cb);
+
+    cb->tcpcb_cubic_wstart = 0u;
+}
+
+/************************************************************************
+* NAME: fnet_tcp_cubic_cbrt
+*
+* DESCRIPTION: This function calculates the integer cubic root.
+*
+* RETURNS: The cubic root of x, rounded down.
+*************************************************************************/
+static fnet_uint32_t fnet_tcp_cubic_cbrt( fnet_uint32_t x )
+{
+    fnet_uint32_t   root = 0u;
+    fnet_uint32_t   bit;
+    fnet_uint32_t   try_root;
+
+    /* The root of the 32-bit value is less than 2^11.*/
+    for(bit = (1u << 10); bit; bit >>= 1)
+    {
+        try_root = root | bit;
+
+        if((try_root <= 1625u) && ((try_root * try_root * try_root) <= x))
+        {
+            root = try_root;
+        }
+    }
+
+    return root;
+}
+#endif /* FNET_CFG_TCP_CUBIC */
+
+#if FNET_CFG_TCP_TIMESTAMPS
+/************************************************************************
+* NAME: fnet_tcp_settimestampopt
+*
+* DESCRIPTION: This function creates the timestamps option. 
+*              The timestamp value is the stack time in milliseconds, 
+*              with millisecond granularity if FNET_CFG_CPU_TIMER_FINE 
+*              is set, otherwise it advances by FNET_TIMER_PERIOD_MS steps.
+*              The "tsrecent" value is echoed.
+*
+* RETURNS: The option length.
+*************************************************************************/
+static fnet_uint8_t fnet_tcp_settimestampopt( fnet_uint32_t tsrecent, fnet_uint8_t *options )
+{
+    *((fnet_uint32_t *)options) = fnet_htonl(FNET_TCP_TIMESTAMP_HEADER);
+    *((fnet_uint32_t *)(options + 4u)) = fnet_htonl((fnet_uint32_t)fnet_timer_fine_ms());
+    *((fnet_uint32_t *)(options + 8u)) = fnet_htonl(tsrecent);
+
+    return FNET_TCP_TIMESTAMP_SIZE;
+}
+
+/************************************************************************
+* NAME: fnet_tcp_addtimestampopt
+*
+* DESCRIPTION: This function puts the timestamps option before 
+*              the options of the segment, if the timestamps are used.
+*              The options pointer is changed to the tsoptions buffer.
+*
+* RETURNS: The new length of the options.
+*************************************************************************/
+static fnet_uint8_t fnet_tcp_addtimestampopt( fnet_tcp_control_t *cb, fnet_uint32_t *tsoptions, void **options, fnet_uint8_t optlen )
+{
+    if(((cb->tcpcb_flags & FNET_TCP_CBF_TIMESTAMP) != 0u) && ((optlen + FNET_TCP_TIMESTAMP_SIZE) <= FNET_TCP_SIZE_OPTIONS))
+    {
+        if((*options) && (optlen))
+        {
+            fnet_memcpy((fnet_uint8_t *)tsoptions + FNET_TCP_TIMESTAMP_SIZE, *options, (fnet_size_t)optlen);
+        }
+
+        optlen += fnet_tcp_settimestampopt(cb->tcpcb_tsrecent, (fnet_uint8_t *)tsoptions);
+        *options = tsoptions;
+    }
+
+    return optlen;
+}
+
+/************************************************************************
+* NAME: fnet_tcp_paws
+*
+* DESCRIPTION: This function checks the timestamp of the input segment 
+*              (Protection Against Wrapped Sequences, RFC7323). 
+*              The segment with the timestamp older than the last 
+*              timestamp of another side is an old duplicate.
+*
+* RETURNS: FNET_FALSE if the segment must be dropped. Otherwise
+*          this function returns FNET_TRUE.
+*************************************************************************/
+static fnet_bool_t fnet_tcp_paws( fnet_tcp_control_t *cb, fnet_uint8_t sgmtype )
+{
+    fnet_bool_t result = FNET_TRUE;
+
+    if(((cb->tcpcb_flags & FNET_TCP_CBF_TIMESTAMP_RCVD) != 0u) && ((sgmtype & FNET_TCP_SGT_RST) == 0u)
+        && ((fnet_int32_t)(cb->tcpcb_tsval - cb->tcpcb_tsrecent) < 0))
+    {
+        if((fnet_time_t)(fnet_timer_ms() - cb->tcpcb_tsrecent_age) > FNET_TCP_PAWS_IDLE)
+        {
+            /* The saved timestamp is too old to be compared, invalidate it.*/
+            cb->tcpcb_tsrecent = cb->tcpcb_tsval;
+            cb->tcpcb_tsrecent_age = fnet_timer_ms();
+        }
+        else
+        {
+            result = FNET_FALSE;
+        }
+    }
+
+    return result;
+}
+#endif /* FNET_CFG_TCP_TIMESTAMPS */
+
+#if FNET_CFG_TCP_SACK
+/************************************************************************
+* NAME: fnet_tcp_setsackopt
+*
+* DESCRIPTION: This function creates the SACK option, reporting
+*              the out-of-order data of the reassembly queue.
+*              The first block contains the most recently received data,
+*              as RFC2018 requires.
+*
+* RETURNS: The option length, or 0 if the option is not needed.
+*************************************************************************/
+static fnet_uint8_t fnet_tcp_setsackopt( fnet_socket_if_t *sk, fnet_uint32_t *options )
+{
+    fnet_uint8_t            optionlen = 0u;
+#if !FNET_CFG_TCP_DISCARD_OUT_OF_ORDER
+    fnet_tcp_control_t      *cb = (fnet_tcp_control_t *)sk->protocol_control;
+    fnet_tcp_reass_block_t  *block = cb->tcpcb_reass.block;
+    fnet_index_t            first = 0u;
+    fnet_index_t            num = 1u;
+    fnet_index_t            num_max = FNET_TCP_SACK_BLOCKS_MAX;
+    fnet_index_t            i;
+
+    if(((cb->tcpcb_flags & FNET_TCP_CBF_SACK) != 0u) && (cb->tcpcb_reass.block_num))
+    {
+    #if FNET_CFG_TCP_TIMESTAMPS
+        /* The timestamps option takes the room of one block.*/
+        if((cb->tcpcb_flags & FNET_TCP_CBF_TIMESTAMP) != 0u)
+        {
+            num_max = FNET_TCP_SACK_BLOCKS_MAX_TIMESTAMP;
+        }
+    #endif
+
+        /* Find the block of the most recently received data.*/
+        for(i = 0u; i < cb->tcpcb_reass.block_num; i++)
+        {
+            if(fnet_tcp_hit(block[i].seq, block[i].seq + block[i].length - 1u, cb->tcpcb_reass.last_seq))
+            {
+                first = i;
+                break;
+            }
+        }
+
+        options[1] = fnet_htonl(block[first].seq);
+        options[2] = fnet_htonl(block[first].seq + block[first].length);
+
+        /* The other blocks follow in the sequence order.*/
+        for(i = 0u; (i < cb->tcpcb_reass.block_num) && (num < num_max); i++)
+        {
+            if(i != first)
+            {
+                options[(num << 1) + 1u] = fnet_htonl(block[i].seq);
+                options[(num << 1) + 2u] = fnet_htonl(block[i].seq + block[i].length);
+                num++;
+            }
+        }
+
+        optionlen = (fnet_uint8_t)(2u + (num * FNET_TCP_SACK_BLOCK_SIZE));
+        options[0] = fnet_htonl(FNET_TCP_SACK_HEADER | optionlen);
+        optionlen += 2u; /* NOPs.*/
+    }
+#else
+    FNET_COMP_UNUSED_ARG(sk);
+    FNET_COMP_UNUSED_ARG(options);
+#endif /* !FNET_CFG_TCP_DISCARD_OUT_OF_ORDER */
+
+    return optionlen;
+}
+
+/************************************************************************
+* NAME: fnet_tcp_sack_add
+*
+* DESCRIPTION: This function adds the received SACK block to 
+*              the scoreboard. Overlapping and adjacent blocks are merged.
+*              If the scoreboard is full, the block with the highest
+*              sequence number is lost.
+*
+* RETURNS: None.
+*************************************************************************/
+static void fnet_tcp_sack_add( fnet_tcp_control_t *cb, fnet_uint32_t left, fnet_uint32_t right )
+{
+    fnet_tcp_sack_block_t   *block = cb->tcpcb_sackblock;
+    fnet_index_t            first;
+    fnet_index_t            last;
+    fnet_index_t            i;
+
+    /* Ignore the invalid and the acknowledged blocks.*/
+    if((!FNET_TCP_COMP_G(right, left)) || (!FNET_TCP_COMP_G(right, cb->tcpcb_rcvack))
+        || (FNET_TCP_COMP_G(right, cb->tcpcb_maxrcvack)))
+    {
+        return;
+    }
+
+    if(FNET_TCP_COMP_G(cb->tcpcb_rcvack, left))
+    {
+        left = cb->tcpcb_rcvack;
+    }
+
+    /* Blocks [first, last) overlap the new block or are adjacent to it.*/
+    first = 0u;
+    while((first < cb->tcpcb_sackblock_num) && (FNET_TCP_COMP_G(left, block[first].right)))
+    {
+        first++;
+    }
+
+    last = first;
+    while((last < cb->tcpcb_sackblock_num) && (FNET_TCP_COMP_GE(right, block[last].left)))
+    {
+        if(FNET_TCP_COMP_G(left, block[last].left))
+        {
+            left = block[last].left;
+        }
+
+        if(FNET_TCP_COMP_G(block[last].right, right))
+        {
+            right = block[last].right;
+        }
+
+        last++;
+    }
+
+    if(first == last)
+    {
+        if(first == FNET_TCP_SACK_SCOREBOARD)
+        {
+            return;
+        }
+
+        if(cb->tcpcb_sackblock_num == FNET_TCP_SACK_SCOREBOARD)
+        {
+            cb->tcpcb_sackblock_num--;
+        }
+
+        for(i = cb->tcpcb_sackblock_num; i > first; i--)
+        {
+            block[i] = block[i - 1u];
+        }
+
+        cb->tcpcb_sackblock_num++;
+    }
+    else
+    {
+        /* Leave one block instead of [first, last).*/
+        for(i = last; i < cb->tcpcb_sackblock_num; i++)
+        {
+            block[i - (last - first) + 1u] = block[i];
+        }
+
+        cb->tcpcb_sackblock_num -= (last - first) - 1u;
+    }
+
+    block[first].left = left;
+    block[first].right = right;
+}
+
+/************************************************************************
+* NAME: fnet_tcp_sack_ack
+*
+* DESCRIPTION: This function deletes the cumulatively acknowledged data
+*              from the scoreboard.
+*
+* RETURNS: None.
+*************************************************************************/
+static void fnet_tcp_sack_ack( fnet_tcp_control_t *cb )
+{
+    fnet_index_t    first = 0u;
+    fnet_index_t    i;
+
+    while((first < cb->tcpcb_sackblock_num) && (FNET_TCP_COMP_GE(cb->tcpcb_rcvack, cb->tcpcb_sackblock[first].right)))
+    {
+        first++;
+    }
+
+    if(first)
+    {
+        for(i = first; i < cb->tcpcb_sackblock_num; i++)
+        {
+            cb->tcpcb_sackblock[i - first] = cb->tcpcb_sackblock[i];
+        }
+
+        cb->tcpcb_sackblock_num -= first;
+    }
+
+    if((cb->tcpcb_sackblock_num) && (FNET_TCP_COMP_G(cb->tcpcb_rcvack, cb->tcpcb_sackblock[0].left)))
+    {
+        cb->tcpcb_sackblock[0].left = cb->tcpcb_rcvack;
+    }
+}
+
+/************************************************************************
+* NAME: fnet_tcp_sack_count
+*
+* DESCRIPTION: This function calculates the size of 
+*              the selectively acknowledged data.
+*
+* RETURNS: The number of bytes in the scoreboard.
+*************************************************************************/
+static fnet_size_t fnet_tcp_sack_count( fnet_tcp_control_t *cb )
+{
+    fnet_size_t     count = 0u;
+    fnet_index_t    i;
+
+    for(i = 0u; i < cb->tcpcb_sackblock_num; i++)
+    {
+        count += fnet_tcp_getsize(cb->tcpcb_sackblock[i].left, cb->tcpcb_sackblock[i].right);
+    }
+
+    return count;
+}
+
+/************************************************************************
+* NAME: fnet_tcp_sack_retransmit
+*
+* DESCRIPTION: This function retransmits one segment from the first
+*              hole of the scoreboard that is not retransmitted yet.
+*              Only the holes below a SACK block are considered lost.
+*
+* RETURNS: TRUE if the segment is retransmitted. Otherwise
+*          this function returns FALSE.
+*************************************************************************/
+static fnet_bool_t fnet_tcp_sack_retransmit( fnet_socket_if_t *sk )
+{
+    fnet_tcp_control_t  *cb = (fnet_tcp_control_t *)sk->protocol_control;
+    fnet_uint32_t       seq;
+    fnet_uint32_t       sndseq;
+    fnet_size_t         size;
+    fnet_index_t        i;
+
+    seq = cb->tcpcb_rcvack;
+    if(FNET_TCP_COMP_G(cb->tcpcb_sackrxt, seq))
+    {
+        seq = cb->tcpcb_sackrxt;
+    }
+
+    for(i = 0u; i < cb->tcpcb_sackblock_num; i++)
+    {
+        if(FNET_TCP_COMP_G(cb->tcpcb_sackblock[i].right, seq))
+        {
+            if(FNET_TCP_COMP_G(cb->tcpcb_sackblock[i].left, seq))
+            {
+                size = fnet_tcp_getsize(seq, cb->tcpcb_sackblock[i].left);
+                if(size > cb->tcpcb_sndmss)
+                {
+                    size = cb->tcpcb_sndmss;
+                }
+
+                /* Retransmit the segment.*/
+                sndseq = cb->tcpcb_sndseq;
+                cb->tcpcb_sndseq = seq;
+                fnet_tcp_senddataseg(sk, 0, 0u, size);
+                cb->tcpcb_sndseq = sndseq;
+
+                cb->tcpcb_sackrxt = seq + size;
+
+                /* Round trip time can't be measured in this case.*/
+                cb->tcpcb_timers.round_trip = FNET_TCP_TIMER_OFF;
+                cb->tcpcb_timing_state = TCP_TS_SEGMENT_LOST;
+
+                return FNET_TRUE;
+            }
+
+            seq = cb->tcpcb_sackblock[i].right;
+        }
+    }
+
+    return FNET_FALSE;
+}
+#endif /* FNET_CFG_TCP_SACK */
+
+/************************************************************************
+* NAME: fnet_tcp_findsk
+*
+* DESCRIPTION: This function finds the socket with parameters that allow
+*              to receive and process the segment. 
+*              The connection with the same 4-tuple (including partial
+*              and incoming connections) is looked up first. Otherwise,
+*              the listening socket bound to the destination address
+*              is preferred to the listening socket bound to any address.
+*
+* RETURNS: If the socket is found this function returns the pointer to the
+*          socket. Otherwise, this function returns 0.
+*************************************************************************/
+static fnet_socket_if_t *fnet_tcp_findsk( struct sockaddr *src_addr,  struct sockaddr *dest_addr )                                       
+{
+    fnet_socket_if_t   *listensk = 0;
+    fnet_socket_if_t   *sk;
+
+    fnet_isr_lock();
+    
+    /* Search the connection with the same local and foreign parameters (address and port).*/
+    sk = fnet_tcp_hash[fnet_tcp_hash_key(dest_addr->sa_port, src_addr)];
+
+    while(sk)
+    {
+        if((sk->local_addr.sa_port == dest_addr->sa_port) && (sk->foreign_addr.sa_port == src_addr->sa_port) 
+           && ((sk->state != SS_UNCONNECTED) || (sk->head_con))
+           && (fnet_socket_addr_are_equal(&sk->foreign_addr, src_addr)) && (fnet_socket_addr_are_equal(&sk->local_addr, dest_addr)))
+        {
+            break;
+        }
+
+        sk = sk->hash_next;
+    }
+
+    if(!sk)
+    {
+        /* Search the listening socket with the same local port.*/
+        sk = fnet_tcp_listen_hash[fnet_tcp_hash_key(dest_addr->sa_port, 0)];
+
+        while(sk)
+        {
+            if((sk->local_addr.sa_port == dest_addr->sa_port) && (sk->state == SS_LISTENING))
+            {
+                if(fnet_socket_addr_are_equal(&sk->local_addr, dest_addr))
+                {
+                    break; /* Exact match.*/
                 }
 
-                sk = sk->next;
+                if((!listensk) && (fnet_socket_addr_is_unspecified(&sk->local_addr)))
+                {
+                    listensk = sk; /* Wildcard match.*/
+                }
             }
+
+            sk = sk->hash_next;
         }
 
-        /* Listening socket is unique (with the same local parameters).*/
         if(!sk)
         {
             sk = listensk;
@@ -4096,6 +6712,178 @@ static fnet_socket_if_t *fnet_tcp_findsk( struct sockaddr *src_addr,  struct soc
     return sk;
 }
 
+/************************************************************************
+* NAME: fnet_tcp_hash_key
+*
+* DESCRIPTION: This function calculates the lookup-table bucket index.
+*              Listening sockets are hashed by the local port only 
+*              (foreign_addr is 0).
+*
+* RETURNS: Bucket index.
+*************************************************************************/
+static fnet_index_t fnet_tcp_hash_key( fnet_uint16_t local_port, const struct sockaddr *foreign_addr )
+{
+    fnet_uint32_t   key = local_port;
+    fnet_size_t     addr_size;
+    fnet_index_t    i;
+
+    if(foreign_addr)
+    {
+        key ^= ((fnet_uint32_t)foreign_addr->sa_port << 16);
+
+        addr_size = (foreign_addr->sa_family == AF_INET6) ? sizeof(fnet_ip6_addr_t) : sizeof(fnet_ip4_addr_t);
+
+        for(i = 0u; i < addr_size; i++)
+        {
+            key = (key * 31u) + foreign_addr->sa_data[i];
+        }
+    }
+
+    key ^= (key >> 16);
+    key ^= (key >> 8);
+
+    return (fnet_index_t)(key & (FNET_CFG_TCP_HASH_SIZE - 1u));
+}
+
+/************************************************************************
+* NAME: fnet_tcp_hash_add
+*
+* DESCRIPTION: This function adds the socket to the lookup table,
+*              according to its current state and addresses.
+*
+* RETURNS: None.
+*************************************************************************/
+static void fnet_tcp_hash_add( fnet_socket_if_t *sk )
+{
+    fnet_socket_if_t    **bucket;
+
+    fnet_isr_lock();
+
+    if(sk->state == SS_LISTENING)
+    {
+        bucket = &fnet_tcp_listen_hash[fnet_tcp_hash_key(sk->local_addr.sa_port, 0)];
+    }
+    else
+    {
+        bucket = &fnet_tcp_hash[fnet_tcp_hash_key(sk->local_addr.sa_port, &sk->foreign_addr)];
+    }
+
+    sk->hash_next = *bucket;
+    *bucket = sk;
+
+    fnet_isr_unlock();
+}
+
+/************************************************************************
+* NAME: fnet_tcp_hash_del
+*
+* DESCRIPTION: This function deletes the socket from the lookup tables.
+*              It must be called before the foreign address of 
+*              a hashed socket is changed.
+*              It does nothing if the socket is not hashed.
+*
+* RETURNS: None.
+*************************************************************************/
+static void fnet_tcp_hash_del( fnet_socket_if_t *sk )
+{
+    fnet_socket_if_t    **bucket;
+
+    fnet_isr_lock();
+
+    bucket = &fnet_tcp_hash[fnet_tcp_hash_key(sk->local_addr.sa_port, &sk->foreign_addr)];
+
+    while((*bucket) && ((*bucket) != sk))
+    {
+        bucket = &(*bucket)->hash_next;
+    }
+
+    if(!(*bucket))
+    {
+        bucket = &fnet_tcp_listen_hash[fnet_tcp_hash_key(sk->local_addr.sa_port, 0)];
+
+        while((*bucket) && ((*bucket) != sk))
+        {
+            bucket = &(*bucket)->hash_next;
+        }
+    }
+
+    if(*bucket)
+    {
+        *bucket = sk->hash_next;
+    }
+
+    sk->hash_next = 0;
+
+    fnet_isr_unlock();
+}
+
+/***********************************************************************
+* NAME: fnet_tcp_newpartialsk
+*
+* DESCRIPTION: This function creates the socket of the connection, 
+*              requested by the SYN segment to the listening socket, 
+*              and adds it to the partial sockets list.
+*              "isn" is the initial sequence number of the connection,
+*              "foreign_isn" is the initial sequence number of another side.
+*
+* RETURNS: If no error occurs, this function returns the pointer 
+*          to the new socket in the SYN_RCVD state. Otherwise it returns 0.
+*************************************************************************/
+static fnet_socket_if_t *fnet_tcp_newpartialsk( fnet_socket_if_t *mainsk, struct sockaddr *local_addr, fnet_uint32_t isn, fnet_uint32_t foreign_isn )
+{
+    fnet_socket_if_t    *psk;
+    fnet_tcp_control_t  *pcb;
+
+    /* Create the socket.*/
+    psk = fnet_socket_copy(mainsk);
+
+    fnet_memset_zero(&mainsk->foreign_addr, sizeof(mainsk->foreign_addr));         
+
+    /* Check the memory allocation.*/
+    if(!psk)
+    {
+        return 0;
+    }
+
+    /* Set the local address.*/
+    fnet_memcpy(&psk->local_addr, local_addr, sizeof(psk->local_addr));
+
+    /* Create the control block.*/
+    pcb = (fnet_tcp_control_t *)fnet_malloc_zero(sizeof(fnet_tcp_control_t));
+
+    /* Check the memory allocation.*/
+    if(!pcb)
+    {
+        fnet_free(psk);
+        return 0;
+    }
+
+    /* Initialize the pointer.*/
+    psk->protocol_control = (void *)pcb;
+    fnet_tcp_initconnection(psk);
+
+    /* Add the new socket to the partial list.*/
+    fnet_tcp_addpartialsk(mainsk, psk);
+    fnet_tcp_hash_add(psk);
+
+    /* Initialize the parameters of the control block.*/
+    pcb->tcpcb_sndack = foreign_isn + 1u;
+    pcb->tcpcb_sndseq = isn;
+    pcb->tcpcb_maxrcvack = isn + 1u;
+
+#if FNET_CFG_TCP_URGENT  
+    pcb->tcpcb_sndurgseq = isn;        
+    pcb->tcpcb_rcvurgseq = foreign_isn;
+#endif /* FNET_CFG_TCP_URGENT */
+
+    /* Change the states.*/
+    psk->state = SS_CONNECTING;
+    pcb->tcpcb_prev_connection_state = FNET_TCP_CS_LISTENING;
+    pcb->tcpcb_connection_state = FNET_TCP_CS_SYN_RCVD;
+
+    return psk;
+}
+
 /***********************************************************************
 * NAME: fnet_tcp_addpartialsk
 *
@@ -4128,6 +6916,8 @@ static void fnet_tcp_movesk2incominglist( fnet_socket_if_t *sk )
 
     fnet_socket_list_del(&mainsk->partial_con, sk);
     fnet_socket_list_add(&mainsk->incoming_con, sk);
+
+    fnet_socket_poll_update(mainsk);
 }
 
 /***********************************************************************
@@ -4171,8 +6961,10 @@ static void fnet_tcp_closesk( fnet_socket_if_t *sk )
             fnet_tcp_deletetmpbuf(cb);
 #endif            
             fnet_socket_buffer_release(&sk->send_buffer);
+            fnet_tcp_hash_del(sk);
             sk->state = SS_UNCONNECTED;
             fnet_memset_zero(&sk->foreign_addr, sizeof(sk->foreign_addr));
+            fnet_socket_poll_update(sk);
         }
     }
 }
@@ -4199,8 +6991,11 @@ static void fnet_tcp_delpartialsk( fnet_socket_if_t *sk )
 *************************************************************************/
 static void fnet_tcp_delincomingsk( fnet_socket_if_t *sk )
 {
-    sk->head_con->incoming_con_len--;
-    fnet_tcp_delsk(&sk->head_con->incoming_con, sk);
+    fnet_socket_if_t *mainsk = sk->head_con;
+
+    mainsk->incoming_con_len--;
+    fnet_tcp_delsk(&mainsk->incoming_con, sk);
+    fnet_socket_poll_update(mainsk);
 }
 
 /***********************************************************************
@@ -4231,20 +7026,8 @@ static void fnet_tcp_delcb( fnet_tcp_control_t *cb )
 #if !FNET_CFG_TCP_DISCARD_OUT_OF_ORDER
 static void fnet_tcp_deletetmpbuf( fnet_tcp_control_t *cb )
 {
-    fnet_netbuf_t *buf, *delbuf;
-
-    buf = cb->tcpcb_rcvchain;
-
-
-    while(buf)
-    {
-        delbuf = buf;
-        buf = buf->next_chain;
-        fnet_netbuf_free_chain(delbuf);
-    }
-
-    cb->tcpcb_count = 0u;
-    cb->tcpcb_rcvchain = 0;
+    fnet_tcp_reass_free(&cb->tcpcb_reass);
+    cb->tcpcb_rcvfin = FNET_FALSE;
 }
 #endif
 
@@ -4257,6 +7040,7 @@ static void fnet_tcp_deletetmpbuf( fnet_tcp_control_t *cb )
 *************************************************************************/
 static void fnet_tcp_delsk( fnet_socket_if_t ** head, fnet_socket_if_t *sk )
 {
+    fnet_tcp_hash_del(sk);
     fnet_tcp_delcb((fnet_tcp_control_t *)sk->protocol_control);
     fnet_socket_release(head, sk);
 }
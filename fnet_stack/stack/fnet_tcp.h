@@ -43,6 +43,9 @@
 
 #define FNET_TCP_MSS_HEADER         (0x02040000u) /* MSS option*/ 
 #define FNET_TCP_WINDOW_HEADER      (0x30300u)    /* Window scale option*/
+#define FNET_TCP_SACK_PERMITTED_HEADER (0x01010402u) /* SACK-permitted option, preceded by two NOPs.*/
+#define FNET_TCP_SACK_HEADER        (0x01010500u) /* SACK option, preceded by two NOPs (the length is added).*/
+#define FNET_TCP_TIMESTAMP_HEADER   (0x0101080Au) /* Timestamps option, preceded by two NOPs.*/
 
 /************************************************************************
 *    Protocol structure
@@ -63,12 +66,25 @@ extern struct fnet_prot_if fnet_tcp_prot_if;
 *    Control values for timers
 *************************************************************************/
 #define FNET_TCP_TIMER_OFF          ((fnet_time_t)(-1))    /* Switch off value.*/
-#define FNET_TCP_TIMER_ON_INCREMENT (0u)     /* Switch on value for increment timers.*/
 
 /************************************************************************
 *    Step of Initial sequence number (ISN)
 *************************************************************************/
 #define FNET_TCP_STEPISN            (64000u)
+#define FNET_TCP_STEPISN_PERIOD     ((FNET_TCP_STEPISN * FNET_TCP_TIMER_PERIOD) / 500u) /* Step per timer period (64000 per 500 ms).*/
+
+/************************************************************************
+*    SYN cookie layout
+*    (5 bits of the counter, 3 bits of the MSS index, 24 bits of the hash)
+*************************************************************************/
+#define FNET_TCP_COOKIE_PERIOD_SHIFT    (6u)            /* The counter is changed every 64 sec.*/
+#define FNET_TCP_COOKIE_COUNT_SHIFT     (27u)
+#define FNET_TCP_COOKIE_COUNT_MASK      (0x1Fu)
+#define FNET_TCP_COOKIE_MSS_SHIFT       (24u)
+#define FNET_TCP_COOKIE_MSS_MASK        (0x7u)
+#define FNET_TCP_COOKIE_HASH_MASK       (0x00FFFFFFu)
+#define FNET_TCP_COOKIE_REKEY_PERIOD    (256u)          /* The secret key is changed every 256 sec (four counter periods).*/
+#define FNET_TCP_COOKIE_ROTL(x, b)      (((x) << (b)) | ((x) >> (32u - (b))))
 
 /************************************************************************
 *    Defaults values
@@ -80,31 +96,36 @@ extern struct fnet_prot_if fnet_tcp_prot_if;
 /************************************************************************
 *    Periods of timers
 *************************************************************************/
-#define FNET_TCP_SLOWTIMO       (500u)       /* Slow timer period (ms).*/
-#define FNET_TCP_FASTTIMO       (200u)       /* Fast timer period (ms).*/
+#define FNET_TCP_TIMER_PERIOD   (FNET_TIMER_PERIOD_MS) /* Period of checking the timers of connections (ms).
+                                                * The timers keep deadlines in milliseconds (fnet_timer_fine_ms()).
+                                                * The connections are scanned only if the earliest deadline 
+                                                * is expired. It is checked on every input segment too.*/
+#define FNET_TCP_TIMEOUT_MAX    (0x7FFFFFFFu)   /* Maximal timeout (ms). The deadlines are compared by the signed difference.*/
+#define FNET_TCP_DELACK_TIMEOUT (100u)          /* Delayed acknowledgment timeout (ms).*/
+#define FNET_TCP_RTT_DEFAULT    (500u)          /* Round trip time, assumed before it is measured (ms).*/
+#define FNET_TCP_TLP_DELACK     (200u)          /* Delayed acknowledgment timeout of another side, 
+                                                 * added to the probe timeout of a single segment (ms).*/
 
 /************************************************************************
 *    Keepalive timer parameters                                          
 *************************************************************************/
-#define FNET_TCP_KEEPIDLE_DEFAULT   (14400u) /* x FNET_TCP_SLOWTIMO  
-                                             * Standart value for keepalive timer (2 hours).
+#define FNET_TCP_KEEPIDLE_DEFAULT   (7200000u) /* Standart value for keepalive timer (2 hours, in ms).
                                              */
-#define FNET_TCP_KEEPINTVL_DEFAULT  (150u)   /* x FNET_TCP_SLOWTIMO  
-                                             * Standart value for retransmission of the keepalive segment (75 sec).
+#define FNET_TCP_KEEPINTVL_DEFAULT  (75000u)   /* Standart value for retransmission of the keepalive segment (75 sec, in ms).
                                              */
 #define FNET_TCP_KEEPCNT_DEFAULT    (8u)     /* Number of keepalive segments in state of retransmission.
                                              */
 
 
 /************************************************************************
-*    Initial value for the retransmission and persist timers (6 sec)     
+*    Initial value for the retransmission timeout (1 sec, RFC6298)     
 *************************************************************************/
-#define FNET_TCP_TIMERS_INIT    (12u)
+#define FNET_TCP_TIMERS_INIT    (1000u)
 
 /************************************************************************
-*    Limit of timers (60 sec)                                            
+*    Limit of the persist timer (60 sec)                                            
 *************************************************************************/
-#define FNET_TCP_TIMERS_LIMIT   (120u)
+#define FNET_TCP_TIMERS_LIMIT   (60000u)
 
 /************************************************************************
 *    Shifts of the retransmission variables                              
@@ -115,12 +136,12 @@ extern struct fnet_prot_if fnet_tcp_prot_if;
 /************************************************************************
 *    Maximal size of synchronized options
 *************************************************************************/
-#define FNET_TCP_MAX_OPT_SIZE       (8u)
+#define FNET_TCP_MAX_OPT_SIZE       (24u)
 
 /************************************************************************
 *    Maximal window size 
 *************************************************************************/
-#define FNET_TCP_MAXWIN             (4u*1024u)/*(0xffff)*/
+#define FNET_TCP_MAXWIN             (0xffffu) /* Maximal window without the window scale option.*/
 
 /************************************************************************
 *    Maximal value of the sequence number
@@ -145,22 +166,36 @@ extern struct fnet_prot_if fnet_tcp_prot_if;
 /************************************************************************
 *    Abort interval for the data retransmission and the connection termination
 *************************************************************************/
-#define FNET_TCP_ABORT_INTERVAL     (240u/5u) /* 240 x FNET_TCP_SLOWTIMO = 2 minutes/5 */
+#define FNET_TCP_ABORT_INTERVAL     (120000u/5u) /* 2 minutes/5 (ms) */
 
 /************************************************************************
 *    Abort interval for the connection establishment                      
 *************************************************************************/
-#define FNET_TCP_ABORT_INTERVAL_CON (150u/5u) /* 150 x FNET_TCP_SLOWTIMO = 75 sec/5 */
+#define FNET_TCP_ABORT_INTERVAL_CON (75000u/5u) /* 75 sec/5 (ms) */
 
 /************************************************************************
 *    Number of repeated acknowledgments for the fast retransmission
 *************************************************************************/
 #define FNET_TCP_NUMBER_FOR_FAST_RET    (3u)
 
+/************************************************************************
+*    CUBIC limits (to avoid 32-bit overflows).
+*************************************************************************/
+#define FNET_TCP_CUBIC_DELTA_MAX    (104857u)   /* Maximal difference between Wmax and cwnd (1/16 segments).*/
+#define FNET_TCP_CUBIC_T_MAX        (4000u)     /* Maximal distance from the origin point (1/64 sec).*/
+#define FNET_TCP_CUBIC_TIME_MAX     (60000u)    /* Maximal duration of the epoch, taken into account (ms).*/
+
 /************************************************************************
 *    Timewait delay                                       
 *************************************************************************/
-#define FNET_TCP_TIME_WAIT              (240u/5u) /* 240 x FNET_TCP_SLOWTIMO  = 2 minutes/5 */
+#define FNET_TCP_TIME_WAIT              (120000u/5u) /* 2 minutes/5 (ms) */
+
+/************************************************************************
+*    Timestamps parameters (RFC7323)                                       
+*************************************************************************/
+#define FNET_TCP_PAWS_IDLE              (24u*24u*60u*60u*1000u) /* Timestamp of another side becomes 
+                                                                 * invalid after 24 days of idle (ms).*/
+#define FNET_TCP_TIMESTAMP_RTT_MAX      (FNET_TCP_TIMERS_LIMIT) /* Maximal valid round trip time sample (ms).*/
 
 
 /************************************************************************
@@ -211,9 +246,22 @@ extern struct fnet_prot_if fnet_tcp_prot_if;
 #define FNET_TCP_OTYPES_NOP         (1u) /* No Option.*/
 #define FNET_TCP_OTYPES_MSS         (2u) /* Maximal segment size.*/
 #define FNET_TCP_OTYPES_WINDOW      (3u) /* Scale window.*/
+#define FNET_TCP_OTYPES_SACK_PERMITTED (4u) /* SACK permitted.*/
+#define FNET_TCP_OTYPES_SACK        (5u) /* SACK.*/
+#define FNET_TCP_OTYPES_TIMESTAMP   (8u) /* Timestamps.*/
 
 #define FNET_TCP_MSS_SIZE           (4u) /* MSS option size.*/
 #define FNET_TCP_WINDOW_SIZE        (3u) /* Window scale option size.*/
+#define FNET_TCP_SACK_PERMITTED_SIZE (4u) /* SACK-permitted option size (with two NOPs).*/
+#define FNET_TCP_SACK_BLOCK_SIZE    (8u) /* Size of a SACK block.*/
+#define FNET_TCP_TIMESTAMP_SIZE     (12u) /* Timestamps option size (with two NOPs).*/
+
+/************************************************************************
+*    SACK parameters
+*************************************************************************/
+#define FNET_TCP_SACK_BLOCKS_MAX    (4u) /* Maximal number of SACK blocks in a sent segment.*/
+#define FNET_TCP_SACK_BLOCKS_MAX_TIMESTAMP (3u) /* Maximal number of SACK blocks sent together with timestamps.*/
+#define FNET_TCP_SACK_SCOREBOARD    (8u) /* Maximal number of SACK blocks kept by the sender.*/
 
 /**************************************************************************/ /*!
  * @internal
@@ -226,6 +274,8 @@ typedef struct
     fnet_uint32_t   keep_idle;      /* TCP_KEEPIDLE option. */
     fnet_uint32_t   keep_intvl;     /* TCP_KEEPINTVL option. */
     fnet_uint32_t   keep_cnt;       /* TCP_KEEPCNT option. */
+    fnet_uint32_t   rto_min;        /* TCP_RTO_MIN option (ms). */
+    fnet_uint32_t   rto_max;        /* TCP_RTO_MAX option (ms). */
     fnet_bool_t     tcp_nodelay;    /*  If this option is set to FNET_TRUE, the Nagle algorithm 
                                     *   is disabled (and vice versa). @n
                                     *   The Nagle algorithm is effective in reducing the number 
@@ -235,6 +285,7 @@ typedef struct
                                     *   But for some applications this algorithm can impede 
                                     *   performance, especially for a bulky data transfer.
                                     */ 
+    fnet_bool_t     tcp_cork;       /* TCP_CORK option. */
 #if FNET_CFG_TCP_URGENT 
                     fnet_bool_t tcp_bsd;    /*  If this option is set to FNET_TRUE, the BSD interpretation of 
                                     *   the urgent pointer is used. In this case the 
@@ -249,6 +300,10 @@ typedef struct
                                     *   This option is avalable only if FNET_CFG_TCP_URGENT is set to 1.
                                     */
 #endif
+#if FNET_CFG_TCP_RCVBUF_AUTO
+    fnet_bool_t     rcvbuf_auto;    /* TCP_RCVBUF_AUTO option. */
+#endif
+    fnet_tcp_congestion_t congestion; /* TCP_CONGESTION option. */
 
 } fnet_tcp_sockopt_t;
 
@@ -294,6 +349,7 @@ FNET_COMP_PACKED_END
 #define FNET_TCP_AP_SEND_IMMEDIATELLY   (2u) /* Ackonwledgment must be sent immediatelly.*/
 #define FNET_TCP_AP_SEND_WITH_DELAY     (4u) /* Ackonwledgment can be sent with delay.*/
 #define FNET_TCP_AP_FIN_ACK             (8u) /* Acknowledgment of the final segment.*/
+#define FNET_TCP_AP_WND_UPDATE          (16u) /* The segment changes the send window (it is not a duplicate acknowledgment).*/
 
 /************************************************************************
 *    Flags of control block
@@ -306,6 +362,12 @@ FNET_COMP_PACKED_END
 #define FNET_TCP_CBF_RCVD_SCALE     (0x20u)  /* Another side uses the scale option.*/
 #define FNET_TCP_CBF_SEND_TIMEOUT   (0x40u)  /* Silly window avoidance flag.*/
 #define FNET_TCP_CBF_INSND          (0x80u)  /* The fnet_tcp_snd function is executed now.*/
+#define FNET_TCP_CBF_SACK           (0x100u) /* Another side permits the SACK option.*/
+#define FNET_TCP_CBF_RECOVERY       (0x200u) /* Fast recovery is in progress.*/
+#define FNET_TCP_CBF_TIMESTAMP      (0x400u) /* Timestamps option is used by both sides.*/
+#define FNET_TCP_CBF_TIMESTAMP_RCVD (0x800u) /* Input segment contains the timestamps option.*/
+#define FNET_TCP_CBF_TLP            (0x1000u) /* Tail loss probe is sent.*/
+#define FNET_TCP_CBF_MORE           (0x2000u) /* More data follows (MSG_MORE), partial segments are held.*/
 
 /************************************************************************
 *    Standart states for TCP ( described in RFC793)
@@ -338,6 +400,8 @@ typedef enum
 
 /************************************************************************
 *    TCP timers structure
+*    The timers keep the expiration time (fnet_timer_fine_ms()),
+*    or FNET_TCP_TIMER_OFF.
 *************************************************************************/
 typedef struct
 {
@@ -350,21 +414,101 @@ typedef struct
     fnet_time_t persist;            /* Persist timer. 
                                     * It keeps window size information flowing even if the other end closes its receive window.*/
     fnet_time_t delayed_ack;        /* Delayed acknowledgment timer.*/
-    fnet_time_t round_trip;         /* Round trip timer.*/
+    fnet_time_t round_trip;         /* Round trip timer (start time of the measurement).*/
+#if FNET_CFG_TCP_TLP
+    fnet_time_t tlp;                /* Tail loss probe timer. 
+                                    * After a repeated acknowledgment, it is the reordering timer.*/
+#endif
 } fnet_tcp_timers_t;
 
 
+#if !FNET_CFG_TCP_DISCARD_OUT_OF_ORDER
 /************************************************************************
-*    Control block structure
+*    Block of contiguous out-of-order data
 *************************************************************************/
 typedef struct
+{
+    fnet_uint32_t   seq;                    /* Sequence number of the first byte.*/
+    fnet_size_t     length;                 /* Number of bytes.*/
+    fnet_netbuf_t   *head;                  /* Data, without TCP headers.*/
+    fnet_netbuf_t   *tail;                  /* Last net_buf of the data chain.*/
+} fnet_tcp_reass_block_t;
+
+/************************************************************************
+*    Reassembly queue of out-of-order data
+*************************************************************************/
+typedef struct
+{
+    fnet_tcp_reass_block_t  block[FNET_CFG_TCP_REASS_INTERVALS];  /* Sorted by sequence number. 
+                                                                   * Blocks do not overlap and are not adjacent.*/
+    fnet_index_t            block_num;      /* Number of used blocks.*/
+    fnet_size_t             count;          /* Number of queued bytes.*/
+    fnet_uint32_t           last_seq;       /* Sequence number of the most recently queued data.*/
+} fnet_tcp_reass_t;
+#endif
+
+#if FNET_CFG_TCP_SACK
+/************************************************************************
+*    Block of data acknowledged by the SACK option
+*************************************************************************/
+typedef struct
+{
+    fnet_uint32_t   left;                   /* Sequence number of the first byte.*/
+    fnet_uint32_t   right;                  /* Sequence number following the last byte.*/
+} fnet_tcp_sack_block_t;
+#endif
+
+#if FNET_CFG_TCP_TIMEWAIT_SIZE
+/************************************************************************
+*    Compact TIME_WAIT record
+*************************************************************************/
+typedef struct
+{
+    struct sockaddr local_addr;     /* Local address and port.*/
+    struct sockaddr foreign_addr;   /* Foreign address and port.*/
+    fnet_uint32_t   sndseq;         /* Sequence number following the final segment.*/
+    fnet_uint32_t   sndack;         /* Acknowledgment number.*/
+#if FNET_CFG_TCP_TIMESTAMPS
+    fnet_bool_t     timestamp;      /* Timestamps option is used by the connection.*/
+    fnet_uint32_t   tsrecent;       /* Timestamp to be echoed (TS.Recent).*/
+#endif
+    fnet_time_t     expiry;         /* End of the TIME_WAIT state (FNET_TCP_TIMER_OFF if the record is free).*/
+} fnet_tcp_timewait_t;
+#endif
+
+/************************************************************************
+*    Congestion control algorithm
+*************************************************************************/
+struct fnet_tcp_control;
+
+typedef struct
+{
+    void (*init)( struct fnet_tcp_control *cb );                        /* The connection is established, or the algorithm is changed.*/
+    void (*on_ack)( struct fnet_tcp_control *cb, fnet_size_t size );    /* New data is acknowledged (out of the fast recovery).*/
+    void (*on_loss)( struct fnet_tcp_control *cb );                     /* Loss is detected by repeated acknowledgments.*/
+    void (*on_rto)( struct fnet_tcp_control *cb );                      /* Retransmission timeout.*/
+    void (*on_idle)( struct fnet_tcp_control *cb );                     /* Data is sent after the idle period.*/
+} fnet_tcp_cc_t;
+
+/************************************************************************
+*    Control block structure
+*************************************************************************/
+typedef struct fnet_tcp_control
 {
     /* Receive variables.*/
 #if !FNET_CFG_TCP_DISCARD_OUT_OF_ORDER    
-    fnet_netbuf_t   *tcpcb_rcvchain;        /* Temporary buffer.*/
-    fnet_size_t     tcpcb_count;            /* Size of data in the temporary buffer.*/
+    fnet_tcp_reass_t tcpcb_reass;           /* Out-of-order data.*/
+    fnet_uint32_t   tcpcb_rcvfinseq;        /* Sequence number of the out-of-order final segment.*/
+    fnet_uint32_t   tcpcb_rcvfinack;        /* Acknowledgment number of the out-of-order final segment.*/
+    fnet_bool_t     tcpcb_rcvfin;           /* Out-of-order final segment is received.*/
 #endif    
     fnet_size_t     tcpcb_rcvcountmax;      /* Size of the input and temporary buffers.*/
+#if FNET_CFG_TCP_RCVBUF_AUTO
+    fnet_size_t     tcpcb_rcvcountcap;      /* Upper limit of tcpcb_rcvcountmax (0 if auto-tuning is off).*/
+    fnet_uint32_t   tcpcb_autoseq;          /* Receive sequence number at the start of the measurement.*/
+    fnet_time_t     tcpcb_autotime;         /* Start time of the measurement (ms).*/
+    fnet_time_t     tcpcb_rcvrtt;           /* Round trip time, estimated by the receiver (ms).*/
+#endif
     
     fnet_uint32_t tcpcb_rcvack;             /* Highest acknowledged number of sent segments.*/
     fnet_uint32_t tcpcb_maxrcvack;          /* Maximal acknowledgment.*/
@@ -386,6 +530,24 @@ typedef struct
     fnet_uint32_t tcpcb_cwnd;           /* Congestion window.*/
     fnet_uint32_t tcpcb_pcount;         /* Counter of the tcpcb_cwnd parts.*/
     fnet_uint32_t tcpcb_ssthresh;       /* Slow start threshold.*/
+    fnet_uint32_t tcpcb_recover;        /* Highest sequence number sent when the fast recovery started.*/
+#if FNET_CFG_TCP_TLP
+    fnet_uint32_t tcpcb_tlphigh;        /* Highest sequence number sent when the tail loss probe is sent.*/
+#endif
+    fnet_time_t   tcpcb_sndtime;        /* Time when the data is sent last time (ms).*/
+#if FNET_CFG_TCP_SYN_COOKIES
+    fnet_uint32_t tcpcb_cookies_sent;   /* Number of SYN cookies sent (listening socket).*/
+    fnet_uint32_t tcpcb_cookies_valid;  /* Number of valid SYN cookies received (listening socket).*/
+    fnet_time_t   tcpcb_cookie_time;    /* Time when the last SYN cookie is sent (listening socket, sec).*/
+#endif
+    const fnet_tcp_cc_t *tcpcb_cc;      /* Congestion control algorithm.*/
+#if FNET_CFG_TCP_CUBIC
+    fnet_uint32_t tcpcb_cubic_wmax;     /* Congestion window before the last reduction.*/
+    fnet_uint32_t tcpcb_cubic_origin;   /* Origin point of the cubic function.*/
+    fnet_uint32_t tcpcb_cubic_wstart;   /* Congestion window at the start of the epoch (0 if the epoch is not started).*/
+    fnet_time_t   tcpcb_cubic_k;        /* Time period to reach the origin point (1/64 sec).*/
+    fnet_time_t   tcpcb_cubic_epoch;    /* Start time of the congestion avoidance epoch (ms).*/
+#endif
     fnet_uint16_t tcpcb_sndmss;         /* Maximal segment size (MSS).*/    
     fnet_uint8_t tcpcb_sendscale;       /* Scale of the window.*/
 #if FNET_CFG_TCP_URGENT     
@@ -394,16 +556,32 @@ typedef struct
 
     /* Input buffer variables.*/
     fnet_size_t   tcpcb_newfreercvsize; /* Free size of the input buffer.*/
+#if FNET_CFG_TCP_SEND_COALESCE
+    fnet_size_t   tcpcb_sndtailroom;    /* Spare space after the data of the last net_buf of the output buffer.*/
+#endif
 
     /* Retransmission variables.*/
     fnet_index_t tcpcb_fastretrcounter;         /* Repeated acknowledgment counter (for fast retransmission).*/
-    fnet_time_t tcpcb_rto;                      /* Retransmission timeout.*/
-    fnet_time_t tcpcb_crto;                     /* Current retransmission timeout.*/
-    fnet_time_t tcpcb_cprto;                    /* Current retransmission timeout for persist timer.*/
+    fnet_time_t tcpcb_rto;                      /* Retransmission timeout (ms).*/
+    fnet_time_t tcpcb_crto;                     /* Current retransmission timeout (ms).*/
+    fnet_time_t tcpcb_cprto;                    /* Current retransmission timeout for persist timer (ms).*/
     fnet_uint32_t tcpcb_retrseq;                /* Sequenc number of the retransmitting data.*/
     fnet_int32_t tcpcb_srtt;                    /* Smoothed round trip time.*/
     fnet_int32_t tcpcb_rttvar;                  /* Round trip time variance.*/
     fnet_tcp_timing_state_t tcpcb_timing_state; /* Timing state, defined by fnet_tcp_timing_state_t.*/
+#if FNET_CFG_TCP_SACK
+    fnet_tcp_sack_block_t tcpcb_sackblock[FNET_TCP_SACK_SCOREBOARD]; /* Scoreboard of the selectively acknowledged data.
+                                                 * Sorted by sequence number. Blocks do not overlap and are not adjacent.*/
+    fnet_index_t tcpcb_sackblock_num;           /* Number of used scoreboard blocks.*/
+    fnet_uint32_t tcpcb_sackrxt;                /* Highest sequence number retransmitted during the loss recovery.*/
+#endif
+#if FNET_CFG_TCP_TIMESTAMPS
+    fnet_uint32_t tcpcb_tsrecent;               /* Timestamp to be echoed to another side (TS.Recent).*/
+    fnet_time_t tcpcb_tsrecent_age;             /* Time when tcpcb_tsrecent is updated (ms).*/
+    fnet_uint32_t tcpcb_tslastack;              /* Last acknowledgment number sent (Last.ACK.sent).*/
+    fnet_uint32_t tcpcb_tsval;                  /* Timestamp value of the input segment.*/
+    fnet_uint32_t tcpcb_tsecr;                  /* Timestamp echo reply of the input segment.*/
+#endif
 
     /* Timers.*/
     fnet_tcp_timers_t tcpcb_timers;             /* Structure of the timers.*/
@@ -415,6 +593,26 @@ typedef struct
     fnet_flag_t tcpcb_flags; 
 } fnet_tcp_control_t;
 
+/************************************************************************
+*     Function Prototypes
+*************************************************************************/
+#if defined(__cplusplus)
+extern "C" {
+#endif
+
+#if !FNET_CFG_TCP_DISCARD_OUT_OF_ORDER
+fnet_bool_t fnet_tcp_reass_add( fnet_tcp_reass_t *reass, fnet_uint32_t seq, fnet_netbuf_t *data, fnet_size_t count_max );
+fnet_netbuf_t *fnet_tcp_reass_get( fnet_tcp_reass_t *reass, fnet_uint32_t *rcv_seq );
+void fnet_tcp_reass_free( fnet_tcp_reass_t *reass );
+#endif
+#if FNET_CFG_TCP_TIMEWAIT_SIZE
+fnet_bool_t fnet_tcp_timewait_conflict( const struct sockaddr *local_addr, const struct sockaddr *foreign_addr, fnet_bool_t wildcard );
+#endif
+
+#if defined(__cplusplus)
+}
+#endif
+
 /*************************************************************************/
 
 #endif
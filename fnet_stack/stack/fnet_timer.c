@@ -122,6 +122,22 @@ fnet_time_t fnet_timer_ms( void )
     return (fnet_current_time*FNET_TIMER_PERIOD_MS);
 }
 
+/************************************************************************
+* NAME: fnet_timer_fine_ms
+*
+* DESCRIPTION: This function returns current value of the timer 
+* in milliseconds, with millisecond granularity if the hardware 
+* timer supports it (FNET_CFG_CPU_TIMER_FINE). 
+*************************************************************************/
+fnet_time_t fnet_timer_fine_ms( void )
+{
+#if FNET_CFG_CPU_TIMER_FINE && !FNET_CFG_OS_TIMER
+    return fnet_cpu_timer_ms();
+#else
+    return fnet_timer_ms();
+#endif
+}
+
 /************************************************************************
 * NAME: fnet_timer_ticks_inc
 *
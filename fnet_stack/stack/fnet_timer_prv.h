@@ -53,6 +53,8 @@ void fnet_timer_free( fnet_timer_desc_t timer );
 void fnet_timer_ticks_inc( void );
 void fnet_timer_handler_bottom(fnet_uint32_t cookie);
 fnet_return_t fnet_cpu_timer_init( fnet_time_t period_ms );
+fnet_time_t fnet_cpu_timer_ms( void );
+fnet_time_t fnet_timer_fine_ms( void );
 
 #if defined(__cplusplus)
 }
@@ -46,6 +46,8 @@ static fnet_return_t fnet_udp_detach( fnet_socket_if_t *sk );
 static fnet_return_t fnet_udp_connect( fnet_socket_if_t *sk, struct sockaddr *foreign_addr);
 static fnet_int32_t fnet_udp_snd( fnet_socket_if_t *sk, fnet_uint8_t *buf, fnet_size_t len, fnet_flag_t flags, const struct sockaddr *addr);
 static fnet_int32_t fnet_udp_rcv(fnet_socket_if_t *sk, fnet_uint8_t *buf, fnet_size_t len, fnet_flag_t flags, struct sockaddr *addr);
+static fnet_int32_t fnet_udp_snd_netbuf( fnet_socket_if_t *sk, fnet_netbuf_t *nb, fnet_flag_t flags, const struct sockaddr *addr);
+static fnet_int32_t fnet_udp_rcv_netbuf(fnet_socket_if_t *sk, fnet_netbuf_t **nb_ptr, fnet_size_t len, fnet_flag_t flags, struct sockaddr *addr);
 static void fnet_udp_control_input(fnet_prot_notify_t command, struct sockaddr *src_addr,  struct sockaddr *dest_addr, fnet_netbuf_t *nb);
 static fnet_return_t fnet_udp_shutdown( fnet_socket_if_t *sk, fnet_sd_flags_t how );
 static void fnet_udp_input( fnet_netif_t *netif, struct sockaddr *foreign_addr,  struct sockaddr *local_addr, fnet_netbuf_t *nb, fnet_netbuf_t *ip_nb);
@@ -62,6 +64,9 @@ static fnet_error_t fnet_udp_output(struct sockaddr * src_addr, const struct soc
 *     Global Data Structures
 *************************************************************************/
 
+/* Sockets, hashed by local port.*/
+static fnet_socket_if_t *fnet_udp_port_hash[FNET_CFG_SOCKET_PORT_HASH_SIZE];
+
 /************************************************************************
  * Protocol API structures.
  ************************************************************************/
@@ -77,7 +82,10 @@ static const fnet_socket_prot_if_t fnet_udp_socket_api =
     fnet_udp_shutdown,      /* Protocol "shutdown" function.*/
     fnet_ip_setsockopt,     /* Protocol "setsockopt" function.*/
     fnet_ip_getsockopt,     /* Protocol "getsockopt" function.*/
-    0                       /* Protocol "listen" function.*/
+    0,                      /* Protocol "listen" function.*/
+    0,                      /* Protocol "poll" function.*/
+    fnet_udp_rcv_netbuf,    /* Protocol zero-copy "receive" function.*/
+    fnet_udp_snd_netbuf     /* Protocol zero-copy "send" function.*/
 };
 
 fnet_prot_if_t fnet_udp_prot_if =
@@ -91,7 +99,8 @@ fnet_prot_if_t fnet_udp_prot_if =
     fnet_udp_input,         /* Protocol input function.*/
     fnet_udp_control_input, /* Protocol input control function.*/     
     0,                      /* protocol drain function.*/
-    &fnet_udp_socket_api    /* Socket API */
+    &fnet_udp_socket_api,   /* Socket API */
+    fnet_udp_port_hash       /* Port lookup table.*/
 };
 
 /************************************************************************
@@ -135,17 +144,17 @@ static fnet_error_t fnet_udp_output(  struct sockaddr *src_addr, const struct so
     netif = (fnet_netif_t *)fnet_netif_get_by_scope_id(scope_id); /* It can be FNET_NULL, in case scope_id is 0.*/
 
     /* Construct UDP header.*/
-    if((nb_header = fnet_netbuf_new(sizeof(fnet_udp_header_t), FNET_TRUE)) == 0)
+    if((nb_header = fnet_netbuf_push(nb, sizeof(fnet_udp_header_t), FNET_TRUE)) == 0)
     {
         fnet_netbuf_free_chain(nb); 
         return (FNET_ERR_NOMEM);
     }
+    nb = nb_header;
 
-    udp_header = (fnet_udp_header_t *)nb_header->data_ptr;
+    udp_header = (fnet_udp_header_t *)nb->data_ptr;
 
     udp_header->source_port = src_addr->sa_port;             /* Source port number.*/
     udp_header->destination_port = dest_addr->sa_port;       /* Destination port number.*/
-    nb = fnet_netbuf_concat(nb_header, nb);
     udp_header->length = fnet_htons((fnet_uint16_t)nb->total_length);  /* Length.*/
 
     /* Checksum calculation.*/
@@ -279,7 +288,7 @@ static void fnet_udp_input(fnet_netif_t *netif, struct sockaddr *foreign_addr,
             {
                 last = 0;
 
-                for (sock = fnet_udp_prot_if.head; sock != 0; sock = sock->next)
+                for (sock = fnet_socket_hash_head(&fnet_udp_prot_if, local_addr->sa_port); sock != 0; sock = sock->hash_next)
                 {
                     /* Compare local port number.*/
                     if(sock->local_addr.sa_port != local_addr->sa_port)
@@ -363,6 +372,10 @@ static void fnet_udp_input(fnet_netif_t *netif, struct sockaddr *foreign_addr,
                             {
                                 fnet_netbuf_free_chain(nb_tmp);
                             }
+                            else
+                            {
+                                fnet_socket_poll_update(last);
+                            }
                         }
                     }
                     last = sock;
@@ -382,12 +395,14 @@ static void fnet_udp_input(fnet_netif_t *netif, struct sockaddr *foreign_addr,
                 {
                     goto BAD;
                 }
+
+                fnet_socket_poll_update(last);
                 
                 fnet_netbuf_free_chain(ip_nb);                  
             }
             else /* For unicast datagram.*/
             {
-                sock = fnet_socket_lookup(fnet_udp_prot_if.head, local_addr, foreign_addr, FNET_IP_PROTOCOL_UDP);
+                sock = fnet_socket_lookup(&fnet_udp_prot_if, local_addr, foreign_addr, FNET_IP_PROTOCOL_UDP);
 
                 if(sock)
                 {
@@ -399,6 +414,8 @@ static void fnet_udp_input(fnet_netif_t *netif, struct sockaddr *foreign_addr,
                     {
                         goto BAD;
                     }
+
+                    fnet_socket_poll_update(sock);
                     
                     fnet_netbuf_free_chain(ip_nb);
                 }
@@ -522,9 +539,41 @@ static fnet_return_t fnet_udp_connect( fnet_socket_if_t *sk, struct sockaddr *fo
 static fnet_int32_t fnet_udp_snd( fnet_socket_if_t *sk, fnet_uint8_t *buf, fnet_size_t len, fnet_flag_t flags, const struct sockaddr *addr)
 {
     fnet_netbuf_t           *nb;
+
+    if(len > sk->send_buffer.count_max)
+    {
+        fnet_socket_set_error(sk, FNET_ERR_MSGSIZE);   /* Message too long, do not copy it.*/
+        return (FNET_ERR);
+    }
+
+#if FNET_CFG_UDP_CHECKSUM && FNET_CFG_CHECKSUM_COPY
+    /* The payload is summed while copied, fnet_udp_output() does not read it again.*/
+    nb = fnet_netbuf_from_buf_checksum(buf, len, FNET_CFG_NETBUF_HEADROOM, FNET_FALSE);
+#else
+    nb = fnet_netbuf_from_buf_headroom(buf, len, FNET_CFG_NETBUF_HEADROOM, FNET_FALSE);
+#endif
+
+    if(nb == 0)
+    {
+        fnet_socket_set_error(sk, FNET_ERR_NOMEM);     /* Cannot allocate memory.*/
+        return (FNET_ERR);
+    }
+
+    return fnet_udp_snd_netbuf(sk, nb, flags, addr);
+}
+
+/************************************************************************
+* NAME: fnet_udp_snd_netbuf
+*
+* DESCRIPTION: UDP send function. The UDP header is prepended 
+*              to the net_buf chain, which is always freed.
+*************************************************************************/
+static fnet_int32_t fnet_udp_snd_netbuf( fnet_socket_if_t *sk, fnet_netbuf_t *nb, fnet_flag_t flags, const struct sockaddr *addr)
+{
     fnet_error_t            error = FNET_ERR_OK;
     const struct sockaddr   *foreign_addr;
     fnet_bool_t             flags_save = FNET_FALSE;
+    fnet_size_t             len = nb->total_length;
 
     fnet_isr_lock();
 
@@ -551,15 +600,11 @@ static fnet_int32_t fnet_udp_snd( fnet_socket_if_t *sk, fnet_uint8_t *buf, fnet_
         foreign_addr = &sk->foreign_addr;
     }
 
-    if((nb = fnet_netbuf_from_buf(buf, len, FNET_FALSE)) == 0)
-    {
-        error = FNET_ERR_NOMEM;     /* Cannot allocate memory.*/
-        goto ERROR;
-    }
-
     if(sk->local_addr.sa_port == 0u)
     {
-        sk->local_addr.sa_port = fnet_socket_get_uniqueport(sk->protocol_interface->head, &sk->local_addr); /* Get ephemeral port.*/
+        fnet_socket_hash_del(sk);
+        sk->local_addr.sa_port = fnet_socket_get_uniqueport(sk->protocol_interface, &sk->local_addr); /* Get ephemeral port.*/
+        fnet_socket_hash_add(sk);
     }
 
     if((flags & MSG_DONTROUTE) != 0u) /* Save */
@@ -569,6 +614,7 @@ static fnet_int32_t fnet_udp_snd( fnet_socket_if_t *sk, fnet_uint8_t *buf, fnet_
     }
 
     error = fnet_udp_output(&sk->local_addr, foreign_addr, &(sk->options), nb);
+    nb = 0; /* It is freed by fnet_udp_output().*/
 
     if((flags & MSG_DONTROUTE) != 0u) /* Restore.*/
     {
@@ -582,6 +628,11 @@ static fnet_int32_t fnet_udp_snd( fnet_socket_if_t *sk, fnet_uint8_t *buf, fnet_
     }
 
 ERROR:
+    if(nb)
+    {
+        fnet_netbuf_free_chain(nb);
+    }
+    
     fnet_socket_set_error(sk, error);
     fnet_isr_unlock();
     return (FNET_ERR);
@@ -635,6 +686,53 @@ ERROR:
     return (FNET_ERR);
 }
 
+/************************************************************************
+* NAME: fnet_udp_rcv_netbuf
+*
+* DESCRIPTION :UDP zero-copy receive function.
+*************************************************************************/
+static fnet_int32_t fnet_udp_rcv_netbuf(fnet_socket_if_t *sk, fnet_netbuf_t **nb_ptr, fnet_size_t len, fnet_flag_t flags, struct sockaddr *addr)
+{
+    fnet_error_t    error = FNET_ERR_OK;
+    fnet_int32_t    length;
+    struct sockaddr foreign_addr;
+    
+    FNET_COMP_UNUSED_ARG(flags);
+
+    fnet_memset_zero ((void *)&foreign_addr, sizeof(foreign_addr));
+    
+    if((length = fnet_socket_buffer_take_address(&(sk->receive_buffer), nb_ptr, len, &foreign_addr)) == FNET_ERR)
+    {
+        /* The message was too large to fit into the specified length and was discarded.*/
+        error = FNET_ERR_MSGSIZE;
+        goto ERROR;
+    }
+
+    if(sk->options.local_error == FNET_ERR_OK) 
+    {
+        if(addr)
+        {
+            fnet_socket_addr_copy(&foreign_addr, addr);
+        }
+        
+        return (length);
+    }
+    else /* We get UDP or ICMP error.*/
+    {
+        error = sk->options.local_error;
+    }
+
+ERROR:
+    if(*nb_ptr)
+    {
+        fnet_netbuf_free_chain(*nb_ptr);
+        *nb_ptr = 0;
+    }
+
+    fnet_socket_set_error(sk, error);
+    return (FNET_ERR);
+}
+
 /************************************************************************
 * NAME: fnet_udp_control_input
 *
@@ -682,6 +780,7 @@ static void fnet_udp_control_input(fnet_prot_notify_t command, struct sockaddr *
             }
 
             sock->options.local_error = error;
+            fnet_socket_poll_update(sock);
         }
     }
 }